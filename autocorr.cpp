@@ -2,7 +2,7 @@
  * @file timescales/autocorr.cpp
  * @author Krzysztof Findeisen
  * @date Created February 16, 2011
- * @date Last modified November 19, 2013
+ * @date Last modified October 18, 2026
  */ 
 
 /* Copyright 2014, California Institute of Technology.
@@ -27,6 +27,7 @@
  * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <complex>
 #include <string>
 #include <vector>
@@ -35,8 +36,12 @@
 #include <boost/smart_ptr.hpp>
 #include <gsl/gsl_fft_halfcomplex.h>
 #include "dft.h"
+#include "sharedcache.h"
+#include "utils.h"
+#include "workspace.h"
 #include "timeexcept.h"
 #include "timescales.h"
+#include "trace.h"
 #include "../common/alloc.tmp.h"
 #include "../common/stats.tmp.h"
 
@@ -143,48 +148,318 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
  *
  * @todo Verify that input validation is worth the cost
  * @todo Prove performance
- * @todo Factor this function
  */
 void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
 		const DoubleVec &offsets, DoubleVec &acf, double maxFreq) {
+	autoCorr(times, fluxes, offsets, acf, maxFreq, threadWorkspace());
+}
+
+/** Calculates the autocorrelation function for a subset of a time series. 
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p fluxes. The maximum frequency is the 
+ * pseudo-Nyquist frequency of the unmasked epochs.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] offsets	The time grid over which the autocorrelation function 
+ *			should be calculated. 
+ * @param[out] acf	The value of the autocorrelation function at each 
+ *			offset.
+ *
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p mask.size() = @p times.size()
+ * @pre @p fluxes[i] is the flux of the source at @p times[i], for all i
+ * @pre @p offsets contains at least two unique elements
+ * @pre @p offsets contains only nonnegative values
+ * @pre @p offsets is uniformly sampled from 0 to some maximum value. This 
+ *	requirement will be relaxed in future versions.
+ * 
+ * @post @p acf.size() = @p offsets.size()
+ * @post @p acf[i] is the Scargle autocorrelation function of the unmasked 
+ *	data evaluated at @p offsets[i], for all i
+ * 
+ * @perform O(FM + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = @p offsets.size()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some offsets are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times, @p fluxes, and 
+ *	@p mask have different lengths, if @p offsets has at most one distinct 
+ *	value, or if it is not uniformly sampled.
+ * @exception std::bad_alloc Thrown if there is not enough memory to perform 
+ *	the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &offsets, DoubleVec &acf) {
+	checkMaskSize(times.size(), mask, "autoCorr()");
+
+	// Pseudo-Nyquist frequency of the unmasked epochs
+	// Delegate the remaining input validation to autoCorr()
+	double tMin = 0.0, tMax = 0.0;
+	size_t nValid = 0;
+	for(size_t i = 0; i < times.size(); i++) {
+		if (mask[i]) {
+			if (nValid == 0 || times[i] < tMin) {
+				tMin = times[i];
+			}
+			if (nValid == 0 || times[i] > tMax) {
+				tMax = times[i];
+			}
+			nValid++;
+		}
+	}
+	if (tMax <= tMin) {
+		throw except::BadLightCurve("Argument 'times' to autoCorr() contains only one unique value");
+	}
+
+	autoCorr(times, fluxes, mask, offsets, acf, 0.5 * nValid / (tMax - tMin));
+}
+
+/** Calculates the autocorrelation function for a subset of a time series. 
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p fluxes.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] offsets	The time grid over which the autocorrelation function 
+ *			should be calculated.
+ * @param[in] maxFreq	The maximum frequency to consider when calculating 
+ *			the autocorrelation function.
+ * @param[out] acf	The value of the autocorrelation function at each 
+ *			offset.
+ *
+ * @note Increasing maxFreq will increase the time resolution of acf at the 
+ *	cost of making the entire function noisier.
+ * 
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p mask.size() = @p times.size()
+ * @pre @p fluxes[i] is the flux of the source at @p times[i], for all i
+ * @pre @p offsets contains at least two unique elements
+ * @pre @p offsets contains only nonnegative values
+ * @pre @p offsets is uniformly sampled from 0 to some maximum value. This 
+ *	requirement will be relaxed in future versions.
+ * @pre @p maxFreq is positive
+ * 
+ * @post @p acf.size() = @p offsets.size()
+ * @post @p acf[i] is the Scargle autocorrelation function of the unmasked 
+ *	data evaluated at @p offsets[i], for all i
+ * 
+ * @perform O(FM + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = @p offsets.size()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some offsets are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times, @p fluxes, and 
+ *	@p mask have different lengths, if @p offsets has at most one distinct 
+ *	value, if it is not uniformly sampled, or if @p maxFreq is non-positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to perform 
+ *	the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ *
+ * @todo Verify that input validation is worth the cost
+ * @todo Prove performance
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &offsets, DoubleVec &acf, 
+		double maxFreq) {
+	autoCorr(times, fluxes, mask, offsets, acf, maxFreq, threadWorkspace());
+}
+
+/** Calculates the autocorrelation function for a time series, using 
+ *	preallocated memory.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] offsets	The time grid over which the autocorrelation function 
+ *			should be calculated.
+ * @param[out] acf	The value of the autocorrelation function at each 
+ *			offset.
+ * @param[in] maxFreq	The maximum frequency to consider when calculating 
+ *			the autocorrelation function.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ * 
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p times.size()
+ * @pre @p fluxes[i] is the flux of the source at @p times[i], for all i
+ * @pre @p offsets contains at least two unique elements
+ * @pre @p offsets contains only nonnegative values
+ * @pre @p offsets is uniformly sampled from 0 to some maximum value. This 
+ *	requirement will be relaxed in future versions.
+ * @pre @p maxFreq is positive
+ * 
+ * @post @p acf.size() = @p offsets.size()
+ * @post @p acf[i] is the Scargle autocorrelation function evaluated at @p offsets[i], for all i
+ * 
+ * @perform O(FN) time, where N = @p times.size() and F = @p offsets.size()
+ * @perfmore O(N + F) memory, which is allocated only the first time a 
+ *	Workspace is used
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has at most 
+ *	one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some offsets are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times and @p fluxes have 
+ *	different lengths, if @p offsets has at most one distinct value, if 
+ *	it is not uniformly sampled, or if @p maxFreq is non-positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to perform 
+ *	the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &offsets, DoubleVec &acf, double maxFreq, 
+		Workspace &workspace) {
+	ScratchFrame frame(workspace);
+	BoolVec &allValid = frame.bools(times.size());
+	allValid.assign(times.size(), true);
+	
+	autoCorr(times, fluxes, allValid, offsets, acf, maxFreq, workspace);
+}
+
+/** Calculates the autocorrelation function for a subset of a time series, 
+ *	using preallocated memory.
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p fluxes.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] offsets	The time grid over which the autocorrelation function 
+ *			should be calculated.
+ * @param[in] maxFreq	The maximum frequency to consider when calculating 
+ *			the autocorrelation function.
+ * @param[out] acf	The value of the autocorrelation function at each 
+ *			offset.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @note Increasing maxFreq will increase the time resolution of acf at the 
+ *	cost of making the entire function noisier.
+ * 
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p mask.size() = @p times.size()
+ * @pre @p fluxes[i] is the flux of the source at @p times[i], for all i
+ * @pre @p offsets contains at least two unique elements
+ * @pre @p offsets contains only nonnegative values
+ * @pre @p offsets is uniformly sampled from 0 to some maximum value. This 
+ *	requirement will be relaxed in future versions.
+ * @pre @p maxFreq is positive
+ * 
+ * @post @p acf.size() = @p offsets.size()
+ * @post @p acf[i] is the Scargle autocorrelation function of the unmasked 
+ *	data evaluated at @p offsets[i], for all i
+ * 
+ * @perform O(FM + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = @p offsets.size()
+ * @perfmore O(N + F) memory, which is allocated only the first time a 
+ *	Workspace is used
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some offsets are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times, @p fluxes, and 
+ *	@p mask have different lengths, if @p offsets has at most one distinct 
+ *	value, if it is not uniformly sampled, or if @p maxFreq is non-positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to perform 
+ *	the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ *
+ * @todo Verify that input validation is worth the cost
+ * @todo Prove performance
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &offsets, DoubleVec &acf, 
+		double maxFreq, Workspace &workspace) {
+	TraceSpan span("autoCorr");
 	size_t nTimes  = times.size();
 	size_t nOutput = offsets.size();
-	double tRange  = deltaT(times);
 	
+	if (fluxes.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Arguments 'times' and 'fluxes' to autoCorr() are not the same length (gave " 
+				+ lexical_cast<string>(nTimes)        + " for times, " 
+				+ lexical_cast<string>(fluxes.size()) + " for fluxes)");
+		} catch(const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Arguments 'times' and 'fluxes' to autoCorr() are not the same length");
+		}
+	}
+	checkMaskSize(nTimes, mask, "autoCorr()");
+
+	// All temporaries come from the workspace
+	ScratchFrame frame(workspace);
+
+	IndexVec &valid = frame.indices(0);
+	for(size_t i = 0; i < nTimes; i++) {
+		if (mask[i]) {
+			valid.push_back(i);
+		}
+	}
+
 	// Normalize the data
 	// Scargle (1989) argues this is too crude, but a fitting method of 
 	//	the kind he proposes is too slow and too inflexible
+	// Masked epochs are skipped by dft(), so their values don't matter
 	// While we're at it, also test for non-uniqueness and sorting
-	DoubleVec zeroFluxes(nTimes);
-	double meanFlux = kpfutils::mean(fluxes.begin(), fluxes.end());
+	DoubleVec &zeroFluxes = frame.doubles(nTimes);
+	zeroFluxes.assign(nTimes, 0.0);
+	double meanFlux = 0.0;
 	bool diffValues = false, sortedTimes = true;
-	for(size_t i = 0; i < nTimes; i++) {
-		zeroFluxes[i] = fluxes[i] - meanFlux;
-
-		if (!diffValues && times[i] != times.front()) {
+	for(IndexVec::const_iterator j = valid.begin(); j != valid.end(); j++) {
+		meanFlux += fluxes[*j];
+		if (!diffValues && times[*j] != times[valid.front()]) {
 			diffValues = true;
 		}
-		if (sortedTimes && i > 0 && times[i-1] > times[i]) {
+	}
+	if (!valid.empty()) {
+		meanFlux /= valid.size();
+	}
+	for(IndexVec::const_iterator j = valid.begin(); j != valid.end(); j++) {
+		zeroFluxes[*j] = fluxes[*j] - meanFlux;
+	}
+	for(size_t i = 1; i < nTimes && sortedTimes; i++) {
+		if (times[i-1] > times[i]) {
 			sortedTimes = false;
 		}
 	}
 	
 	// Construct the flat source we'll use to get the window function
-	DoubleVec oneFluxes(nTimes, 1.0);
+	DoubleVec &oneFluxes = frame.doubles(nTimes);
+	oneFluxes.assign(nTimes, 1.0);
 	
 	// Verify the preconditions
 	if (!diffValues) {
 		throw except::BadLightCurve("Argument 'times' to autoCorr() contains only one unique value");
 	} else if (!sortedTimes) {
 		throw kpfutils::except::NotSorted("Argument 'times' to autoCorr()  is not sorted in ascending order");
-	} else if (fluxes.size() != nTimes) {
-		try {
-			throw std::invalid_argument("Arguments 'times' and 'fluxes' to autoCorr() are not the same length (gave " 
-				+ lexical_cast<string>(nTimes)        + " for times, " 
-				+ lexical_cast<string>(fluxes.size()) + " for fluxes)");
-		} catch(const boost::bad_lexical_cast& e) {
-			throw std::invalid_argument("Arguments 'times' and 'fluxes' to autoCorr() are not the same length");
-		}
 	} else if (maxFreq <= 0.0) {
 		try {
 			throw std::invalid_argument("Argument 'maxFreq' to autoCorr() must be positive (gave " 
@@ -224,14 +499,19 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
 	// Going to a finer frequency spacing has no effect other than to 
 	// 	introduce a string of zeros at offset > Delta T in the final 
 	//	answer
-	DoubleVec freq;
+	// Only the unmasked epochs count towards the time range
+	double tRange  = times[valid.back()] - times[valid.front()];
+	DoubleVec &freq = frame.doubles(0);
 	double freqStep = 0.5/tRange;
-	freqGen(times, freq, 0.0, 0.5/offSpace, 0.5);
+	double freqUnit = 1.0/tRange;
+	for(double curFreq = 0.0; curFreq < 0.5/offSpace; curFreq += 0.5*freqUnit) {
+		freq.push_back(curFreq);
+	}
 
 	// Forward transform
-	ComplexVec xForm, winXForm;
-	dft(times, zeroFluxes, freq,    xForm);
-	dft(times,  oneFluxes, freq, winXForm);
+	ComplexVec &xForm = frame.complexes(0), &winXForm = frame.complexes(0);
+	dft(times, zeroFluxes, mask, freq,    xForm, workspace);
+	dft(times,  oneFluxes, mask, freq, winXForm, workspace);
 
 	// Zero all the high frequencies
 	// Note if maxFreq > 0.5/offSpace, this code has no effect
@@ -256,14 +536,10 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
 	
 	// Reverse transform -- setup
 	size_t gslSize = 2*xForm.size() - 1;
-	shared_ptr<gsl_fft_halfcomplex_wavetable> theTable(checkAlloc(
-		gsl_fft_halfcomplex_wavetable_alloc(gslSize)), 
-		&gsl_fft_halfcomplex_wavetable_free);
-	shared_ptr<gsl_fft_real_workspace> theSpace(checkAlloc(
-		gsl_fft_real_workspace_alloc(gslSize)), 
-		&gsl_fft_real_workspace_free);
+	gsl_fft_halfcomplex_wavetable* theTable = frame.halfcomplexTable(gslSize);
+	gsl_fft_real_workspace* theSpace = frame.realSpace(gslSize);
 	
-	scoped_array<double> gslBuffer(new double[gslSize]);
+	DoubleVec &gslBuffer = frame.doubles(gslSize);
 	gslBuffer[0] = xForm[0].real();
 	for (size_t i = 1; i < xForm.size(); i++) {
 		gslBuffer[2*i-1] = xForm[i].real();
@@ -274,11 +550,11 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
 	//	xForm[0].imag() need be dropped
 	
 	// Reverse transform -- action
-	gsl_fft_halfcomplex_transform(gslBuffer.get(), 1, gslSize, 
-		theTable.get(), theSpace.get());
+	gsl_fft_halfcomplex_transform(&gslBuffer[0], 1, gslSize, 
+		theTable, theSpace);
 	
 	// Reinterpret gslBuffer as autocorrelation function
-	DoubleVec tempAcf;
+	DoubleVec &tempAcf = frame.doubles(0);
 	for(size_t i = 0; i < gslSize; i++) {
 		double time = static_cast<double>(i)/((gslSize-1) * freqStep);
 		// Values above tRange are aliases, so don't record them
@@ -298,9 +574,9 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
 		gslBuffer[2*i-1] = winXForm[i].real();
 		gslBuffer[2*i  ] = winXForm[i].imag();
 	}
-	gsl_fft_halfcomplex_transform(gslBuffer.get(), 1, gslSize, 
-			theTable.get(), theSpace.get());
-	DoubleVec winAcf;
+	gsl_fft_halfcomplex_transform(&gslBuffer[0], 1, gslSize, 
+			theTable, theSpace);
+	DoubleVec &winAcf = frame.doubles(0);
 	for(size_t i = 0; i < gslSize; i++) {
 		double time = static_cast<double>(i)/((gslSize-1) * freqStep);
 		// Values above tRange are aliases, so don't record them
@@ -320,8 +596,7 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
 	
 	// IMPORTANT: no exceptions beyond this point
 	
-	using std::swap;
-	swap(acf, tempAcf);
+	storeResult(tempAcf, acf);
 }
 
 /** Calculates the autocorrelation window function for a time sampling.
@@ -537,4 +812,89 @@ void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf,
 	swap(wf, tempWf);
 }
 
+/** Computes an ACF window function into a cache table.
+ */
+class WindowBuilder : public TableBuilder {
+public:
+	/** Stores the arguments of acWindow().
+	 */
+	WindowBuilder(const DoubleVec &times, const DoubleVec &offsets, double maxFreq) 
+			: times(times), offsets(offsets), maxFreq(maxFreq) {
+	}
+
+	/** Runs acWindow() and stores its output.
+	 */
+	virtual void build(double* table) const {
+		DoubleVec wf;
+		acWindow(times, offsets, wf, maxFreq);
+		std::copy(wf.begin(), wf.end(), table);
+	}
+
+private:
+	const DoubleVec &times, &offsets;
+	const double maxFreq;
+};
+
+/** Calculates the window function of the Scargle autocorrelation function, 
+ *	sharing the result between processes.
+ *
+ * This function gives the same result as 
+ * @ref acWindow(const DoubleVec&, const DoubleVec&, DoubleVec&, double) "acWindow()", 
+ * but the first process on a node to ask for a given window function 
+ * publishes it in @p cache, and every later request with the same 
+ * arguments copies it instead of recomputing it.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] offsets	The time offsets over which the window function 
+ *			should be calculated.
+ * @param[out] wf	The window function evaluated at each offset
+ * @param[in] maxFreq	The maximum frequency to use when computing the 
+ *			window function.
+ * @param[in,out] cache	The cache in which to look for, or publish, the 
+ *			window function
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p offsets contains at least two unique values
+ * @pre @p offsets is sorted in ascending order
+ * @pre @p offsets is a uniform grid
+ * @pre @p offsets[0] = 0
+ * @pre @p maxFreq > 0
+ * 
+ * @post @p wf is identical to the output of acWindow() without a cache.
+ * 
+ * @perform O(FN) time for the first request on a node, O(N + F) time 
+ *	for later ones, where N = @p times.size() and F = @p offsets.size()
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has at most 
+ *	one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some offsets are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p offsets has at most one 
+ *	distinct value, if it is not uniformly sampled, or if @p maxFreq is 
+ *	non-negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to perform 
+ *	the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception. The cache is unchanged, except that it may have 
+ *	allocated space for the window function.
+ */
+void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf, 
+		double maxFreq, SharedCache &cache) {
+	CacheKey key("acWindow");
+	key.add(times).add(offsets).add(&maxFreq, sizeof(maxFreq));
+	shared_ptr<const double> table = CacheAccess::table(cache, key, offsets.size(), 
+		WindowBuilder(times, offsets, maxFreq));
+
+	DoubleVec temp(table.get(), table.get() + offsets.size());
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(wf, temp);
+}
+
 }	// end kpftimes
@@ -0,0 +1,330 @@
+/** Crash-isolated processing of many objects in a pool of worker processes
+ * @file timescales/batch.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+
+/** States of an object in a batch. 
+ */
+enum ItemState {
+	PENDING = 0,
+	WORKING,
+	FINISHED,
+	FAILED
+};
+
+/** Memory shared between processBatch() and its workers.
+ *
+ * The layout is a header, one state and one owner per object, and then 
+ * the results of all objects in order.
+ */
+class BatchMap {
+public:
+	/** Maps enough anonymous shared memory for a batch.
+	 *
+	 * @param[in] nItems	The number of objects in the batch
+	 * @param[in] nValues	The number of values produced for each object
+	 *
+	 * @exception std::runtime_error Thrown if the memory could not be mapped.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	BatchMap(size_t nItems, size_t nValues) : base(MAP_FAILED), length(0), 
+			next(NULL), states(NULL), owners(NULL), values(NULL) {
+		const size_t ownerStart = sizeof(size_t) + nItems*sizeof(int);
+		const size_t ownerAligned = (ownerStart + sizeof(pid_t) - 1) 
+			/ sizeof(pid_t) * sizeof(pid_t);
+		const size_t valueStart = ownerAligned + nItems*sizeof(pid_t);
+		const size_t valueAligned = (valueStart + sizeof(double) - 1) 
+			/ sizeof(double) * sizeof(double);
+		length = valueAligned + nItems*nValues*sizeof(double);
+		
+		base = mmap(NULL, length, PROT_READ | PROT_WRITE, 
+			MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if (base == MAP_FAILED) {
+			throw std::runtime_error(string("processBatch() could not map shared memory: ") 
+				+ strerror(errno));
+		}
+		
+		// Anonymous memory is zeroed, so all objects start out PENDING
+		char* bytes = static_cast<char*>(base);
+		next   = static_cast<volatile size_t*>(base);
+		states = reinterpret_cast<volatile int*>(bytes + sizeof(size_t));
+		owners = reinterpret_cast<volatile pid_t*>(bytes + ownerAligned);
+		values = reinterpret_cast<double*>(bytes + valueAligned);
+	}
+
+	/** Unmaps the memory from this process.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	~BatchMap() {
+		munmap(base, length);
+	}
+
+private:
+	// Not copyable
+	BatchMap(const BatchMap &other);
+	BatchMap& operator=(const BatchMap &other);
+
+	void* base;
+	size_t length;
+
+public:
+	/** The index of the next object nobody has claimed */
+	volatile size_t* next;
+	/** The ItemState of each object */
+	volatile int* states;
+	/** The worker that claimed each object */
+	volatile pid_t* owners;
+	/** The results of each object, in order */
+	double* values;
+};
+
+/** Does nothing.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BatchTask::~BatchTask() {
+}
+
+/** Processes objects until none are left. Runs in a worker process.
+ *
+ * @param[in,out] task	The calculation to run
+ * @param[in] nItems	The number of objects in the batch
+ * @param[in,out] map	The memory shared with processBatch()
+ *
+ * @post Every object claimed by this worker is FINISHED or FAILED, 
+ *	unless the worker crashed.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void runWorker(BatchTask &task, size_t nItems, BatchMap &map) {
+	const size_t nValues = task.resultSize();
+	const pid_t self = getpid();
+	DoubleVec result;
+	
+	for(;;) {
+		size_t item = __sync_fetch_and_add(map.next, 1);
+		if (item >= nItems) {
+			break;
+		}
+		map.owners[item] = self;
+		__sync_synchronize();
+		map.states[item] = WORKING;
+		
+		int outcome = FAILED;
+		try {
+			TraceSpan span("BatchTask::process", item);
+			result.assign(nValues, 0.0);
+			task.process(item, result);
+			if (result.size() == nValues) {
+				std::copy(result.begin(), result.end(), map.values + item*nValues);
+				outcome = FINISHED;
+			}
+		} catch (...) {
+			// Any exception counts as a failure of this object only
+		}
+		__sync_synchronize();
+		map.states[item] = outcome;
+	}
+}
+
+/** Starts a worker process.
+ *
+ * @param[in,out] task	The calculation to run
+ * @param[in] nItems	The number of objects in the batch
+ * @param[in,out] map	The memory shared with the workers
+ *
+ * @return The process ID of the worker, or -1 if it could not be started.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+pid_t startWorker(BatchTask &task, size_t nItems, BatchMap &map) {
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Let a crash end the worker, even if the parent traps signals
+		signal(SIGSEGV, SIG_DFL);
+		signal(SIGBUS , SIG_DFL);
+		signal(SIGFPE , SIG_DFL);
+		signal(SIGILL , SIG_DFL);
+		signal(SIGABRT, SIG_DFL);
+		resetTraceAfterFork();
+		
+		runWorker(task, nItems, map);
+		flushWorkerTrace();
+		// Skip destructors and atexit handlers that belong to the parent
+		_exit(0);
+	}
+	return pid;
+}
+
+/** Runs a task over many objects in a pool of worker processes.
+ *
+ * Each worker is a forked copy of the calling process, so @p task and 
+ * everything it refers to are available to the workers without being 
+ * copied explicitly. Workers claim objects one at a time from a shared 
+ * counter, so the load stays balanced even if some objects take much 
+ * longer than others. 
+ *
+ * An object fails if BatchTask::process() throws an exception for it, or 
+ * if its worker crashes while processing it. A crashed worker is replaced 
+ * as long as objects remain, and no other object is affected.
+ *
+ * Each call of processBatch() creates new workers, so state changed by 
+ * one call of BatchTask::process() is visible only to later objects 
+ * handled by the same worker. Workers should not use OpenMP, and the 
+ * caller should not be inside an OpenMP parallel region.
+ *
+ * @param[in,out] task	The calculation to run on each object
+ * @param[in] nItems	The number of objects to process
+ * @param[in] nWorkers	The number of worker processes to run at once
+ * @param[out] results	The values produced for each object, in order. 
+ *			Object i occupies elements 
+ *			[i &times; task.resultSize(), (i+1) &times; task.resultSize()).
+ * @param[out] failed	The indices of the objects that could not be 
+ *			processed, in ascending order
+ *
+ * @pre @p nWorkers &ge; 1
+ *
+ * @post @p results.size() = @p nItems &times; task.resultSize()
+ * @post The values of every object listed in @p failed are NaN.
+ *
+ * @perform O(@p nItems &times; task.resultSize()) time in the calling 
+ *	process, plus the time to process each object divided among 
+ *	@p nWorkers processes
+ * @perfmore O(@p nItems &times; task.resultSize()) shared memory
+ *
+ * @exception std::invalid_argument Thrown if @p nWorkers is zero.
+ * @exception std::runtime_error Thrown if shared memory could not be 
+ *	allocated, or if no worker could be started.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the results.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception.
+ */
+void processBatch(BatchTask &task, size_t nItems, size_t nWorkers, 
+		DoubleVec &results, std::vector<size_t> &failed) {
+	if (nWorkers == 0) {
+		throw std::invalid_argument("processBatch() needs at least one worker");
+	}
+	TraceSpan span("processBatch", nItems);
+	const size_t nValues = task.resultSize();
+	
+	DoubleVec tempResults(nItems*nValues, std::numeric_limits<double>::quiet_NaN());
+	std::vector<size_t> tempFailed;
+	
+	if (nItems > 0) {
+		BatchMap map(nItems, nValues);
+		
+		std::vector<pid_t> workers;
+		for(size_t i = 0; i < std::min(nWorkers, nItems); i++) {
+			pid_t pid = startWorker(task, nItems, map);
+			if (pid > 0) {
+				workers.push_back(pid);
+			}
+		}
+		if (workers.empty()) {
+			throw std::runtime_error(string("processBatch() could not start any workers: ") 
+				+ strerror(errno));
+		}
+		
+		while (!workers.empty()) {
+			bool changed = false;
+			for(size_t i = 0; i < workers.size(); ) {
+				int status = 0;
+				pid_t done = waitpid(workers[i], &status, WNOHANG);
+				if (done == 0 || (done < 0 && errno == EINTR)) {
+					i++;
+					continue;
+				}
+				changed = true;
+				const pid_t dead = workers[i];
+				workers.erase(workers.begin() + i);
+				
+				if (done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+					// The worker crashed; only its current object is lost
+					for(size_t item = 0; item < nItems; item++) {
+						if (map.states[item] == WORKING && map.owners[item] == dead) {
+							map.states[item] = FAILED;
+						}
+					}
+					if (*map.next < nItems) {
+						pid_t pid = startWorker(task, nItems, map);
+						if (pid > 0) {
+							workers.push_back(pid);
+						}
+					}
+				}
+			}
+			if (!changed) {
+				timespec pause = {0, 1000000};
+				nanosleep(&pause, NULL);
+			}
+		}
+		
+		// Objects that are not FINISHED were lost with their worker, 
+		//	or were never reached because every worker crashed
+		__sync_synchronize();
+		for(size_t item = 0; item < nItems; item++) {
+			if (map.states[item] == FINISHED) {
+				std::copy(map.values + item*nValues, map.values + (item+1)*nValues, 
+					tempResults.begin() + item*nValues);
+			} else {
+				tempFailed.push_back(item);
+			}
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(results, tempResults);
+	swap(failed , tempFailed );
+}
+
+}		// end kpftimes
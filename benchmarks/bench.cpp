@@ -0,0 +1,534 @@
+/** Benchmark harness for the Timescales library.
+ * @file timescales/benchmarks/bench.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ *
+ * This program times a fixed set of library calls on synthetic data and 
+ * prints the results as JSON. With the @c --counters option it also reads 
+ * the CPU's hardware event counters around each call, and reports derived 
+ * metrics that show whether a calculation is limited by computation, 
+ * cache or memory.
+ *
+ * With the @c --differential option it instead compares each of the 
+ * library's fast paths to the calculation it replaces, on random cadences 
+ * and on the light curves used by the regression tests, and reports the 
+ * errors and speedups.
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <time.h>
+#include "../timescales.h"
+#include "counters.h"
+#include "differential.h"
+#include "report.h"
+#include "workload.h"
+
+using namespace kpftimes;
+using kpftimes::bench::HardwareCounters;
+using boost::shared_ptr;
+
+/** A library call whose speed is measured.
+ *
+ * Each case describes the size of its problem in two ways. The number of 
+ * elements is the natural unit of work for the algorithm (e.g., 
+ * time-frequency pairs for a periodogram), and is used to normalize cache 
+ * and branch misses. The nominal flop count is the number of 
+ * floating-point operations in a textbook implementation, and is used to 
+ * normalize memory traffic; it is zero if there is no simple model.
+ */
+class Case {
+public:
+	virtual ~Case() {
+	}
+	
+	/** Returns a unique identifier for the case.
+	 */
+	virtual std::string name() const = 0;
+	/** Returns the number of elements processed by one run.
+	 */
+	virtual double elements() const = 0;
+	/** Returns the nominal number of floating-point operations in one run.
+	 */
+	virtual double flops() const = 0;
+	/** Runs the calculation once.
+	 */
+	virtual void run() = 0;
+};
+
+/** Makes an irregularly sampled, noisy sine curve.
+ *
+ * @param[in] n		The number of observations
+ * @param[in] baseline	The time spanned by the observations
+ * @param[out] times	The observation times, in ascending order
+ * @param[out] fluxes	The simulated measurements
+ */
+void makeLightCurve(size_t n, double baseline, DoubleVec &times, DoubleVec &fluxes) {
+	times .resize(n);
+	fluxes.resize(n);
+	for(size_t i = 0; i < n; i++) {
+		// Deterministic, so that runs are comparable
+		times [i] = baseline * (i + 0.5 + 0.4*sin(3.7*i)) / n;
+		fluxes[i] = sin(2.0*times[i]) + 0.3*cos(17.0*i);
+	}
+}
+
+/** Makes a regular grid.
+ *
+ * @param[in] n		The number of grid points
+ * @param[in] start	The first grid point
+ * @param[in] step	The spacing of the grid
+ * @param[out] grid	The grid
+ */
+void makeGrid(size_t n, double start, double step, DoubleVec &grid) {
+	grid.resize(n);
+	for(size_t i = 0; i < n; i++) {
+		grid[i] = start + step * i;
+	}
+}
+
+/** Times lombScargle().
+ *
+ * An element is one pair of an observation and a frequency. The direct 
+ * sum needs about 16 operations per element.
+ */
+class PeriodogramCase : public Case {
+public:
+	PeriodogramCase(size_t nTimes, size_t nFreqs) : times(), fluxes(), freqs(), 
+			power(), workspace() {
+		makeLightCurve(nTimes, 100.0, times, fluxes);
+		makeGrid(nFreqs, 0.001, 0.001, freqs);
+	}
+	virtual std::string name() const {
+		return "lombScargle_n" + boost::lexical_cast<std::string>(times.size());
+	}
+	virtual double elements() const {
+		return static_cast<double>(times.size()) * freqs.size();
+	}
+	virtual double flops() const {
+		return 16.0 * elements();
+	}
+	virtual void run() {
+		lombScargle(times, fluxes, freqs, power, workspace);
+	}
+private:
+	DoubleVec times, fluxes, freqs, power;
+	Workspace workspace;
+};
+
+/** Times lsThreshold() with white noise.
+ *
+ * An element is one pair of an observation and a frequency in one 
+ * simulation, with the same operation count as for lombScargle().
+ */
+class ThresholdCase : public Case {
+public:
+	ThresholdCase(size_t nTimes, size_t nFreqs, long nSims) : times(), freqs(), 
+			nSims(nSims) {
+		DoubleVec fluxes;
+		makeLightCurve(nTimes, 100.0, times, fluxes);
+		makeGrid(nFreqs, 0.001, 0.001, freqs);
+	}
+	virtual std::string name() const {
+		return "lsThreshold_n" + boost::lexical_cast<std::string>(times.size());
+	}
+	virtual double elements() const {
+		return static_cast<double>(times.size()) * freqs.size() * nSims;
+	}
+	virtual double flops() const {
+		return 16.0 * elements();
+	}
+	virtual void run() {
+		lsThreshold(times, freqs, 0.05, nSims, WhiteNoise(), 42);
+	}
+private:
+	DoubleVec times, freqs;
+	const long nSims;
+};
+
+/** Times autoCorr().
+ *
+ * An element is one pair of an observation and an offset. The ACF is 
+ * computed through Fourier transforms, so there is no simple flop model.
+ */
+class AutoCorrCase : public Case {
+public:
+	AutoCorrCase(size_t nTimes, size_t nOffsets) : times(), fluxes(), offsets(), 
+			acf(), workspace() {
+		makeLightCurve(nTimes, 100.0, times, fluxes);
+		makeGrid(nOffsets, 0.0, 0.01, offsets);
+	}
+	virtual std::string name() const {
+		return "autoCorr_n" + boost::lexical_cast<std::string>(times.size());
+	}
+	virtual double elements() const {
+		return static_cast<double>(times.size()) * offsets.size();
+	}
+	virtual double flops() const {
+		return 0.0;
+	}
+	virtual void run() {
+		autoCorr(times, fluxes, offsets, acf, 10.0, workspace);
+	}
+private:
+	DoubleVec times, fluxes, offsets, acf;
+	Workspace workspace;
+};
+
+/** Times dmdt().
+ *
+ * An element is one pair of observations, needing two subtractions.
+ */
+class DmdtCase : public Case {
+public:
+	explicit DmdtCase(size_t nTimes) : times(), fluxes(), deltaT(), deltaM() {
+		makeLightCurve(nTimes, 100.0, times, fluxes);
+	}
+	virtual std::string name() const {
+		return "dmdt_n" + boost::lexical_cast<std::string>(times.size());
+	}
+	virtual double elements() const {
+		const double n = static_cast<double>(times.size());
+		return 0.5 * n * (n - 1.0);
+	}
+	virtual double flops() const {
+		return 2.0 * elements();
+	}
+	virtual void run() {
+		dmdt(times, fluxes, deltaT, deltaM);
+	}
+private:
+	DoubleVec times, fluxes, deltaT, deltaM;
+};
+
+/** Times lombScargle() on every object of a synthetic survey.
+ *
+ * The objects come from makeObject(), so their cadences and lengths 
+ * follow the mix of a real survey rather than a single random cadence. 
+ * Elements and flops are counted as for PeriodogramCase.
+ */
+class SurveyCase : public Case {
+public:
+	SurveyCase(size_t nObjects, size_t nFreqs) : objects(nObjects), freqs(), 
+			power(), workspace() {
+		for(size_t i = 0; i < nObjects; i++) {
+			kpftimes::bench::makeObject(1, i + 1, objects[i]);
+		}
+		makeGrid(nFreqs, 0.002, 0.002, freqs);
+	}
+	virtual std::string name() const {
+		return "survey_lombScargle";
+	}
+	virtual double elements() const {
+		double epochs = 0.0;
+		for(size_t i = 0; i < objects.size(); i++) {
+			epochs += objects[i].times.size();
+		}
+		return epochs * freqs.size();
+	}
+	virtual double flops() const {
+		return 16.0 * elements();
+	}
+	virtual void run() {
+		for(size_t i = 0; i < objects.size(); i++) {
+			lombScargle(objects[i].times, objects[i].fluxes, freqs, power, workspace);
+		}
+	}
+private:
+	std::vector<kpftimes::bench::SyntheticObject> objects;
+	DoubleVec freqs, power;
+	Workspace workspace;
+};
+
+/** Returns a monotonic time stamp.
+ *
+ * @return The time, in seconds, since an arbitrary fixed point.
+ */
+double now() {
+	timespec stamp;
+	clock_gettime(CLOCK_MONOTONIC, &stamp);
+	return stamp.tv_sec + 1e-9 * stamp.tv_nsec;
+}
+
+/** Formats a number for JSON output.
+ *
+ * @param[in] x	The number to format
+ *
+ * @return A JSON number, or @c null if @p x is not finite.
+ */
+std::string json(double x) {
+	if (x != x || x - x != 0.0) {
+		return "null";
+	}
+	char buffer[32];
+	sprintf(buffer, "%.6g", x);
+	return buffer;
+}
+
+/** Formats a string for JSON output.
+ *
+ * @param[in] x	The string to format
+ *
+ * @return A quoted JSON string.
+ */
+std::string json(const std::string &x) {
+	std::string result = "\"";
+	for(size_t i = 0; i < x.size(); i++) {
+		if (x[i] == '"' || x[i] == '\\') {
+			result += '\\';
+		}
+		if (static_cast<unsigned char>(x[i]) >= 0x20) {
+			result += x[i];
+		}
+	}
+	return result + "\"";
+}
+
+/** Returns the ratio of two measurements, or NaN if either is missing.
+ *
+ * @param[in] numerator, denominator	The measurements to divide
+ *
+ * @return @p numerator / @p denominator, or NaN if @p denominator is 
+ *	not positive.
+ */
+double ratio(double numerator, double denominator) {
+	if (denominator > 0.0) {
+		return numerator / denominator;
+	} else {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+}
+
+/** Times one case and prints its results.
+ *
+ * The counters are reported for the fastest run, which is the one least 
+ * disturbed by other processes.
+ *
+ * @param[in,out] benchmark	The case to run
+ * @param[in] repeats		The number of timed runs
+ * @param[in,out] counters	The counters to read, or NULL to skip them
+ * @param[in] out		The stream to print to
+ */
+void runCase(Case &benchmark, int repeats, HardwareCounters *counters, FILE *out) {
+	fprintf(out, "    {\n      \"name\": %s,\n", json(benchmark.name()).c_str());
+	fprintf(out, "      \"elements\": %s,\n", json(benchmark.elements()).c_str());
+	fprintf(out, "      \"nominal_flops\": %s,\n", 
+		json(benchmark.flops() > 0.0 ? benchmark.flops() 
+			: std::numeric_limits<double>::quiet_NaN()).c_str());
+	fprintf(out, "      \"repeats\": %d,\n", repeats);
+	
+	try {
+		// Warm up caches and workspaces
+		benchmark.run();
+		
+		DoubleVec times;
+		std::vector<DoubleVec> counts(HardwareCounters::N_EVENTS);
+		for(int i = 0; i < repeats; i++) {
+			if (counters != NULL) {
+				counters->start();
+			}
+			const double start = now();
+			benchmark.run();
+			times.push_back(now() - start);
+			if (counters != NULL) {
+				counters->stop();
+				for(int e = 0; e < HardwareCounters::N_EVENTS; e++) {
+					counts[e].push_back(counters->value(
+						static_cast<HardwareCounters::Event>(e)));
+				}
+			}
+		}
+		const size_t fastest = std::min_element(times.begin(), times.end()) 
+				- times.begin();
+		DoubleVec sorted = times;
+		std::sort(sorted.begin(), sorted.end());
+		const double best = sorted.front();
+		
+		fprintf(out, "      \"best_seconds\": %s,\n", json(best).c_str());
+		fprintf(out, "      \"median_seconds\": %s,\n", 
+			json(sorted[sorted.size()/2]).c_str());
+		fprintf(out, "      \"nominal_gflops\": %s", 
+			json(ratio(1e-9 * benchmark.flops(), best)).c_str());
+		
+		if (counters != NULL) {
+			double value[HardwareCounters::N_EVENTS];
+			fprintf(out, ",\n      \"counters\": {\n");
+			for(int e = 0; e < HardwareCounters::N_EVENTS; e++) {
+				value[e] = counts[e][fastest];
+				fprintf(out, "        \"%s\": %s%s\n", 
+					HardwareCounters::name(static_cast<HardwareCounters::Event>(e)), 
+					json(value[e]).c_str(), 
+					e + 1 < HardwareCounters::N_EVENTS ? "," : "");
+			}
+			fprintf(out, "      },\n");
+			
+			// Each last-level miss moves one 64-byte cache line from memory
+			const double elements = benchmark.elements();
+			fprintf(out, "      \"derived\": {\n");
+			fprintf(out, "        \"ipc\": %s,\n", json(ratio(
+				value[HardwareCounters::INSTRUCTIONS], 
+				value[HardwareCounters::CYCLES])).c_str());
+			fprintf(out, "        \"bytes_per_flop\": %s,\n", json(ratio(
+				64.0 * value[HardwareCounters::LLC_MISSES], 
+				benchmark.flops())).c_str());
+			fprintf(out, "        \"l1d_misses_per_element\": %s,\n", json(ratio(
+				value[HardwareCounters::L1D_MISSES], elements)).c_str());
+			fprintf(out, "        \"llc_misses_per_element\": %s,\n", json(ratio(
+				value[HardwareCounters::LLC_MISSES], elements)).c_str());
+			fprintf(out, "        \"branch_misses_per_element\": %s\n", json(ratio(
+				value[HardwareCounters::BRANCH_MISSES], elements)).c_str());
+			fprintf(out, "      }");
+		}
+		fprintf(out, "\n");
+	} catch (const std::exception &e) {
+		fprintf(out, "      \"error\": %s\n", json(e.what()).c_str());
+	}
+	fprintf(out, "    }");
+}
+
+/** Prints the command-line syntax.
+ */
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [--counters] [--repeat N] [--only NAME] [--output FILE]\n", 
+		program);
+	fprintf(stderr, "       %s --differential [--corpus DIR] [--repeat N] [--output FILE]\n", 
+		program);
+	fprintf(stderr, "  --counters     read hardware event counters around each call\n");
+	fprintf(stderr, "  --repeat N     time each call N times (default 5)\n");
+	fprintf(stderr, "  --only NAME    run only benchmarks whose name starts with NAME\n");
+	fprintf(stderr, "  --output FILE  write the JSON report to FILE instead of stdout\n");
+	fprintf(stderr, "  --differential compare fast paths to their reference calculations\n");
+	fprintf(stderr, "  --corpus DIR   directory with idl_target_in_*.txt (default ../tests)\n");
+}
+
+/** Runs the benchmarks.
+ *
+ * @return 0 on success, 1 if the command line was invalid or the output 
+ *	file could not be opened, 2 if a fast path exceeded its tolerance.
+ */
+int main(int argc, char *argv[]) {
+	bool useCounters = false, differential = false;
+	int repeats = 5;
+	std::string only, outFile, corpus = "../tests";
+	for(int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--counters") {
+			useCounters = true;
+		} else if (arg == "--repeat" && i + 1 < argc) {
+			repeats = atoi(argv[++i]);
+		} else if (arg == "--only" && i + 1 < argc) {
+			only = argv[++i];
+		} else if (arg == "--output" && i + 1 < argc) {
+			outFile = argv[++i];
+		} else if (arg == "--differential") {
+			differential = true;
+		} else if (arg == "--corpus" && i + 1 < argc) {
+			corpus = argv[++i];
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (repeats < 1) {
+		usage(argv[0]);
+		return 1;
+	}
+	
+	shared_ptr<FILE> outHandle;
+	FILE *out = stdout;
+	if (!outFile.empty()) {
+		outHandle.reset(fopen(outFile.c_str(), "w"), &fclose);
+		if (outHandle.get() == NULL) {
+			fprintf(stderr, "Could not open %s\n", outFile.c_str());
+			return 1;
+		}
+		out = outHandle.get();
+	}
+	
+	if (differential) {
+		try {
+			std::vector<kpftimes::bench::LightCurve> curves;
+			kpftimes::bench::makeCadences(curves);
+			kpftimes::bench::loadCorpus(corpus, curves);
+			return kpftimes::bench::runDifferential(curves, repeats, out) > 0 ? 2 : 0;
+		} catch (const std::exception &e) {
+			fprintf(stderr, "Differential tests failed: %s\n", e.what());
+			return 1;
+		}
+	}
+	
+	std::vector<shared_ptr<Case> > cases;
+	cases.push_back(shared_ptr<Case>(new PeriodogramCase(2000, 20000)));
+	cases.push_back(shared_ptr<Case>(new PeriodogramCase(  32, 100000)));
+	cases.push_back(shared_ptr<Case>(new ThresholdCase(200, 2000, 200)));
+	cases.push_back(shared_ptr<Case>(new AutoCorrCase(1000, 2000)));
+	cases.push_back(shared_ptr<Case>(new DmdtCase(2000)));
+	cases.push_back(shared_ptr<Case>(new SurveyCase(50, 1000)));
+	
+	shared_ptr<HardwareCounters> counters;
+	if (useCounters) {
+		counters.reset(new HardwareCounters());
+	}
+	
+	fprintf(out, "{\n  \"library\": \"timescales\",\n");
+	if (counters.get() == NULL) {
+		fprintf(out, "  \"counters\": {\"enabled\": false},\n");
+	} else {
+		fprintf(out, "  \"counters\": {\"enabled\": true, \"status\": %s, \"events\": {", 
+			json(counters->status().empty() ? "ok" : counters->status()).c_str());
+		for(int e = 0; e < HardwareCounters::N_EVENTS; e++) {
+			const HardwareCounters::Event event = static_cast<HardwareCounters::Event>(e);
+			fprintf(out, "%s\"%s\": %s", e > 0 ? ", " : "", HardwareCounters::name(event), 
+				counters->available(event) ? "true" : "false");
+		}
+		fprintf(out, "}},\n");
+	}
+	
+	fprintf(out, "  \"benchmarks\": [\n");
+	bool first = true;
+	for(size_t i = 0; i < cases.size(); i++) {
+		if (cases[i]->name().compare(0, only.size(), only) != 0) {
+			continue;
+		}
+		if (!first) {
+			fprintf(out, ",\n");
+		}
+		runCase(*cases[i], repeats, counters.get(), out);
+		first = false;
+	}
+	fprintf(out, "\n  ]\n}\n");
+	
+	return 0;
+}
@@ -0,0 +1,237 @@
+/** Hardware performance counters for the benchmark harness
+ * @file timescales/benchmarks/counters.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <boost/cstdint.hpp>
+#include "counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kpftimes { namespace bench {
+
+using boost::uint64_t;
+
+#ifdef __linux__
+/** Opens one counter for the calling thread and its future children.
+ *
+ * @param[in] type, config	The event to count, as defined by 
+ *				@c perf_event_open
+ *
+ * @return A file descriptor for the counter, or -1 if it could not be 
+ *	opened.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+int openCounter(boost::uint32_t type, uint64_t config) {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size           = sizeof(attr);
+	attr.type           = type;
+	attr.config         = config;
+	attr.disabled       = 1;
+	attr.inherit        = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv     = 1;
+	attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	
+	return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+/** Opens as many counters as the system allows.
+ *
+ * @post available() is true for every event the system can count. If 
+ *	it is false for all events, status() explains why.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the status.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+HardwareCounters::HardwareCounters() : reason() {
+	for(int i = 0; i < N_EVENTS; i++) {
+		fds[i]    = -1;
+		values[i] = std::numeric_limits<double>::quiet_NaN();
+	}
+	
+	#ifdef __linux__
+	fds[CYCLES]        = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	int error = errno;
+	fds[INSTRUCTIONS]  = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	fds[L1D_MISSES]    = openCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D 
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8) 
+			| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	fds[LLC_MISSES]    = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	fds[BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+	
+	bool any = false;
+	for(int i = 0; i < N_EVENTS; i++) {
+		any = any || (fds[i] >= 0);
+	}
+	if (!any) {
+		reason = std::string("perf_event_open failed: ") + strerror(error);
+		if (error == EACCES || error == EPERM) {
+			reason += " (see /proc/sys/kernel/perf_event_paranoid)";
+		}
+	}
+	#else
+	reason = "hardware counters are only supported on Linux";
+	#endif
+}
+
+/** Closes the counters.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+HardwareCounters::~HardwareCounters() {
+	#ifdef __linux__
+	for(int i = 0; i < N_EVENTS; i++) {
+		if (fds[i] >= 0) {
+			close(fds[i]);
+		}
+	}
+	#endif
+}
+
+/** Tests whether an event is being counted.
+ *
+ * @param[in] event	The event to test
+ *
+ * @return True if value() will report @p event.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool HardwareCounters::available(Event event) const {
+	return fds[event] >= 0;
+}
+
+/** Explains why no events are being counted.
+ *
+ * @return A human-readable explanation, or an empty string if at least 
+ *	one event is available.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const std::string& HardwareCounters::status() const {
+	return reason;
+}
+
+/** Returns a short identifier for an event.
+ *
+ * @param[in] event	The event to name
+ *
+ * @return A name suitable for use as a JSON key.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const char* HardwareCounters::name(Event event) {
+	switch (event) {
+		case CYCLES:        return "cycles";
+		case INSTRUCTIONS:  return "instructions";
+		case L1D_MISSES:    return "l1d_misses";
+		case LLC_MISSES:    return "llc_misses";
+		case BRANCH_MISSES: return "branch_misses";
+		default:            return "unknown";
+	}
+}
+
+/** Resets and starts all counters.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void HardwareCounters::start() {
+	#ifdef __linux__
+	for(int i = 0; i < N_EVENTS; i++) {
+		if (fds[i] >= 0) {
+			ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+	#endif
+}
+
+/** Stops all counters and records their values.
+ *
+ * If the kernel had to share the hardware between more events than it 
+ * could count at once, the values are scaled up to the full interval.
+ *
+ * @post value() returns the count since the last call to start(), or 
+ *	NaN for an event that could not be counted.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void HardwareCounters::stop() {
+	#ifdef __linux__
+	for(int i = 0; i < N_EVENTS; i++) {
+		if (fds[i] >= 0) {
+			ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+	for(int i = 0; i < N_EVENTS; i++) {
+		values[i] = std::numeric_limits<double>::quiet_NaN();
+		if (fds[i] < 0) {
+			continue;
+		}
+		
+		// value, time enabled, time running
+		uint64_t data[3];
+		if (read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) 
+				|| data[2] == 0) {
+			continue;
+		}
+		values[i] = static_cast<double>(data[0]);
+		if (data[2] < data[1]) {
+			values[i] *= static_cast<double>(data[1]) / static_cast<double>(data[2]);
+		}
+	}
+	#endif
+}
+
+/** Returns the value of a counter at the last call to stop().
+ *
+ * @param[in] event	The event to report
+ *
+ * @return The number of events counted, or NaN if @p event was not 
+ *	counted.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double HardwareCounters::value(Event event) const {
+	return values[event];
+}
+
+}}		// end kpftimes::bench
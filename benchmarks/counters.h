@@ -0,0 +1,101 @@
+/** Hardware performance counters for the benchmark harness
+ * @file timescales/benchmarks/counters.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHCOUNTERSH
+#define BENCHCOUNTERSH
+
+#include <string>
+
+namespace kpftimes { namespace bench {
+
+/** Reads CPU event counters around a block of code.
+ *
+ * On Linux, the counters are read with the @c perf_event_open system 
+ * call. Each event is opened separately, so a machine or kernel that 
+ * does not support one event (common in virtual machines) still reports 
+ * the others. If no event can be opened, for example because 
+ * @c /proc/sys/kernel/perf_event_paranoid forbids it, the object is still 
+ * usable but reports nothing.
+ *
+ * Only user-space events of the calling thread, and of threads it 
+ * creates after the counters are opened, are counted.
+ */
+class HardwareCounters {
+public:
+	/** The events that can be counted.
+	 */
+	enum Event {
+		CYCLES,		///< CPU cycles
+		INSTRUCTIONS,	///< Instructions retired
+		L1D_MISSES,	///< Level 1 data cache read misses
+		LLC_MISSES,	///< Last-level cache misses
+		BRANCH_MISSES,	///< Mispredicted branches
+		N_EVENTS	///< The number of events; not an event itself
+	};
+
+	/** Opens as many counters as the system allows.
+	 */
+	HardwareCounters();
+	/** Closes the counters.
+	 */
+	~HardwareCounters();
+
+	/** Tests whether an event is being counted.
+	 */
+	bool available(Event event) const;
+	/** Explains why no events are being counted.
+	 */
+	const std::string& status() const;
+	/** Returns a short identifier for an event.
+	 */
+	static const char* name(Event event);
+
+	/** Resets and starts all counters.
+	 */
+	void start();
+	/** Stops all counters and records their values.
+	 */
+	void stop();
+	/** Returns the value of a counter at the last call to stop().
+	 */
+	double value(Event event) const;
+
+private:
+	// Not copyable
+	HardwareCounters(const HardwareCounters &other);
+	HardwareCounters& operator=(const HardwareCounters &other);
+
+	int fds[N_EVENTS];
+	double values[N_EVENTS];
+	std::string reason;
+};
+
+}}		// end kpftimes::bench
+
+#endif		// end ifndef BENCHCOUNTERSH
@@ -0,0 +1,655 @@
+/** Differential accuracy checks of the library's fast paths
+ * @file timescales/benchmarks/differential.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../timescales.h"
+#include "../dft.h"
+#include "../kernels.h"
+#include "../nufft.h"
+#include "../tuning.h"
+#include "differential.h"
+#include "report.h"
+
+namespace kpftimes { namespace bench {
+
+using boost::lexical_cast;
+using boost::shared_ptr;
+using std::string;
+
+/** Chooses frequencies up to the pseudo-Nyquist frequency of a cadence.
+ *
+ * @param[in,out] curve	The light curve whose frequency grid is to be set
+ */
+void setFreqs(LightCurve &curve) {
+	const size_t N_FREQS = 1000;
+	const double fMax = pseudoNyquistFreq(curve.times);
+	curve.freqs.resize(N_FREQS);
+	for(size_t i = 0; i < N_FREQS; i++) {
+		curve.freqs[i] = fMax * (i + 1) / N_FREQS;
+	}
+}
+
+/** Adds light curves with random cadences.
+ *
+ * The cadences are either uniformly random over 100 days, or clustered 
+ * into nightly visits during three 120-day seasons. Each light curve is 
+ * a noisy sine wave. The random numbers are seeded, so every run tests 
+ * the same cadences.
+ *
+ * @param[in,out] curves	The list to which to add the light curves
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	the light curves.
+ *
+ * @exceptsafe @p curves is unchanged in the event of an exception.
+ */
+void makeCadences(std::vector<LightCurve> &curves) {
+	const size_t sizes[] = {16, 48, 400, 1000};
+	const size_t nSizes  = sizeof(sizes) / sizeof(sizes[0]);
+	using boost::math::double_constants::two_pi;
+	
+	shared_ptr<gsl_rng> gen(gsl_rng_alloc(gsl_rng_mt19937), &gsl_rng_free);
+	if (gen.get() == NULL) {
+		throw std::bad_alloc();
+	}
+	gsl_rng_set(gen.get(), 42);
+	
+	std::vector<LightCurve> temp(curves);
+	for(size_t k = 0; k < nSizes; k++) {
+		for(int seasonal = 0; seasonal <= 1; seasonal++) {
+			LightCurve curve;
+			curve.name = (seasonal ? "seasonal_n" : "uniform_n") 
+					+ lexical_cast<string>(sizes[k]);
+			for(size_t i = 0; i < sizes[k]; i++) {
+				if (seasonal) {
+					const double night = floor(120.0 * gsl_rng_uniform(gen.get()));
+					const double year  = floor(3.0 * gsl_rng_uniform(gen.get()));
+					curve.times.push_back(365.0*year + night 
+						+ 0.3*gsl_rng_uniform(gen.get()));
+				} else {
+					curve.times.push_back(100.0 * gsl_rng_uniform(gen.get()));
+				}
+			}
+			std::sort(curve.times.begin(), curve.times.end());
+			for(size_t i = 0; i < curve.times.size(); i++) {
+				curve.fluxes.push_back(sin(two_pi*curve.times[i]/3.3) 
+					+ gsl_ran_gaussian(gen.get(), 0.3));
+			}
+			setFreqs(curve);
+			temp.push_back(curve);
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(curves, temp);
+}
+
+/** Adds the light curves of the IDL regression corpus.
+ *
+ * @param[in] directory	The directory containing the files 
+ *			idl_target_in_0.txt, idl_target_in_1.txt, etc.
+ * @param[in,out] curves	The list to which to add the light curves
+ *
+ * @post Adds every consecutively numbered file, stopping at the first 
+ *	one that does not exist. Lines starting with '#' are ignored; 
+ *	the other lines hold a time and a flux.
+ *
+ * @exception std::runtime_error Thrown if a file could not be parsed.
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	the light curves.
+ *
+ * @exceptsafe @p curves is unchanged in the event of an exception.
+ */
+void loadCorpus(const string &directory, std::vector<LightCurve> &curves) {
+	std::vector<LightCurve> temp(curves);
+	for(int i = 0; ; i++) {
+		const string fileName = directory + "/idl_target_in_" 
+				+ lexical_cast<string>(i) + ".txt";
+		std::ifstream in(fileName.c_str());
+		if (!in) {
+			break;
+		}
+		
+		LightCurve curve;
+		curve.name = "idl_target_in_" + lexical_cast<string>(i);
+		string line;
+		while (std::getline(in, line)) {
+			if (line.empty() || line[0] == '#' || line[0] == '\r') {
+				continue;
+			}
+			std::istringstream fields(line);
+			double time = 0.0, flux = 0.0;
+			if (!(fields >> time >> flux)) {
+				throw std::runtime_error("Could not parse " + fileName + ": " + line);
+			}
+			curve.times .push_back(time);
+			curve.fluxes.push_back(flux);
+		}
+		setFreqs(curve);
+		temp.push_back(curve);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(curves, temp);
+}
+
+/** Changes the tuning parameters for the lifetime of the object.
+ */
+class TuningOverride {
+public:
+	/** Sets the largest light curve handled by the short light curve 
+	 *	kernels, and the smallest frequency set handled by the type 3 
+	 *	nonuniform FFT. By default the type 3 transform is never used, 
+	 *	so that reference calculations are direct sums.
+	 */
+	explicit TuningOverride(size_t smallNLimit, 
+			size_t type3MinTargets = static_cast<size_t>(-1)) : saved(currentTuning()) {
+		Tuning tuning = saved;
+		tuning.smallNLimit     = smallNLimit;
+		tuning.type3MinTargets = type3MinTargets;
+		setTuning(tuning);
+	}
+	/** Restores the previous parameters.
+	 */
+	~TuningOverride() {
+		setTuning(saved);
+	}
+private:
+	// Not copyable
+	TuningOverride(const TuningOverride &other);
+	TuningOverride& operator=(const TuningOverride &other);
+
+	const Tuning saved;
+};
+
+/** A faster algorithm and the calculation it approximates.
+ *
+ * Both calculations return their results as a list of numbers; complex 
+ * results are listed as alternating real and imaginary parts. The error 
+ * of the fast path is the largest difference from the reference, and its 
+ * relative error is that difference divided by the largest magnitude in 
+ * the reference.
+ */
+class FastPath {
+public:
+	virtual ~FastPath() {
+	}
+	
+	/** Returns a unique identifier for the fast path.
+	 */
+	virtual string name() const = 0;
+	/** Returns the largest acceptable relative error.
+	 */
+	virtual double tolerance() const = 0;
+	/** Tests whether the fast path is used for a light curve.
+	 */
+	virtual bool applies(const LightCurve &) const {
+		return true;
+	}
+	/** Runs the reference calculation.
+	 */
+	virtual void reference(const LightCurve &curve, DoubleVec &result) = 0;
+	/** Runs the fast calculation.
+	 */
+	virtual void fast(const LightCurve &curve, DoubleVec &result) = 0;
+};
+
+/** Flattens a list of complex numbers.
+ */
+void flatten(const ComplexVec &x, DoubleVec &result) {
+	result.resize(2*x.size());
+	for(size_t i = 0; i < x.size(); i++) {
+		result[2*i  ] = x[i].real();
+		result[2*i+1] = x[i].imag();
+	}
+}
+
+/** The short light curve kernels of lombScargle(), against the 
+ *	direct sums used for longer light curves.
+ */
+class SmallPeriodogramPath : public FastPath {
+public:
+	virtual string name() const {
+		return "lombScargle_small_kernels";
+	}
+	virtual double tolerance() const {
+		return 1e-9;
+	}
+	virtual bool applies(const LightCurve &curve) const {
+		return curve.times.size() <= MAX_SMALL_N;
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		TuningOverride direct(0);
+		lombScargle(curve.times, curve.fluxes, curve.freqs, result);
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		TuningOverride kernels(MAX_SMALL_N);
+		lombScargle(curve.times, curve.fluxes, curve.freqs, result);
+	}
+};
+
+/** The short light curve kernels of dft(), against the direct sums 
+ *	used for longer light curves.
+ *
+ * Only the masked version of dft() has kernels for short light curves.
+ */
+class SmallDftPath : public FastPath {
+public:
+	SmallDftPath() : transform() {
+	}
+	virtual string name() const {
+		return "dft_small_kernels";
+	}
+	virtual double tolerance() const {
+		return 1e-10;
+	}
+	virtual bool applies(const LightCurve &curve) const {
+		return curve.times.size() <= MAX_SMALL_N;
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		TuningOverride direct(0);
+		dft(curve.times, curve.fluxes, BoolVec(curve.times.size(), true), 
+			curve.freqs, transform);
+		flatten(transform, result);
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		TuningOverride kernels(MAX_SMALL_N);
+		dft(curve.times, curve.fluxes, BoolVec(curve.times.size(), true), 
+			curve.freqs, transform);
+		flatten(transform, result);
+	}
+private:
+	ComplexVec transform;
+};
+
+/** The type 3 nonuniform FFT in lombScargle(), against the direct sums 
+ *	it replaces.
+ *
+ * The light curves' frequencies are a regular grid, but the type 3 
+ * transform makes no use of that.
+ */
+class Type3PeriodogramPath : public FastPath {
+public:
+	virtual string name() const {
+		return "lombScargle_type3";
+	}
+	virtual double tolerance() const {
+		return 1e-8;
+	}
+	virtual bool applies(const LightCurve &curve) const {
+		using boost::math::double_constants::two_pi;
+		return curve.times.size() > MAX_SMALL_N && preferType3(curve.times.size(), 
+			curve.freqs.size(), curve.times.back() - curve.times.front(), 
+			two_pi * (curve.freqs.back() - curve.freqs.front()), TYPE3_PRECISION);
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		TuningOverride direct(0);
+		lombScargle(curve.times, curve.fluxes, curve.freqs, result);
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		TuningOverride type3(0, 0);
+		lombScargle(curve.times, curve.fluxes, curve.freqs, result);
+	}
+};
+
+/** Periodograms from a precomputed LsPlan, against lombScargle().
+ *
+ * The plan is built during the untimed first run, since its cost is 
+ * shared by all the light curves with the same cadence.
+ */
+class PlanPath : public FastPath {
+public:
+	PlanPath() : plan(), planned(NULL) {
+	}
+	virtual string name() const {
+		return "lombScargle_plan";
+	}
+	virtual double tolerance() const {
+		return 1e-8;
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		lombScargle(curve.times, curve.fluxes, curve.freqs, result);
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		if (planned != &curve) {
+			plan.reset(new LsPlan(curve.times, curve.freqs));
+			planned = &curve;
+		}
+		lombScargle(*plan, curve.fluxes, BoolVec(curve.times.size(), true), result);
+	}
+private:
+	// Not copyable
+	PlanPath(const PlanPath &other);
+	PlanPath& operator=(const PlanPath &other);
+
+	shared_ptr<LsPlan> plan;
+	const LightCurve* planned;
+};
+
+/** Binned periodograms from lombScargleMultires(), against lombScargle().
+ *
+ * The power differs from the unbinned periodogram by a fraction of order 
+ * the phase tolerance; errors of twice the phase tolerance are seen on 
+ * the regression corpus.
+ */
+class MultiresPath : public FastPath {
+public:
+	virtual string name() const {
+		return "lombScargleMultires_0.01";
+	}
+	virtual double tolerance() const {
+		return 0.03;
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		lombScargle(curve.times, curve.fluxes, curve.freqs, result);
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		lombScargleMultires(curve.times, curve.fluxes, curve.freqs, 0.01, result);
+	}
+};
+
+/** Evaluates a Fourier series term by term.
+ *
+ * @param[in] coeffs	The coefficients, in the order used by nufftType2()
+ * @param[in] x		The points at which to evaluate the series
+ * @param[out] result	The values of the series, flattened
+ */
+void seriesReference(const ComplexVec &coeffs, const DoubleVec &x, DoubleVec &result) {
+	const double half = static_cast<double>(coeffs.size() / 2);
+	ComplexVec values(x.size());
+	for(size_t j = 0; j < x.size(); j++) {
+		std::complex<double> sum(0.0, 0.0);
+		for(size_t m = 0; m < coeffs.size(); m++) {
+			sum += coeffs[m] * std::polar(1.0, (m - half) * x[j]);
+		}
+		values[j] = sum;
+	}
+	flatten(values, result);
+}
+
+/** A Fourier series to be evaluated at a light curve's observation times.
+ */
+class SeriesPath : public FastPath {
+public:
+	SeriesPath() : coeffs(), x(), values(), prepared(NULL) {
+		for(size_t m = 0; m < 257; m++) {
+			coeffs.push_back(std::complex<double>(sin(1.0 + m), cos(2.0 + m)) 
+				/ (1.0 + 0.01*m));
+		}
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		prepare(curve);
+		seriesReference(coeffs, x, result);
+	}
+protected:
+	/** Maps the observation times onto [-10, 10].
+	 */
+	void prepare(const LightCurve &curve) {
+		if (prepared == &curve) {
+			return;
+		}
+		const double t0 = curve.times.front();
+		const double span = std::max(curve.times.back() - t0, 1e-300);
+		x.resize(curve.times.size());
+		for(size_t j = 0; j < x.size(); j++) {
+			x[j] = 20.0 * (curve.times[j] - t0) / span - 10.0;
+		}
+		prepared = &curve;
+	}
+
+	ComplexVec coeffs;
+	DoubleVec x;
+	ComplexVec values;
+private:
+	// Not copyable
+	SeriesPath(const SeriesPath &other);
+	SeriesPath& operator=(const SeriesPath &other);
+
+	const LightCurve* prepared;
+};
+
+/** The nonuniform FFT used by PowerLawNoise, against term-by-term 
+ *	evaluation.
+ */
+class NufftPath : public SeriesPath {
+public:
+	virtual string name() const {
+		return "nufftType2_1e-9";
+	}
+	virtual double tolerance() const {
+		return 1e-7;
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		prepare(curve);
+		nufftType2(coeffs, x, values, 1e-9);
+		flatten(values, result);
+	}
+};
+
+/** The phasor recurrence used by PowerLawNoise, against term-by-term 
+ *	evaluation.
+ */
+class RecurrencePath : public SeriesPath {
+public:
+	virtual string name() const {
+		return "directType2_recurrence";
+	}
+	virtual double tolerance() const {
+		return 1e-10;
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		prepare(curve);
+		directType2(coeffs, x, values);
+		flatten(values, result);
+	}
+};
+
+/** The skiplist behind rollingMedian(), against sorting each window.
+ */
+class RollingMedianPath : public FastPath {
+public:
+	virtual string name() const {
+		return "rollingMedian_skiplist";
+	}
+	virtual double tolerance() const {
+		return 1e-12;
+	}
+	virtual void reference(const LightCurve &curve, DoubleVec &result) {
+		const double window = 0.1 * (curve.times.back() - curve.times.front());
+		const size_t n = curve.times.size();
+		result.resize(n);
+		DoubleVec inWindow;
+		for(size_t i = 0; i < n; i++) {
+			inWindow.clear();
+			for(size_t j = 0; j < n; j++) {
+				if (fabs(curve.times[j] - curve.times[i]) <= 0.5*window) {
+					inWindow.push_back(curve.fluxes[j]);
+				}
+			}
+			std::sort(inWindow.begin(), inWindow.end());
+			const size_t mid = inWindow.size() / 2;
+			result[i] = (inWindow.size() % 2 == 1) ? inWindow[mid] 
+					: 0.5*(inWindow[mid-1] + inWindow[mid]);
+		}
+	}
+	virtual void fast(const LightCurve &curve, DoubleVec &result) {
+		const double window = 0.1 * (curve.times.back() - curve.times.front());
+		rollingMedian(curve.times, curve.fluxes, window, result);
+	}
+};
+
+/** Runs one side of a comparison and measures its speed.
+ *
+ * @param[in,out] path	The fast path to run
+ * @param[in] useFast	Whether to run the fast or the reference calculation
+ * @param[in] curve	The input to the calculation
+ * @param[in] repeats	The number of timed runs
+ * @param[out] result	The output of the calculation
+ *
+ * @return The shortest time taken by a run, after an untimed first run.
+ *
+ * @exception std::exception Thrown if the calculation fails.
+ */
+double timeSide(FastPath &path, bool useFast, const LightCurve &curve, int repeats, 
+		DoubleVec &result) {
+	double best = std::numeric_limits<double>::infinity();
+	for(int i = -1; i < repeats; i++) {
+		const double start = now();
+		if (useFast) {
+			path.fast(curve, result);
+		} else {
+			path.reference(curve, result);
+		}
+		if (i >= 0) {
+			best = std::min(best, now() - start);
+		}
+	}
+	return best;
+}
+
+/** Compares each fast path against its reference, and prints the errors 
+ *	and speedups as JSON.
+ *
+ * Each fast path is run on every light curve to which it applies. The 
+ * report gives the worst absolute and relative errors over all light 
+ * curves, and the speedup of the summed run times.
+ *
+ * @param[in] curves	The light curves on which to compare
+ * @param[in] repeats	The number of timed runs of each calculation
+ * @param[in] out	The stream to print to
+ *
+ * @return The number of fast paths whose relative error exceeds their 
+ *	tolerance, or which failed.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	run the comparisons.
+ */
+int runDifferential(const std::vector<LightCurve> &curves, int repeats, FILE *out) {
+	std::vector<shared_ptr<FastPath> > paths;
+	paths.push_back(shared_ptr<FastPath>(new SmallPeriodogramPath()));
+	paths.push_back(shared_ptr<FastPath>(new SmallDftPath()));
+	paths.push_back(shared_ptr<FastPath>(new Type3PeriodogramPath()));
+	paths.push_back(shared_ptr<FastPath>(new PlanPath()));
+	paths.push_back(shared_ptr<FastPath>(new MultiresPath()));
+	paths.push_back(shared_ptr<FastPath>(new NufftPath()));
+	paths.push_back(shared_ptr<FastPath>(new RecurrencePath()));
+	paths.push_back(shared_ptr<FastPath>(new RollingMedianPath()));
+	
+	int failures = 0;
+	fprintf(out, "{\n  \"library\": \"timescales\",\n  \"curves\": %lu,\n", 
+		static_cast<unsigned long>(curves.size()));
+	fprintf(out, "  \"differential\": [\n");
+	for(size_t p = 0; p < paths.size(); p++) {
+		FastPath &path = *paths[p];
+		
+		size_t nCurves = 0;
+		double maxAbs = 0.0, maxRel = 0.0, refTime = 0.0, fastTime = 0.0;
+		string worst, error;
+		DoubleVec expected, actual;
+		for(size_t c = 0; c < curves.size() && error.empty(); c++) {
+			if (!path.applies(curves[c])) {
+				continue;
+			}
+			try {
+				refTime  += timeSide(path, false, curves[c], repeats, expected);
+				fastTime += timeSide(path, true , curves[c], repeats, actual);
+			} catch (const std::exception &e) {
+				error = curves[c].name + ": " + e.what();
+				break;
+			}
+			if (actual.size() != expected.size()) {
+				error = curves[c].name + ": wrong number of results";
+				break;
+			}
+			
+			double diff = 0.0, scale = 0.0;
+			for(size_t i = 0; i < expected.size(); i++) {
+				// Written so that NaNs count as errors
+				if (!(fabs(actual[i] - expected[i]) <= diff)) {
+					diff = fabs(actual[i] - expected[i]);
+				}
+				scale = std::max(scale, fabs(expected[i]));
+			}
+			const double rel = (scale > 0.0 ? diff / scale : diff);
+			if (!(rel <= maxRel) || nCurves == 0) {
+				worst = curves[c].name;
+			}
+			if (!(diff <= maxAbs)) {
+				maxAbs = diff;
+			}
+			if (!(rel <= maxRel)) {
+				maxRel = rel;
+			}
+			nCurves++;
+		}
+		
+		const bool pass = error.empty() && maxRel <= path.tolerance();
+		if (!pass) {
+			failures++;
+		}
+		fprintf(out, "    {\n      \"name\": %s,\n", json(path.name()).c_str());
+		fprintf(out, "      \"tolerance\": %s,\n", json(path.tolerance()).c_str());
+		fprintf(out, "      \"curves\": %lu,\n", static_cast<unsigned long>(nCurves));
+		if (!error.empty()) {
+			fprintf(out, "      \"error\": %s,\n", json(error).c_str());
+		} else {
+			fprintf(out, "      \"max_abs_error\": %s,\n", json(maxAbs).c_str());
+			fprintf(out, "      \"max_rel_error\": %s,\n", json(maxRel).c_str());
+			fprintf(out, "      \"worst_curve\": %s,\n", json(worst).c_str());
+			fprintf(out, "      \"reference_seconds\": %s,\n", json(refTime).c_str());
+			fprintf(out, "      \"fast_seconds\": %s,\n", json(fastTime).c_str());
+			fprintf(out, "      \"speedup\": %s,\n", json(ratio(refTime, fastTime)).c_str());
+		}
+		fprintf(out, "      \"pass\": %s\n    }%s\n", pass ? "true" : "false", 
+			p + 1 < paths.size() ? "," : "");
+	}
+	fprintf(out, "  ],\n  \"failures\": %d\n}\n", failures);
+	
+	return failures;
+}
+
+}}		// end kpftimes::bench
@@ -0,0 +1,75 @@
+/** Differential accuracy checks of the library's fast paths
+ * @file timescales/benchmarks/differential.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHDIFFERENTIALH
+#define BENCHDIFFERENTIALH
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../timescales.h"
+
+namespace kpftimes { namespace bench {
+
+/** A light curve and the frequency grid on which to analyze it.
+ */
+struct LightCurve {
+	LightCurve() : name(), times(), fluxes(), freqs() {
+	}
+
+	/** A label for the light curve in reports
+	 */
+	std::string name;
+	/** The observation times, in ascending order
+	 */
+	DoubleVec times;
+	/** The measurements at each time
+	 */
+	DoubleVec fluxes;
+	/** Frequencies up to the pseudo-Nyquist frequency of @p times
+	 */
+	DoubleVec freqs;
+};
+
+/** Adds light curves with random cadences.
+ */
+void makeCadences(std::vector<LightCurve> &curves);
+
+/** Adds the light curves of the IDL regression corpus.
+ */
+void loadCorpus(const std::string &directory, std::vector<LightCurve> &curves);
+
+/** Compares each fast path against its reference, and prints the errors 
+ *	and speedups as JSON.
+ */
+int runDifferential(const std::vector<LightCurve> &curves, int repeats, FILE *out);
+
+}}		// end kpftimes::bench
+
+#endif		// end ifndef BENCHDIFFERENTIALH
@@ -0,0 +1,108 @@
+/** Generates a synthetic survey catalog.
+ * @file timescales/benchmarks/mksurvey.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ *
+ * This program writes a catalog of simulated light curves with realistic 
+ * cadences and variability, so that benchmarks and scaling studies can be 
+ * run on representative inputs that are identical on every machine.
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "../timescales.h"
+#include "workload.h"
+
+using namespace kpftimes;
+using namespace kpftimes::bench;
+
+/** Prints the command-line syntax.
+ */
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [--objects N] [--seed S] [--truth FILE] CATALOG\n", program);
+	fprintf(stderr, "  --objects N   number of light curves (default 10000)\n");
+	fprintf(stderr, "  --seed S      random seed (default 1)\n");
+	fprintf(stderr, "  --truth FILE  also write the simulated parameters of each object\n");
+}
+
+/** Writes a synthetic survey and summarizes it.
+ *
+ * @return 0 on success, 1 if the command line was invalid or the catalog 
+ *	could not be written.
+ */
+int main(int argc, char *argv[]) {
+	long nObjects = 10000;
+	unsigned long seed = 1;
+	std::string truthFile, catalogFile;
+	for(int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--objects" && i + 1 < argc) {
+			nObjects = atol(argv[++i]);
+		} else if (arg == "--seed" && i + 1 < argc) {
+			seed = strtoul(argv[++i], NULL, 10);
+		} else if (arg == "--truth" && i + 1 < argc) {
+			truthFile = argv[++i];
+		} else if (catalogFile.empty() && arg.compare(0, 2, "--") != 0) {
+			catalogFile = arg;
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (catalogFile.empty() || nObjects < 1) {
+		usage(argv[0]);
+		return 1;
+	}
+	
+	try {
+		writeSurvey(catalogFile, truthFile, nObjects, seed);
+		
+		CatalogReader catalog(catalogFile);
+		std::vector<size_t> lengths;
+		double total = 0.0;
+		for(size_t i = 0; i < catalog.size(); i++) {
+			lengths.push_back(catalog.getLength(i));
+			total += lengths.back();
+		}
+		std::sort(lengths.begin(), lengths.end());
+		printf("Wrote %lu objects with %.0f epochs to %s\n", 
+			static_cast<unsigned long>(lengths.size()), total, catalogFile.c_str());
+		printf("Epochs per object: min %lu, median %lu, 99th percentile %lu, max %lu\n", 
+			static_cast<unsigned long>(lengths.front()), 
+			static_cast<unsigned long>(lengths[lengths.size()/2]), 
+			static_cast<unsigned long>(lengths[lengths.size()*99/100]), 
+			static_cast<unsigned long>(lengths.back()));
+	} catch (const std::exception &e) {
+		fprintf(stderr, "Could not generate survey: %s\n", e.what());
+		return 1;
+	}
+	
+	return 0;
+}
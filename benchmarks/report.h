@@ -0,0 +1,51 @@
+/** Timing and output helpers shared by the benchmark modes
+ * @file timescales/benchmarks/report.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHREPORTH
+#define BENCHREPORTH
+
+#include <string>
+
+/** Returns a monotonic time stamp.
+ */
+double now();
+
+/** Formats a number for JSON output.
+ */
+std::string json(double x);
+
+/** Formats a string for JSON output.
+ */
+std::string json(const std::string &x);
+
+/** Returns the ratio of two measurements, or NaN if either is missing.
+ */
+double ratio(double numerator, double denominator);
+
+#endif		// end ifndef BENCHREPORTH
@@ -0,0 +1,336 @@
+/** Synthetic survey workloads for benchmarks and scaling studies
+ * @file timescales/benchmarks/workload.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <boost/math/constants/constants.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../timescales.h"
+#include "workload.h"
+
+namespace kpftimes { namespace bench {
+
+using boost::shared_ptr;
+
+/** Returns a short identifier for a cadence.
+ *
+ * @param[in] cadence	The cadence to name
+ *
+ * @return A name without spaces.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const char* cadenceName(Cadence cadence) {
+	switch (cadence) {
+		case SEASONAL: return "seasonal";
+		case SPACE:    return "space";
+		case SPARSE:   return "sparse";
+		default:       return "unknown";
+	}
+}
+
+/** Returns a short identifier for a signal.
+ *
+ * @param[in] signal	The signal to name
+ *
+ * @return A name without spaces.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const char* signalName(Signal signal) {
+	switch (signal) {
+		case NO_SIGNAL: return "none";
+		case SINUSOID:  return "sinusoid";
+		case ECLIPSE:   return "eclipse";
+		case RED_NOISE: return "rednoise";
+		default:        return "unknown";
+	}
+}
+
+/** Draws a number whose logarithm is uniformly distributed.
+ *
+ * @param[in] gen	The random number generator to use
+ * @param[in] min, max	The range of the number
+ *
+ * @return A number between @p min and @p max.
+ */
+double logUniform(const gsl_rng *gen, double min, double max) {
+	return min * pow(max/min, gsl_rng_uniform(gen));
+}
+
+/** Simulates a ground-based cadence.
+ *
+ * The object is observable for 200 days of each of three years, and 
+ * each visit is made at a similar time of night, which produces strong 
+ * one-day and one-year aliases. For half the objects, visits are avoided 
+ * within three days of full moon. The number of visits follows a 
+ * lognormal distribution with a median of 60 and a long tail, as in 
+ * real surveys where a few fields are observed far more often than most.
+ *
+ * @param[in] gen	The random number generator to use
+ * @param[out] times	The observation times
+ */
+void seasonalCadence(const gsl_rng *gen, DoubleVec &times) {
+	const double SEASON = 200.0;
+	const double YEARS  = 3.0;
+	const double MONTH  = 29.53;
+	
+	const double target = std::min(3000.0, std::max(10.0, 
+			floor(exp(log(60.0) + gsl_ran_gaussian(gen, 1.0)))));
+	const bool avoidMoon = (gsl_rng_uniform(gen) < 0.5);
+	const double start  = floor(365.0 * gsl_rng_uniform(gen));
+	const double moon   = MONTH * gsl_rng_uniform(gen);
+	// Nights lost to weather and the moon are made up with more visits
+	const double usable = 0.7 * SEASON * YEARS * (avoidMoon ? 0.8 : 1.0);
+	const double perNight = ceil(target / usable);
+	const double pVisit = std::min(1.0, target / (perNight * usable));
+	
+	times.clear();
+	for(double year = 0.0; year < YEARS; year++) {
+		for(double night = 0.0; night < SEASON; night++) {
+			const double day = 365.25*year + start + night;
+			const double lunarPhase = fmod(day - moon, MONTH);
+			if (gsl_rng_uniform(gen) > 0.7 
+					|| (avoidMoon && fabs(lunarPhase - 0.5*MONTH) < 3.0)) {
+				continue;
+			}
+			for(double visit = 0.0; visit < perNight; visit++) {
+				if (gsl_rng_uniform(gen) < pVisit) {
+					times.push_back(day + 0.15 + 0.25*gsl_rng_uniform(gen));
+				}
+			}
+		}
+	}
+	std::sort(times.begin(), times.end());
+}
+
+/** Simulates a space-based cadence.
+ *
+ * The object is observed every 30 minutes for one to three 27.4-day 
+ * sectors a year apart. Each sector loses one day to downlink in the 
+ * middle, and a small fraction of the remaining exposures is discarded.
+ *
+ * @param[in] gen	The random number generator to use
+ * @param[out] times	The observation times
+ */
+void spaceCadence(const gsl_rng *gen, DoubleVec &times) {
+	const double SECTOR = 27.4;
+	const double STEP   = 1.0 / 48.0;
+	
+	const unsigned long nSectors = 1 + gsl_rng_uniform_int(gen, 3);
+	
+	times.clear();
+	for(unsigned long sector = 0; sector < nSectors; sector++) {
+		const double start = 365.25 * sector;
+		for(double t = 0.0; t < SECTOR; t += STEP) {
+			const bool downlink = fabs(t - 0.5*SECTOR) < 0.5;
+			if (!downlink && gsl_rng_uniform(gen) > 0.005) {
+				times.push_back(start + t);
+			}
+		}
+	}
+}
+
+/** Simulates a sparse survey cadence.
+ *
+ * The object gets 8 to 70 visits at random over five years. Most visits 
+ * are followed by a second one 106 minutes later, as for a scanning 
+ * satellite with two fields of view.
+ *
+ * @param[in] gen	The random number generator to use
+ * @param[out] times	The observation times
+ */
+void sparseCadence(const gsl_rng *gen, DoubleVec &times) {
+	const unsigned long nVisits = 8 + gsl_rng_uniform_int(gen, 63);
+	
+	times.clear();
+	for(unsigned long visit = 0; visit < nVisits; visit++) {
+		const double t = 5.0 * 365.25 * gsl_rng_uniform(gen);
+		times.push_back(t);
+		if (gsl_rng_uniform(gen) < 0.8) {
+			times.push_back(t + 106.0/1440.0);
+		}
+	}
+	std::sort(times.begin(), times.end());
+}
+
+/** Simulates one object of a synthetic survey.
+ *
+ * Each object is generated from its own random stream, derived from 
+ * @p seed and @p id, so an object does not depend on how many other 
+ * objects are generated or in what order.
+ *
+ * About 55% of objects have a SEASONAL cadence, 15% SPACE, and 30% 
+ * SPARSE. Half the objects have no signal; the rest have a SINUSOID (20%), 
+ * an ECLIPSE (10%), or RED_NOISE (20%). Periods are log-uniform between 
+ * 0.05 and 200 days, and red noise timescales between 5 and 500 days. 
+ * Signal amplitudes are 0.3 to 10 times the measurement noise, which is 
+ * itself between 5 and 100 millimagnitudes.
+ *
+ * @param[in] seed	The seed for the survey as a whole
+ * @param[in] id	The ID of the object to generate
+ * @param[out] object	The simulated object
+ *
+ * @post @p object.times.size() &ge; 2
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	simulate the object.
+ *
+ * @exceptsafe @p object is in a valid but unspecified state in the 
+ *	event of an exception.
+ */
+void makeObject(unsigned long seed, unsigned long id, SyntheticObject &object) {
+	using boost::math::double_constants::two_pi;
+	
+	shared_ptr<gsl_rng> gen(gsl_rng_alloc(gsl_rng_mt19937), &gsl_rng_free);
+	if (gen.get() == NULL) {
+		throw std::bad_alloc();
+	}
+	// Mix the seed and ID so that neighbouring objects get unrelated streams
+	unsigned long mixed = seed * 2654435761UL + id;
+	mixed ^= mixed >> 15;
+	mixed *= 2246822519UL;
+	mixed ^= mixed >> 13;
+	gsl_rng_set(gen.get(), mixed);
+	
+	object.id = id;
+	const double cadenceDraw = gsl_rng_uniform(gen.get());
+	object.cadence = (cadenceDraw < 0.55 ? SEASONAL : (cadenceDraw < 0.70 ? SPACE : SPARSE));
+	const double signalDraw = gsl_rng_uniform(gen.get());
+	object.signal = (signalDraw < 0.5 ? NO_SIGNAL : (signalDraw < 0.7 ? SINUSOID 
+			: (signalDraw < 0.8 ? ECLIPSE : RED_NOISE)));
+	
+	do {
+		switch (object.cadence) {
+			case SEASONAL: seasonalCadence(gen.get(), object.times); break;
+			case SPACE:    spaceCadence   (gen.get(), object.times); break;
+			default:       sparseCadence  (gen.get(), object.times); break;
+		}
+	} while (object.times.size() < 2);
+	
+	object.noise     = logUniform(gen.get(), 0.005, 0.1);
+	object.amplitude = 0.0;
+	object.period    = 0.0;
+	object.tau       = 0.0;
+	const double mean = 14.0 + 6.0*gsl_rng_uniform(gen.get());
+	const size_t n = object.times.size();
+	
+	object.fluxes.assign(n, mean);
+	if (object.signal != NO_SIGNAL) {
+		object.amplitude = object.noise * logUniform(gen.get(), 0.3, 10.0);
+	}
+	if (object.signal == SINUSOID || object.signal == ECLIPSE) {
+		object.period = logUniform(gen.get(), 0.05, 200.0);
+		const double phase0 = gsl_rng_uniform(gen.get());
+		const double duty   = 0.05 + 0.1*gsl_rng_uniform(gen.get());
+		for(size_t i = 0; i < n; i++) {
+			const double phase = object.times[i] / object.period + phase0;
+			if (object.signal == SINUSOID) {
+				object.fluxes[i] += object.amplitude * sin(two_pi * phase);
+			} else if (phase - floor(phase) < duty) {
+				// Magnitudes, so an eclipse makes the object fainter
+				object.fluxes[i] += object.amplitude;
+			}
+		}
+	} else if (object.signal == RED_NOISE) {
+		object.tau = logUniform(gen.get(), 5.0, 500.0);
+		DampedRandomWalk model(object.tau);
+		DoubleVec deviates(model.numDeviates(object.times)), walk;
+		for(size_t i = 0; i < deviates.size(); i++) {
+			deviates[i] = gsl_ran_gaussian(gen.get(), 1.0);
+		}
+		model.simulate(object.times, deviates, walk);
+		for(size_t i = 0; i < n; i++) {
+			object.fluxes[i] += object.amplitude * walk[i];
+		}
+	}
+	for(size_t i = 0; i < n; i++) {
+		object.fluxes[i] += gsl_ran_gaussian(gen.get(), object.noise);
+	}
+}
+
+/** Writes a synthetic survey to a catalog file.
+ *
+ * @param[in] catalogFile	The catalog to create, in the format read by 
+ *				CatalogReader
+ * @param[in] truthFile	A text file to which to write the parameters of 
+ *				each object, one line per object. No file is 
+ *				written if this is empty.
+ * @param[in] nObjects	The number of objects to simulate
+ * @param[in] seed	The seed for the survey. The same seed always 
+ *			produces the same catalog.
+ *
+ * @post The objects have IDs 1 through @p nObjects, and are those 
+ *	returned by makeObject().
+ *
+ * @exception std::runtime_error Thrown if either file could not be written.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	simulate the objects.
+ *
+ * @exceptsafe If an exception is thrown, @p catalogFile is not created, 
+ *	and @p truthFile may be incomplete.
+ */
+void writeSurvey(const std::string &catalogFile, const std::string &truthFile, 
+		size_t nObjects, unsigned long seed) {
+	CatalogWriter catalog(catalogFile, nObjects);
+	
+	std::ofstream truth;
+	if (!truthFile.empty()) {
+		truth.open(truthFile.c_str());
+		truth << "# id cadence n signal period amplitude tau noise\n";
+	}
+	
+	SyntheticObject object;
+	for(size_t i = 0; i < nObjects; i++) {
+		makeObject(seed, i + 1, object);
+		catalog.add(object.id, object.times, object.fluxes);
+		if (!truthFile.empty()) {
+			truth << object.id << ' ' << cadenceName(object.cadence) << ' ' 
+				<< object.times.size() << ' ' << signalName(object.signal) << ' ' 
+				<< object.period << ' ' << object.amplitude << ' ' 
+				<< object.tau << ' ' << object.noise << '\n';
+		}
+	}
+	
+	if (!truthFile.empty()) {
+		truth.close();
+		if (!truth) {
+			throw std::runtime_error("Could not write " + truthFile);
+		}
+	}
+	catalog.close();
+}
+
+}}		// end kpftimes::bench
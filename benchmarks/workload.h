@@ -0,0 +1,113 @@
+/** Synthetic survey workloads for benchmarks and scaling studies
+ * @file timescales/benchmarks/workload.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHWORKLOADH
+#define BENCHWORKLOADH
+
+#include <string>
+#include "../timescales.h"
+
+namespace kpftimes { namespace bench {
+
+/** The observing strategies that can be simulated.
+ */
+enum Cadence {
+	SEASONAL,	///< Ground-based monitoring, with seasonal and lunar gaps and visits at the same time of night
+	SPACE,		///< Uniform 30-minute sampling in 27-day sectors, each split by a downlink gap
+	SPARSE,		///< A few dozen visits over several years, mostly in closely spaced pairs
+	N_CADENCES	///< The number of cadences; not a cadence itself
+};
+
+/** The kinds of variability that can be injected.
+ */
+enum Signal {
+	NO_SIGNAL,	///< Measurement noise only
+	SINUSOID,	///< A sine wave
+	ECLIPSE,	///< Periodic box-shaped dips
+	RED_NOISE,	///< A damped random walk
+	N_SIGNALS	///< The number of signals; not a signal itself
+};
+
+/** One simulated object, and the parameters used to make it.
+ */
+struct SyntheticObject {
+	SyntheticObject() : id(0), cadence(SEASONAL), signal(NO_SIGNAL), period(0.0), 
+			amplitude(0.0), tau(0.0), noise(0.0), times(), fluxes() {
+	}
+
+	/** The object's ID in the catalog
+	 */
+	unsigned long id;
+	/** The observing strategy
+	 */
+	Cadence cadence;
+	/** The injected variability
+	 */
+	Signal signal;
+	/** The period of a SINUSOID or ECLIPSE signal, in days, or zero
+	 */
+	double period;
+	/** The semi-amplitude of a SINUSOID, the depth of an ECLIPSE, or the 
+	 *	standard deviation of RED_NOISE, in magnitudes
+	 */
+	double amplitude;
+	/** The timescale of a RED_NOISE signal, in days, or zero
+	 */
+	double tau;
+	/** The standard deviation of the measurement noise, in magnitudes
+	 */
+	double noise;
+	/** The observation times, in days, in ascending order
+	 */
+	DoubleVec times;
+	/** The simulated magnitudes
+	 */
+	DoubleVec fluxes;
+};
+
+/** Returns a short identifier for a cadence.
+ */
+const char* cadenceName(Cadence cadence);
+
+/** Returns a short identifier for a signal.
+ */
+const char* signalName(Signal signal);
+
+/** Simulates one object of a synthetic survey.
+ */
+void makeObject(unsigned long seed, unsigned long id, SyntheticObject &object);
+
+/** Writes a synthetic survey to a catalog file.
+ */
+void writeSurvey(const std::string &catalogFile, const std::string &truthFile, 
+		size_t nObjects, unsigned long seed);
+
+}}		// end kpftimes::bench
+
+#endif		// end ifndef BENCHWORKLOADH
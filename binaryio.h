@@ -0,0 +1,76 @@
+/** Helpers for the library's binary file formats. None of these routines 
+ *	are intended as part of the public API.
+ * @file timescales/binaryio.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARYIOH
+#define BINARYIOH
+
+#include <iostream>
+#include <boost/cstdint.hpp>
+
+namespace kpftimes {
+
+/** Written after the magic number of each binary file, so that a reader 
+ *	can detect a file from a machine with a different byte order.
+ *
+ * @ingroup util
+ */
+const boost::uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+/** Writes a value to a binary stream in native byte order.
+ *
+ * @param[in,out] out	The stream to write to
+ * @param[in] x		The value to write
+ *
+ * @exceptsafe Sets the stream's error state on failure.
+ *
+ * @ingroup util
+ */
+template <typename T>
+void writeRaw(std::ostream &out, const T &x) {
+	out.write(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+/** Reads a value from a binary stream in native byte order.
+ *
+ * @param[in,out] in	The stream to read from
+ * @param[out] x	The value read
+ *
+ * @exceptsafe Sets the stream's error state on failure.
+ *
+ * @ingroup util
+ */
+template <typename T>
+void readRaw(std::istream &in, T &x) {
+	in.read(reinterpret_cast<char*>(&x), sizeof(T));
+}
+
+}		// end kpftimes
+
+#endif		// end ifndef BINARYIOH
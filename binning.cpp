@@ -0,0 +1,456 @@
+/** Error-controlled binning of dense light curves
+ * @file timescales/binning.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/version.hpp>
+#include "../common/stats.tmp.h"
+#include "timeexcept.h"
+#include "timescales.h"
+#include "utils.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** Chooses the widest bins that keep a periodogram within a given error.
+ *
+ * Binning replaces each epoch with the weighted centroid of its bin, 
+ * which moves it by less than one bin width. At frequencies up to 
+ * @p fMax, the phase of every term in the Lomb-Scargle sums (including 
+ * the terms at twice the frequency, which determine the time offset 
+ * &tau;) therefore moves by at most @p tolerance radians. Since each 
+ * term is a sine or cosine, each sum changes by at most @p tolerance 
+ * times the sum of the absolute values of its coefficients.
+ *
+ * @param[in] fMax	The highest frequency of interest
+ * @param[in] tolerance	The largest acceptable phase error, in radians
+ *
+ * @return The width of the bins, in the units of 1/@p fMax.
+ *
+ * @pre @p fMax > 0
+ * @pre @p tolerance > 0
+ *
+ * @post The return value is 
+ *	@p tolerance / (4&pi; @p fMax).
+ *
+ * @perform Constant time
+ *
+ * @exception std::invalid_argument Thrown if @p fMax or @p tolerance is 
+ *	not positive.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+double maxBinWidth(double fMax, double tolerance) {
+	if (!(fMax > 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'fMax' in maxBinWidth() must be positive (gave " 
+				+ lexical_cast<string>(fMax) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'fMax' in maxBinWidth() must be positive");
+		}
+	}
+	if (!(tolerance > 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'tolerance' in maxBinWidth() must be positive (gave " 
+				+ lexical_cast<string>(tolerance) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'tolerance' in maxBinWidth() must be positive");
+		}
+	}
+	
+	return tolerance / (4.0*pi*fMax);
+}
+
+/** Checks that a light curve can be binned.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] caller	The name of the public function, for use in error 
+ *			messages.
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void checkBinnable(const DoubleVec &times, const DoubleVec &data, const string &caller) {
+	if (data.size() != times.size()) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'data' in " + caller + " are not the same length (gave " 
+			+ lexical_cast<string>(times.size()) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'data' in " + caller + " are not the same length");
+		}
+	}
+	if (!kpfutils::isSorted(times.begin(), times.end())) {
+		throw kpfutils::except::NotSorted("Parameter 'times' in " + caller + " is not sorted in ascending order");
+	}
+}
+
+/** Groups the epochs of a light curve into bins.
+ *
+ * Does no validation of its arguments.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] width	The width of each bin
+ * @param[out] binTimes	The mean time of each bin
+ * @param[out] binData	The mean of @p data in each bin
+ * @param[out] binWeights The number of epochs in each bin
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p width > 0
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the bins.
+ *
+ * @exceptsafe If an exception is thrown, the contents of the output 
+ *	vectors are unspecified.
+ */
+void binUnchecked(const DoubleVec &times, const DoubleVec &data, double width, 
+		DoubleVec &binTimes, DoubleVec &binData, DoubleVec &binWeights) {
+	const size_t nTimes = times.size();
+	
+	binTimes  .clear();
+	binData   .clear();
+	binWeights.clear();
+	
+	size_t i = 0;
+	while (i < nTimes) {
+		// Each bin starts at its first epoch, so no bin is empty
+		const double end = times[i] + width;
+		double sumTime = 0.0, sumData = 0.0;
+		size_t count = 0;
+		for (; i < nTimes && times[i] < end; i++) {
+			sumTime += times[i];
+			sumData += data[i];
+			count++;
+		}
+		binTimes  .push_back(sumTime / count);
+		binData   .push_back(sumData / count);
+		binWeights.push_back(static_cast<double>(count));
+	}
+}
+
+/** Bins a light curve to a coarser time resolution.
+ *
+ * Use maxBinWidth() to choose a @p width for a given frequency range. 
+ * The binned light curve can be passed to autoCorr() or any other 
+ * analysis function that only needs timescales much longer than 
+ * @p width, but for the periodogram lombScargleMultires() is more 
+ * accurate because it weights each bin by @p binWeights.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] width	The width of each bin, in the same units as @p times.
+ * @param[out] binTimes	The mean time of the epochs in each bin
+ * @param[out] binData	The mean of @p data in each bin
+ * @param[out] binWeights The number of epochs in each bin
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p width > 0
+ *
+ * @post @p binTimes, @p binData, and @p binWeights have the same length, 
+ *	which is at most @p times.size().
+ * @post Each bin contains at least one epoch, and all epochs in a bin 
+ *	are less than @p width apart.
+ * @post @p binTimes is sorted in ascending order.
+ * @post The sum of @p binWeights equals @p times.size().
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, or if @p width is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the bins.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void binLightCurve(const DoubleVec &times, const DoubleVec &data, double width, 
+		DoubleVec &binTimes, DoubleVec &binData, DoubleVec &binWeights) {
+	checkBinnable(times, data, "binLightCurve()");
+	if (!(width > 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'width' in binLightCurve() must be positive (gave " 
+				+ lexical_cast<string>(width) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'width' in binLightCurve() must be positive");
+		}
+	}
+	
+	// copy-and-swap
+	DoubleVec tempTimes, tempData, tempWeights;
+	binUnchecked(times, data, width, tempTimes, tempData, tempWeights);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(binTimes  , tempTimes  );
+	swap(binData   , tempData   );
+	swap(binWeights, tempWeights);
+}
+
+/** Calculates a Lomb-Scargle periodogram of a weighted light curve.
+ *
+ * Each epoch counts as @p weights[j] coincident epochs with the same 
+ * value, so with unit weights the result is identical to lombScargle(). 
+ * Does no validation of its arguments.
+ *
+ * @param[in] times	Times at which @p data were taken, shifted to start 
+ *			near zero
+ * @param[in] data	Measurements of a time series, with the weighted 
+ *			mean subtracted
+ * @param[in] weights	The weight of each measurement
+ * @param[in] var	The variance used to normalize the periodogram
+ * @param[in] freqs	The frequency grid
+ * @param[in] which	The indices of @p freqs to calculate
+ * @param[out] power	The periodogram. Only the elements named in 
+ *			@p which are changed.
+ *
+ * @pre @p freqs[k] &ge; 0 for all k in @p which
+ * @pre @p power.size() = @p freqs.size()
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p which.size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void weightedLs(const DoubleVec &times, const DoubleVec &data, const DoubleVec &weights, 
+		double var, const DoubleVec &freqs, const IndexVec &which, DoubleVec &power) {
+	const size_t nTimes = times.size();
+	
+	double sumWeights = 0.0;
+	for (size_t j = 0; j < nTimes; j++) {
+		sumWeights += weights[j];
+	}
+
+	// Ref.: W.H. Press and G.B. Rybicki, 1989, ApJ 338, 277, with each 
+	//	sum over epochs weighted
+	for (size_t k = 0; k < which.size(); k++) {
+		const size_t i = which[k];
+		const double om = 2.0 * pi*freqs[i];
+		if (om == 0.0) {
+			// Use the limit as frequency goes to zero
+			power[i] = 0.0;
+			continue;
+		}
+		
+		double s2 = 0.0, c2 = 0.0, sh = 0.0, ch = 0.0;
+		for (size_t j = 0; j < nTimes; j++) {
+			s2 += weights[j] * sin(2.0 * om * times[j]);
+			c2 += weights[j] * cos(2.0 * om * times[j]);
+			sh += weights[j] * data[j] * sin(om * times[j]);
+			ch += weights[j] * data[j] * cos(om * times[j]);
+		}
+		
+		// Eq. (2)
+		const double omTau = 0.5 * atan2(s2, c2);
+		const double cosOmTau = cos(omTau);
+		const double sinOmTau = sin(omTau);
+		
+		// Eq. (7)
+		const double tmp = c2*cos(2.0*omTau) + s2*sin(2.0*omTau);
+		const double tc2 = 0.5*(sumWeights+tmp);
+		const double ts2 = 0.5*(sumWeights-tmp);
+		
+		// Eq. (3)
+		const double cc = ch*cosOmTau + sh*sinOmTau;
+		const double sc = sh*cosOmTau - ch*sinOmTau;
+		power[i] = 0.5*(cc*cc / tc2 + sc*sc / ts2)/var;
+	}
+}
+
+/** Calculates the Lomb-Scargle periodogram for a densely sampled time 
+ *	series, binning the data wherever the frequency allows.
+ *
+ * The frequency grid is divided into octaves below its highest frequency. 
+ * Each octave is calculated from the light curve binned with 
+ * maxBinWidth() for the top of that octave, or from the full light curve 
+ * if binning would not at least halve the number of epochs. Bins are 
+ * weighted by the number of epochs they contain, and every octave is 
+ * normalized by the variance of the full light curve, so the octaves 
+ * join without discontinuities.
+ *
+ * With this binning, each of the trigonometric sums in the periodogram 
+ * differs from the sum over the full light curve by at most @p tolerance 
+ * times the sum of the absolute values of its coefficients. For 
+ * @p tolerance &lt;&lt; 1 the power differs from lombScargle() by a 
+ * fraction of order @p tolerance.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] freqs	The frequency grid over which the periodogram should 
+ *			be calculated. Need not be sorted.
+ * @param[in] tolerance	The largest phase error, in radians, that binning 
+ *			may introduce into any term of the periodogram.
+ * @param[out] power	The periodogram power at each frequency.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data contains at least two unique values
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre @p tolerance > 0
+ *
+ * @post @p power.size() = @p freqs.size()
+ * @post @p power[i] approximates the periodogram of @p data at @p freqs[i], 
+ *	as calculated by lombScargle(), to within the error described above.
+ *
+ * @perform O(NF<sub>0</sub> + &Sigma;<sub>k</sub> (N + N<sub>k</sub>F<sub>k</sub>)) 
+ *	time, where N = @p times.size(), F<sub>0</sub> is the number of 
+ *	frequencies calculated at full resolution, and N<sub>k</sub> and 
+ *	F<sub>k</sub> are the number of bins and frequencies in the kth 
+ *	binned octave. For a light curve sampled much more densely than 
+ *	1/@p freqs, this is much less than the O(NF) time of lombScargle().
+ * @perfmore O(N + F) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value or if @p data has no variability.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, or if @p tolerance is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void lombScargleMultires(const DoubleVec &times, const DoubleVec &data, 
+		const DoubleVec &freqs, double tolerance, DoubleVec &power) {
+	const size_t nTimes = times.size();
+	const size_t nFreq  = freqs.size();
+	
+	// Verify the preconditions
+	checkBinnable(times, data, "lombScargleMultires()");
+	if (nTimes < 2 || times.front() == times.back()) {
+		throw except::BadLightCurve("Parameter 'times' in lombScargleMultires() contains only one unique date");
+	}
+	if (!(tolerance > 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'tolerance' in lombScargleMultires() must be positive (gave " 
+				+ lexical_cast<string>(tolerance) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'tolerance' in lombScargleMultires() must be positive");
+		}
+	}
+	double fMax = 0.0;
+	for (size_t i = 0; i < nFreq; i++) {
+		if (freqs[i] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in lombScargleMultires() contains negative frequencies");
+		}
+		fMax = std::max(fMax, freqs[i]);
+	}
+	
+	// Full sample variance, used to normalize every octave
+	const double var = kpfutils::variance(data.begin(), data.end());
+	if (var <= 0.0) {
+		throw except::BadLightCurve("Parameter 'data' in lombScargleMultires() has no variability");
+	}
+	const double meanF = kpfutils::mean(data.begin(), data.end());
+	
+	// make times of manageable size (Scargle periodogram is time-shift invariant)
+	const double t0 = times.front();
+	DoubleVec times0(nTimes), data0(nTimes);
+	for (size_t j = 0; j < nTimes; j++) {
+		times0[j] = times[j] - t0;
+		data0 [j] = data [j] - meanF;
+	}
+	
+	// Assign each frequency to an octave; octave k covers 
+	//	(fMax/2^(k+1), fMax/2^k], and zero frequencies go in octave 0
+	std::vector<IndexVec> octaves;
+	for (size_t i = 0; i < nFreq; i++) {
+		size_t k = 0;
+		if (freqs[i] > 0.0) {
+			double edge = 0.5*fMax;
+			while (freqs[i] <= edge) {
+				edge *= 0.5;
+				k++;
+			}
+		}
+		if (k >= octaves.size()) {
+			octaves.resize(k+1);
+		}
+		octaves[k].push_back(i);
+	}
+	
+	// copy-and-swap
+	DoubleVec tempPower(nFreq, 0.0);
+	const DoubleVec unitWeights(nTimes, 1.0);
+	DoubleVec binTimes, binData, binWeights;
+	
+	double edge = fMax;
+	for (size_t k = 0; k < octaves.size(); k++, edge *= 0.5) {
+		if (octaves[k].empty()) {
+			continue;
+		}
+		
+		if (edge > 0.0) {
+			binUnchecked(times0, data0, maxBinWidth(edge, tolerance), 
+				binTimes, binData, binWeights);
+		}
+		if (edge > 0.0 && 2*binTimes.size() <= nTimes) {
+			weightedLs(binTimes, binData, binWeights, var, 
+				freqs, octaves[k], tempPower);
+		} else {
+			weightedLs(times0, data0, unitWeights, var, 
+				freqs, octaves[k], tempPower);
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(power, tempPower);
+}
+
+}		// end kpftimes
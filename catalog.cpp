@@ -0,0 +1,430 @@
+/** Binary files of light curves
+ * @file timescales/catalog.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include "binaryio.h"
+#include "catalog.h"
+#include "timescales.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+using boost::uint32_t;
+using boost::uint64_t;
+
+/** Identifies catalog files
+ */
+const char CATALOG_MAGIC[8] = {'K', 'P', 'F', 'T', 'C', 'A', 'T', '1'};
+
+/** The state of a catalog being written.
+ */
+struct CatalogWriter::Impl {
+	Impl(const string &fileName, size_t nObjects);
+
+	string fileName, tempName;
+	std::ofstream out;
+	size_t nObjects;
+	std::vector<CatalogEntry> index;
+	bool closed;
+};
+
+/** The state of an open catalog.
+ */
+struct CatalogReader::Impl {
+	explicit Impl(const string &fileName);
+
+	string fileName;
+	std::ifstream in;
+	std::vector<CatalogEntry> index;
+};
+
+/** Returns the position of the first light curve in a catalog.
+ *
+ * @param[in] nObjects	The number of objects in the catalog
+ *
+ * @return The size of the header and index, in bytes.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+uint64_t catalogDataStart(size_t nObjects) {
+	return sizeof(CATALOG_MAGIC) + 2*sizeof(uint32_t) + sizeof(uint64_t) 
+		+ nObjects*3*sizeof(uint64_t);
+}
+
+/** Opens a temporary file and reserves space for the header and index.
+ *
+ * @param[in] fileName	The name the finished catalog will have
+ * @param[in] nObjects	The number of objects the catalog will hold
+ *
+ * @exception std::runtime_error Thrown if the file could not be written.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+CatalogWriter::Impl::Impl(const string &fileName, size_t nObjects) 
+		: fileName(fileName), tempName(fileName + ".tmp"), 
+		out(tempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc), 
+		nObjects(nObjects), index(), closed(false) {
+	index.reserve(nObjects);
+	
+	const char zeros[3*sizeof(uint64_t)] = {0};
+	out.write(CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+	writeRaw(out, BYTE_ORDER_MARK);
+	writeRaw(out, static_cast<uint32_t>(0));
+	writeRaw(out, static_cast<uint64_t>(nObjects));
+	for(size_t i = 0; i < nObjects && out; i++) {
+		out.write(zeros, sizeof(zeros));
+	}
+	if (!out) {
+		out.close();
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not write catalog file " + tempName);
+	}
+}
+
+/** Starts a catalog with a fixed number of objects.
+ *
+ * @param[in] fileName	The file to write. Nothing is written to 
+ *			@p fileName itself until close() is called.
+ * @param[in] nObjects	The number of light curves the catalog will hold
+ *
+ * @post The catalog is ready for @p nObjects calls to add().
+ *
+ * @perform O(@p nObjects) time
+ *
+ * @exception std::runtime_error Thrown if the temporary file could not 
+ *	be written.
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	the catalog's index.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+CatalogWriter::CatalogWriter(const string &fileName, size_t nObjects) 
+		: impl(new Impl(fileName, nObjects)) {
+}
+
+/** Discards the catalog if it was never closed.
+ *
+ * @post If close() was not called successfully, no catalog named 
+ *	@p fileName was created, and the temporary file is deleted.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CatalogWriter::~CatalogWriter() {
+	if (!impl->closed) {
+		impl->out.close();
+		std::remove(impl->tempName.c_str());
+	}
+}
+
+/** Appends a light curve to the catalog.
+ *
+ * @param[in] id	An identifier for the object. IDs should be unique 
+ *			within a catalog, but need not be consecutive or 
+ *			sorted.
+ * @param[in] times	The times of the light curve
+ * @param[in] fluxes	The fluxes of the light curve
+ *
+ * @pre @p times.size() = @p fluxes.size()
+ * @pre Fewer than @p nObjects light curves have been added
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception std::invalid_argument Thrown if @p times and @p fluxes 
+ *	have different lengths.
+ * @exception std::logic_error Thrown if the catalog is already full or 
+ *	closed.
+ * @exception std::runtime_error Thrown if the light curve could not be 
+ *	written. The catalog cannot be completed after such an error.
+ *
+ * @exceptsafe The catalog is unchanged in the event of a logic error 
+ *	or invalid argument.
+ */
+void CatalogWriter::add(unsigned long id, const DoubleVec &times, const DoubleVec &fluxes) {
+	if (times.size() != fluxes.size()) {
+		try {
+			throw std::invalid_argument("Light curve " + lexical_cast<string>(id) 
+				+ " has " + lexical_cast<string>(times.size()) + " times but " 
+				+ lexical_cast<string>(fluxes.size()) + " fluxes");
+		} catch (const boost::bad_lexical_cast &e) {
+			throw std::invalid_argument("Times and fluxes in CatalogWriter::add() have different lengths");
+		}
+	} else if (impl->closed || impl->index.size() >= impl->nObjects) {
+		throw std::logic_error("Catalog " + impl->fileName + " is already full");
+	}
+	
+	CatalogEntry entry;
+	entry.id     = id;
+	entry.offset = static_cast<uint64_t>(impl->out.tellp());
+	entry.length = times.size();
+	if (!times.empty()) {
+		impl->out.write(reinterpret_cast<const char*>(&times [0]), times .size()*sizeof(double));
+		impl->out.write(reinterpret_cast<const char*>(&fluxes[0]), fluxes.size()*sizeof(double));
+	}
+	if (!impl->out) {
+		throw std::runtime_error("Could not write catalog file " + impl->tempName);
+	}
+	
+	// index has already reserved space for entry
+	impl->index.push_back(entry);
+}
+
+/** Finishes the catalog.
+ *
+ * Writes the index and renames the temporary file to its final name, 
+ * replacing any existing file with that name.
+ *
+ * @pre add() has been called @p nObjects times
+ *
+ * @post The catalog can be read by CatalogReader.
+ *
+ * @perform O(@p nObjects) time
+ *
+ * @exception std::logic_error Thrown if too few light curves have been 
+ *	added, or if the catalog is already closed.
+ * @exception std::runtime_error Thrown if the catalog could not be written.
+ *
+ * @exceptsafe If an exception is thrown, any existing file named 
+ *	@p fileName is unchanged.
+ */
+void CatalogWriter::close() {
+	if (impl->closed || impl->index.size() != impl->nObjects) {
+		try {
+			throw std::logic_error("Catalog " + impl->fileName + " has " 
+				+ lexical_cast<string>(impl->index.size()) + " of " 
+				+ lexical_cast<string>(impl->nObjects) + " objects, or is already closed");
+		} catch (const boost::bad_lexical_cast &e) {
+			throw std::logic_error("Catalog " + impl->fileName 
+				+ " is incomplete or already closed");
+		}
+	}
+	
+	impl->out.seekp(sizeof(CATALOG_MAGIC) + 2*sizeof(uint32_t) + sizeof(uint64_t));
+	for(size_t i = 0; i < impl->index.size(); i++) {
+		writeRaw(impl->out, impl->index[i].id);
+		writeRaw(impl->out, impl->index[i].offset);
+		writeRaw(impl->out, impl->index[i].length);
+	}
+	impl->out.close();
+	if (!impl->out) {
+		throw std::runtime_error("Could not write catalog file " + impl->tempName);
+	}
+	if (std::rename(impl->tempName.c_str(), impl->fileName.c_str()) != 0) {
+		throw std::runtime_error("Could not create catalog file " + impl->fileName);
+	}
+	
+	impl->closed = true;
+}
+
+/** Opens a catalog and reads its index.
+ *
+ * @param[in] fileName	The catalog to read
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, 
+ *	is not a catalog, was written on a machine with a different byte 
+ *	order, or is corrupted.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+CatalogReader::Impl::Impl(const string &fileName) : fileName(fileName), 
+		in(fileName.c_str(), std::ios::in | std::ios::binary), index() {
+	if (!in) {
+		throw std::runtime_error("Could not open catalog file " + fileName);
+	}
+	
+	char magic[sizeof(CATALOG_MAGIC)];
+	uint32_t order = 0, reserved = 0;
+	uint64_t nObjects = 0;
+	in.read(magic, sizeof(magic));
+	readRaw(in, order);
+	if (!in || !std::equal(magic, magic+sizeof(magic), CATALOG_MAGIC)) {
+		throw std::runtime_error(fileName + " is not a Timescales catalog file");
+	} else if (order != BYTE_ORDER_MARK) {
+		throw std::runtime_error("Catalog file " + fileName + " was written on a machine with a different byte order");
+	}
+	readRaw(in, reserved);
+	readRaw(in, nObjects);
+	
+	in.seekg(0, std::ios::end);
+	const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+	if (!in || nObjects > fileSize / (3*sizeof(uint64_t))) {
+		throw std::runtime_error("Catalog file " + fileName + " is truncated");
+	}
+	in.seekg(sizeof(CATALOG_MAGIC) + 2*sizeof(uint32_t) + sizeof(uint64_t));
+	
+	index.resize(nObjects);
+	for(size_t i = 0; i < index.size(); i++) {
+		readRaw(in, index[i].id);
+		readRaw(in, index[i].offset);
+		readRaw(in, index[i].length);
+		if (in && (index[i].offset < catalogDataStart(index.size()) 
+				|| index[i].length > fileSize / (2*sizeof(double)) 
+				|| index[i].offset + 2*sizeof(double)*index[i].length > fileSize)) {
+			throw std::runtime_error("Catalog file " + fileName + " is corrupted");
+		}
+	}
+	if (!in) {
+		throw std::runtime_error("Catalog file " + fileName + " is truncated");
+	}
+}
+
+/** Opens a catalog.
+ *
+ * @param[in] fileName	A file written by CatalogWriter
+ *
+ * @perform O(M) time, where M is the number of objects in the catalog. 
+ *	Light curves are not read until requested.
+ * @perfmore O(M) memory
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, 
+ *	is not a catalog, was written on a machine with a different byte 
+ *	order, or is corrupted.
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	the catalog's index.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+CatalogReader::CatalogReader(const string &fileName) : impl(new Impl(fileName)) {
+}
+
+/** Returns the number of objects in the catalog.
+ *
+ * @return The number of light curves in the file.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t CatalogReader::size() const {
+	return impl->index.size();
+}
+
+/** Verifies that an object exists in a catalog.
+ *
+ * @param[in] object	The position of the object in the catalog
+ * @param[in] size	The number of objects in the catalog
+ * @param[in] caller	The function that needs the object
+ *
+ * @exception std::out_of_range Thrown if @p object &ge; @p size.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void checkObject(size_t object, size_t size, const string &caller) {
+	if (object >= size) {
+		try {
+			throw std::out_of_range("Object " + lexical_cast<string>(object) 
+				+ " requested from a catalog of " + lexical_cast<string>(size) 
+				+ " in " + caller);
+		} catch (const boost::bad_lexical_cast &e) {
+			throw std::out_of_range("Object out of bounds in " + caller);
+		}
+	}
+}
+
+/** Returns the ID of an object.
+ *
+ * @param[in] object	The position of the object in the catalog
+ *
+ * @return The ID given when the object was added to the catalog.
+ *
+ * @exception std::out_of_range Thrown if @p object &ge; size().
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+unsigned long CatalogReader::getId(size_t object) const {
+	checkObject(object, size(), "CatalogReader::getId()");
+	return static_cast<unsigned long>(impl->index[object].id);
+}
+
+/** Returns the number of epochs in an object's light curve.
+ *
+ * @param[in] object	The position of the object in the catalog
+ *
+ * @return The length of the light curve.
+ *
+ * @exception std::out_of_range Thrown if @p object &ge; size().
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+size_t CatalogReader::getLength(size_t object) const {
+	checkObject(object, size(), "CatalogReader::getLength()");
+	return static_cast<size_t>(impl->index[object].length);
+}
+
+/** Reads an object's light curve.
+ *
+ * @param[in] object	The position of the object in the catalog
+ * @param[out] times	The times of the light curve
+ * @param[out] fluxes	The fluxes of the light curve
+ *
+ * @post @p times and @p fluxes are identical to the vectors passed to 
+ *	CatalogWriter::add() for this object.
+ *
+ * @perform O(N) time, where N is the length of the light curve
+ *
+ * @exception std::out_of_range Thrown if @p object &ge; size().
+ * @exception std::runtime_error Thrown if the light curve could not be 
+ *	read.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void CatalogReader::read(size_t object, DoubleVec &times, DoubleVec &fluxes) const {
+	checkObject(object, size(), "CatalogReader::read()");
+	const CatalogEntry &entry = impl->index[object];
+	
+	const size_t n = static_cast<size_t>(entry.length);
+	DoubleVec tempTimes(n), tempFluxes(n);
+	impl->in.clear();
+	impl->in.seekg(entry.offset);
+	if (n > 0) {
+		impl->in.read(reinterpret_cast<char*>(&tempTimes [0]), n*sizeof(double));
+		impl->in.read(reinterpret_cast<char*>(&tempFluxes[0]), n*sizeof(double));
+	}
+	if (!impl->in) {
+		throw std::runtime_error("Could not read a light curve from catalog file " 
+			+ impl->fileName);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(times , tempTimes );
+	swap(fluxes, tempFluxes);
+}
+
+}		// end kpftimes
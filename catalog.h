@@ -0,0 +1,59 @@
+/** Layout of catalog and shard files. None of these routines are 
+ *	intended as part of the public API.
+ * @file timescales/catalog.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATALOGH
+#define CATALOGH
+
+#include <boost/cstdint.hpp>
+
+namespace kpftimes {
+
+/** The index entry for one object in a catalog.
+ *
+ * A catalog file consists of an 8-byte magic number, the byte order 
+ * mark, a reserved 32-bit word, the number of objects as a 64-bit 
+ * integer, one CatalogEntry per object, and finally the light curves. 
+ * Each light curve is stored as all of its times followed by all of 
+ * its fluxes.
+ *
+ * @ingroup util
+ */
+struct CatalogEntry {
+	/** The object's ID */
+	boost::uint64_t id;
+	/** The position of the light curve in the file, in bytes */
+	boost::uint64_t offset;
+	/** The number of epochs in the light curve */
+	boost::uint64_t length;
+};
+
+}		// end kpftimes
+
+#endif		// end ifndef CATALOGH
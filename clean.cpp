@@ -0,0 +1,430 @@
+/** CLEAN deconvolution of irregularly sampled spectra
+ * @file timescales/clean.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_fft_complex.h>
+#include "../common/alloc.tmp.h"
+#include "../common/stats.tmp.h"
+#include "clean.h"
+#include "dft.h"
+#include "nufft.h"
+#include "timescales.h"
+#include "trace.h"
+#include "workspace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Removes the spectral window from a dirty spectrum by CLEAN iterations
+ *
+ * The implementation follows @cite CleanSpectra. Each iteration finds 
+ * the highest peak of the residual spectrum, finds the amplitude of the 
+ * sinusoid that would produce it (including the contribution from its 
+ * own negative-frequency alias), and subtracts a fraction @p gain of 
+ * that sinusoid's spectrum from the residuals. On a uniform grid the 
+ * sinusoid's spectrum is the window shifted by whole bins, so the 
+ * subtraction is a multiply-add over contiguous arrays.
+ *
+ * The spectra are stored for non-negative frequencies only; negative 
+ * frequencies are the complex conjugates of the positive ones.
+ *
+ * @param[in] dirty	The spectrum of the data, at frequencies 
+ *			k&Delta;f for k = 0, ..., M
+ * @param[in] window	The spectral window, at frequencies k&Delta;f 
+ *			for k = 0, ..., 2M
+ * @param[in] nIter	The number of CLEAN iterations
+ * @param[in] gain	The fraction of each peak to remove per iteration
+ * @param[out] components	The CLEAN components found at each frequency 
+ *				of @p dirty
+ * @param[out] residual	The spectrum left after all iterations
+ *
+ * @pre @p dirty.size() = M + 1 &ge; 2
+ * @pre @p window.size() = 2M + 1
+ * @pre 0 < @p gain &le; 1
+ *
+ * @post @p components.size() = @p residual.size() = @p dirty.size()
+ * @post @p components[0] = 0
+ *
+ * @perform O(@p nIter &times; M) time
+ * @perfmore O(M) memory
+ *
+ * @exception std::invalid_argument Thrown if @p dirty and @p window have 
+ *	inconsistent sizes or if @p gain is not in (0, 1].
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void cleanComponents(const ComplexVec &dirty, const ComplexVec &window, 
+		size_t nIter, double gain, ComplexVec &components, ComplexVec &residual) {
+	const size_t nFreq = dirty.size();
+	if (nFreq < 2 || window.size() != 2*nFreq - 1) {
+		try {
+			throw std::invalid_argument("Window in cleanComponents() must have twice as many frequencies as the spectrum (gave " 
+				+ lexical_cast<string>(nFreq) + " for the spectrum and " 
+				+ lexical_cast<string>(window.size()) + " for the window)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Window in cleanComponents() must have twice as many frequencies as the spectrum");
+		}
+	}
+	if (!(gain > 0.0 && gain <= 1.0)) {
+		try {
+			throw std::invalid_argument("Gain in cleanComponents() must be in the interval (0, 1] (gave " 
+				+ lexical_cast<string>(gain) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Gain in cleanComponents() must be in the interval (0, 1]");
+		}
+	}
+	const size_t nMax = nFreq - 1;
+	
+	// Separate real and imaginary parts keep the subtraction vectorizable. 
+	//	The window is stored from -2M to 2M, so that both of its shifts 
+	//	are contiguous.
+	DoubleVec winRe(4*nMax + 1), winIm(4*nMax + 1);
+	for (size_t k = 0; k <= 2*nMax; k++) {
+		winRe[2*nMax + k] =  window[k].real();
+		winIm[2*nMax + k] =  window[k].imag();
+		winRe[2*nMax - k] =  window[k].real();
+		winIm[2*nMax - k] = -window[k].imag();
+	}
+	DoubleVec resRe(nFreq), resIm(nFreq);
+	for (size_t k = 0; k < nFreq; k++) {
+		resRe[k] = dirty[k].real();
+		resIm[k] = dirty[k].imag();
+	}
+	ComplexVec tempComponents(nFreq, 0.0);
+	
+	for (size_t iter = 0; iter < nIter; iter++) {
+		// The zero frequency is not a sinusoid
+		size_t peak = 1;
+		double peakNorm = resRe[1]*resRe[1] + resIm[1]*resIm[1];
+		for (size_t k = 2; k < nFreq; k++) {
+			const double norm = resRe[k]*resRe[k] + resIm[k]*resIm[k];
+			if (norm > peakNorm) {
+				peak = k;
+				peakNorm = norm;
+			}
+		}
+		if (!(peakNorm > 0.0)) {
+			break;
+		}
+		
+		// Solve R(p) = a + conj(a) W(2p) for the sinusoid's amplitude a
+		const std::complex<double> r(resRe[peak], resIm[peak]);
+		const std::complex<double> w2(winRe[2*nMax + 2*peak], winIm[2*nMax + 2*peak]);
+		const double denom = 1.0 - std::norm(w2);
+		// If |W(2p)| = 1 only part of a is determined; take the smallest 
+		//	solution
+		const std::complex<double> a = gain * (denom > 1e-12 
+				? (r - std::conj(r)*w2) / denom : 0.5*r);
+		tempComponents[peak] += a;
+		
+		// R(k) -= a W(k - p) + conj(a) W(k + p)
+		const double ar = a.real(), ai = a.imag();
+		const double* minusRe = &winRe[2*nMax - peak];
+		const double* minusIm = &winIm[2*nMax - peak];
+		const double* plusRe  = &winRe[2*nMax + peak];
+		const double* plusIm  = &winIm[2*nMax + peak];
+		for (size_t k = 0; k < nFreq; k++) {
+			resRe[k] -= (ar*minusRe[k] - ai*minusIm[k]) + (ar*plusRe[k] + ai*plusIm[k]);
+			resIm[k] -= (ar*minusIm[k] + ai*minusRe[k]) + (ar*plusIm[k] - ai*plusRe[k]);
+		}
+	}
+	
+	ComplexVec tempResidual(nFreq);
+	for (size_t k = 0; k < nFreq; k++) {
+		tempResidual[k] = std::complex<double>(resRe[k], resIm[k]);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(components, tempComponents);
+	swap(residual  , tempResidual  );
+}
+
+/** Finds the width of the Gaussian that matches the main lobe of a 
+ *	spectral window
+ *
+ * @param[in] window	The spectral window, at frequencies k&Delta;f 
+ *			for k = 0, 1, ...
+ *
+ * @return The standard deviation, in units of &Delta;f, of the Gaussian 
+ *	whose half width at half maximum matches that of |@p window|.
+ *
+ * @perform O(H) time, where H is the half width of the main lobe in bins
+ *
+ * @exception std::invalid_argument Thrown if @p window is zero at zero 
+ *	frequency, or never falls to half its central value.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+double cleanBeamWidth(const ComplexVec &window) {
+	if (window.empty() || !(std::abs(window[0]) > 0.0)) {
+		throw std::invalid_argument("Window in cleanBeamWidth() has no central peak");
+	}
+	const double center = std::abs(window[0]);
+	for (size_t k = 1; k < window.size(); k++) {
+		const double level = std::abs(window[k]) / center;
+		if (level <= 0.5) {
+			const double last = std::abs(window[k-1]) / center;
+			const double halfWidth = (k - 1) + (last - 0.5) / (last - level);
+			return halfWidth / sqrt(2.0*log(2.0));
+		}
+	}
+	throw std::invalid_argument("Window in cleanBeamWidth() is wider than the frequency grid");
+}
+
+/** Convolves CLEAN components with a Gaussian beam and adds the residuals
+ *
+ * The convolution is done with FFTs over the full (positive and 
+ * negative frequency) spectrum, so its cost does not depend on the 
+ * number of components or the width of the beam.
+ *
+ * @param[in] components	The CLEAN components at frequencies k&Delta;f 
+ *				for k = 0, ..., M
+ * @param[in] residual	The residual spectrum at the same frequencies
+ * @param[in] beamWidth	The standard deviation of the beam, in units 
+ *			of &Delta;f
+ * @param[out] spectrum	The restored spectrum at the same frequencies
+ *
+ * @pre @p residual.size() = @p components.size()
+ * @pre @p beamWidth > 0
+ *
+ * @post @p spectrum.size() = @p components.size()
+ * @post @p spectrum[k] = @p residual[k] + &sum;<sub>j</sub> C(j) 
+ *	exp(-(k - j)<sup>2</sup>/(2 @p beamWidth<sup>2</sup>)), where C(j) 
+ *	= @p components[j] for j &ge; 0 and conj(@p components[-j]) 
+ *	otherwise, and the Gaussian is truncated at 6 @p beamWidth.
+ *
+ * @perform O(L log L) time, where L is about 2M + 12 @p beamWidth
+ * @perfmore O(L) memory
+ *
+ * @exception std::invalid_argument Thrown if @p components and 
+ *	@p residual have different sizes, or if @p beamWidth is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void restoreClean(const ComplexVec &components, const ComplexVec &residual, 
+		double beamWidth, ComplexVec &spectrum) {
+	const size_t nFreq = components.size();
+	if (residual.size() != nFreq) {
+		throw std::invalid_argument("Components and residuals in restoreClean() are not the same length");
+	}
+	if (!(beamWidth > 0.0)) {
+		try {
+			throw std::invalid_argument("Beam width in restoreClean() must be positive (gave " 
+				+ lexical_cast<string>(beamWidth) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Beam width in restoreClean() must be positive");
+		}
+	}
+	if (nFreq == 0) {
+		ComplexVec temp;
+		swap(spectrum, temp);
+		return;
+	}
+	const size_t nMax = nFreq - 1;
+	const size_t beamMax = static_cast<size_t>(ceil(6.0*beamWidth));
+	// Long enough that the convolution does not wrap around
+	const size_t nFft = niceFftSize(2*nMax + 1 + 2*beamMax);
+	
+	// Interleaved real and imaginary parts, as GSL expects. The 
+	//	components are stored from -M to M, the beam centered on zero.
+	DoubleVec comps(2*nFft, 0.0), beam(2*nFft, 0.0);
+	for (size_t k = 0; k <= nMax; k++) {
+		comps[2*(nMax + k)  ] =  components[k].real();
+		comps[2*(nMax + k)+1] =  components[k].imag();
+		comps[2*(nMax - k)  ] =  components[k].real();
+		comps[2*(nMax - k)+1] = -components[k].imag();
+	}
+	beam[0] = 1.0;
+	for (size_t j = 1; j <= beamMax; j++) {
+		const double value = exp(-0.5*(j/beamWidth)*(j/beamWidth));
+		beam[2*j]          = value;
+		beam[2*(nFft - j)] = value;
+	}
+	
+	shared_ptr<gsl_fft_complex_wavetable> theTable(checkAlloc(
+		gsl_fft_complex_wavetable_alloc(nFft)),
+		&gsl_fft_complex_wavetable_free);
+	shared_ptr<gsl_fft_complex_workspace> theSpace(checkAlloc(
+		gsl_fft_complex_workspace_alloc(nFft)),
+		&gsl_fft_complex_workspace_free);
+	gsl_fft_complex_forward(&comps[0], 1, nFft, theTable.get(), theSpace.get());
+	gsl_fft_complex_forward(&beam [0], 1, nFft, theTable.get(), theSpace.get());
+	for (size_t i = 0; i < nFft; i++) {
+		const std::complex<double> product = std::complex<double>(comps[2*i], comps[2*i+1]) 
+				* std::complex<double>(beam[2*i], beam[2*i+1]);
+		comps[2*i  ] = product.real();
+		comps[2*i+1] = product.imag();
+	}
+	gsl_fft_complex_inverse(&comps[0], 1, nFft, theTable.get(), theSpace.get());
+	
+	ComplexVec temp(nFreq);
+	for (size_t k = 0; k <= nMax; k++) {
+		temp[k] = std::complex<double>(comps[2*(nMax + k)], comps[2*(nMax + k)+1]) 
+				+ residual[k];
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(spectrum, temp);
+}
+
+/** Calculates the CLEAN spectrum of a light curve
+ *
+ * CLEAN (@cite CleanSpectra) removes the aliases and sidelobes that an 
+ * irregular cadence adds to the Fourier spectrum. It repeatedly 
+ * subtracts the spectral window, centered on the highest remaining peak, 
+ * from the spectrum of the data, and then replaces each subtracted peak 
+ * with a Gaussian "clean beam" that matches the main lobe of the window.
+ *
+ * The spectra are normalized so that a sinusoid of semi-amplitude A 
+ * produces a peak of height A/2.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] freqs	The frequency grid, which must start at zero and 
+ *			be evenly spaced. freqGen() with @p fMin = 0 
+ *			produces a suitable grid.
+ * @param[in] nIter	The number of CLEAN iterations. Typical values 
+ *			are a few hundred.
+ * @param[in] gain	The fraction of each peak to remove per iteration. 
+ *			Typical values are 0.1 to 0.5.
+ * @param[out] amplitude	The magnitude of the CLEAN spectrum at each 
+ *				frequency.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p times.size()
+ * @pre @p freqs[k] = k &Delta;f for some &Delta;f > 0, and 
+ *	@p freqs.size() &ge; 2
+ * @pre 0 < @p gain &le; 1
+ *
+ * @post @p amplitude.size() = @p freqs.size()
+ *
+ * @perform O(NF + @p nIter &times; F + F log F) time, where N = 
+ *	@p times.size() and F = @p freqs.size()
+ * @perfmore O(N + F) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p fluxes have 
+ *	different lengths, if @p freqs is not an evenly spaced grid 
+ *	starting at zero, if the spectral window is wider than the grid, 
+ *	or if @p gain is not in (0, 1].
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void cleanSpectrum(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &freqs, size_t nIter, double gain, DoubleVec &amplitude) {
+	TraceSpan span("cleanSpectrum");
+	const size_t nTimes = times.size();
+	const size_t nFreq  = freqs.size();
+	
+	// Verify the preconditions
+	if (nFreq < 2 || freqs[0] != 0.0 || !(freqs[1] > 0.0)) {
+		throw std::invalid_argument("Parameter 'freqs' in cleanSpectrum() must be an evenly spaced grid starting at zero");
+	}
+	const double step = freqs[1];
+	for (size_t k = 2; k < nFreq; k++) {
+		if (fabs(freqs[k] - k*step) > 1e-6*step) {
+			throw std::invalid_argument("Parameter 'freqs' in cleanSpectrum() must be an evenly spaced grid starting at zero");
+		}
+	}
+	if (fluxes.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'fluxes' in cleanSpectrum() are not the same length (gave " 
+			+ lexical_cast<string>(nTimes) + " for times and " 
+			+ lexical_cast<string>(fluxes.size()) + " for fluxes)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'fluxes' in cleanSpectrum() are not the same length");
+		}
+	}
+	
+	// The spectrum of the data and the window, normalized so that the 
+	//	window is 1 at zero frequency
+	Workspace workspace;
+	const BoolVec allValid(nTimes, true);
+	DoubleVec centered(fluxes);
+	if (nTimes > 0) {
+		const double meanF = kpfutils::mean(fluxes.begin(), fluxes.end());
+		for (size_t j = 0; j < nTimes; j++) {
+			centered[j] -= meanF;
+		}
+	}
+	DoubleVec windowFreqs(2*nFreq - 1);
+	for (size_t k = 0; k < windowFreqs.size(); k++) {
+		windowFreqs[k] = k*step;
+	}
+	ComplexVec dirty, window;
+	dft(times, centered, allValid, freqs, dirty, workspace);
+	dft(times, DoubleVec(nTimes, 1.0), allValid, windowFreqs, window, workspace);
+	for (size_t k = 0; k < dirty.size(); k++) {
+		dirty[k] /= static_cast<double>(nTimes);
+	}
+	for (size_t k = 0; k < window.size(); k++) {
+		window[k] /= static_cast<double>(nTimes);
+	}
+	
+	ComplexVec components, residual, spectrum;
+	cleanComponents(dirty, window, nIter, gain, components, residual);
+	restoreClean(components, residual, cleanBeamWidth(window), spectrum);
+	
+	DoubleVec temp(nFreq);
+	for (size_t k = 0; k < nFreq; k++) {
+		temp[k] = std::abs(spectrum[k]);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(amplitude, temp);
+}
+
+}		// end kpftimes
@@ -0,0 +1,66 @@
+/** CLEAN deconvolution of irregularly sampled spectra. None of these 
+ *	routines are intended as part of the public API.
+ * @file timescales/clean.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLEANH
+#define CLEANH
+
+#include <complex>
+#include <vector>
+
+/** A convenient shorthand for vectors of doubles.
+ */
+typedef std::vector<double               >  DoubleVec;
+/** A convenient shorthand for vectors of complex numbers.
+ */
+typedef std::vector<std::complex<double> > ComplexVec;
+
+namespace kpftimes {
+
+/** Removes the spectral window from a dirty spectrum by CLEAN iterations
+ * @ingroup util
+ */
+void cleanComponents(const ComplexVec &dirty, const ComplexVec &window, 
+		size_t nIter, double gain, ComplexVec &components, ComplexVec &residual);
+
+/** Finds the width of the Gaussian that matches the main lobe of a 
+ *	spectral window
+ * @ingroup util
+ */
+double cleanBeamWidth(const ComplexVec &window);
+
+/** Convolves CLEAN components with a Gaussian beam and adds the residuals
+ * @ingroup util
+ */
+void restoreClean(const ComplexVec &components, const ComplexVec &residual, 
+		double beamWidth, ComplexVec &spectrum);
+
+}	// end kpftimes::
+
+#endif		// end ifndef CLEANH
@@ -0,0 +1,522 @@
+/** C interface to the Timescales library
+ * @file timescales/ctimescales.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+#include <boost/lexical_cast.hpp>
+#include "ctimescales.h"
+#include "timescales.h"
+#include "workspace.h"
+
+/** Reusable temporary memory for the C interface.
+ */
+struct kpft_workspace {
+	/** Creates an empty workspace.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	kpft_workspace() : workspace(), error() {
+	}
+
+	/** Memory shared by all calls using this workspace */
+	kpftimes::Workspace workspace;
+	/** Description of the last error, if any */
+	std::string error;
+};
+
+/** Precomputed periodogram tables for the C interface.
+ */
+struct kpft_plan {
+	/** Precomputes the periodogram tables for a cadence and frequency grid.
+	 *
+	 * @param[in] times, freqs As for kpftimes::LsPlan::LsPlan()
+	 *
+	 * @exception std::invalid_argument Thrown if the arguments are 
+	 *	invalid. See kpftimes::LsPlan::LsPlan() for details.
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	build the tables.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	kpft_plan(const DoubleVec &times, const DoubleVec &freqs) : plan(times, freqs) {
+	}
+
+	/** The C++ plan */
+	kpftimes::LsPlan plan;
+};
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+/** Verifies that a caller's array can be accessed.
+ *
+ * @param[in] data	The address of the array's first element
+ * @param[in] size	The number of elements in the array
+ *
+ * @exception std::invalid_argument Thrown if @p data is null but 
+ *	@p size is not zero.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+void checkArray(const void *data, size_t size) {
+	if (data == NULL && size > 0) {
+		try {
+			throw std::invalid_argument("Null pointer passed for an array of " 
+				+ lexical_cast<string>(size) + " elements");
+		} catch (const boost::bad_lexical_cast &e) {
+			throw std::invalid_argument("Null pointer passed for a nonempty array");
+		}
+	}
+}
+
+/** Copies a caller's array into a borrowed buffer.
+ *
+ * @param[in,out] frame	The frame from which to borrow the buffer
+ * @param[in] x		The array to copy
+ *
+ * @return A vector with the elements of @p x, valid until @p frame is 
+ *	destroyed.
+ *
+ * @exception std::invalid_argument Thrown if @p x has a null pointer 
+ *	but a nonzero length.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	copy the array.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+DoubleVec& gather(ScratchFrame &frame, const kpft_vector &x) {
+	checkArray(x.data, x.size);
+	DoubleVec &result = frame.doubles(x.size);
+	for(size_t i = 0; i < x.size; i++) {
+		result[i] = x.data[static_cast<ptrdiff_t>(i) * x.stride];
+	}
+	return result;
+}
+
+/** Copies a caller's flags into a borrowed buffer.
+ *
+ * @param[in,out] frame	The frame from which to borrow the buffer
+ * @param[in] mask	The flags to copy, or null to mark all epochs valid
+ * @param[in] nTimes	The number of epochs to mark valid if @p mask is null
+ *
+ * @return A vector with the elements of @p mask, valid until @p frame is 
+ *	destroyed.
+ *
+ * @exception std::invalid_argument Thrown if @p mask has a null pointer 
+ *	but a nonzero length.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	copy the flags.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+BoolVec& gather(ScratchFrame &frame, const kpft_flags *mask, size_t nTimes) {
+	if (mask == NULL) {
+		BoolVec &result = frame.bools(nTimes);
+		result.assign(nTimes, true);
+		return result;
+	}
+	
+	checkArray(mask->data, mask->size);
+	BoolVec &result = frame.bools(mask->size);
+	for(size_t i = 0; i < mask->size; i++) {
+		result[i] = (mask->data[static_cast<ptrdiff_t>(i) * mask->stride] != 0);
+	}
+	return result;
+}
+
+/** Verifies that a caller's output buffer has the expected size.
+ *
+ * @param[in] out	The buffer to check
+ * @param[in] size	The size of the result to be stored in @p out
+ * @param[in] caller	The name of the calling function, for error messages
+ *
+ * @exception std::invalid_argument Thrown if @p out has the wrong size, 
+ *	or has a null pointer but a nonzero length.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+void checkOutput(const kpft_out_vector &out, size_t size, const char *caller) {
+	// caller is a C string so that the check allocates no memory unless 
+	//	it fails
+	if (out.size != size) {
+		try {
+			throw std::invalid_argument("Output buffer for " + string(caller) 
+				+ " has the wrong length (gave " 
+				+ lexical_cast<string>(out.size) + ", need " 
+				+ lexical_cast<string>(size) + ")");
+		} catch (const boost::bad_lexical_cast &e) {
+			throw std::invalid_argument("Output buffer for " + string(caller) 
+				+ " has the wrong length");
+		}
+	}
+	if (out.data == NULL && out.size > 0) {
+		throw std::invalid_argument("Output buffer for " + string(caller) + " is null");
+	}
+}
+
+/** Copies a result into a caller's array.
+ *
+ * @param[in] x		The result to copy
+ * @param[out] out	The caller's array
+ *
+ * @pre @p out.size = @p x.size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void scatter(const DoubleVec &x, const kpft_out_vector &out) {
+	for(size_t i = 0; i < out.size; i++) {
+		out.data[static_cast<ptrdiff_t>(i) * out.stride] = x[i];
+	}
+}
+
+/** Converts the exception currently being handled into a status code.
+ *
+ * @param[in,out] workspace The workspace in which to record the error 
+ *	message
+ *
+ * @return The status code corresponding to the exception.
+ *
+ * @pre Must be called from within a catch block
+ *
+ * @exceptsafe Does not throw exceptions. If the error message cannot be 
+ *	stored, it is left empty.
+ */
+int translateException(kpft_workspace &workspace) {
+	int status = KPFT_EFAIL;
+	const char *message = "Unknown error";
+	try {
+		throw;
+	} catch (const std::bad_alloc &e) {
+		status  = KPFT_ENOMEM;
+		message = "Out of memory";
+	} catch (const std::invalid_argument &e) {
+		status  = KPFT_EINVAL;
+		message = e.what();
+	} catch (const std::exception &e) {
+		message = e.what();
+	} catch (...) {
+	}
+	
+	try {
+		workspace.error = message;
+	} catch (const std::bad_alloc &e) {
+		workspace.error.clear();
+	}
+	return status;
+}
+
+}		// end kpftimes
+
+using namespace kpftimes;
+
+/** Creates an empty workspace.
+ *
+ * @return A new workspace, which must be destroyed with 
+ *	kpft_workspace_free(), or null if there is not enough memory.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+kpft_workspace* kpft_workspace_new(void) {
+	return new(std::nothrow) kpft_workspace();
+}
+
+/** Destroys a workspace and frees its memory.
+ *
+ * @param[in] workspace The workspace to destroy. May be null.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void kpft_workspace_free(kpft_workspace *workspace) {
+	delete workspace;
+}
+
+/** Returns a description of the last error reported through a workspace.
+ *
+ * @param[in] workspace The workspace to query
+ *
+ * @return A null-terminated string, valid until the workspace is next 
+ *	used. The string is empty if no error has been reported.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const char* kpft_workspace_error(const kpft_workspace *workspace) {
+	return (workspace == NULL ? "" : workspace->error.c_str());
+}
+
+/** Calculates the Lomb-Scargle periodogram for a time series.
+ *
+ * @param[in,out] workspace Memory to use for temporary storage. May be null.
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] mask	Flags indicating which epochs to use, or null to use 
+ *			all epochs
+ * @param[in] freqs	The frequency grid over which the periodogram should 
+ *			be calculated.
+ * @param[out] power	The periodogram power at each frequency.
+ *
+ * @pre @p power.size = @p freqs.size
+ * @pre Other preconditions as for kpftimes::lombScargle()
+ *
+ * @post @p power holds the periodogram, if the call succeeded
+ *
+ * @return KPFT_SUCCESS, or KPFT_EINVAL if any precondition is violated, 
+ *	or KPFT_ENOMEM if there is not enough memory to do the calculations.
+ *
+ * @exceptsafe Does not throw exceptions. The arguments are unchanged 
+ *	in the event of an error, except for the memory and error message 
+ *	held by @p workspace.
+ */
+int kpft_lomb_scargle(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector data, const kpft_flags *mask, kpft_vector freqs, 
+		kpft_out_vector power) {
+	kpft_workspace temp;
+	kpft_workspace &ws = (workspace != NULL ? *workspace : temp);
+	
+	try {
+		checkOutput(power, freqs.size, "kpft_lomb_scargle()");
+		
+		ScratchFrame frame(ws.workspace);
+		const DoubleVec &t = gather(frame, times);
+		const DoubleVec &y = gather(frame, data);
+		const BoolVec   &m = gather(frame, mask, times.size);
+		const DoubleVec &f = gather(frame, freqs);
+		DoubleVec &result  = frame.doubles(0);
+		
+		lombScargle(t, y, m, f, result, ws.workspace);
+		
+		// IMPORTANT: no exceptions beyond this point
+		
+		scatter(result, power);
+		return KPFT_SUCCESS;
+	} catch (...) {
+		return translateException(ws);
+	}
+}
+
+/** Calculates the autocorrelation function for a time series.
+ *
+ * @param[in,out] workspace Memory to use for temporary storage. May be null.
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use, or null to use 
+ *			all epochs
+ * @param[in] offsets	The time grid over which the autocorrelation function 
+ *			should be calculated.
+ * @param[in] maxFreq	The maximum frequency to consider when calculating 
+ *			the autocorrelation function.
+ * @param[out] acf	The value of the autocorrelation function at each 
+ *			offset.
+ *
+ * @pre @p acf.size = @p offsets.size
+ * @pre Other preconditions as for kpftimes::autoCorr()
+ *
+ * @post @p acf holds the autocorrelation function, if the call succeeded
+ *
+ * @return KPFT_SUCCESS, or KPFT_EINVAL if any precondition is violated, 
+ *	or KPFT_ENOMEM if there is not enough memory to do the calculations.
+ *
+ * @exceptsafe Does not throw exceptions. The arguments are unchanged 
+ *	in the event of an error, except for the memory and error message 
+ *	held by @p workspace.
+ */
+int kpft_autocorr(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector fluxes, const kpft_flags *mask, kpft_vector offsets, 
+		double maxFreq, kpft_out_vector acf) {
+	kpft_workspace temp;
+	kpft_workspace &ws = (workspace != NULL ? *workspace : temp);
+	
+	try {
+		checkOutput(acf, offsets.size, "kpft_autocorr()");
+		
+		ScratchFrame frame(ws.workspace);
+		const DoubleVec &t = gather(frame, times);
+		const DoubleVec &y = gather(frame, fluxes);
+		const BoolVec   &m = gather(frame, mask, times.size);
+		const DoubleVec &o = gather(frame, offsets);
+		DoubleVec &result  = frame.doubles(0);
+		
+		autoCorr(t, y, m, o, result, maxFreq, ws.workspace);
+		
+		// IMPORTANT: no exceptions beyond this point
+		
+		scatter(result, acf);
+		return KPFT_SUCCESS;
+	} catch (...) {
+		return translateException(ws);
+	}
+}
+
+/** Calculates the significance threshold for a Lomb-Scargle periodogram 
+ *	of white noise.
+ *
+ * @param[in,out] workspace Memory to use for temporary storage. May be null.
+ * @param[in] times	Times at which data were taken
+ * @param[in] freqs	The frequency grid over which the periodogram was 
+ *			calculated.
+ * @param[in] fap	The false alarm probability the threshold should 
+ *			correspond to.
+ * @param[in] nSims	The number of simulations to use.
+ * @param[in] seed	The seed for the simulations.
+ * @param[out] threshold The power that will be exceeded in a fraction 
+ *			@p fap of white noise light curves.
+ *
+ * @pre Preconditions as for kpftimes::lsThreshold()
+ *
+ * @return KPFT_SUCCESS, or KPFT_EINVAL if any precondition is violated, 
+ *	or KPFT_ENOMEM if there is not enough memory to do the calculations.
+ *
+ * @exceptsafe Does not throw exceptions. The arguments are unchanged 
+ *	in the event of an error, except for the memory and error message 
+ *	held by @p workspace.
+ */
+int kpft_ls_threshold(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector freqs, double fap, long nSims, unsigned long seed, 
+		double *threshold) {
+	kpft_workspace temp;
+	kpft_workspace &ws = (workspace != NULL ? *workspace : temp);
+	
+	try {
+		if (threshold == NULL) {
+			throw std::invalid_argument("Output for kpft_ls_threshold() is null");
+		}
+		
+		ScratchFrame frame(ws.workspace);
+		const DoubleVec &t = gather(frame, times);
+		const DoubleVec &f = gather(frame, freqs);
+		
+		*threshold = lsThreshold(t, f, fap, nSims, WhiteNoise(), seed);
+		return KPFT_SUCCESS;
+	} catch (...) {
+		return translateException(ws);
+	}
+}
+
+/** Precomputes the periodogram tables for a cadence and frequency grid.
+ *
+ * @param[in,out] workspace Memory to use for temporary storage. May be null.
+ * @param[in] times	The times at which light curves will be observed
+ * @param[in] freqs	The frequency grid over which periodograms will be 
+ *			calculated.
+ * @param[out] plan	The new plan, which must be destroyed with 
+ *			kpft_plan_free().
+ *
+ * @pre Preconditions as for kpftimes::LsPlan::LsPlan()
+ *
+ * @return KPFT_SUCCESS, or KPFT_EINVAL if any precondition is violated, 
+ *	or KPFT_ENOMEM if there is not enough memory to build the tables.
+ *
+ * @exceptsafe Does not throw exceptions. The arguments are unchanged 
+ *	in the event of an error, except for the memory and error message 
+ *	held by @p workspace.
+ */
+int kpft_plan_new(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector freqs, kpft_plan **plan) {
+	kpft_workspace temp;
+	kpft_workspace &ws = (workspace != NULL ? *workspace : temp);
+	
+	try {
+		if (plan == NULL) {
+			throw std::invalid_argument("Output for kpft_plan_new() is null");
+		}
+		
+		ScratchFrame frame(ws.workspace);
+		const DoubleVec &t = gather(frame, times);
+		const DoubleVec &f = gather(frame, freqs);
+		
+		*plan = new kpft_plan(t, f);
+		return KPFT_SUCCESS;
+	} catch (...) {
+		return translateException(ws);
+	}
+}
+
+/** Destroys a plan and frees its memory.
+ *
+ * @param[in] plan The plan to destroy. May be null.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void kpft_plan_free(kpft_plan *plan) {
+	delete plan;
+}
+
+/** Calculates the Lomb-Scargle periodogram for a light curve observed 
+ *	with a planned cadence.
+ *
+ * @param[in,out] workspace Memory to use for temporary storage. May be null.
+ * @param[in] plan	The cadence and frequency grid of the light curve
+ * @param[in] data	Measurements at each time in the plan
+ * @param[in] mask	Flags indicating which epochs to use, or null to use 
+ *			all epochs
+ * @param[out] power	The periodogram power at each frequency in the plan.
+ *
+ * @pre @p power.size is the number of frequencies in @p plan
+ * @pre Other preconditions as for kpftimes::lombScargle(const LsPlan&, 
+ *	const DoubleVec&, const BoolVec&, DoubleVec&)
+ *
+ * @post @p power holds the periodogram, if the call succeeded
+ *
+ * @return KPFT_SUCCESS, or KPFT_EINVAL if any precondition is violated, 
+ *	or KPFT_ENOMEM if there is not enough memory to do the calculations.
+ *
+ * @exceptsafe Does not throw exceptions. The arguments are unchanged 
+ *	in the event of an error, except for the memory and error message 
+ *	held by @p workspace.
+ */
+int kpft_plan_lomb_scargle(kpft_workspace *workspace, const kpft_plan *plan, 
+		kpft_vector data, const kpft_flags *mask, kpft_out_vector power) {
+	kpft_workspace temp;
+	kpft_workspace &ws = (workspace != NULL ? *workspace : temp);
+	
+	try {
+		if (plan == NULL) {
+			throw std::invalid_argument("Plan for kpft_plan_lomb_scargle() is null");
+		}
+		checkOutput(power, plan->plan.getFreqs().size(), "kpft_plan_lomb_scargle()");
+		
+		ScratchFrame frame(ws.workspace);
+		const DoubleVec &y = gather(frame, data);
+		const BoolVec   &m = gather(frame, mask, plan->plan.getTimes().size());
+		DoubleVec &result  = frame.doubles(0);
+		
+		lombScargle(plan->plan, y, m, result, ws.workspace);
+		
+		// IMPORTANT: no exceptions beyond this point
+		
+		scatter(result, power);
+		return KPFT_SUCCESS;
+	} catch (...) {
+		return translateException(ws);
+	}
+}
@@ -0,0 +1,179 @@
+/** C interface to the Timescales library
+ * @file timescales/ctimescales.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CTIMESCALESH
+#define CTIMESCALESH
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup capi C interface
+ *
+ * These functions expose the core of the library to programs that cannot 
+ * call C++ directly. Arrays are passed as a pointer, a length, and a 
+ * stride, so that callers can pass their own buffers (including 
+ * non-contiguous slices) without copying them into a library type. 
+ * Results are written into buffers owned by the caller.
+ *
+ * Each function that does real work takes a kpft_workspace, which holds 
+ * the library's temporary memory between calls. Once a workspace has 
+ * served a call, later calls of the same or smaller size allocate no 
+ * memory. A workspace may not be used by more than one thread at once; 
+ * give each thread its own. A null workspace is allowed, at the cost of 
+ * allocating temporary memory on every call.
+ *
+ * No function in this interface throws an exception. Instead, each 
+ * returns one of the @ref KPFT_SUCCESS "KPFT_*" status codes, and stores 
+ * a description of any error in its workspace.
+ * @{
+ */
+
+/** Status code for a successful call.
+ */
+#define KPFT_SUCCESS 0
+/** Status code for a call with invalid arguments, such as arrays of 
+ *	inconsistent length, a null pointer for a nonempty array, or a 
+ *	light curve with no variability.
+ */
+#define KPFT_EINVAL  1
+/** Status code for a call that ran out of memory.
+ */
+#define KPFT_ENOMEM  2
+/** Status code for any other failure.
+ */
+#define KPFT_EFAIL   3
+
+/** A read-only array of doubles owned by the caller.
+ *
+ * Element i is at @p data[i*@p stride]. The stride is counted in 
+ * elements, not bytes, and may be negative.
+ */
+typedef struct kpft_vector {
+	/** Pointer to the first element */
+	const double *data;
+	/** Number of elements */
+	size_t size;
+	/** Distance between consecutive elements, in units of doubles */
+	ptrdiff_t stride;
+} kpft_vector;
+
+/** A writable array of doubles owned by the caller.
+ *
+ * Element i is at @p data[i*@p stride].
+ */
+typedef struct kpft_out_vector {
+	/** Pointer to the first element */
+	double *data;
+	/** Number of elements */
+	size_t size;
+	/** Distance between consecutive elements, in units of doubles */
+	ptrdiff_t stride;
+} kpft_out_vector;
+
+/** A read-only array of flags owned by the caller.
+ *
+ * Element i is at @p data[i*@p stride], and is true if nonzero.
+ */
+typedef struct kpft_flags {
+	/** Pointer to the first element */
+	const unsigned char *data;
+	/** Number of elements */
+	size_t size;
+	/** Distance between consecutive elements, in units of bytes */
+	ptrdiff_t stride;
+} kpft_flags;
+
+/** Reusable temporary memory for the C interface, corresponding to 
+ *	kpftimes::Workspace.
+ */
+typedef struct kpft_workspace kpft_workspace;
+
+/** Precomputed periodogram tables for a cadence, corresponding to 
+ *	kpftimes::LsPlan.
+ */
+typedef struct kpft_plan kpft_plan;
+
+/** Creates an empty workspace.
+ */
+kpft_workspace* kpft_workspace_new(void);
+
+/** Destroys a workspace and frees its memory.
+ */
+void kpft_workspace_free(kpft_workspace *workspace);
+
+/** Returns a description of the last error reported through a workspace.
+ */
+const char* kpft_workspace_error(const kpft_workspace *workspace);
+
+/** Calculates the Lomb-Scargle periodogram for a time series, 
+ *	corresponding to kpftimes::lombScargle().
+ */
+int kpft_lomb_scargle(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector data, const kpft_flags *mask, kpft_vector freqs, 
+		kpft_out_vector power);
+
+/** Calculates the autocorrelation function for a time series, 
+ *	corresponding to kpftimes::autoCorr().
+ */
+int kpft_autocorr(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector fluxes, const kpft_flags *mask, kpft_vector offsets, 
+		double maxFreq, kpft_out_vector acf);
+
+/** Calculates the significance threshold for a Lomb-Scargle periodogram 
+ *	of white noise, corresponding to kpftimes::lsThreshold().
+ */
+int kpft_ls_threshold(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector freqs, double fap, long nSims, unsigned long seed, 
+		double *threshold);
+
+/** Precomputes the periodogram tables for a cadence and frequency grid.
+ */
+int kpft_plan_new(kpft_workspace *workspace, kpft_vector times, 
+		kpft_vector freqs, kpft_plan **plan);
+
+/** Destroys a plan and frees its memory.
+ */
+void kpft_plan_free(kpft_plan *plan);
+
+/** Calculates the Lomb-Scargle periodogram for a light curve observed 
+ *	with a planned cadence.
+ */
+int kpft_plan_lomb_scargle(kpft_workspace *workspace, const kpft_plan *plan, 
+		kpft_vector data, const kpft_flags *mask, kpft_out_vector power);
+
+/** @} */	/* end capi */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif		/* end ifndef CTIMESCALESH */
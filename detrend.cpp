@@ -0,0 +1,761 @@
+/** Rolling-window statistics for detrending light curves
+ * @file timescales/detrend.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/lexical_cast.hpp>
+#include "../common/stats_except.h"
+#include "skiplist.h"
+#include "timeexcept.h"
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+/** Finds an element of the absolute deviations of a sorted list from 
+ *	its median.
+ *
+ * The deviations of the elements below the median, read from the median 
+ * down, and of the elements at or above the median, read from the median 
+ * up, form two sorted sequences. The desired element is found by 
+ * bisecting on how many of its predecessors come from the lower sequence.
+ *
+ * @param[in] sorted	The values whose deviations are needed
+ * @param[in] med	The median of @p sorted
+ * @param[in] nBelow	The number of elements of @p sorted less than @p med
+ * @param[in] rank	The rank of the desired deviation
+ *
+ * @return The (@p rank + 1)th smallest value of |x - @p med| over all 
+ *	x in @p sorted.
+ *
+ * @pre @p rank < @p sorted.size()
+ *
+ * @perform O(log<sup>2</sup> N) time, where N = @p sorted.size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double rankedDeviation(const IndexableSkiplist &sorted, double med, 
+		size_t nBelow, size_t rank) {
+	const size_t nAbove = sorted.size() - nBelow;
+	const size_t want   = rank + 1;
+
+	// i = number of the smallest (rank+1) deviations taken from below
+	size_t lo = (want > nAbove ? want - nAbove : 0);
+	size_t hi = std::min(want, nBelow);
+	while (lo < hi) {
+		size_t i = lo + (hi - lo)/2;
+		size_t j = want - i;
+		double lower = med - sorted.at(nBelow - 1 - i);
+		double upper = sorted.at(nBelow + j - 1) - med;
+		if (lower < upper) {
+			lo = i + 1;
+		} else {
+			hi = i;
+		}
+	}
+
+	// The answer is the larger of the last deviation taken from each side
+	const size_t i = lo;
+	const size_t j = want - i;
+	double result = 0.0;
+	if (i > 0) {
+		result = med - sorted.at(nBelow - i);
+	}
+	if (j > 0) {
+		result = std::max(result, sorted.at(nBelow + j - 1) - med);
+	}
+	return result;
+}
+
+/** Finds the median of a sorted list.
+ *
+ * @param[in] sorted	The values whose median is needed
+ *
+ * @return The middle element of @p sorted, or the mean of the two middle 
+ *	elements if @p sorted has an even number of elements.
+ *
+ * @pre @p sorted.size() &ge; 1
+ *
+ * @perform O(log N) time, where N = @p sorted.size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double sortedMedian(const IndexableSkiplist &sorted) {
+	const size_t n = sorted.size();
+	return 0.5*(sorted.at((n-1)/2) + sorted.at(n/2));
+}
+
+/** Defines the window over which statistics are computed.
+ *
+ * @param[in] window	The width of the window, in the same units as the 
+ *			times of the light curves. Each statistic at time 
+ *			t is computed from all epochs in 
+ *			[t - @p window/2, t + @p window/2].
+ *
+ * @pre @p window > 0
+ *
+ * @exception std::invalid_argument Thrown if @p window is not positive.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+RollingStats::RollingStats(double window) : window(window), sorted(NULL) {
+	if (!(window > 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'window' in RollingStats() must be positive (gave " 
+				+ lexical_cast<string>(window) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'window' in RollingStats() must be positive");
+		}
+	}
+}
+
+/** Creates a copy of a workspace.
+ *
+ * @param[in] other	The object to copy
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	copy the workspace.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+RollingStats::RollingStats(const RollingStats &other) : window(other.window), 
+		sorted(other.sorted != NULL ? new IndexableSkiplist(*other.sorted) : NULL) {
+}
+
+/** Replaces this workspace with a copy of another.
+ *
+ * @param[in] other	The object to copy
+ *
+ * @return A reference to this object
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	copy the workspace.
+ *
+ * @exceptsafe This object is unchanged in the event of an exception.
+ */
+RollingStats& RollingStats::operator=(const RollingStats &other) {
+	if (this != &other) {
+		IndexableSkiplist* newSorted = (other.sorted != NULL 
+				? new IndexableSkiplist(*other.sorted) : NULL);
+
+		// IMPORTANT: no exceptions beyond this point
+
+		delete sorted;
+		sorted = newSorted;
+		window = other.window;
+	}
+	return *this;
+}
+
+/** Releases the workspace.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+RollingStats::~RollingStats() {
+	delete sorted;
+}
+
+/** Returns the width of the window.
+ *
+ * @return The width passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double RollingStats::getWindow() const {
+	return window;
+}
+
+/** Computes a rolling statistic of a light curve.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] stat	The statistic to compute
+ * @param[out] out	The statistic at each epoch
+ * @param[in] caller	The name of the public function, for use in error 
+ *			messages.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ *
+ * @post @p out.size() = @p times.size()
+ * @post @p out[i] is @p stat evaluated over all j such that 
+ *	|@p times[j] - @p times[i]| &le; getWindow()/2
+ *
+ * @perform O(N log w) time for the median and mean, and O(N 
+ *	log<sup>2</sup> w) for the median absolute deviation, where N = 
+ *	@p times.size() and w is the largest number of epochs in a window
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths or if @p data contains NaNs.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the statistic.
+ *
+ * @exceptsafe If the arguments are invalid, they are unchanged. If there 
+ *	is not enough memory, the contents of @p out are unspecified.
+ */
+void RollingStats::run(const DoubleVec &times, const DoubleVec &data, Statistic stat, 
+		DoubleVec &out, const string &caller) {
+	const size_t n = times.size();
+
+	// Verify the preconditions
+	if (data.size() != n) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'data' in " + caller + " are not the same length (gave " 
+			+ lexical_cast<string>(n) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'data' in " + caller + " are not the same length");
+		}
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (i > 0 && times[i-1] > times[i]) {
+			throw kpfutils::except::NotSorted("Parameter 'times' in " + caller + " is not sorted in ascending order");
+		}
+		// NaN is the only value not equal to itself
+		if (data[i] != data[i]) {
+			throw std::invalid_argument("Parameter 'data' in " + caller + " contains NaNs");
+		}
+	}
+
+	if (stat != MEAN) {
+		if (sorted == NULL) {
+			sorted = new IndexableSkiplist();
+		} else {
+			sorted->clear();
+		}
+	}
+	// Reuses the caller's storage if it is big enough
+	out.resize(n);
+
+	const double halfWidth = 0.5*window;
+	double sum = 0.0;
+	// The window is [first, last)
+	size_t first = 0, last = 0;
+	for (size_t i = 0; i < n; i++) {
+		while (last < n && times[last] <= times[i] + halfWidth) {
+			if (stat == MEAN) {
+				sum += data[last];
+			} else {
+				sorted->insert(data[last]);
+			}
+			last++;
+		}
+		while (times[first] < times[i] - halfWidth) {
+			if (stat == MEAN) {
+				sum -= data[first];
+			} else {
+				sorted->remove(data[first]);
+			}
+			first++;
+		}
+		// assert: first <= i < last, so the window is never empty
+
+		switch (stat) {
+		case MEAN:
+			out[i] = sum / (last - first);
+			break;
+		case MEDIAN:
+			out[i] = sortedMedian(*sorted);
+			break;
+		case RESIDUAL:
+			out[i] = data[i] - sortedMedian(*sorted);
+			break;
+		case MAD: {
+			const size_t count = sorted->size();
+			const double med   = sortedMedian(*sorted);
+			const size_t below = sorted->countBelow(med);
+			out[i] = 0.5*(rankedDeviation(*sorted, med, below, (count-1)/2) 
+					+ rankedDeviation(*sorted, med, below, count/2));
+			break;
+		}
+		}
+	}
+}
+
+/** Computes the median of a light curve in a sliding time window.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[out] medians	The median of @p data over the window centered on 
+ *			each epoch. May be the same object as @p data.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ *
+ * @post @p medians.size() = @p times.size()
+ * @post @p medians[i] is the median of @p data[j] over all j such that 
+ *	|@p times[j] - @p times[i]| &le; getWindow()/2. If there are an 
+ *	even number of such epochs, the median is the mean of the middle two.
+ *
+ * @perform O(N log w) time, where N = @p times.size() and w is the 
+ *	largest number of epochs in a window
+ * @perfmore O(w) memory, which is kept for later calls
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths or if @p data contains NaNs.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the medians.
+ *
+ * @exceptsafe If the arguments are invalid, they are unchanged. If there 
+ *	is not enough memory, the contents of @p medians are unspecified.
+ */
+void RollingStats::median(const DoubleVec &times, const DoubleVec &data, DoubleVec &medians) {
+	if (&medians == &data) {
+		DoubleVec temp;
+		run(times, data, MEDIAN, temp, "RollingStats::median()");
+		using std::swap;
+		swap(medians, temp);
+	} else {
+		run(times, data, MEDIAN, medians, "RollingStats::median()");
+	}
+}
+
+/** Computes the median absolute deviation of a light curve in a sliding 
+ *	time window.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[out] mads	The median absolute deviation of @p data over the 
+ *			window centered on each epoch. May be the same 
+ *			object as @p data.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ *
+ * @post @p mads.size() = @p times.size()
+ * @post @p mads[i] is the median of |@p data[j] - m<sub>i</sub>| over 
+ *	all j such that |@p times[j] - @p times[i]| &le; getWindow()/2, 
+ *	where m<sub>i</sub> is the median of @p data over the same epochs. 
+ *	The result is not scaled to match the standard deviation of a 
+ *	normal distribution.
+ *
+ * @perform O(N log<sup>2</sup> w) time, where N = @p times.size() and w 
+ *	is the largest number of epochs in a window
+ * @perfmore O(w) memory, which is kept for later calls
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths or if @p data contains NaNs.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the deviations.
+ *
+ * @exceptsafe If the arguments are invalid, they are unchanged. If there 
+ *	is not enough memory, the contents of @p mads are unspecified.
+ */
+void RollingStats::mad(const DoubleVec &times, const DoubleVec &data, DoubleVec &mads) {
+	if (&mads == &data) {
+		DoubleVec temp;
+		run(times, data, MAD, temp, "RollingStats::mad()");
+		using std::swap;
+		swap(mads, temp);
+	} else {
+		run(times, data, MAD, mads, "RollingStats::mad()");
+	}
+}
+
+/** Computes the mean of a light curve in a sliding time window.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[out] means	The mean of @p data over the window centered on 
+ *			each epoch. May be the same object as @p data.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ *
+ * @post @p means.size() = @p times.size()
+ * @post @p means[i] is the mean of @p data[j] over all j such that 
+ *	|@p times[j] - @p times[i]| &le; getWindow()/2
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths or if @p data contains NaNs.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the means.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void RollingStats::mean(const DoubleVec &times, const DoubleVec &data, DoubleVec &means) {
+	if (&means == &data) {
+		DoubleVec temp;
+		run(times, data, MEAN, temp, "RollingStats::mean()");
+		using std::swap;
+		swap(means, temp);
+	} else {
+		run(times, data, MEAN, means, "RollingStats::mean()");
+	}
+}
+
+/** Subtracts the rolling median from a light curve.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[out] residuals The difference between @p data and its rolling 
+ *			median. May be the same object as @p data.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ *
+ * @post @p residuals.size() = @p times.size()
+ * @post @p residuals[i] = @p data[i] - m<sub>i</sub>, where m<sub>i</sub> 
+ *	is the median of @p data over all epochs j such that 
+ *	|@p times[j] - @p times[i]| &le; getWindow()/2
+ *
+ * @perform O(N log w) time, where N = @p times.size() and w is the 
+ *	largest number of epochs in a window
+ * @perfmore O(w) memory, which is kept for later calls
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths or if @p data contains NaNs.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	detrend the light curve.
+ *
+ * @exceptsafe If the arguments are invalid, they are unchanged. If there 
+ *	is not enough memory, the contents of @p residuals are unspecified.
+ */
+void RollingStats::detrend(const DoubleVec &times, const DoubleVec &data, DoubleVec &residuals) {
+	if (&residuals == &data) {
+		DoubleVec temp;
+		run(times, data, RESIDUAL, temp, "RollingStats::detrend()");
+		using std::swap;
+		swap(residuals, temp);
+	} else {
+		run(times, data, RESIDUAL, residuals, "RollingStats::detrend()");
+	}
+}
+
+/** Computes the median of a light curve in a sliding time window.
+ *
+ * This function is a convenience wrapper for RollingStats::median(). 
+ * Use a RollingStats object directly to avoid reallocating the working 
+ * storage for each light curve.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] window	The width of the window, in the same units as 
+ *			@p times.
+ * @param[out] medians	The median of @p data over the window centered on 
+ *			each epoch.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ * @pre @p window > 0
+ *
+ * @post @p medians.size() = @p times.size()
+ * @post @p medians[i] is the median of @p data[j] over all j such that 
+ *	|@p times[j] - @p times[i]| &le; @p window/2
+ *
+ * @perform O(N log w) time, where N = @p times.size() and w is the 
+ *	largest number of epochs in a window
+ * @perfmore O(w) memory
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, if @p data contains NaNs, or if @p window is not 
+ *	positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the medians.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void rollingMedian(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &medians) {
+	// copy-and-swap
+	DoubleVec temp;
+	RollingStats(window).median(times, data, temp);
+
+	using std::swap;
+	swap(medians, temp);
+}
+
+/** Computes the median absolute deviation of a light curve in a sliding 
+ *	time window.
+ *
+ * This function is a convenience wrapper for RollingStats::mad(). 
+ * Use a RollingStats object directly to avoid reallocating the working 
+ * storage for each light curve.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] window	The width of the window, in the same units as 
+ *			@p times.
+ * @param[out] mads	The median absolute deviation of @p data over the 
+ *			window centered on each epoch.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ * @pre @p window > 0
+ *
+ * @post @p mads.size() = @p times.size()
+ * @post @p mads[i] is the median absolute deviation of @p data[j] from 
+ *	its median over all j such that |@p times[j] - @p times[i]| &le; 
+ *	@p window/2
+ *
+ * @perform O(N log<sup>2</sup> w) time, where N = @p times.size() and w 
+ *	is the largest number of epochs in a window
+ * @perfmore O(w) memory
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, if @p data contains NaNs, or if @p window is not 
+ *	positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the deviations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void rollingMad(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &mads) {
+	// copy-and-swap
+	DoubleVec temp;
+	RollingStats(window).mad(times, data, temp);
+
+	using std::swap;
+	swap(mads, temp);
+}
+
+/** Computes the mean of a light curve in a sliding time window.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] window	The width of the window, in the same units as 
+ *			@p times.
+ * @param[out] means	The mean of @p data over the window centered on 
+ *			each epoch.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ * @pre @p window > 0
+ *
+ * @post @p means.size() = @p times.size()
+ * @post @p means[i] is the mean of @p data[j] over all j such that 
+ *	|@p times[j] - @p times[i]| &le; @p window/2
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, if @p data contains NaNs, or if @p window is not 
+ *	positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the means.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void rollingMean(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &means) {
+	// copy-and-swap
+	DoubleVec temp;
+	RollingStats(window).mean(times, data, temp);
+
+	using std::swap;
+	swap(means, temp);
+}
+
+/** Subtracts the rolling median from a light curve.
+ *
+ * This function is a convenience wrapper for RollingStats::detrend(). 
+ * Use a RollingStats object directly to avoid reallocating the working 
+ * storage for each light curve.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] window	The width of the window, in the same units as 
+ *			@p times.
+ * @param[out] residuals The difference between @p data and its rolling 
+ *			median.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data does not contain NaNs
+ * @pre @p window > 0
+ *
+ * @post @p residuals.size() = @p times.size()
+ * @post @p residuals[i] = @p data[i] - m<sub>i</sub>, where m<sub>i</sub> 
+ *	is the median of @p data over all epochs j such that 
+ *	|@p times[j] - @p times[i]| &le; @p window/2
+ *
+ * @perform O(N log w) time, where N = @p times.size() and w is the 
+ *	largest number of epochs in a window
+ * @perfmore O(w) memory
+ *
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, if @p data contains NaNs, or if @p window is not 
+ *	positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	detrend the light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void detrend(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &residuals) {
+	// copy-and-swap
+	DoubleVec temp;
+	RollingStats(window).detrend(times, data, temp);
+
+	using std::swap;
+	swap(residuals, temp);
+}
+
+/** Subtracts the rolling median from each of a batch of light curves.
+ *
+ * Each light curve may have its own cadence. The output vectors are 
+ * reused if they are already large enough, so a batch run repeatedly 
+ * through the same @p residuals allocates no memory after the first time.
+ *
+ * @param[in] times	Times at which each light curve was observed
+ * @param[in] data	Measurements of each light curve
+ * @param[in] window	The width of the window, in the same units as 
+ *			@p times.
+ * @param[out] residuals The difference between each light curve and its 
+ *			rolling median.
+ *
+ * @pre @p data.size() = @p times.size()
+ * @pre @p times[k] is sorted in ascending order, for all k
+ * @pre @p data[k].size() = @p times[k].size(), for all k
+ * @pre @p data[k] does not contain NaNs, for all k
+ * @pre @p window > 0
+ *
+ * @post @p residuals.size() = @p times.size()
+ * @post @p residuals[k] is the output of 
+ *	@ref detrend(const DoubleVec&, const DoubleVec&, double, DoubleVec&) "detrend"(@p times[k], @p data[k], @p window), 
+ *	for all k
+ *
+ * @perform O(N log w) time, where N is the total number of epochs and w 
+ *	is the largest number of epochs in a window
+ * @perfmore If the library was compiled with OpenMP, light curves are 
+ *	detrended in parallel.
+ *
+ * @exception kpfutils::except::NotSorted Thrown if some element of 
+ *	@p times is not in ascending order.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, if one of their elements does, if @p data 
+ *	contains NaNs, or if @p window is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	detrend the light curves.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p residuals 
+ *	are unspecified.
+ */
+void detrend(const std::vector<DoubleVec> &times, const std::vector<DoubleVec> &data, 
+		double window, std::vector<DoubleVec> &residuals) {
+	const long nStars = static_cast<long>(times.size());
+	if (data.size() != times.size()) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'data' in detrend() do not have the same number of light curves (gave " 
+			+ lexical_cast<string>(times.size()) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'data' in detrend() do not have the same number of light curves");
+		}
+	}
+	// Checks the window before any threads start
+	const RollingStats prototype(window);
+	residuals.resize(times.size());
+
+	// Exceptions must not propagate out of a parallel region
+	bool outOfMemory = false;
+	string failure;
+	bool unsorted = false;
+
+	#ifdef _OPENMP
+	#pragma omp parallel
+	#endif
+	{
+		// One workspace per thread
+		RollingStats stats(prototype);
+
+		#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+		#endif
+		for (long k = 0; k < nStars; k++) {
+			try {
+				TraceSpan span("detrend", static_cast<unsigned long>(k));
+				stats.detrend(times[k], data[k], residuals[k]);
+			} catch (const std::bad_alloc& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(detrendError)
+				#endif
+				outOfMemory = true;
+			} catch (const kpfutils::except::NotSorted& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(detrendError)
+				#endif
+				{
+					unsorted = true;
+					failure  = e.what();
+				}
+			} catch (const std::exception& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(detrendError)
+				#endif
+				failure = e.what();
+			}
+		}
+	}
+
+	if (outOfMemory) {
+		throw std::bad_alloc();
+	} else if (unsorted) {
+		throw kpfutils::except::NotSorted(failure);
+	} else if (!failure.empty()) {
+		throw std::invalid_argument(failure);
+	}
+}
+
+}		// end kpftimes
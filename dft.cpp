@@ -2,7 +2,7 @@
  * @file timescales/dft.cpp
  * @author Krzysztof Findeisen
  * @date Created February 13, 2011
- * @date Last modified November 25, 2013
+ * @date Last modified October 18, 2026
  */ 
 
 /* Copyright 2014, California Institute of Technology.
@@ -36,6 +36,11 @@
 #include <boost/math/constants/constants.hpp>
 #include <boost/version.hpp>
 #include "dft.h"
+#include "kernels.h"
+#include "nufft.h"
+#include "tuning.h"
+#include "utils.h"
+#include "workspace.h"
 #include "../common/stats_except.h"
 #include "timeexcept.h"
 
@@ -60,7 +65,10 @@ using boost::lexical_cast;
  * @pre all elements of @p freqs[i] &gt; 0 for all i
  * 
  * @post @p dft.size() = @p freqs.size()
- * @post @p dft[i] is the discrete Fourier transform evaluated at @p freqs[i], for all i
+ * @post @p dft[i] is the discrete Fourier transform evaluated at @p freqs[i], for all i. 
+ *	If F is large, even on a uniform grid, the transform is evaluated 
+ *	with a type 3 nonuniform FFT and is accurate only to TYPE3_PRECISION 
+ *	relative to the sum of the magnitudes of its terms.
  *
  * @perform O(NF) time, where N = @p times.size() and F = freqs.size()
  *
@@ -136,4 +144,201 @@ void dft(const DoubleVec &times, const DoubleVec &fluxes,
 	swap(dft, tempDft);
 }
 
+/** Calculates the discrete Fourier transform for a subset of a list of 
+ *	times and fluxes
+ *
+ * Epochs for which @p mask is false are skipped, as if they had been 
+ * removed from both @p times and @p fluxes.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] freqs	The frequency grid over which the DFT should 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ * @param[out] dft	Fourier transform at each frequency.
+ *
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p mask.size() = @p times.size()
+ * @pre @p fluxes[i] is the flux of the source at @p times[i], for all i
+ * @pre all elements of @p freqs[i] &gt; 0 for all i
+ * 
+ * @post @p dft.size() = @p freqs.size()
+ * @post @p dft[i] is the discrete Fourier transform of the unmasked data 
+ *	evaluated at @p freqs[i], for all i. If F is large, even on a 
+ *	uniform grid, the transform is evaluated with a type 3 nonuniform 
+ *	FFT and is accurate only to TYPE3_PRECISION relative to the sum of 
+ *	the magnitudes of its terms.
+ *
+ * @perform O(MF + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = freqs.size()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times, @p fluxes, and 
+ *	@p mask have different lengths.
+ * 
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void dft(const DoubleVec &times, const DoubleVec &fluxes, const BoolVec &mask, 
+		const DoubleVec &freqs, ComplexVec &dft) {
+	kpftimes::dft(times, fluxes, mask, freqs, dft, threadWorkspace());
+}
+
+/** Calculates the discrete Fourier transform for a subset of a list of 
+ *	times and fluxes, using preallocated memory
+ *
+ * Epochs for which @p mask is false are skipped, as if they had been 
+ * removed from both @p times and @p fluxes.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] freqs	The frequency grid over which the DFT should 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ * @param[out] dft	Fourier transform at each frequency.
+ * @param[in,out] workspace Memory to use for temporary storage.
+ *
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p mask.size() = @p times.size()
+ * @pre @p fluxes[i] is the flux of the source at @p times[i], for all i
+ * @pre all elements of @p freqs[i] &gt; 0 for all i
+ * 
+ * @post @p dft.size() = @p freqs.size()
+ * @post @p dft[i] is the discrete Fourier transform of the unmasked data 
+ *	evaluated at @p freqs[i], for all i. If F is large, even on a 
+ *	uniform grid, the transform is evaluated with a type 3 nonuniform 
+ *	FFT and is accurate only to TYPE3_PRECISION relative to the sum of 
+ *	the magnitudes of its terms.
+ *
+ * @perform O(MF + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = freqs.size()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times, @p fluxes, and 
+ *	@p mask have different lengths.
+ * 
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void dft(const DoubleVec &times, const DoubleVec &fluxes, const BoolVec &mask, 
+		const DoubleVec &freqs, ComplexVec &dft, Workspace &workspace) {
+	#if BOOST_VERSION >= 105000
+	using boost::math::double_constants::pi;
+	#elif BOOST_VERSION >= 103500
+	const static double pi = boost::math::constants::pi<double>();
+	#endif
+	const static std::complex<double> I(0.0, 1.0);
+	
+	size_t nTimes = times.size();
+	size_t nFreqs = freqs.size();
+	
+	// Verify the preconditions
+	if (fluxes.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Arguments 'times' and 'fluxes' to dft() are not the same length (gave " 
+			+ lexical_cast<string>(nTimes) + " for times and " 
+			+ lexical_cast<string>(fluxes.size()) + " for fluxes)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Arguments 'times' and 'fluxes' to dft() are not the same length");
+		}
+	}
+	checkMaskSize(nTimes, mask, "dft()");
+
+	ScratchFrame frame(workspace);
+
+	IndexVec &valid = frame.indices(0);
+	for(size_t i = 0; i < nTimes; i++) {
+		if (mask[i]) {
+			valid.push_back(i);
+		}
+	}
+
+	// test for non-uniqueness and sorting
+	bool diffValues = false, sortedTimes = true;
+	for(size_t i = 1; i < nTimes && sortedTimes; i++) {
+		if (times[i-1] > times[i]) {
+			sortedTimes = false;
+		}
+	}
+	for(IndexVec::const_iterator j = valid.begin(); j != valid.end() && !diffValues; j++) {
+		if (times[*j] != times[valid.front()]) {
+			diffValues = true;
+		}
+	}
+
+	if (!diffValues) {
+		throw except::BadLightCurve("Argument 'times' to dft() contains only one unique date");
+	} else if (!sortedTimes) {
+		throw kpfutils::except::NotSorted("Argument 'times' to dft() is not sorted in ascending order");
+	}
+
+	// copy-and-swap
+	ComplexVec &tempDft = frame.complexes(nFreqs);
+	tempDft.assign(nFreqs, 0.0);
+
+	if (valid.size() <= currentTuning().smallNLimit) {
+		// Loops over so few epochs are mostly overhead, so run them 
+		//	across frequencies instead
+		size_t nValid = valid.size();
+		DoubleVec &validTimes = frame.doubles(nValid), &validFluxes = frame.doubles(nValid);
+		for(size_t j = 0; j < nValid; j++) {
+			validTimes [j] =  times[valid[j]];
+			validFluxes[j] = fluxes[valid[j]];
+		}
+		DoubleVec &om = frame.doubles(nFreqs);
+		for(size_t i = 0; i < nFreqs; i++) {
+			om[i] = 2.0 * pi * freqs[i];
+		}
+		
+		DoubleVec &re = frame.doubles(nFreqs), &im = frame.doubles(nFreqs);
+		dftSmall(validTimes, validFluxes, om, re, im);
+		for(size_t i = 0; i < nFreqs; i++) {
+			tempDft[i] = std::complex<double>(re[i], im[i]);
+		}
+	} else if (nFreqs > 0 && preferType3(valid.size(), nFreqs, 
+			times[valid.back()] - times[valid.front()], 
+			2.0 * pi * (*std::max_element(freqs.begin(), freqs.end()) 
+			- *std::min_element(freqs.begin(), freqs.end())), TYPE3_PRECISION)) {
+		// Large frequency sets, uniform or not, are too big to sum directly
+		size_t nValid = valid.size();
+		DoubleVec  &validTimes = frame.doubles(nValid);
+		ComplexVec &strengths  = frame.complexes(nValid);
+		for(size_t j = 0; j < nValid; j++) {
+			validTimes[j] = times[valid[j]] - times[valid.front()];
+			strengths [j] = fluxes[valid[j]];
+		}
+		DoubleVec &om = frame.doubles(nFreqs);
+		for(size_t i = 0; i < nFreqs; i++) {
+			om[i] = -2.0 * pi * freqs[i];
+		}
+		
+		ComplexVec &sums = frame.complexes(nFreqs);
+		nufftType3(validTimes, strengths, om, sums, TYPE3_PRECISION, workspace);
+		// Undo the shift in time
+		for(size_t i = 0; i < nFreqs; i++) {
+			tempDft[i] = sums[i] * exp(I * om[i] * times[valid.front()]);
+		}
+	} else {
+		for(size_t i = 0; i < nFreqs; i++) {
+			double omega = 2.0 * pi * freqs[i];
+			for(IndexVec::const_iterator j = valid.begin(); j != valid.end(); j++) {
+				tempDft[i] += fluxes[*j] * exp(-I * omega * times[*j]);
+			}
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	storeResult(tempDft, dft);
+}
+
 }		// end kpftimes
@@ -2,7 +2,7 @@
  * @file dft.h
  * @author Krzysztof Findeisen
  * @date Created February 13, 2011
- * @date Last modified April 14, 2011
+ * @date Last modified October 18, 2026
  */ 
 
 /* Copyright 2014, California Institute of Technology.
@@ -39,15 +39,34 @@ typedef std::vector<double               >  DoubleVec;
 /** A convenient shorthand for vectors of complex numbers.
  */
 typedef std::vector<std::complex<double> > ComplexVec;
+/** A convenient shorthand for per-epoch validity flags.
+ */
+typedef std::vector<bool> BoolVec;
 
 namespace kpftimes {
 
+class Workspace;
+
 /** Calculates the discrete Fourier transform for a list of times and fluxes
  * @ingroup util
  */
 void dft(const DoubleVec &times, const DoubleVec &fluxes, 
 		const DoubleVec &freqs, ComplexVec &dft);
 
+/** Calculates the discrete Fourier transform for a subset of a list of 
+ *	times and fluxes
+ * @ingroup util
+ */
+void dft(const DoubleVec &times, const DoubleVec &fluxes, const BoolVec &mask, 
+		const DoubleVec &freqs, ComplexVec &dft);
+
+/** Calculates the discrete Fourier transform for a subset of a list of 
+ *	times and fluxes, using preallocated memory
+ * @ingroup util
+ */
+void dft(const DoubleVec &times, const DoubleVec &fluxes, const BoolVec &mask, 
+		const DoubleVec &freqs, ComplexVec &dft, Workspace &workspace);
+
 }	// end kpftimes::
 
 #endif
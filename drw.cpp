@@ -0,0 +1,725 @@
+/** Damped random walk likelihoods and fitting
+ * @file timescales/drw.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/version.hpp>
+#include "../common/stats.tmp.h"
+#include "../common/stats_except.h"
+#include "timeexcept.h"
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** Number of grid points whose Kalman filters are run side by side
+ */
+const size_t DRW_BLOCK = 256;
+
+/** Verifies that a light curve can be modeled as a damped random walk.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] errors	Measurement errors of @p fluxes
+ * @param[in] caller	The name of the public function, for use in error 
+ *			messages.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times, @p fluxes, and 
+ *	@p errors have different lengths, if any error is negative, or if 
+ *	two epochs with zero error share a time.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void checkDrwData(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, const string &caller) {
+	const size_t nTimes = times.size();
+	if (fluxes.size() != nTimes || errors.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'times', 'fluxes', and 'errors' in " + caller 
+				+ " are not the same length (gave " 
+				+ lexical_cast<string>(nTimes) + " for times, " 
+				+ lexical_cast<string>(fluxes.size()) + " for fluxes, and " 
+				+ lexical_cast<string>(errors.size()) + " for errors)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times', 'fluxes', and 'errors' in " + caller 
+				+ " are not the same length");
+		}
+	}
+	if (nTimes < 2 || times.front() == times.back()) {
+		throw except::BadLightCurve("Parameter 'times' in " + caller + " contains only one unique date");
+	}
+	for (size_t i = 0; i < nTimes; i++) {
+		if (!(errors[i] >= 0.0)) {
+			throw std::invalid_argument("Parameter 'errors' in " + caller + " contains negative errors");
+		}
+		if (i > 0) {
+			if (times[i-1] > times[i]) {
+				throw kpfutils::except::NotSorted("Parameter 'times' in " + caller + " is not sorted in ascending order");
+			}
+			if (times[i-1] == times[i] && errors[i-1] == 0.0 && errors[i] == 0.0) {
+				throw std::invalid_argument("Parameter 'times' in " + caller 
+					+ " contains repeated dates with no measurement error");
+			}
+		}
+	}
+}
+
+/** Verifies that damped random walk parameters are physical.
+ *
+ * @param[in] tau	The damping timescale
+ * @param[in] sigma	The standard deviation of the process
+ * @param[in] caller	The name of the public function, for use in error 
+ *			messages.
+ *
+ * @exception std::invalid_argument Thrown if @p tau or @p sigma is not 
+ *	positive.
+ *
+ * @exceptsafe Does not change any state.
+ */
+void checkDrwParams(double tau, double sigma, const string &caller) {
+	if (!(tau > 0.0) || !(sigma > 0.0)) {
+		try {
+			throw std::invalid_argument("Timescale and amplitude in " + caller 
+				+ " must be positive (gave tau = " + lexical_cast<string>(tau) 
+				+ " and sigma = " + lexical_cast<string>(sigma) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Timescale and amplitude in " + caller 
+				+ " must be positive");
+		}
+	}
+}
+
+/** Evaluates the damped random walk likelihood at a list of parameters.
+ *
+ * The likelihood is computed with a Kalman filter, which is exact 
+ * because the damped random walk is a Markov process 
+ * (@cite DrwQuasars). The mean flux is replaced by its maximum 
+ * likelihood value: since the filter is linear in the data, filtering 
+ * a column of ones alongside the fluxes gives the innovations for any 
+ * mean at no extra cost.
+ *
+ * The filters for up to @ref DRW_BLOCK parameter sets run side by side, 
+ * with the parameter sets varying fastest, so that the update for one 
+ * epoch is a single loop over contiguous arrays.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] errors	Measurement errors of @p fluxes
+ * @param[in] taus	The damping timescale of each parameter set
+ * @param[in] sigmas	The standard deviation of each parameter set
+ * @param[in] n		The number of parameter sets
+ * @param[out] logLike	An array of length @p n, which receives the 
+ *			log-likelihood of each parameter set.
+ *
+ * @pre The arguments passed checkDrwData()
+ * @pre All elements of @p taus and @p sigmas are positive
+ *
+ * @perform O(N @p n) time, where N = @p times.size()
+ * @perfmore O(N + min(@p n, @ref DRW_BLOCK)) memory
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p logLike 
+ *	are unspecified.
+ */
+void drwLikelihoods(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, const double* taus, const double* sigmas, 
+		size_t n, double* logLike) {
+	const size_t nTimes = times.size();
+	if (nTimes == 0 || n == 0) {
+		return;
+	}
+	
+	// The profiled likelihood does not depend on the mean, but 
+	//	subtracting it avoids cancellation
+	const double meanF = kpfutils::mean(fluxes.begin(), fluxes.end());
+	// Per-epoch inputs, stored one after another
+	DoubleVec epochs(3*nTimes);
+	double* const y    = &epochs[0];
+	double* const err2 = &epochs[nTimes];
+	double* const dt   = &epochs[2*nTimes];
+	for (size_t i = 0; i < nTimes; i++) {
+		y[i]    = fluxes[i] - meanF;
+		err2[i] = errors[i]*errors[i];
+		// Nothing is known before the first epoch, so the state starts 
+		//	from the stationary distribution
+		dt[i]   = (i > 0 ? times[i] - times[i-1] : std::numeric_limits<double>::infinity());
+	}
+	
+	// Per-parameter filter state, stored one array after another
+	const size_t blockSize = std::min(n, DRW_BLOCK);
+	DoubleVec filters(9*blockSize);
+	double* const invTau    = &filters[0];
+	double* const var       = &filters[1*blockSize];
+	// Predicted states for the fluxes and for a constant
+	double* const stateY    = &filters[2*blockSize];
+	double* const stateOne  = &filters[3*blockSize];
+	// Variance of the state after the last measurement
+	double* const post      = &filters[4*blockSize];
+	// Running sums of log S, e_y^2/S, e_y e_1/S, and e_1^2/S
+	double* const sumLogS   = &filters[5*blockSize];
+	double* const sumYY     = &filters[6*blockSize];
+	double* const sumYOne   = &filters[7*blockSize];
+	double* const sumOneOne = &filters[8*blockSize];
+	
+	for (size_t first = 0; first < n; first += DRW_BLOCK) {
+		const size_t count = std::min(DRW_BLOCK, n - first);
+		for (size_t k = 0; k < count; k++) {
+			invTau[k]    = 1.0/taus[first + k];
+			var[k]       = sigmas[first + k]*sigmas[first + k];
+			stateY[k]    = 0.0;
+			stateOne[k]  = 0.0;
+			post[k]      = 0.0;
+			sumLogS[k]   = 0.0;
+			sumYY[k]     = 0.0;
+			sumYOne[k]   = 0.0;
+			sumOneOne[k] = 0.0;
+		}
+		
+		for (size_t i = 0; i < nTimes; i++) {
+			const double step = dt[i], noise = err2[i], obs = y[i];
+			for (size_t k = 0; k < count; k++) {
+				// Predict
+				const double decay  = exp(-step*invTau[k]);
+				const double decay2 = decay*decay;
+				const double prior  = decay2*post[k] + var[k]*(1.0 - decay2);
+				stateY  [k] *= decay;
+				stateOne[k] *= decay;
+				
+				// Innovations
+				const double total = prior + noise;
+				const double inv   = 1.0/total;
+				const double innovY   = obs - stateY  [k];
+				const double innovOne = 1.0 - stateOne[k];
+				sumLogS  [k] += log(total);
+				sumYY    [k] += innovY  *innovY  *inv;
+				sumYOne  [k] += innovY  *innovOne*inv;
+				sumOneOne[k] += innovOne*innovOne*inv;
+				
+				// Update
+				const double gain = prior*inv;
+				stateY  [k] += gain*innovY;
+				stateOne[k] += gain*innovOne;
+				post    [k]  = prior*noise*inv;
+			}
+		}
+		
+		for (size_t k = 0; k < count; k++) {
+			const double chi2 = sumYY[k] - sumYOne[k]*sumYOne[k]/sumOneOne[k];
+			logLike[first + k] = -0.5*(chi2 + sumLogS[k] + nTimes*log(2.0*pi));
+		}
+	}
+}
+
+/** The negative log-likelihood of a light curve, as a function of the 
+ *	logarithms of the damped random walk parameters, within bounds.
+ *
+ * @ingroup util
+ */
+class DrwObjective {
+public:
+	/** Defines the objective for a light curve.
+	 *
+	 * @param[in] times, fluxes, errors The light curve
+	 * @param[in] lower, upper	The bounds on log(tau) and 
+	 *				log(sigma), in that order
+	 *
+	 * @pre The light curve passed checkDrwData()
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	DrwObjective(const DoubleVec &times, const DoubleVec &fluxes, 
+			const DoubleVec &errors, const double lower[], const double upper[]) 
+			: times(times), fluxes(fluxes), errors(errors), lower(), upper() {
+		for (size_t d = 0; d < 2; d++) {
+			this->lower[d] = lower[d];
+			this->upper[d] = upper[d];
+		}
+	}
+	
+	/** Evaluates the objective.
+	 *
+	 * @param[in] x	The logarithms of tau and sigma
+	 *
+	 * @return The negative log-likelihood, or infinity if @p x is out 
+	 *	of bounds.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	do the calculations.
+	 *
+	 * @exceptsafe Does not change any state.
+	 */
+	double operator()(const double x[]) const {
+		for (size_t d = 0; d < 2; d++) {
+			if (!(x[d] >= lower[d] && x[d] <= upper[d])) {
+				return std::numeric_limits<double>::infinity();
+			}
+		}
+		const double tau = exp(x[0]), sigma = exp(x[1]);
+		double logLike;
+		drwLikelihoods(times, fluxes, errors, &tau, &sigma, 1, &logLike);
+		return -logLike;
+	}
+	
+private:
+	const DoubleVec &times, &fluxes, &errors;
+	double lower[2], upper[2];
+};
+
+/** Minimizes a function of two variables with the Nelder-Mead simplex 
+ *	method.
+ *
+ * @param[in] f		The function to minimize
+ * @param[in,out] x	The starting point on input, the best point found 
+ *			on output
+ * @param[in] step	The size of the initial simplex along each axis
+ *
+ * @post f(@p x) is no larger than its initial value
+ *
+ * @perform At most a few hundred evaluations of @p f
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	evaluate @p f.
+ *
+ * @exceptsafe @p x is unchanged in the event of an exception.
+ */
+void simplexMinimize(const DrwObjective &f, double x[], const double step[]) {
+	const size_t MAX_ITER = 500;
+	const double TOLERANCE = 1e-7;
+	
+	double vertex[3][2] = {{x[0], x[1]}, {x[0] + step[0], x[1]}, {x[0], x[1] + step[1]}};
+	double value[3] = {f(vertex[0]), f(vertex[1]), f(vertex[2])};
+	
+	for (size_t iter = 0; iter < MAX_ITER; iter++) {
+		// Order the vertices from best to worst
+		for (size_t i = 1; i < 3; i++) {
+			for (size_t j = i; j > 0 && value[j] < value[j-1]; j--) {
+				std::swap(value[j], value[j-1]);
+				std::swap(vertex[j][0], vertex[j-1][0]);
+				std::swap(vertex[j][1], vertex[j-1][1]);
+			}
+		}
+		double size = 0.0;
+		for (size_t i = 1; i < 3; i++) {
+			for (size_t d = 0; d < 2; d++) {
+				size = std::max(size, fabs(vertex[i][d] - vertex[0][d]));
+			}
+		}
+		if (size < TOLERANCE) {
+			break;
+		}
+		
+		double centroid[2], trial[2], other[2];
+		for (size_t d = 0; d < 2; d++) {
+			centroid[d] = 0.5*(vertex[0][d] + vertex[1][d]);
+			trial[d] = 2.0*centroid[d] - vertex[2][d];
+		}
+		const double reflected = f(trial);
+		
+		if (reflected < value[0]) {
+			// Expand
+			for (size_t d = 0; d < 2; d++) {
+				other[d] = 3.0*centroid[d] - 2.0*vertex[2][d];
+			}
+			const double expanded = f(other);
+			const bool useExpanded = (expanded < reflected);
+			for (size_t d = 0; d < 2; d++) {
+				vertex[2][d] = (useExpanded ? other[d] : trial[d]);
+			}
+			value[2] = (useExpanded ? expanded : reflected);
+		} else if (reflected < value[1]) {
+			for (size_t d = 0; d < 2; d++) {
+				vertex[2][d] = trial[d];
+			}
+			value[2] = reflected;
+		} else {
+			// Contract toward the better of the worst and reflected points
+			const bool outside = (reflected < value[2]);
+			for (size_t d = 0; d < 2; d++) {
+				other[d] = 0.5*(centroid[d] + (outside ? trial[d] : vertex[2][d]));
+			}
+			const double contracted = f(other);
+			if (contracted < std::min(reflected, value[2])) {
+				for (size_t d = 0; d < 2; d++) {
+					vertex[2][d] = other[d];
+				}
+				value[2] = contracted;
+			} else {
+				// Shrink toward the best vertex
+				for (size_t i = 1; i < 3; i++) {
+					for (size_t d = 0; d < 2; d++) {
+						vertex[i][d] = 0.5*(vertex[0][d] + vertex[i][d]);
+					}
+					value[i] = f(vertex[i]);
+				}
+			}
+		}
+	}
+	
+	const size_t best = std::min_element(value, value + 3) - value;
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	x[0] = vertex[best][0];
+	x[1] = vertex[best][1];
+}
+
+/** Calculates the log-likelihood of a light curve under a damped random 
+ *	walk model.
+ *
+ * The damped random walk (@cite DrwQuasars) has covariance 
+ * &sigma;<sup>2</sup> exp(-|t<sub>i</sub> - t<sub>j</sub>|/&tau;), the 
+ * same process simulated by DampedRandomWalk. Measurement errors are 
+ * added in quadrature, and the mean flux is set to its maximum 
+ * likelihood value. The likelihood is calculated with a Kalman filter, 
+ * which gives the same value as the Gaussian process likelihood in 
+ * linear rather than cubic time.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] errors	The Gaussian measurement error of each flux. May be 
+ *			zero.
+ * @param[in] tau	The damping timescale, in the units of @p times
+ * @param[in] sigma	The standard deviation of the intrinsic variability, 
+ *			in the units of @p fluxes
+ *
+ * @return The natural logarithm of the likelihood.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p errors.size() = @p times.size()
+ * @pre all elements of @p errors are &ge; 0
+ * @pre no two elements of @p times with zero error are equal
+ * @pre @p tau > 0
+ * @pre @p sigma > 0
+ *
+ * @perform O(N) time, where N = @p times.size()
+ * @perfmore O(N) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if the light curve or the 
+ *	parameters violate any other precondition.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+double drwLogLikelihood(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, double tau, double sigma) {
+	checkDrwData(times, fluxes, errors, "drwLogLikelihood()");
+	checkDrwParams(tau, sigma, "drwLogLikelihood()");
+	
+	double logLike;
+	drwLikelihoods(times, fluxes, errors, &tau, &sigma, 1, &logLike);
+	return logLike;
+}
+
+/** Calculates the log-likelihood of a light curve under a damped random 
+ *	walk model, for every combination of a set of timescales and 
+ *	amplitudes.
+ *
+ * The likelihoods are the same as those of the single-parameter 
+ * version of drwLogLikelihood(), but the filters for many parameters 
+ * are run together over the light curve.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] errors	The Gaussian measurement error of each flux. May be 
+ *			zero.
+ * @param[in] taus	The damping timescales to try
+ * @param[in] sigmas	The standard deviations to try
+ * @param[out] logLike	The natural logarithm of the likelihood at each 
+ *			combination, with @p sigmas varying fastest.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p errors.size() = @p times.size()
+ * @pre all elements of @p errors are &ge; 0
+ * @pre no two elements of @p times with zero error are equal
+ * @pre all elements of @p taus and @p sigmas are > 0
+ *
+ * @post @p logLike.size() = @p taus.size() &times; @p sigmas.size()
+ * @post @p logLike[i*@p sigmas.size() + j] = drwLogLikelihood(@p times, 
+ *	@p fluxes, @p errors, @p taus[i], @p sigmas[j])
+ *
+ * @perform O(N T S) time, where N = @p times.size(), T = @p taus.size(), 
+ *	and S = @p sigmas.size()
+ * @perfmore O(N + T S) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if the light curve or the 
+ *	parameters violate any other precondition.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void drwLogLikelihood(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, const DoubleVec &taus, const DoubleVec &sigmas, 
+		DoubleVec &logLike) {
+	TraceSpan span("drwLogLikelihood");
+	checkDrwData(times, fluxes, errors, "drwLogLikelihood()");
+	
+	const size_t n = taus.size() * sigmas.size();
+	DoubleVec gridTaus(n), gridSigmas(n);
+	for (size_t i = 0; i < taus.size(); i++) {
+		for (size_t j = 0; j < sigmas.size(); j++) {
+			checkDrwParams(taus[i], sigmas[j], "drwLogLikelihood()");
+			gridTaus  [i*sigmas.size() + j] = taus  [i];
+			gridSigmas[i*sigmas.size() + j] = sigmas[j];
+		}
+	}
+	
+	DoubleVec temp(n);
+	if (n > 0) {
+		drwLikelihoods(times, fluxes, errors, &gridTaus[0], &gridSigmas[0], n, &temp[0]);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(logLike, temp);
+}
+
+/** Finds the damped random walk that best describes a light curve.
+ *
+ * fitDrw() maximizes the likelihood of drwLogLikelihood(). It first 
+ * evaluates a logarithmic grid of timescales and amplitudes, then 
+ * refines the best grid point with the Nelder-Mead simplex method. 
+ * Every step costs O(N), so the fit takes time linear in the length of 
+ * the light curve.
+ *
+ * The timescale is searched between one tenth of the shortest interval 
+ * between epochs and ten times the baseline, and the amplitude between 
+ * 1/100 and 100 times the standard deviation of the fluxes. A timescale 
+ * at the upper limit means that the light curve cannot tell a damped 
+ * random walk from an undamped one.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] errors	The Gaussian measurement error of each flux. May be 
+ *			zero.
+ * @param[out] tau	The maximum likelihood damping timescale
+ * @param[out] sigma	The maximum likelihood standard deviation of the 
+ *			intrinsic variability
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p errors.size() = @p times.size()
+ * @pre @p fluxes contains at least two unique values
+ * @pre all elements of @p errors are &ge; 0
+ * @pre no two elements of @p times with zero error are equal
+ *
+ * @perform O(N) time, where N = @p times.size()
+ * @perfmore O(N) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times or 
+ *	@p fluxes has at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if the light curve violates 
+ *	any other precondition.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void fitDrw(const DoubleVec &times, const DoubleVec &fluxes, const DoubleVec &errors, 
+		double &tau, double &sigma) {
+	checkDrwData(times, fluxes, errors, "fitDrw()");
+	const size_t nTimes = times.size();
+	
+	const double scale = sqrt(kpfutils::variance(fluxes.begin(), fluxes.end()));
+	if (!(scale > 0.0)) {
+		throw except::BadLightCurve("Parameter 'fluxes' in fitDrw() contains only one unique value");
+	}
+	double minStep = times.back() - times.front();
+	for (size_t i = 1; i < nTimes; i++) {
+		if (times[i] > times[i-1]) {
+			minStep = std::min(minStep, times[i] - times[i-1]);
+		}
+	}
+	const double lower[2] = {log(0.1*minStep), log(0.01*scale)};
+	const double upper[2] = {log(10.0*(times.back() - times.front())), log(100.0*scale)};
+	
+	// Coarse grid, evaluated in one pass over the light curve
+	const size_t N_TAU = 32, N_SIGMA = 16;
+	const double gridStep[2] = {(upper[0] - lower[0]) / (N_TAU - 1), 
+		(upper[1] - lower[1]) / (N_SIGMA - 1)};
+	DoubleVec gridTaus(N_TAU * N_SIGMA), gridSigmas(N_TAU * N_SIGMA), 
+		gridLike(N_TAU * N_SIGMA);
+	for (size_t i = 0; i < N_TAU; i++) {
+		for (size_t j = 0; j < N_SIGMA; j++) {
+			gridTaus  [i*N_SIGMA + j] = exp(lower[0] + i*gridStep[0]);
+			gridSigmas[i*N_SIGMA + j] = exp(lower[1] + j*gridStep[1]);
+		}
+	}
+	drwLikelihoods(times, fluxes, errors, &gridTaus[0], &gridSigmas[0], 
+			gridTaus.size(), &gridLike[0]);
+	const size_t best = std::max_element(gridLike.begin(), gridLike.end()) 
+			- gridLike.begin();
+	
+	// Refine within the best grid cell
+	double x[2] = {log(gridTaus[best]), log(gridSigmas[best])};
+	const double step[2] = {0.5*gridStep[0], 0.5*gridStep[1]};
+	simplexMinimize(DrwObjective(times, fluxes, errors, lower, upper), x, step);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	tau   = exp(x[0]);
+	sigma = exp(x[1]);
+}
+
+/** Finds the damped random walk that best describes each of a batch of 
+ *	light curves.
+ *
+ * Each light curve is fit as by the single-star version of fitDrw().
+ *
+ * @param[in] times	Times at which each star was observed
+ * @param[in] fluxes	Flux measurements of each star
+ * @param[in] errors	Measurement errors of each star
+ * @param[out] taus	The maximum likelihood timescale of each star
+ * @param[out] sigmas	The maximum likelihood standard deviation of each 
+ *			star
+ *
+ * @pre @p fluxes.size() = @p errors.size() = @p times.size()
+ * @pre Each star satisfies the preconditions of the single-star version 
+ *	of fitDrw()
+ *
+ * @post @p taus.size() = @p sigmas.size() = @p times.size()
+ *
+ * @perform O(N) time, where N is the total number of epochs
+ * @perfmore If the library was compiled with OpenMP, stars are fit in 
+ *	parallel.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if any star has 
+ *	at most one distinct time or flux.
+ * @exception kpfutils::except::NotSorted Thrown if any star's times are 
+ *	not in ascending order.
+ * @exception std::invalid_argument Thrown if the batch or any star violates 
+ *	any other precondition.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void fitDrw(const std::vector<DoubleVec> &times, const std::vector<DoubleVec> &fluxes, 
+		const std::vector<DoubleVec> &errors, DoubleVec &taus, DoubleVec &sigmas) {
+	const long nStars = static_cast<long>(times.size());
+	if (fluxes.size() != times.size() || errors.size() != times.size()) {
+		throw std::invalid_argument("Parameters 'times', 'fluxes', and 'errors' in fitDrw() must describe the same stars");
+	}
+	DoubleVec tempTaus(nStars), tempSigmas(nStars);
+
+	// Exceptions must not propagate out of a parallel region
+	bool outOfMemory = false;
+	string failure;
+	bool unsorted = false, badCurve = false;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+	#endif
+	for (long k = 0; k < nStars; k++) {
+		try {
+			TraceSpan span("fitDrw", static_cast<unsigned long>(k));
+			fitDrw(times[k], fluxes[k], errors[k], tempTaus[k], tempSigmas[k]);
+		} catch (const std::bad_alloc& e) {
+			#ifdef _OPENMP
+			#pragma omp critical(drwError)
+			#endif
+			outOfMemory = true;
+		} catch (const kpfutils::except::NotSorted& e) {
+			#ifdef _OPENMP
+			#pragma omp critical(drwError)
+			#endif
+			{
+				unsorted = true;
+				failure  = e.what();
+			}
+		} catch (const except::BadLightCurve& e) {
+			#ifdef _OPENMP
+			#pragma omp critical(drwError)
+			#endif
+			{
+				badCurve = true;
+				failure  = e.what();
+			}
+		} catch (const std::exception& e) {
+			#ifdef _OPENMP
+			#pragma omp critical(drwError)
+			#endif
+			failure = e.what();
+		}
+	}
+
+	if (outOfMemory) {
+		throw std::bad_alloc();
+	} else if (unsorted) {
+		throw kpfutils::except::NotSorted(failure);
+	} else if (badCurve) {
+		throw except::BadLightCurve(failure);
+	} else if (!failure.empty()) {
+		throw std::invalid_argument(failure);
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	using std::swap;
+	swap(taus  , tempTaus  );
+	swap(sigmas, tempSigmas);
+}
+
+}		// end kpftimes
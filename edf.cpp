@@ -0,0 +1,404 @@
+/** Compact distributions of false peaks
+ * @file timescales/edf.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include "binaryio.h"
+#include "timescales.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::uint32_t;
+using boost::uint64_t;
+
+/** Identifies files written by LsEdf::save()
+ */
+const char EDF_MAGIC[8] = {'K', 'P', 'F', 'T', 'E', 'D', 'F', '1'};
+
+/** The number of peaks LsEdf::fap() searches for at once
+ */
+const size_t EDF_BATCH = 8;
+
+/** Summarizes a set of simulated peak powers.
+ *
+ * If there are more peaks than @p maxKnots, the highest @p maxKnots/2 
+ * peaks are kept exactly, and the rest of the distribution is sampled 
+ * at evenly spaced ranks. False alarm probabilities above 
+ * (@p maxKnots/2)/@p peaks.size() are then accurate to about 
+ * 2/@p maxKnots, and those below it are exact.
+ *
+ * @param[in] peaks	The peak powers of the simulations, in any order, 
+ *			such as the @p powers computed by lsNormalEdf() 
+ *			or LsMonteCarlo::edf().
+ * @param[in] maxKnots	The maximum number of knots to store.
+ *
+ * @pre @p peaks.size() &ge; 1
+ * @pre @p peaks contains no NaNs
+ * @pre @p maxKnots &ge; 4
+ *
+ * @post getNumSims() = @p peaks.size()
+ * @post size() &le; @p maxKnots
+ *
+ * @perform O(S log S) time, where S = @p peaks.size()
+ * @perfmore O(S) temporary memory
+ *
+ * @exception std::invalid_argument Thrown if @p peaks is empty or 
+ *	contains NaNs, or if @p maxKnots &lt; 4.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	build the distribution.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+LsEdf::LsEdf(const DoubleVec &peaks, size_t maxKnots) 
+		: nSims(static_cast<long>(peaks.size())), powers(), counts() {
+	if (peaks.empty()) {
+		throw std::invalid_argument("LsEdf needs at least one simulated peak");
+	}
+	if (maxKnots < 4) {
+		try {
+			throw std::invalid_argument("LsEdf needs at least 4 knots (gave " 
+				+ lexical_cast<string>(maxKnots) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("LsEdf needs at least 4 knots");
+		}
+	}
+	for(size_t i = 0; i < peaks.size(); i++) {
+		if (!(peaks[i] == peaks[i])) {
+			throw std::invalid_argument("Simulated peaks passed to LsEdf contain NaN");
+		}
+	}
+	
+	DoubleVec sorted(peaks);
+	std::sort(sorted.begin(), sorted.end());
+	const size_t n = sorted.size();
+	
+	std::vector<size_t> ranks;
+	if (n <= maxKnots) {
+		for(size_t i = 0; i < n; i++) {
+			ranks.push_back(i);
+		}
+	} else {
+		const size_t nTail = maxKnots/2;
+		const size_t nBody = maxKnots - nTail;
+		const size_t bodyEnd = n - nTail;
+		// Includes the lowest peak and the last peak below the tail
+		for(size_t j = 0; j < nBody; j++) {
+			ranks.push_back((j*(bodyEnd-1) + (nBody-1)/2) / (nBody-1));
+		}
+		for(size_t i = bodyEnd; i < n; i++) {
+			ranks.push_back(i);
+		}
+	}
+	
+	powers.reserve(ranks.size());
+	counts.reserve(ranks.size());
+	for(size_t i = 0; i < ranks.size(); i++) {
+		const double power = sorted[ranks[i]];
+		if (!powers.empty() && power <= powers.back()) {
+			continue;
+		}
+		powers.push_back(power);
+		counts.push_back(static_cast<double>(
+			std::upper_bound(sorted.begin(), sorted.end(), power) - sorted.begin()));
+	}
+}
+
+/** Loads a distribution saved by save().
+ *
+ * @param[in] fileName	A file written by save()
+ *
+ * @post The new object is identical to the one that wrote @p fileName.
+ *
+ * @perform O(K) time, where K is the number of knots in the file
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, 
+ *	is not a distribution file, or was written on a machine with a 
+ *	different byte order.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the distribution.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+LsEdf::LsEdf(const string &fileName) : nSims(0), powers(), counts() {
+	std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("Could not open distribution file " + fileName);
+	}
+	
+	char magic[sizeof(EDF_MAGIC)];
+	uint32_t order = 0;
+	uint64_t nKnots = 0;
+	in.read(magic, sizeof(magic));
+	readRaw(in, order);
+	if (!in || !std::equal(magic, magic+sizeof(magic), EDF_MAGIC)) {
+		throw std::runtime_error(fileName + " is not a Timescales distribution file");
+	} else if (order != BYTE_ORDER_MARK) {
+		throw std::runtime_error("Distribution file " + fileName + " was written on a machine with a different byte order");
+	}
+	readRaw(in, nSims);
+	readRaw(in, nKnots);
+	if (!in || nSims < 1 || nKnots < 1 || nKnots > static_cast<uint64_t>(nSims)) {
+		throw std::runtime_error("Distribution file " + fileName + " is corrupted");
+	}
+	
+	powers.resize(nKnots);
+	counts.resize(nKnots);
+	in.read(reinterpret_cast<char*>(&powers[0]), nKnots*sizeof(double));
+	in.read(reinterpret_cast<char*>(&counts[0]), nKnots*sizeof(double));
+	if (!in) {
+		throw std::runtime_error("Distribution file " + fileName + " is truncated");
+	}
+	for(size_t i = 1; i < nKnots; i++) {
+		if (!(powers[i] > powers[i-1]) || !(counts[i] > counts[i-1])) {
+			throw std::runtime_error("Distribution file " + fileName + " is corrupted");
+		}
+	}
+	if (!(counts[0] >= 1.0) || counts[nKnots-1] != static_cast<double>(nSims)) {
+		throw std::runtime_error("Distribution file " + fileName + " is corrupted");
+	}
+}
+
+/** Returns the number of simulations summarized.
+ *
+ * @return The number of simulated peaks the distribution was built from.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+long LsEdf::getNumSims() const {
+	return nSims;
+}
+
+/** Returns the number of knots stored.
+ *
+ * @return The number of distinct peak powers in the summary.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t LsEdf::size() const {
+	return powers.size();
+}
+
+/** Interpolates the false alarm probability of a peak.
+ *
+ * Between two knots the number of simulations with a lower peak rises 
+ * linearly, reaching the count of the upper knot only at the knot 
+ * itself. Where every simulated peak is a knot, this gives the exact 
+ * empirical distribution.
+ *
+ * @param[in] knot	The last knot no higher than @p power
+ * @param[in] power	The peak power to look up
+ *
+ * @return The fraction of simulations with a peak higher than @p power.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double LsEdf::lookup(size_t knot, double power) const {
+	double below = counts[knot];
+	if (knot + 1 < powers.size()) {
+		const double gap = counts[knot+1] - counts[knot] - 1.0;
+		below += gap * (power - powers[knot]) / (powers[knot+1] - powers[knot]);
+	}
+	return 1.0 - below/static_cast<double>(nSims);
+}
+
+/** Returns the false alarm probability of a peak.
+ *
+ * @param[in] power	The height of a periodogram peak
+ *
+ * @return The fraction of simulations whose highest peak was above 
+ *	@p power, or NaN if @p power is NaN.
+ *
+ * @perform O(log K) time, where K = size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double LsEdf::fap(double power) const {
+	if (!(power >= powers.front())) {
+		return (power < powers.front() ? 1.0 : std::numeric_limits<double>::quiet_NaN());
+	}
+	const size_t knot = std::upper_bound(powers.begin(), powers.end(), power) 
+			- powers.begin() - 1;
+	return lookup(knot, power);
+}
+
+/** Returns the false alarm probabilities of many peaks.
+ *
+ * The peaks are looked up several at a time, with a binary search that 
+ * takes the same number of steps for every peak and has no branches 
+ * that depend on the data. The searches of one group are interleaved, 
+ * so the processor can overlap their memory accesses.
+ *
+ * @param[in] powers	The heights of periodogram peaks, in any order
+ * @param[out] faps	The false alarm probability of each peak, as 
+ *			returned by fap(double)
+ *
+ * @post @p faps.size() = @p powers.size()
+ *
+ * @perform O(N log K) time, where N = @p powers.size() and K = size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the result.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception.
+ */
+void LsEdf::fap(const DoubleVec &powers, DoubleVec &faps) const {
+	const size_t nIn = powers.size();
+	const size_t nKnots = this->powers.size();
+	const double* const knots = &this->powers[0];
+	DoubleVec temp(nIn);
+	
+	for(size_t start = 0; start < nIn; start += EDF_BATCH) {
+		const size_t m = std::min(EDF_BATCH, nIn - start);
+		const double* const x = &powers[start];
+		
+		// Invariant: knots[base[j]] <= x[j], or base[j] = 0
+		size_t base[EDF_BATCH];
+		for(size_t j = 0; j < m; j++) {
+			base[j] = 0;
+		}
+		for(size_t len = nKnots; len > 1; ) {
+			const size_t half = len/2;
+			for(size_t j = 0; j < m; j++) {
+				base[j] = (knots[base[j] + half] <= x[j] ? base[j] + half : base[j]);
+			}
+			len -= half;
+		}
+		
+		for(size_t j = 0; j < m; j++) {
+			if (x[j] >= knots[0]) {
+				temp[start+j] = lookup(base[j], x[j]);
+			} else {
+				temp[start+j] = (x[j] < knots[0] ? 1.0 
+					: std::numeric_limits<double>::quiet_NaN());
+			}
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(faps, temp);
+}
+
+/** Returns the peak power needed for a given false alarm probability.
+ *
+ * @param[in] fap	Desired false alarm probability
+ *
+ * @return The lowest power whose false alarm probability, as returned 
+ *	by fap(double), is no more than @p fap. If @p fap lies in the part 
+ *	of the distribution that is kept exactly, this is one of the 
+ *	simulated peaks.
+ *
+ * @pre 0 < @p fap < 1
+ * @pre @p fap  getNumSims() &ge; 10
+ *
+ * @perform O(log K) time, where K = size()
+ *
+ * @exception std::invalid_argument Thrown if @p fap is outside (0, 1), 
+ *	or if the distribution has too few simulations to estimate it.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+double LsEdf::threshold(double fap) const {
+	if (fap >= 1.0 || fap <= 0.0) {
+		try {
+			throw std::invalid_argument("False alarm probability in LsEdf::threshold() must be in the interval (0, 1) (gave " + lexical_cast<string>(fap) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("False alarm probability in LsEdf::threshold() must be in the interval (0, 1)");
+		}
+	} else if (nSims*fap < 10) {
+		throw std::invalid_argument("Not enough simulations in LsEdf::threshold() to get a significant peak at the desired false alarm probability");
+	}
+	
+	const double target = nSims*(1.0 - fap);
+	const size_t knot = std::lower_bound(counts.begin(), counts.end(), target) 
+			- counts.begin();
+	if (knot == 0) {
+		return powers[0];
+	}
+	const double gap = counts[knot] - counts[knot-1] - 1.0;
+	if (gap > 0.0 && target <= counts[knot-1] + gap) {
+		return powers[knot-1] + (target - counts[knot-1]) / gap 
+				* (powers[knot] - powers[knot-1]);
+	}
+	return powers[knot];
+}
+
+/** Writes the distribution to a file.
+ *
+ * The file is written in the machine's native byte order, and cannot 
+ * be read on a machine with a different one.
+ *
+ * @param[in] fileName	The file to write. It is first written under a 
+ *			temporary name, then renamed, so an existing 
+ *			file is replaced atomically.
+ *
+ * @post LsEdf(@p fileName) creates a copy of this object.
+ *
+ * @perform O(K) time, where K = size()
+ *
+ * @exception std::runtime_error Thrown if the file could not be written.
+ *
+ * @exceptsafe If an exception is thrown, any existing file named 
+ *	@p fileName is unchanged.
+ */
+void LsEdf::save(const string &fileName) const {
+	const string tempName = fileName + ".tmp";
+	
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(EDF_MAGIC, sizeof(EDF_MAGIC));
+		writeRaw(out, BYTE_ORDER_MARK);
+		writeRaw(out, nSims);
+		writeRaw(out, static_cast<uint64_t>(powers.size()));
+		out.write(reinterpret_cast<const char*>(&powers[0]), powers.size()*sizeof(double));
+		out.write(reinterpret_cast<const char*>(&counts[0]), counts.size()*sizeof(double));
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write distribution file " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not replace distribution file " + fileName);
+	}
+}
+
+}		// end kpftimes
@@ -0,0 +1,345 @@
+/** Injection-recovery tests of periodogram completeness
+ * @file timescales/injection.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/version.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "lssim.h"
+#include "timescales.h"
+#include "trace.h"
+#include "tuning.h"
+#include "utils.h"
+#include "../common/alloc.tmp.h"
+#include "../common/stats.tmp.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** Runs one block of injections at a single period, for every amplitude.
+ *
+ * The same noise realizations and phases are used for every amplitude, 
+ * so that the completeness measured at different amplitudes differs 
+ * only because of the amplitude.
+ *
+ * @param[in] simulator	The periodogram tables for the cadence
+ * @param[in] times	The cadence
+ * @param[in] freqs	The frequency grid of @p simulator
+ * @param[in] period	The period of the injected signals
+ * @param[in] amplitudes The semi-amplitudes of the injected signals
+ * @param[in] model	The noise process into which signals are injected
+ * @param[in] threshold	The power a peak must exceed to be detected
+ * @param[in] tolerance	The largest fractional error in frequency for 
+ *			a detection to count as a recovery
+ * @param[in] stream	The seed of the block's random number stream
+ * @param[in] count	The number of injections in the block
+ * @param[in,out] recovered An array with one element per amplitude, each 
+ *			of which is incremented once per recovered signal
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	run the injections.
+ * @exception std::exception Thrown if @p model could not simulate 
+ *	the light curve.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p recovered 
+ *	are unspecified.
+ */
+void injectBlock(const LsSimulator &simulator, const DoubleVec &times, 
+		const DoubleVec &freqs, double period, const DoubleVec &amplitudes, 
+		const NullModel &model, double threshold, double tolerance, 
+		unsigned long stream, long count, long* recovered) {
+	const size_t nTimes = times.size();
+	const double freq = 1.0/period;
+
+	// The signal's phasor is computed once per period; each injection 
+	//	only rotates and scales it, so no trigonometric functions are 
+	//	evaluated per injection
+	DoubleVec sinT(nTimes), cosT(nTimes);
+	for (size_t j = 0; j < nTimes; j++) {
+		const double phase = 2.0*pi*freq*(times[j] - times.front());
+		sinT[j] = sin(phase);
+		cosT[j] = cos(phase);
+	}
+
+	shared_ptr<gsl_rng> noiseGen(checkAlloc(
+		gsl_rng_alloc(gsl_rng_ranlxd2)), &gsl_rng_free);
+	gsl_rng_set(noiseGen.get(), stream);
+
+	const size_t nDeviates = model.numDeviates(times);
+	DoubleVec deviates(nDeviates);
+	DoubleVec fluxes(nTimes);
+	FastTable noise(count, nTimes);
+	DoubleVec cosPhi(count), sinPhi(count);
+	for (long b = 0; b < count; b++) {
+		for (size_t i = 0; i < nDeviates; i++) {
+			deviates[i] = gsl_ran_ugaussian(noiseGen.get());
+		}
+		model.simulate(times, deviates, fluxes);
+		std::copy(fluxes.begin(), fluxes.end(), &noise.at(b, 0));
+
+		const double phi = 2.0*pi*gsl_rng_uniform(noiseGen.get());
+		cosPhi[b] = cos(phi);
+		sinPhi[b] = sin(phi);
+	}
+
+	FastTable data(count, nTimes);
+	DoubleVec var(count), peaks(count);
+	IndexVec where(count);
+	for (size_t a = 0; a < amplitudes.size(); a++) {
+		for (long b = 0; b < count; b++) {
+			const double cosAmp = amplitudes[a]*cosPhi[b];
+			const double sinAmp = amplitudes[a]*sinPhi[b];
+			const double* noiseRow = &noise.at(b, 0);
+			double* row = &data.at(b, 0);
+			// A sin(om t + phi)
+			for (size_t j = 0; j < nTimes; j++) {
+				row[j] = noiseRow[j] + cosAmp*sinT[j] + sinAmp*cosT[j];
+			}
+
+			var[b] = kpfutils::variance(row, row + nTimes);
+			const double meanF = kpfutils::mean(row, row + nTimes);
+			for (size_t j = 0; j < nTimes; j++) {
+				row[j] -= meanF;
+			}
+		}
+
+		simulator.blockPeaks(data, var, &peaks[0], &where[0]);
+		for (long b = 0; b < count; b++) {
+			if (peaks[b] >= threshold 
+					&& fabs(freqs[where[b]] - freq) <= tolerance*freq) {
+				recovered[a]++;
+			}
+		}
+	}
+}
+
+/** Measures the fraction of periodic signals that a periodogram search 
+ *	would recover, over a grid of periods and amplitudes.
+ *
+ * For each period and amplitude, injectionRecovery() adds @p nInject 
+ * sinusoids of random phase to independent realizations of @p model, 
+ * and counts how many give a Lomb-Scargle periodogram whose highest peak 
+ * both exceeds @p threshold and lies at the injected frequency. Only 
+ * the counts are kept; no periodogram is stored.
+ *
+ * The periodogram tables for the cadence are built once and shared by 
+ * all injections, and injections are processed in blocks so that each 
+ * row of the tables is read once per block. @p threshold is typically 
+ * calculated once per cadence, with lsThreshold(), LsEdf::threshold(), 
+ * or ThresholdSurface::threshold(), for the same noise model.
+ *
+ * @param[in] times	Times at which signals are injected
+ * @param[in] freqs	The frequency grid over which periodograms are 
+ *			calculated
+ * @param[in] periods	The periods of the injected signals
+ * @param[in] amplitudes The semi-amplitudes of the injected signals, in 
+ *			the units of the noise simulated by @p model
+ * @param[in] nInject	The number of signals to inject at each period 
+ *			and amplitude
+ * @param[in] model	The noise process into which signals are injected
+ * @param[in] threshold	The normalized periodogram power a peak must 
+ *			reach to be detected
+ * @param[in] tolerance	The largest fractional difference between the 
+ *			peak frequency and the injected frequency for a 
+ *			detection to count as a recovery
+ * @param[in] seed	The seed for the random number generator
+ * @param[out] completeness The fraction of signals recovered at each 
+ *			period and amplitude, with amplitude varying fastest
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre all elements of @p periods are > 0
+ * @pre all elements of @p amplitudes are &ge; 0
+ * @pre @p nInject &ge; 1
+ * @pre @p tolerance &ge; 0
+ *
+ * @post @p completeness.size() = @p periods.size() &times; 
+ *	@p amplitudes.size()
+ * @post @p completeness[i*@p amplitudes.size() + j] is the fraction of 
+ *	signals with period @p periods[i] and amplitude @p amplitudes[j] 
+ *	that were recovered.
+ * @post The result depends only on the arguments, and not on the number 
+ *	of threads used to calculate it.
+ *
+ * @perform O(NF &times; @p nInject &times; P &times; A) time, where N = 
+ *	@p times.size(), F = @p freqs.size(), P = @p periods.size(), and 
+ *	A = @p amplitudes.size()
+ * @perfmore O(NF) memory
+ * @perfmore If the library was compiled with OpenMP, blocks of 
+ *	injections are run in parallel.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::invalid_argument Thrown if @p nInject &lt; 1, if any 
+ *	period is not positive, if any amplitude is negative, or if 
+ *	@p tolerance is negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	run the injections.
+ * @exception std::runtime_error Thrown if @p model could not simulate 
+ *	the light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void injectionRecovery(const DoubleVec &times, const DoubleVec &freqs, 
+		const DoubleVec &periods, const DoubleVec &amplitudes, long nInject, 
+		const NullModel &model, double threshold, double tolerance, 
+		unsigned long seed, DoubleVec &completeness) {
+	TraceSpan span("injectionRecovery");
+
+	// Verify the preconditions
+	checkNumSims(nInject, "injectionRecovery()");
+	for (size_t i = 0; i < periods.size(); i++) {
+		if (!(periods[i] > 0.0)) {
+			try {
+				throw std::invalid_argument("Parameter 'periods' in injectionRecovery() must be positive (gave " 
+					+ lexical_cast<string>(periods[i]) + ")");
+			} catch (const boost::bad_lexical_cast& e) {
+				throw std::invalid_argument("Parameter 'periods' in injectionRecovery() must be positive");
+			}
+		}
+	}
+	for (size_t i = 0; i < amplitudes.size(); i++) {
+		if (!(amplitudes[i] >= 0.0)) {
+			try {
+				throw std::invalid_argument("Parameter 'amplitudes' in injectionRecovery() must be nonnegative (gave " 
+					+ lexical_cast<string>(amplitudes[i]) + ")");
+			} catch (const boost::bad_lexical_cast& e) {
+				throw std::invalid_argument("Parameter 'amplitudes' in injectionRecovery() must be nonnegative");
+			}
+		}
+	}
+	if (!(tolerance >= 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'tolerance' in injectionRecovery() must be nonnegative (gave " 
+				+ lexical_cast<string>(tolerance) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'tolerance' in injectionRecovery() must be nonnegative");
+		}
+	}
+
+	const LsSimulator simulator(times, freqs, "injectionRecovery()");
+	const size_t nAmps = amplitudes.size();
+	const long nBlocks = LsSimulator::numBlocks(nInject);
+	const long nItems  = (nAmps > 0 ? nBlocks * static_cast<long>(periods.size()) : 0);
+
+	// Counts are integers, so the total does not depend on the order in 
+	//	which threads add to it
+	std::vector<long> recovered(periods.size() * nAmps, 0);
+
+	// Exceptions must not propagate out of a parallel region
+	bool outOfMemory = false;
+	string failure;
+
+	#ifdef _OPENMP
+	const int nThreads = simulationThreads();
+	#pragma omp parallel num_threads(nThreads)
+	#endif
+	{
+		// Counts from one block, before they are added to the total
+		// Sized inside the loop so that failures can be caught
+		std::vector<long> myRecovered;
+
+		#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+		#endif
+		for (long item = 0; item < nItems; item++) {
+			const size_t p = static_cast<size_t>(item / nBlocks);
+			const long block = item % nBlocks;
+			const long count = std::min(LsSimulator::BLOCK_SIZE, 
+					nInject - block*LsSimulator::BLOCK_SIZE);
+			TraceSpan blockSpan("injectionRecovery::block", 
+					static_cast<unsigned long>(item));
+			try {
+				myRecovered.assign(nAmps, 0);
+				injectBlock(simulator, times, freqs, periods[p], amplitudes, 
+						model, threshold, tolerance, 
+						mixSeed(seed, static_cast<unsigned long>(item)), 
+						count, &myRecovered[0]);
+
+				#ifdef _OPENMP
+				#pragma omp critical(injectionCount)
+				#endif
+				for (size_t a = 0; a < nAmps; a++) {
+					recovered[p*nAmps + a] += myRecovered[a];
+				}
+			} catch (const std::bad_alloc& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(injectionError)
+				#endif
+				outOfMemory = true;
+			} catch (const std::exception& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(injectionError)
+				#endif
+				failure = e.what();
+			}
+		}
+	}
+
+	if (outOfMemory) {
+		throw std::bad_alloc();
+	} else if (!failure.empty()) {
+		throw std::runtime_error(failure);
+	}
+
+	DoubleVec temp(recovered.size());
+	for (size_t i = 0; i < recovered.size(); i++) {
+		temp[i] = static_cast<double>(recovered[i]) / static_cast<double>(nInject);
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	using std::swap;
+	swap(completeness, temp);
+}
+
+}		// end kpftimes
@@ -0,0 +1,225 @@
+/** Specialized inner loops for short light curves
+ * @file timescales/kernels.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include "kernels.h"
+#include "tuning.h"
+
+namespace kpftimes {
+
+/** Copies a short light curve into a fixed-length buffer, padding it with 
+ *	zeros.
+ *
+ * @param[in] times, data	The light curve to copy
+ * @param[out] paddedTimes, paddedData	Arrays of length @p N to fill
+ *
+ * @pre @p times.size() = @p data.size() &le; @p N
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <size_t N>
+void padEpochs(const DoubleVec &times, const DoubleVec &data, 
+		double paddedTimes[], double paddedData[]) {
+	size_t n = times.size();
+	for(size_t j = 0; j < n; j++) {
+		paddedTimes[j] = times[j];
+		paddedData [j] =  data[j];
+	}
+	for(size_t j = n; j < N; j++) {
+		paddedTimes[j] = 0.0;
+		paddedData [j] = 0.0;
+	}
+}
+
+/** Calculates the Lomb-Scargle sums for a light curve of at most @p N 
+ *	epochs.
+ *
+ * The light curve is padded to exactly @p N epochs at t = 0 with zero 
+ * flux, so that the epoch loop has a fixed length. Padding epochs add 
+ * nothing to any sum except @p cos2, which is corrected up front.
+ *
+ * Arguments are as for lsSumsSmall().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <size_t N>
+void lsSumsFixed(const DoubleVec &times, const DoubleVec &data, 
+		const DoubleVec &om, DoubleVec &sin2, DoubleVec &cos2, 
+		DoubleVec &sh, DoubleVec &ch) {
+	double t[N], y[N];
+	padEpochs<N>(times, data, t, y);
+	const double nPad = static_cast<double>(N - times.size());
+	
+	size_t nFreq = om.size();
+	const size_t block = currentTuning().freqBlock;
+	for(size_t start = 0; start < nFreq; start += block) {
+		const size_t end = std::min(start + block, nFreq);
+		
+		for(size_t i = start; i < end; i++) {
+			sin2[i] = 0.0;
+			cos2[i] = -nPad;
+			sh  [i] = 0.0;
+			ch  [i] = 0.0;
+		}
+		// Transposed loop order: the inner loop runs over independent 
+		//	frequencies, so it has no carried dependency and 
+		//	vectorizes
+		for(size_t j = 0; j < N; j++) {
+			const double tj = t[j], yj = y[j];
+			for(size_t i = start; i < end; i++) {
+				const double s = sin(om[i]*tj), c = cos(om[i]*tj);
+				// Double-angle formulas save two calls to sin/cos
+				sin2[i] += 2.0*s*c;
+				cos2[i] += c*c - s*s;
+				sh  [i] += yj*s;
+				ch  [i] += yj*c;
+			}
+		}
+	}
+}
+
+/** Calculates the discrete Fourier transform of a light curve of at most 
+ *	@p N epochs.
+ *
+ * The light curve is padded to exactly @p N epochs with zero flux, so 
+ * that the epoch loop has a fixed length.
+ *
+ * Arguments are as for dftSmall().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <size_t N>
+void dftFixed(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &om, DoubleVec &re, DoubleVec &im) {
+	double t[N], y[N];
+	padEpochs<N>(times, fluxes, t, y);
+	
+	size_t nFreq = om.size();
+	const size_t block = currentTuning().freqBlock;
+	for(size_t start = 0; start < nFreq; start += block) {
+		const size_t end = std::min(start + block, nFreq);
+		
+		for(size_t i = start; i < end; i++) {
+			re[i] = 0.0;
+			im[i] = 0.0;
+		}
+		for(size_t j = 0; j < N; j++) {
+			const double tj = t[j], yj = y[j];
+			for(size_t i = start; i < end; i++) {
+				re[i] += yj*cos(om[i]*tj);
+				im[i] -= yj*sin(om[i]*tj);
+			}
+		}
+	}
+}
+
+/** Calculates the trigonometric sums needed by the Lomb-Scargle periodogram 
+ *	of a short light curve
+ *
+ * The light curve is assigned to one of a few compile-time sizes, and 
+ * the loops are run with frequency as the inner index.
+ * 
+ * @param[in] times	Times at which @p data were taken, relative to 
+ *			some reference time
+ * @param[in] data	Measurements of a time series, with the mean 
+ *			subtracted
+ * @param[in] om	The angular frequencies at which to evaluate the sums
+ * @param[out] sin2	The sum of sin(2 &omega; t) at each frequency
+ * @param[out] cos2	The sum of cos(2 &omega; t) at each frequency
+ * @param[out] sh	The sum of y sin(&omega; t) at each frequency
+ * @param[out] ch	The sum of y cos(&omega; t) at each frequency
+ *
+ * @pre @p data.size() = @p times.size() &le; MAX_SMALL_N
+ * @pre @p sin2, @p cos2, @p sh, and @p ch have the same size as @p om
+ *
+ * @perform O(NF) time, where N = @p times.size() rounded up to the next 
+ *	supported size and F = @p om.size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void lsSumsSmall(const DoubleVec &times, const DoubleVec &data, 
+		const DoubleVec &om, DoubleVec &sin2, DoubleVec &cos2, 
+		DoubleVec &sh, DoubleVec &ch) {
+	size_t n = times.size();
+	if (n <= 8) {
+		lsSumsFixed< 8>(times, data, om, sin2, cos2, sh, ch);
+	} else if (n <= 16) {
+		lsSumsFixed<16>(times, data, om, sin2, cos2, sh, ch);
+	} else if (n <= 24) {
+		lsSumsFixed<24>(times, data, om, sin2, cos2, sh, ch);
+	} else if (n <= 32) {
+		lsSumsFixed<32>(times, data, om, sin2, cos2, sh, ch);
+	} else if (n <= 48) {
+		lsSumsFixed<48>(times, data, om, sin2, cos2, sh, ch);
+	} else {
+		lsSumsFixed<MAX_SMALL_N>(times, data, om, sin2, cos2, sh, ch);
+	}
+}
+
+/** Calculates the discrete Fourier transform of a short light curve
+ *
+ * The light curve is assigned to one of a few compile-time sizes, and 
+ * the loops are run with frequency as the inner index.
+ * 
+ * @param[in] times	Times at which @p fluxes were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] om	The angular frequencies at which to evaluate the 
+ *			transform
+ * @param[out] re, im	The real and imaginary parts of the transform at 
+ *			each frequency
+ *
+ * @pre @p fluxes.size() = @p times.size() &le; MAX_SMALL_N
+ * @pre @p re and @p im have the same size as @p om
+ *
+ * @perform O(NF) time, where N = @p times.size() rounded up to the next 
+ *	supported size and F = @p om.size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void dftSmall(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &om, DoubleVec &re, DoubleVec &im) {
+	size_t n = times.size();
+	if (n <= 8) {
+		dftFixed< 8>(times, fluxes, om, re, im);
+	} else if (n <= 16) {
+		dftFixed<16>(times, fluxes, om, re, im);
+	} else if (n <= 24) {
+		dftFixed<24>(times, fluxes, om, re, im);
+	} else if (n <= 32) {
+		dftFixed<32>(times, fluxes, om, re, im);
+	} else if (n <= 48) {
+		dftFixed<48>(times, fluxes, om, re, im);
+	} else {
+		dftFixed<MAX_SMALL_N>(times, fluxes, om, re, im);
+	}
+}
+
+}		// end kpftimes
@@ -0,0 +1,67 @@
+/** Specialized inner loops for short light curves. None of these routines 
+ *	are intended as part of the public API.
+ * @file timescales/kernels.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNELSH
+#define KERNELSH
+
+#include <vector>
+
+/** A convenient shorthand for vectors of doubles.
+ */
+typedef std::vector<double> DoubleVec;
+
+namespace kpftimes {
+
+/** The largest number of epochs handled by the short light curve kernels.
+ *
+ * Above this size the per-frequency loops over epochs are long enough to 
+ * run efficiently on their own.
+ *
+ * @ingroup util
+ */
+const size_t MAX_SMALL_N = 64;
+
+/** Calculates the trigonometric sums needed by the Lomb-Scargle periodogram 
+ *	of a short light curve
+ * @ingroup util
+ */
+void lsSumsSmall(const DoubleVec &times, const DoubleVec &data, 
+		const DoubleVec &om, DoubleVec &sin2, DoubleVec &cos2, 
+		DoubleVec &sh, DoubleVec &ch);
+
+/** Calculates the discrete Fourier transform of a short light curve
+ * @ingroup util
+ */
+void dftSmall(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &om, DoubleVec &re, DoubleVec &im);
+
+}	// end kpftimes::
+
+#endif
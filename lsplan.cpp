@@ -0,0 +1,476 @@
+/** Lomb-Scargle periodograms of many light curves sharing a cadence
+ * @file timescales/lsplan.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/version.hpp>
+#include "sharedcache.h"
+#include "timescales.h"
+#include "utils.h"
+#include "workspace.h"
+#include "../common/stats.tmp.h"
+#include "timeexcept.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** Fills the trigonometric tables of an LsPlan.
+ *
+ * The table holds sin(&omega; t) for each frequency and epoch, then 
+ * cos(&omega; t) in the same layout, then the sums of Eq. (6) of 
+ * @cite LSPeriodogram for each frequency.
+ */
+class PlanTables : public TableBuilder {
+public:
+	/** Describes the tables for a cadence.
+	 *
+	 * @param[in] times	The cadence
+	 * @param[in] om	The angular frequency grid
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	PlanTables(const DoubleVec &times, const DoubleVec &om) : times(times), om(om) {
+	}
+
+	/** Returns the number of doubles in the tables.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t size() const {
+		return om.size() * (2*times.size() + 2);
+	}
+
+	/** Computes the tables.
+	 *
+	 * @param[out] table	An array of size() doubles to fill
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void build(double* table) const {
+		const size_t nTimes = times.size();
+		const size_t nFreqs = om.size();
+		double* sinTable = table;
+		double* cosTable = table + nFreqs*nTimes;
+		double* s2       = table + 2*nFreqs*nTimes;
+		double* c2       = s2 + nFreqs;
+
+		// The Scargle periodogram is time-shift invariant, so measure 
+		//	times from the first epoch of the cadence
+		const double t0 = times.front();
+		for (size_t i = 0; i < nFreqs; i++) {
+			double* sinRow = sinTable + i*nTimes;
+			double* cosRow = cosTable + i*nTimes;
+			double sum2 = 0.0, cum2 = 0.0;
+			for (size_t j = 0; j < nTimes; j++) {
+				sinRow[j] = sin(om[i]*(times[j] - t0));
+				cosRow[j] = cos(om[i]*(times[j] - t0));
+
+				// Eq. (6), using double-angle formulas so that 
+				//	lombScargle() can subtract off masked epochs 
+				//	with identical arithmetic
+				sum2 += 2.0*sinRow[j]*cosRow[j];
+				cum2 += cosRow[j]*cosRow[j] - sinRow[j]*sinRow[j];
+			}
+			s2[i] = sum2;
+			c2[i] = cum2;
+		}
+	}
+
+private:
+	const DoubleVec &times, &om;
+};
+
+/** Precomputes the periodogram tables for a cadence and frequency grid.
+ *
+ * @param[in] times	Times at which the light curves were observed. 
+ *			Individual light curves may omit some of these 
+ *			epochs.
+ * @param[in] freqs	The frequency grid over which periodograms will 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(NF) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the tables.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+LsPlan::LsPlan(const DoubleVec &times, const DoubleVec &freqs) 
+		: times(times), freqs(freqs), om(freqs.size()), tables() {
+	init(NULL);
+}
+
+/** Precomputes the periodogram tables for a cadence and frequency grid, 
+ *	or maps them from another process.
+ *
+ * If a plan with the same cadence and frequency grid has already been 
+ * created with @p cache, by this or any other process, its tables are 
+ * reused instead of computed. Otherwise the tables are computed directly 
+ * in @p cache, where later plans can find them.
+ *
+ * @param[in] times	Times at which the light curves were observed. 
+ *			Individual light curves may omit some of these 
+ *			epochs.
+ * @param[in] freqs	The frequency grid over which periodograms will 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ * @param[in,out] cache	The shared memory in which to look for, or store, 
+ *			the tables.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size(), 
+ *	if the tables must be computed; otherwise O(N + F).
+ * @perfmore O(NF) memory, which is allocated from @p cache if it 
+ *	has room. Plans sharing tables through @p cache use only O(N + F) 
+ *	memory each.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the tables.
+ *
+ * @exceptsafe Object construction is atomic. @p cache may have reserved 
+ *	space for the tables even if construction fails.
+ */
+LsPlan::LsPlan(const DoubleVec &times, const DoubleVec &freqs, SharedCache &cache) 
+		: times(times), freqs(freqs), om(freqs.size()), tables() {
+	init(&cache);
+}
+
+/** Validates the cadence and frequency grid, and finds or computes the 
+ *	tables.
+ *
+ * @param[in,out] cache	The shared memory in which to look for the 
+ *			tables, or NULL to compute them privately.
+ *
+ * @pre @p times and @p freqs have been initialized
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the tables.
+ *
+ * @exceptsafe The tables are unchanged in the event of an exception.
+ */
+void LsPlan::init(SharedCache *cache) {
+	const size_t nTimes = times.size();
+	const size_t nFreqs = freqs.size();
+
+	// test for non-uniqueness and sorting
+	bool diffValues = false, sortedTimes = true;
+	for(size_t j = 0; j < nTimes; j++) {
+		if (!diffValues && times[j] != times.front()) {
+			diffValues = true;
+		}
+		if (sortedTimes && j > 0 && times[j-1] > times[j]) {
+			sortedTimes = false;
+		}
+	}
+
+	// Verify the preconditions
+	if (!diffValues) {
+		throw except::BadLightCurve("Parameter 'times' in LsPlan() contains only one unique date");
+	} else if (!sortedTimes) {
+		throw kpfutils::except::NotSorted("Parameter 'times' in LsPlan() is not sorted in ascending order");
+	}
+
+	// Equations are best expressed in angular frequency
+	for(size_t i = 0; i < nFreqs; i++) {
+		if(freqs[i] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in LsPlan() contains negative frequencies");
+		} else {
+			om[i] = 2.0 * pi*freqs[i];
+		}
+	}
+
+	PlanTables builder(times, om);
+	if (cache != NULL) {
+		tables = CacheAccess::table(*cache, 
+			CacheKey("LsPlan").add(times).add(freqs), 
+			builder.size(), builder);
+	} else {
+		tables = CacheAccess::local(builder.size(), builder);
+	}
+}
+
+/** Returns the times at which the cadence was observed.
+ *
+ * @return The @p times argument passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const DoubleVec& LsPlan::getTimes() const {
+	return times;
+}
+
+/** Returns the frequency grid of the periodograms.
+ *
+ * @return The @p freqs argument passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const DoubleVec& LsPlan::getFreqs() const {
+	return freqs;
+}
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series, 
+ *	using a precomputed plan.
+ *
+ * The result is the same as that of 
+ * @ref lombScargle(const DoubleVec&, const DoubleVec&, const BoolVec&, const DoubleVec&, DoubleVec&) 
+ * "lombScargle(plan.getTimes(), fluxes, mask, plan.getFreqs(), power)", 
+ * to within rounding error. The sums in Eq. (6) of @cite LSPeriodogram 
+ * are taken from the plan and corrected for the masked epochs, or, if 
+ * most epochs are masked, summed directly over the unmasked ones.
+ * 
+ * @param[in] plan	The cadence and frequency grid of the periodogram
+ * @param[in] fluxes	Measurements of a time series at each time in 
+ *			@p plan.getTimes()
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[out] power	The periodogram power at each frequency in 
+ *			@p plan.getFreqs().
+ *
+ * @pre @p fluxes.size() = @p mask.size() = @p plan.getTimes().size()
+ * @pre the unmasked elements of @p plan.getTimes() contain at least two 
+ *	unique values
+ * @pre the unmasked elements of @p fluxes contain at least two unique values
+ * 
+ * @post @p power.size() = @p plan.getFreqs().size()
+ * @post @p power[i] is the Lomb-Scargle periodogram of the unmasked data, 
+ *	evaluated at @p plan.getFreqs()[i], for all i
+ *
+ * @perform O((M + min(M, N-M)) F + N) time, where N = 
+ *	@p plan.getTimes().size(), M is the number of unmasked epochs, and 
+ *	F = @p plan.getFreqs().size(). Trigonometric functions are 
+ *	evaluated only once per frequency.
+ * @perfmore O(N + F) memory, drawn from threadWorkspace()
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p plan.getTimes() or @p fluxes have at most one distinct 
+ *	value.
+ * @exception std::invalid_argument Thrown if @p fluxes or @p mask does 
+ *	not have one element per epoch of @p plan.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception
+ */
+void lombScargle(const LsPlan &plan, const DoubleVec &fluxes, 
+		const BoolVec &mask, DoubleVec &power) {
+	lombScargle(plan, fluxes, mask, power, threadWorkspace());
+}
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series, 
+ *	using a precomputed plan and preallocated memory.
+ *
+ * The result is the same as that of 
+ * @ref lombScargle(const DoubleVec&, const DoubleVec&, const BoolVec&, const DoubleVec&, DoubleVec&) 
+ * "lombScargle(plan.getTimes(), fluxes, mask, plan.getFreqs(), power)", 
+ * to within rounding error. The sums in Eq. (6) of @cite LSPeriodogram 
+ * are taken from the plan and corrected for the masked epochs, or, if 
+ * most epochs are masked, summed directly over the unmasked ones.
+ * 
+ * @param[in] plan	The cadence and frequency grid of the periodogram
+ * @param[in] fluxes	Measurements of a time series at each time in 
+ *			@p plan.getTimes()
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[out] power	The periodogram power at each frequency in 
+ *			@p plan.getFreqs().
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @pre @p fluxes.size() = @p mask.size() = @p plan.getTimes().size()
+ * @pre the unmasked elements of @p plan.getTimes() contain at least two 
+ *	unique values
+ * @pre the unmasked elements of @p fluxes contain at least two unique values
+ * 
+ * @post @p power.size() = @p plan.getFreqs().size()
+ * @post @p power[i] is the Lomb-Scargle periodogram of the unmasked data, 
+ *	evaluated at @p plan.getFreqs()[i], for all i
+ *
+ * @perform O((M + min(M, N-M)) F + N) time, where N = 
+ *	@p plan.getTimes().size(), M is the number of unmasked epochs, and 
+ *	F = @p plan.getFreqs().size(). Trigonometric functions are 
+ *	evaluated only once per frequency.
+ * @perfmore O(N + F) memory, which is allocated only the first time a 
+ *	Workspace is used
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p plan.getTimes() or @p fluxes have at most one distinct 
+ *	value.
+ * @exception std::invalid_argument Thrown if @p fluxes or @p mask does 
+ *	not have one element per epoch of @p plan.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void lombScargle(const LsPlan &plan, const DoubleVec &fluxes, 
+		const BoolVec &mask, DoubleVec &power, Workspace &workspace) {
+	const DoubleVec &times = plan.times;
+	const size_t nTimes = times.size();
+	const size_t nFreqs = plan.freqs.size();
+
+	// Verify the preconditions
+	if (fluxes.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'plan' and 'fluxes' in lombScargle() do not have the same number of epochs (gave " 
+			+ lexical_cast<string>(nTimes) + " for plan and " 
+			+ lexical_cast<string>(fluxes.size()) + " for fluxes)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'plan' and 'fluxes' in lombScargle() do not have the same number of epochs");
+		}
+	}
+	checkMaskSize(nTimes, mask, "lombScargle()");
+
+	// All temporaries come from the workspace
+	ScratchFrame frame(workspace);
+
+	IndexVec &valid = frame.indices(0), &masked = frame.indices(0);
+	for (size_t k = 0; k < nTimes; k++) {
+		(mask[k] ? valid : masked).push_back(k);
+	}
+	const size_t nValid = valid.size();
+
+	bool diffValues = false;
+	DoubleVec &data0 = frame.doubles(nValid);
+	for (size_t k = 0; k < nValid; k++) {
+		data0[k] = fluxes[valid[k]];
+		if (!diffValues && times[valid[k]] != times[valid[0]]) {
+			diffValues = true;
+		}
+	}
+	if (!diffValues) {
+		throw except::BadLightCurve("Parameter 'plan' in lombScargle() contains only one unique unmasked date");
+	}
+
+	// Full sample variance
+	double var   = kpfutils::variance(data0.begin(), data0.end());
+	if (var <= 0.0) {
+		throw except::BadLightCurve("Parameter 'fluxes' in lombScargle() has no variability");
+	}
+	double meanF = kpfutils::mean(data0.begin(), data0.end());
+	for (size_t k = 0; k < nValid; k++) {
+		data0[k] -= meanF;
+	}
+
+	// Correcting the full-cadence sums costs one pass over the masked 
+	//	epochs; summing from scratch costs one pass over the valid ones
+	const bool correct = (masked.size() < nValid);
+
+	// copy-and-swap
+	DoubleVec &tempPower = frame.doubles(nFreqs);
+	for (size_t i = 0; i < nFreqs; i++) {
+		if (plan.om[i] == 0.0) {
+			// Use the limit as frequency goes to zero
+			tempPower[i] = 0.0;
+			continue;
+		}
+		const double* sinRow = plan.tables.get() + i*nTimes;
+		const double* cosRow = plan.tables.get() + (nFreqs + i)*nTimes;
+
+		// Eq. (6), restricted to the unmasked epochs
+		double s2 = 0.0, c2 = 0.0;
+		if (correct) {
+			s2 = plan.tables.get()[2*nFreqs*nTimes + i];
+			c2 = plan.tables.get()[2*nFreqs*nTimes + nFreqs + i];
+			for (IndexVec::const_iterator j = masked.begin(); j != masked.end(); j++) {
+				s2 -= 2.0*sinRow[*j]*cosRow[*j];
+				c2 -= cosRow[*j]*cosRow[*j] - sinRow[*j]*sinRow[*j];
+			}
+		} else {
+			for (IndexVec::const_iterator j = valid.begin(); j != valid.end(); j++) {
+				s2 += 2.0*sinRow[*j]*cosRow[*j];
+				c2 += cosRow[*j]*cosRow[*j] - sinRow[*j]*sinRow[*j];
+			}
+		}
+
+		// Eq. (2): Definition -> tan(2omtau)
+		double omTau = 0.5 * atan2(s2, c2);
+		double cosOmTau = cos(omTau);
+		double sinOmTau = sin(omTau);
+
+		// Eq. (7); total(cos(t-tau)^2) and total(sin(t-tau)^2) 
+		double tmp = c2*cos(2.0*omTau) + s2*sin(2.0*omTau);
+		double tc2 = 0.5*(nValid+tmp);
+		double ts2 = 0.5*(nValid-tmp);
+
+		// Eq. (5); sh and ch
+		double sh = 0.0, ch = 0.0;
+		for (size_t k = 0; k < nValid; k++) {
+			sh += data0[k]*sinRow[valid[k]];
+			ch += data0[k]*cosRow[valid[k]];
+		}
+
+		// Eq. (3)
+		double cc = ch*cosOmTau + sh*sinOmTau;
+		double sc = sh*cosOmTau - ch*sinOmTau;
+		// correct normalization 
+		tempPower[i] = 0.5*(cc*cc / tc2 + sc*sc / ts2)/var;
+	}
+
+	storeResult(tempPower, power);
+}
+
+}		// end kpftimes
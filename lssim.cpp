@@ -0,0 +1,498 @@
+/** Simulation engine for Lomb-Scargle significance calculations. None of
+ * these routines are intended as part of the public API.
+ * @file timescales/lssim.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <ctime>
+#include <sys/time.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/version.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "lssim.h"
+#include "timescales.h"
+#include "trace.h"
+#include "tuning.h"
+#include "utils.h"
+#include "../common/alloc.tmp.h"
+#include "../common/stats.tmp.h"
+#include "timeexcept.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** Precomputes the periodogram tables for a cadence and frequency grid.
+ *
+ * @param[in] times	Times at which data will be simulated
+ * @param[in] freqs	The frequency grid over which periodograms will
+ *			be calculated.
+ * @param[in] caller	The name of the public function on whose behalf
+ *			the simulations are run, for use in error messages.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(NF) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of
+ *	@p freqs are negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the tables.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+LsSimulator::LsSimulator(const DoubleVec &times, const DoubleVec &freqs,
+		const string &caller)
+		: times(times), nTimes(times.size()), nFreqs(freqs.size()),
+		om(nFreqs), cosOmTau(nFreqs), sinOmTau(nFreqs), tc2(nFreqs), ts2(nFreqs),
+		sisi(nFreqs, nTimes), coco(nFreqs, nTimes) {
+	size_t i, j;
+
+	// make times of manageable size (Scargle periodogram is time-shift invariant)
+	// while we're at it, test for non-uniqueness
+	bool diffValues = false, sortedTimes = true;
+	DoubleVec times0(nTimes);
+	double t0 = times.front();
+	// Shift the times so t0 = 0
+	for(i = 0; i < nTimes; i++) {
+		times0[i] = times[i] - t0;
+		if (!diffValues && times[i] != t0) {
+			diffValues = true;
+		}
+		if (sortedTimes && i > 0 && times[i-1] > times[i]) {
+			sortedTimes = false;
+		}
+	}
+
+	// Verify the preconditions
+	if (!diffValues) {
+		throw except::BadLightCurve("Parameter 'times' in " + caller + " contains only one unique date");
+	} else if (!sortedTimes) {
+		throw kpfutils::except::NotSorted("Parameter 'times' in " + caller + " is not sorted in ascending order");
+	}
+
+	// Equations are best expressed in angular frequency
+	for(i = 0; i < nFreqs; i++) {
+		if(freqs[i] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in " + caller + " contains negative frequencies");
+		} else {
+			om[i] = 2.0 * pi*freqs[i];
+		}
+	}
+
+	////////////////////////////////
+	// These four vectors are functions only of om, t, and t.size(),
+	//	i.e. they depend on the experimental procedure but
+	//	not the data. We can reuse them for each simulation
+	// Eq. (6); s2, c2
+	for (i = 0; i < nFreqs; i++) {
+		double s2 = 0.0, c2 = 0.0;
+		for (j = 0; j < nTimes; j++) {
+			s2 += sin(2.0 * om[i] * times0[j]);
+			c2 += cos(2.0 * om[i] * times0[j]);
+		}
+
+		// Eq. (2): Definition -> tan(2omtau)
+		// --- tan(2omtau)  =  s2 / c2
+		double omTau = 0.5 * atan2(s2, c2);
+		cosOmTau[i] = cos(omTau);
+		sinOmTau[i] = sin(omTau);
+
+		// Eq. (7); total(cos(t-tau)^2) and total(sin(t-tau)^2)
+		double tmp = c2*cos(2.0*omTau) + s2*sin(2.0*omTau);
+		tc2[i] = 0.5*(nTimes+tmp);		// total(cos(t-tau)^2)
+		ts2[i] = 0.5*(nTimes-tmp);		// total(sin(t-tau)^2)
+	}
+
+	////////////////////////////////
+	// These 2 tables depend only on om and t as well
+	// Eq. (5); sh and ch
+	for (i=0; i < nFreqs; i++) {
+		for(j = 0; j < nTimes; j++) {
+			sisi.at(i,j) = sin(om[i]*times0[j]);
+			coco.at(i,j) = cos(om[i]*times0[j]);
+		}
+	}
+}
+
+/** Returns the number of blocks needed to run a given number of
+ *	simulations.
+ *
+ * @param[in] nSims The number of simulations
+ *
+ * @return The number of blocks of size @ref BLOCK_SIZE needed to hold
+ *	@p nSims simulations.
+ *
+ * @pre @p nSims &ge; 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+long LsSimulator::numBlocks(long nSims) {
+	return (nSims + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+/** Computes the peak periodogram power for a series of simulations.
+ *
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The seed from which the random number stream of
+ *			each block is derived.
+ * @param[in] nSims	The number of simulations to run
+ * @param[out] peaks	The peak power of each simulated periodogram
+ *
+ * @pre @p nSims &ge; 1
+ *
+ * @post @p peaks.size() = @p nSims
+ * @post @p peaks[i] is the highest value of the Lomb-Scargle periodogram
+ *	of simulation i. Simulation i depends only on @p model, @p seed,
+ *	and i.
+ *
+ * @perform O(NF &times; @p nSims) time, where N = @p times.size() and
+ *	F = @p freqs.size()
+ * @perfmore If the library was compiled with OpenMP, blocks of
+ *	simulations are run in parallel.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	run the simulations.
+ * @exception std::runtime_error Thrown if @p model could not simulate
+ *	the light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void LsSimulator::simulatePeaks(const NullModel &model, unsigned long seed,
+		long nSims, DoubleVec &peaks) const {
+	// copy-and-swap
+	DoubleVec tempPeaks(nSims);
+	simulateBlocks(model, seed, nSims, 0, numBlocks(nSims), &tempPeaks[0]);
+
+	using std::swap;
+	swap(peaks, tempPeaks);
+}
+
+/** Computes the peak periodogram power for a range of simulation blocks.
+ *
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The seed from which the random number stream of
+ *			each block is derived.
+ * @param[in] nSims	The total number of simulations in the run
+ * @param[in] firstBlock, lastBlock The half-open range of blocks to
+ *			simulate
+ * @param[out] peaks	An array of length @p nSims. Only the elements
+ *			corresponding to blocks in [@p firstBlock,
+ *			@p lastBlock) are written.
+ *
+ * @pre 0 &le; @p firstBlock &le; @p lastBlock &le; numBlocks(@p nSims)
+ *
+ * @post For each simulation i in the requested blocks, @p peaks[i] is the
+ *	highest value of the Lomb-Scargle periodogram of simulation i.
+ *
+ * @perform O(NF &times; S) time, where N = @p times.size(),
+ *	F = @p freqs.size(), and S is the number of simulations in the
+ *	requested blocks.
+ * @perfmore If the library was compiled with OpenMP, blocks are run in
+ *	parallel.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	run the simulations.
+ * @exception std::runtime_error Thrown if @p model could not simulate
+ *	the light curve.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p peaks
+ *	are unspecified.
+ */
+void LsSimulator::simulateBlocks(const NullModel &model, unsigned long seed,
+		long nSims, long firstBlock, long lastBlock, double* peaks) const {
+	// Exceptions must not propagate out of a parallel region
+	bool outOfMemory = false;
+	string failure;
+
+	#ifdef _OPENMP
+	const int nThreads = simulationThreads();
+	#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+	#endif
+	for (long block = firstBlock; block < lastBlock; block++) {
+		try {
+			runBlock(model, seed, nSims, block, peaks);
+		} catch (const std::bad_alloc& e) {
+			#ifdef _OPENMP
+			#pragma omp critical(lssimError)
+			#endif
+			outOfMemory = true;
+		} catch (const std::exception& e) {
+			#ifdef _OPENMP
+			#pragma omp critical(lssimError)
+			#endif
+			failure = e.what();
+		}
+	}
+
+	if (outOfMemory) {
+		throw std::bad_alloc();
+	} else if (!failure.empty()) {
+		throw std::runtime_error(failure);
+	}
+}
+
+/** Simulates a single block of light curves.
+ *
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The seed for the run
+ * @param[in] nSims	The total number of simulations in the run
+ * @param[in] block	The index of the block to simulate
+ * @param[out] peaks	An array of length @p nSims.
+ *
+ * @post For each simulation i in @p block, @p peaks[i] is the highest
+ *	value of the Lomb-Scargle periodogram of simulation i.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	run the simulations.
+ * @exception std::exception Thrown if @p model could not simulate
+ *	the light curve.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p peaks
+ *	are unspecified.
+ */
+void LsSimulator::runBlock(const NullModel &model, unsigned long seed,
+		long nSims, long block, double* peaks) const {
+	const long first = block*BLOCK_SIZE;
+	const long count = std::min(BLOCK_SIZE, nSims - first);
+	if (count <= 0) {
+		return;
+	}
+	TraceSpan span("LsSimulator::runBlock", static_cast<unsigned long>(block));
+
+	// Each block has its own random number stream, so that blocks may
+	//	be run in any order
+	shared_ptr<gsl_rng> noiseGen(checkAlloc(
+		gsl_rng_alloc(gsl_rng_ranlxd2)), &gsl_rng_free);
+	gsl_rng_set(noiseGen.get(), mixSeed(seed, static_cast<unsigned long>(block)));
+
+	// Simulate every light curve in the block before computing any
+	//	periodograms, so that each row of the trigonometric tables
+	//	is read once per block rather than once per simulation
+	const size_t nDeviates = model.numDeviates(times);
+	DoubleVec deviates(nDeviates);
+	DoubleVec fluxes(nTimes);
+	FastTable data(count, nTimes);
+	DoubleVec var(count);
+	for (long b = 0; b < count; b++) {
+		for (size_t i = 0; i < nDeviates; i++) {
+			deviates[i] = gsl_ran_ugaussian(noiseGen.get());
+		}
+		model.simulate(times, deviates, fluxes);
+
+		double meanF = kpfutils::mean(fluxes.begin(), fluxes.end());
+		for (size_t j = 0; j < nTimes; j++) {
+			data.at(b, j) = fluxes[j]-meanF; 	// .. force OBSERVED count rate to zero
+		}
+		// Full sample variance
+		var[b] = kpfutils::variance(fluxes.begin(), fluxes.end());
+	}
+
+	DoubleVec peak(count);
+	blockPeaks(data, var, &peak[0], NULL);
+	std::copy(peak.begin(), peak.end(), peaks + first);
+}
+
+/** Computes the highest periodogram peak of each of a block of light 
+ *	curves.
+ *
+ * @param[in] data	The light curves, one per row, each with its mean 
+ *			already subtracted.
+ * @param[in] var	The sample variance of each light curve
+ * @param[out] peaks	An array with one element per row of @p data
+ * @param[out] where	An array with one element per row of @p data, or 
+ *			NULL if the peak frequencies are not needed.
+ *
+ * @pre @p data.getY() = @p times.size()
+ * @pre @p var.size() = @p data.getX()
+ *
+ * @post @p peaks[b] is the highest value of the normalized Lomb-Scargle 
+ *	periodogram of row b of @p data.
+ * @post If @p where is not NULL, @p where[b] is the index in @p freqs 
+ *	of @p peaks[b].
+ *
+ * @perform O(NF &times; B) time, where N = @p times.size(), F = 
+ *	@p freqs.size(), and B = @p data.getX(). Each row of the 
+ *	trigonometric tables is read once per block rather than once 
+ *	per light curve.
+ * @perfmore O(B) memory
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the running peaks.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void LsSimulator::blockPeaks(const FastTable &data, const DoubleVec &var, 
+		double* peaks, size_t* where) const {
+	const size_t count = data.getX();
+
+	// Eq. (3) ; computing the periodogram for each simulation
+	//	Since we're only interested in the peak of the
+	//	periodogram, don't calculate the whole thing
+	//	-- just keep a running max in peak[]
+	DoubleVec peak(count, 0.0);
+	IndexVec  best(count, 0);
+	for (size_t i = 0; i < nFreqs; i++) {
+		if (om[i] == 0.0) {
+			// Use the limit as frequency goes to zero
+			continue;
+		}
+		const double* sinRow = &sisi.at(i, 0);
+		const double* cosRow = &coco.at(i, 0);
+		for (size_t b = 0; b < count; b++) {
+			const double* row = &data.at(b, 0);
+			double sh = 0.0, ch = 0.0;
+			for (size_t j = 0; j < nTimes; j++) {
+				sh += row[j]*sinRow[j];
+				ch += row[j]*cosRow[j];
+			}
+
+			double cc = ch*cosOmTau[i] + sh*sinOmTau[i];
+			double sc = sh*cosOmTau[i] - ch*sinOmTau[i];
+			double pp = cc*cc / tc2[i] + sc*sc / ts2[i];
+			if (pp > peak[b]) {
+				peak[b] = pp;
+				best[b] = i;
+			}
+		}
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	// correct normalization
+	for (size_t b = 0; b < count; b++) {
+		peaks[b] = 0.5 * peak[b]/var[b];
+		if (where != NULL) {
+			where[b] = best[b];
+		}
+	}
+}
+
+/** Derives the seed of one random number stream from the seed of a run.
+ *
+ * @param[in] seed	The seed for the run
+ * @param[in] stream	The index of the stream within the run
+ *
+ * @return A seed suitable for gsl_rng_set(). Distinct values of @p stream
+ *	give unrelated seeds, and the result is the same on all platforms.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+unsigned long mixSeed(unsigned long seed, unsigned long stream) {
+	using boost::uint32_t;
+
+	// MurmurHash3 finalizer, applied to 32-bit words so that the result 
+	//	does not depend on the width of unsigned long
+	uint32_t h = static_cast<uint32_t>(seed) 
+			^ (static_cast<uint32_t>(stream + 1) * 0x9E3779B9u);
+	for (int round = 0; round < 2; round++) {
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+	}
+	return static_cast<unsigned long>(h);
+}
+
+/** Returns a random number seed based on the system clock.
+ *
+ * @return A seed suitable for gsl_rng_set()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+unsigned long clockSeed() {
+	// Not the cleverest seed, but we only choose one per run of lsThreshold()
+	// I'm hoping that for any reasonable value of nSims two consecutive
+	//	runs of lsThreshold() should be far enough apart in time that
+	//	the seeds will be different
+	time_t foo;
+	return static_cast<unsigned long>(time(&foo));
+}
+
+/** Returns the current wall-clock time.
+ *
+ * @return The time since an arbitrary, fixed reference, in seconds. 
+ *	Unlike std::clock(), the result counts elapsed time rather than 
+ *	processor time, so it is meaningful when several threads are running.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double wallClock() {
+	timeval now;
+	gettimeofday(&now, NULL);
+	return now.tv_sec + 1e-6*now.tv_usec;
+}
+
+/** Validates the number of simulations requested of a Monte Carlo
+ *	function.
+ *
+ * @param[in] nSims	The number of simulations requested
+ * @param[in] caller	The name of the public function, for use in error
+ *			messages.
+ *
+ * @exception std::invalid_argument Thrown if @p nSims is nonpositive
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void checkNumSims(long nSims, const string &caller) {
+	if (nSims < 1) {
+		try {
+			throw std::invalid_argument("Must run at least one simulation in " + caller + " (gave " + lexical_cast<string>(nSims) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Must run at least one simulation in " + caller + ".");
+		}
+	}
+}
+
+}		// end kpftimes
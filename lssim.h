@@ -0,0 +1,131 @@
+/** Simulation engine for Lomb-Scargle significance calculations. None of
+ * these routines are intended as part of the public API.
+ * @file timescales/lssim.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSSIMH
+#define LSSIMH
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "utils.h"
+
+namespace kpftimes {
+
+class NullModel;
+
+/** Precomputed state for running many periodograms of simulated noise
+ *	on a single cadence and frequency grid.
+ *
+ * All per-cadence work (the Press & Rybicki time offsets and the
+ *	trigonometric tables) is done once, in the constructor. Simulations
+ *	are then run in fixed-size blocks, each of which draws its noise from
+ *	its own random number stream. Because the stream for a block depends
+ *	only on the seed and the block's index, the results of a run do not
+ *	depend on how the blocks are scheduled, or on how many threads
+ *	run them.
+ *
+ * @ingroup util
+ */
+class LsSimulator {
+public:
+	/** Number of simulations in each block
+	 */
+	static const long BLOCK_SIZE = 64;
+
+	/** Precomputes the periodogram tables for a cadence and frequency grid.
+	 */
+	LsSimulator(const DoubleVec &times, const DoubleVec &freqs,
+			const std::string &caller);
+
+	/** Computes the peak periodogram power for a range of simulation
+	 *	blocks.
+	 */
+	void simulateBlocks(const NullModel &model, unsigned long seed,
+			long nSims, long firstBlock, long lastBlock,
+			double* peaks) const;
+
+	/** Computes the peak periodogram power for a series of simulations.
+	 */
+	void simulatePeaks(const NullModel &model, unsigned long seed,
+			long nSims, DoubleVec &peaks) const;
+
+	/** Returns the number of blocks needed to run a given number of
+	 *	simulations.
+	 */
+	static long numBlocks(long nSims);
+
+	/** Computes the highest periodogram peak of each of a block of
+	 *	light curves.
+	 */
+	void blockPeaks(const FastTable &data, const DoubleVec &var,
+			double* peaks, size_t* where) const;
+
+private:
+	void runBlock(const NullModel &model, unsigned long seed,
+			long nSims, long block, double* peaks) const;
+
+	const DoubleVec times;
+	const size_t nTimes, nFreqs;
+
+	// Cadence-dependent parts of Press & Rybicki (1989) Eq. (2)-(7)
+	DoubleVec om, cosOmTau, sinOmTau, tc2, ts2;
+	FastTable sisi, coco;
+};
+
+/** Derives the seed of one random number stream from the seed of a run.
+ * @ingroup util
+ */
+unsigned long mixSeed(unsigned long seed, unsigned long stream);
+
+/** Returns a random number seed based on the system clock.
+ * @ingroup util
+ */
+unsigned long clockSeed();
+
+/** Returns the current wall-clock time.
+ * @ingroup util
+ */
+double wallClock();
+
+/** Validates the number of simulations requested of a Monte Carlo
+ *	function.
+ * @ingroup util
+ */
+void checkNumSims(long nSims, const std::string &caller);
+
+/** Summarizes the inputs of a simulation run.
+ * @ingroup util
+ */
+boost::uint32_t runFingerprint(const DoubleVec &times, const DoubleVec &freqs, 
+		const NullModel &model);
+
+}		// end kpftimes
+
+#endif		// end ifndef LSSIMH
@@ -0,0 +1,634 @@
+/** Interruptible Monte Carlo simulations of Lomb-Scargle periodograms
+ * @file timescales/montecarlo.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include "binaryio.h"
+#include "lssim.h"
+#include "timescales.h"
+#include "tuning.h"
+#include "../common/stats.tmp.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::uint32_t;
+
+/** Identifies checkpoint files written by LsMonteCarlo
+ */
+const char CHECKPOINT_MAGIC[8] = {'K', 'P', 'F', 'T', 'M', 'C', '0', '1'};
+
+/** Adds a block of memory to a running FNV-1a hash.
+ *
+ * @param[in] hash	The hash of the data seen so far
+ * @param[in] data	The start of the block
+ * @param[in] length	The number of bytes in the block
+ *
+ * @return The hash of the data seen so far, followed by the block.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+uint32_t fnvHash(uint32_t hash, const void* data, size_t length) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < length; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/** Summarizes the inputs of a simulation run.
+ *
+ * @param[in] times	Times at which data will be simulated
+ * @param[in] freqs	The frequency grid of the periodograms
+ * @param[in] model	The noise process to simulate
+ *
+ * @return A hash of @p times, @p freqs, and the output of @p model for 
+ *	a fixed set of deviates at @p times. Two runs with the same 
+ *	fingerprint simulate the same periodograms, barring a hash collision.
+ *
+ * @pre @p times is a valid input for @p model
+ *
+ * @perform O(N + F) time plus the time to simulate one light curve, 
+ *	where N = @p times.size() and F = @p freqs.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	simulate a light curve.
+ * @exception std::runtime_error Thrown if @p model could not simulate 
+ *	the light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+uint32_t runFingerprint(const DoubleVec &times, const DoubleVec &freqs, 
+		const NullModel &model) {
+	// The noise models have no other way to identify themselves, so 
+	//	fingerprint one light curve generated from fixed deviates
+	DoubleVec deviates(model.numDeviates(times));
+	for (size_t i = 0; i < deviates.size(); i++) {
+		deviates[i] = sin(1.0 + i);
+	}
+	DoubleVec probe;
+	model.simulate(times, deviates, probe);
+
+	uint32_t hash = 2166136261u;
+	hash = fnvHash(hash, &times[0], times.size()*sizeof(double));
+	if (!freqs.empty()) {
+		hash = fnvHash(hash, &freqs[0], freqs.size()*sizeof(double));
+	}
+	if (!probe.empty()) {
+		hash = fnvHash(hash, &probe[0], probe.size()*sizeof(double));
+	}
+	return hash;
+}
+
+/** Cleans up a progress monitor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+ProgressMonitor::~ProgressMonitor() {
+}
+
+/** Sets up a run of simulations, without running any of them.
+ *
+ * @param[in] times	Times at which data will be simulated
+ * @param[in] freqs	The frequency grid over which periodograms will 
+ *			be calculated.
+ * @param[in] nSims	The number of simulations to run
+ * @param[in] model	The noise process to simulate. The object must 
+ *			remain valid for the lifetime of the LsMonteCarlo.
+ * @param[in] seed	The seed for the random number generator. A run 
+ *			with the same arguments produces the same 
+ *			simulations as lsThreshold() or lsNormalEdf() 
+ *			called with the same @p seed.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre @p nSims &ge; 1
+ *
+ * @post getNumDone() = 0 and getNumSims() = @p nSims
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(NF + @p nSims) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::invalid_argument Thrown if @p nSims is nonpositive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	set up the simulations.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+LsMonteCarlo::LsMonteCarlo(const DoubleVec &times, const DoubleVec &freqs, 
+		long nSims, const NullModel &model, unsigned long seed) 
+		: simulator(NULL), model(&model), seed(seed), nSims(nSims), 
+		fingerprint(0), peaks(), blocksDone(0), elapsed(0.0), monitor(NULL), 
+		cancelled(false), checkpointFile(), checkpointInterval(0.0), 
+		lastCheckpoint(0.0) {
+	checkNumSims(nSims, "LsMonteCarlo()");
+	peaks.resize(nSims);
+	// Last, so that nothing after it can throw
+	simulator = new LsSimulator(times, freqs, "LsMonteCarlo()");
+	try {
+		fingerprint = runFingerprint(times, freqs, model);
+	} catch (...) {
+		delete simulator;
+		throw;
+	}
+}
+
+/** Cleans up the simulations.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+LsMonteCarlo::~LsMonteCarlo() {
+	delete simulator;
+}
+
+/** Chooses an object to be told of the progress of the simulations.
+ *
+ * @param[in] newMonitor The object to notify after each group of blocks, 
+ *			or NULL to stop reporting progress. The object 
+ *			must remain valid while the simulations run.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void LsMonteCarlo::setMonitor(ProgressMonitor* newMonitor) {
+	monitor = newMonitor;
+}
+
+/** Returns the total number of simulations requested.
+ *
+ * @return The value of @p nSims passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+long LsMonteCarlo::getNumSims() const {
+	return nSims;
+}
+
+/** Returns the number of simulations completed so far.
+ *
+ * @return The number of simulations whose results are available to 
+ *	threshold() and edf().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+long LsMonteCarlo::getNumDone() const {
+	return std::min(nSims, blocksDone * LsSimulator::BLOCK_SIZE);
+}
+
+/** Tests whether all simulations have been run.
+ *
+ * @return True if getNumDone() = getNumSims()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool LsMonteCarlo::isDone() const {
+	return getNumDone() >= nSims;
+}
+
+/** Asks the simulations to stop.
+ *
+ * May be called from any thread, including from a ProgressMonitor. 
+ * Simulations already under way finish, and run() or runFor() returns 
+ * at the next block boundary. Cancellation cannot be undone.
+ *
+ * @post isCancelled() = true
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void LsMonteCarlo::cancel() {
+	cancelled = true;
+}
+
+/** Tests whether the simulations have been cancelled.
+ *
+ * @return True if cancel() has been called, or if a ProgressMonitor has 
+ *	asked to stop.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool LsMonteCarlo::isCancelled() const {
+	return cancelled;
+}
+
+/** Estimates how long the remaining simulations will take.
+ *
+ * @return The wall-clock time, in seconds, that the remaining simulations 
+ *	would take at the average rate of the simulations run so far, or 
+ *	a negative number if no simulations have been run.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double LsMonteCarlo::estimateRemaining() const {
+	if (blocksDone == 0) {
+		return -1.0;
+	}
+	const long blocksLeft = LsSimulator::numBlocks(nSims) - blocksDone;
+	return elapsed / blocksDone * blocksLeft;
+}
+
+/** Runs the remaining simulations.
+ *
+ * @return True if all simulations have been run, false if the run was 
+ *	cancelled first.
+ *
+ * @post Either isDone() or isCancelled() is true.
+ *
+ * @perform O(NF &times; S) time, where N = @p times.size(), F = 
+ *	@p freqs.size(), and S is the number of simulations left.
+ * @perfmore If the library was compiled with OpenMP, blocks of 
+ *	simulations are run in parallel.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	run the simulations.
+ * @exception std::runtime_error Thrown if the noise model could not 
+ *	simulate a light curve.
+ *
+ * @exceptsafe If an exception is thrown, the simulations completed 
+ *	before the failed group of blocks are kept, and the run may be 
+ *	resumed.
+ */
+bool LsMonteCarlo::run() {
+	return runUntil(-1.0);
+}
+
+/** Runs simulations for at most a given time.
+ *
+ * Simulations are run in groups of blocks, one block per thread, and 
+ * the time limit is checked between groups. The call may therefore 
+ * overrun @p seconds by up to the time taken by one group.
+ *
+ * @param[in] seconds	The time after which no more groups should be 
+ *			started.
+ *
+ * @return True if all simulations have been run, false otherwise.
+ *
+ * @post Either isDone(), isCancelled(), or at least @p seconds have 
+ *	elapsed.
+ *
+ * @perform O(NF &times; S) time, where N = @p times.size(), F = 
+ *	@p freqs.size(), and S is the number of simulations run.
+ * @perfmore If the library was compiled with OpenMP, blocks of 
+ *	simulations are run in parallel.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	run the simulations.
+ * @exception std::runtime_error Thrown if the noise model could not 
+ *	simulate a light curve.
+ *
+ * @exceptsafe If an exception is thrown, the simulations completed 
+ *	before the failed group of blocks are kept, and the run may be 
+ *	resumed.
+ */
+bool LsMonteCarlo::runFor(double seconds) {
+	return runUntil(wallClock() + std::max(seconds, 0.0));
+}
+
+/** Runs simulations until a deadline.
+ *
+ * @param[in] deadline	The wall-clock time, as returned by wallClock(), 
+ *			after which no more groups should be started, or 
+ *			a negative number for no deadline.
+ *
+ * @return True if all simulations have been run, false otherwise.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	run the simulations.
+ * @exception std::runtime_error Thrown if the noise model could not 
+ *	simulate a light curve.
+ *
+ * @exceptsafe If an exception is thrown, the simulations completed 
+ *	before the failed group of blocks are kept, and the run may be 
+ *	resumed.
+ */
+bool LsMonteCarlo::runUntil(double deadline) {
+	const long nBlocks = LsSimulator::numBlocks(nSims);
+	const long groupSize = simulationThreads();
+	
+	bool unsaved = false;
+	while (blocksDone < nBlocks && !cancelled) {
+		const long lastBlock = std::min(nBlocks, blocksDone + groupSize);
+		
+		const double start = wallClock();
+		simulator->simulateBlocks(*model, seed, nSims, blocksDone, lastBlock, 
+				&peaks[0]);
+		const double end = wallClock();
+		
+		blocksDone = lastBlock;
+		elapsed += end - start;
+		unsaved = true;
+		
+		if (!checkpointFile.empty() && end - lastCheckpoint >= checkpointInterval) {
+			checkpoint(checkpointFile);
+			unsaved = false;
+		}
+		
+		if (monitor != NULL && !monitor->update(getNumDone(), nSims, 
+				estimateRemaining())) {
+			cancelled = true;
+		}
+		if (deadline >= 0.0 && end >= deadline) {
+			break;
+		}
+	}
+	// Don't lose work done since the last checkpoint
+	if (unsaved && !checkpointFile.empty()) {
+		checkpoint(checkpointFile);
+	}
+	
+	return isDone();
+}
+
+/** Saves the progress of the simulations at regular intervals.
+ *
+ * While run() or runFor() is executing, the state of the simulations is 
+ * written to @p fileName whenever at least @p interval seconds have 
+ * passed since the last checkpoint, and again when the call returns. 
+ * Each checkpoint replaces the previous one atomically, so the file is 
+ * never left half-written.
+ *
+ * @param[in] fileName	The file to write, or an empty string to stop 
+ *			checkpointing.
+ * @param[in] interval	The minimum wall-clock time between checkpoints, 
+ *			in seconds.
+ *
+ * @pre @p interval &ge; 0
+ *
+ * @exception std::invalid_argument Thrown if @p interval is negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the file name.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+void LsMonteCarlo::setCheckpoint(const string &fileName, double interval) {
+	if (!(interval >= 0.0)) {
+		try {
+			throw std::invalid_argument("Parameter 'interval' in LsMonteCarlo::setCheckpoint() must be nonnegative (gave " 
+				+ lexical_cast<string>(interval) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'interval' in LsMonteCarlo::setCheckpoint() must be nonnegative");
+		}
+	}
+	
+	string temp(fileName);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(checkpointFile, temp);
+	checkpointInterval = interval;
+	lastCheckpoint = wallClock();
+}
+
+/** Writes the state of the simulations to a file.
+ *
+ * The file holds the seed, the number of simulations, a fingerprint of 
+ * the cadence, frequency grid, and noise model, the number of blocks 
+ * completed, and the peak power of every completed simulation. The 
+ * random number streams need no state of their own, because each block 
+ * starts a new stream derived from the seed and the block's index.
+ *
+ * The file is written in the machine's native byte order, and cannot 
+ * be read on a machine with a different one.
+ *
+ * @param[in] fileName	The file to write. It is first written under a 
+ *			temporary name, then renamed, so an existing 
+ *			checkpoint is replaced atomically.
+ *
+ * @post A call to restore() on an LsMonteCarlo object constructed with 
+ *	the same arguments will return it to the current state.
+ *
+ * @perform O(S) time, where S = getNumDone()
+ *
+ * @exception std::runtime_error Thrown if the file could not be written.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception. If 
+ *	an exception is thrown, any existing file named @p fileName is 
+ *	unchanged.
+ */
+void LsMonteCarlo::checkpoint(const string &fileName) {
+	const string tempName = fileName + ".tmp";
+	const long nDone = getNumDone();
+	
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+		// Lets restore() detect a file from a machine with a different 
+		//	byte order
+		writeRaw(out, BYTE_ORDER_MARK);
+		writeRaw(out, static_cast<uint32_t>(seed));
+		writeRaw(out, static_cast<uint32_t>(fingerprint));
+		writeRaw(out, nSims);
+		writeRaw(out, static_cast<long>(blocksDone));
+		writeRaw(out, elapsed);
+		if (nDone > 0) {
+			out.write(reinterpret_cast<const char*>(&peaks[0]), nDone*sizeof(double));
+		}
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write checkpoint file " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not replace checkpoint file " + fileName);
+	}
+	
+	lastCheckpoint = wallClock();
+}
+
+/** Returns the simulations to the state saved in a file.
+ *
+ * @param[in] fileName	A file written by checkpoint() or setCheckpoint()
+ *
+ * @pre This object was constructed with the same times, frequencies, 
+ *	number of simulations, noise model, and seed as the one that 
+ *	wrote @p fileName.
+ *
+ * @post getNumDone() is the number of simulations completed when 
+ *	@p fileName was written. Running the remaining simulations gives 
+ *	exactly the same results as a run that was never interrupted.
+ *
+ * @perform O(S) time, where S is the number of simulations in the file
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, is 
+ *	not a checkpoint file, or was written on a machine with a 
+ *	different byte order.
+ * @exception std::invalid_argument Thrown if the file was written by a 
+ *	run with different inputs.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+void LsMonteCarlo::restore(const string &fileName) {
+	std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("Could not open checkpoint file " + fileName);
+	}
+	
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	uint32_t order = 0, fileSeed = 0, filePrint = 0;
+	long fileSims = 0, fileBlocks = 0;
+	double fileElapsed = 0.0;
+	in.read(magic, sizeof(magic));
+	readRaw(in, order);
+	if (!in || !std::equal(magic, magic+sizeof(magic), CHECKPOINT_MAGIC)) {
+		throw std::runtime_error(fileName + " is not a Timescales checkpoint file");
+	} else if (order != BYTE_ORDER_MARK) {
+		throw std::runtime_error("Checkpoint file " + fileName + " was written on a machine with a different byte order");
+	}
+	readRaw(in, fileSeed);
+	readRaw(in, filePrint);
+	readRaw(in, fileSims);
+	readRaw(in, fileBlocks);
+	readRaw(in, fileElapsed);
+	if (!in) {
+		throw std::runtime_error("Checkpoint file " + fileName + " is truncated");
+	}
+	
+	if (fileSeed != static_cast<uint32_t>(seed) || fileSims != nSims) {
+		throw std::invalid_argument("Checkpoint file " + fileName + " was written by a run with a different seed or number of simulations");
+	} else if (filePrint != static_cast<uint32_t>(fingerprint)) {
+		throw std::invalid_argument("Checkpoint file " + fileName + " was written by a run with a different cadence, frequency grid, or noise model");
+	} else if (fileBlocks < 0 || fileBlocks > LsSimulator::numBlocks(nSims)) {
+		throw std::runtime_error("Checkpoint file " + fileName + " is corrupted");
+	}
+	
+	const long nDone = std::min(nSims, fileBlocks * LsSimulator::BLOCK_SIZE);
+	DoubleVec tempPeaks(nSims);
+	if (nDone > 0) {
+		in.read(reinterpret_cast<char*>(&tempPeaks[0]), nDone*sizeof(double));
+	}
+	if (!in) {
+		throw std::runtime_error("Checkpoint file " + fileName + " is truncated");
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(peaks, tempPeaks);
+	blocksDone = fileBlocks;
+	elapsed    = fileElapsed;
+}
+
+/** Calculates the significance threshold from the simulations run so far.
+ *
+ * @param[in] fap	Desired false alarm probability
+ *
+ * @return The peak power level that will be reached, with probability 
+ *	@p fap, in a periodogram of the noise model. If isDone(), this is 
+ *	the value returned by lsThreshold() with the same arguments.
+ *
+ * @pre 0 < @p fap < 1
+ * @pre @p fap  getNumDone() &ge; 10
+ *
+ * @perform O(S) time, where S = getNumDone()
+ * @perfmore O(S) memory
+ *
+ * @exception std::invalid_argument Thrown if @p fap is outside (0, 1), 
+ *	or if too few simulations have been run to estimate it.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the threshold.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+double LsMonteCarlo::threshold(double fap) const {
+	const long nDone = getNumDone();
+	if (fap >= 1.0 || fap <= 0.0) {
+		try {
+			throw std::invalid_argument("False alarm probability in LsMonteCarlo::threshold() must be in the interval (0, 1) (gave " + lexical_cast<string>(fap) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("False alarm probability in LsMonteCarlo::threshold() must be in the interval (0, 1)");
+		}
+	} else if (nDone*fap < 10) {
+		throw std::invalid_argument("Not enough simulations completed in LsMonteCarlo::threshold() to get a significant peak at the desired false alarm probability");
+	}
+	
+	return kpfutils::quantile(peaks.begin(), peaks.begin() + nDone, 1.0 - fap);
+}
+
+/** Calculates the empirical distribution function of false peaks from 
+ *	the simulations run so far.
+ *
+ * @param[out] powers	A sorted list of the peak powers of the 
+ *			simulations completed so far.
+ * @param[out] probs	The fraction of simulations with a peak no 
+ *			higher than the corresponding element of @p powers.
+ *
+ * @pre getNumDone() &ge; 1
+ *
+ * @post @p powers.size() = @p probs.size() = getNumDone()
+ * @post If isDone(), @p powers and @p probs equal the output of 
+ *	lsNormalEdf() with the same arguments.
+ *
+ * @perform O(S log S) time, where S = getNumDone()
+ * @perfmore O(S) memory
+ *
+ * @exception std::invalid_argument Thrown if no simulations have been run.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the distribution.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void LsMonteCarlo::edf(DoubleVec &powers, DoubleVec &probs) const {
+	const long nDone = getNumDone();
+	if (nDone < 1) {
+		throw std::invalid_argument("No simulations completed in LsMonteCarlo::edf()");
+	}
+	
+	DoubleVec tempPowers(peaks.begin(), peaks.begin() + nDone);
+	std::sort(tempPowers.begin(), tempPowers.end());
+	DoubleVec tempProbs;
+	tempProbs.reserve(nDone);
+	for(long i = 1; i <= nDone; i++) {
+		tempProbs.push_back(static_cast<double>(i)/nDone);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(powers, tempPowers);
+	swap(probs , tempProbs );
+}
+
+}		// end kpftimes
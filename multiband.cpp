@@ -0,0 +1,339 @@
+/** Periodograms of light curves observed in several filters
+ * @file timescales/multiband.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/version.hpp>
+#include "../common/stats.tmp.h"
+#include "timeexcept.h"
+#include "timescales.h"
+#include "trace.h"
+#include "tuning.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** The trigonometric sums of one band over a block of frequencies.
+ *
+ * Each vector has one element per frequency in the block. The sums run 
+ * over the epochs of the band, with the band's mean already subtracted 
+ * from its data.
+ */
+struct BandSums {
+	/** Allocates sums for a block of frequencies.
+	 *
+	 * @param[in] block	The number of frequencies in a block
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	explicit BandSums(size_t block) : c(block), s(block), cc(block), cs(block), 
+			yc(block), ys(block) {
+	}
+	
+	/** &Sigma; cos(&omega;t) and &Sigma; sin(&omega;t)
+	 */
+	DoubleVec c, s;
+	/** &Sigma; cos<sup>2</sup>(&omega;t) and &Sigma; cos(&omega;t) sin(&omega;t)
+	 */
+	DoubleVec cc, cs;
+	/** &Sigma; y cos(&omega;t) and &Sigma; y sin(&omega;t)
+	 */
+	DoubleVec yc, ys;
+};
+
+/** Accumulates the trigonometric sums of one band over a block of 
+ *	frequencies.
+ *
+ * @param[in] times	The epochs of the band, shifted to start near zero
+ * @param[in] data	The measurements of the band, minus their mean
+ * @param[in] om	The angular frequencies of the block
+ * @param[in] start, end	The range of @p om to use
+ * @param[out] sums	The sums for frequencies @p start to @p end, 
+ *			stored starting at index 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void bandSums(const DoubleVec &times, const DoubleVec &data, const DoubleVec &om, 
+		size_t start, size_t end, BandSums &sums) {
+	const size_t n = end - start;
+	for(size_t i = 0; i < n; i++) {
+		sums.c [i] = 0.0;
+		sums.s [i] = 0.0;
+		sums.cc[i] = 0.0;
+		sums.cs[i] = 0.0;
+		sums.yc[i] = 0.0;
+		sums.ys[i] = 0.0;
+	}
+	// Transposed loop order: the inner loop runs over independent 
+	//	frequencies, so it has no carried dependency and vectorizes
+	for(size_t j = 0; j < times.size(); j++) {
+		const double tj = times[j], yj = data[j];
+		const double* w = &om[start];
+		for(size_t i = 0; i < n; i++) {
+			const double c = cos(w[i]*tj), s = sin(w[i]*tj);
+			sums.c [i] += c;
+			sums.s [i] += s;
+			sums.cc[i] += c*c;
+			sums.cs[i] += c*s;
+			sums.yc[i] += yj*c;
+			sums.ys[i] += yj*s;
+		}
+	}
+}
+
+/** Adds the improvement in fit from one band's sinusoid to a block of 
+ *	the periodogram.
+ *
+ * The model for the band is an offset plus a sinusoid, which makes a 
+ * 3&times;3 linear least-squares problem at each frequency. Because the 
+ * data already have their mean removed, the offset can be eliminated 
+ * analytically, leaving a 2&times;2 system that is solved in closed form 
+ * for every frequency of the block at once.
+ *
+ * @param[in] sums	The band's trigonometric sums over the block
+ * @param[in] nEpochs	The number of epochs in the band
+ * @param[in] n		The number of frequencies in the block
+ * @param[in,out] reduction	The reduction in &chi;<sup>2</sup> from 
+ *				all bands so far, to which this band's is 
+ *				added
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void addBandFit(const BandSums &sums, size_t nEpochs, size_t n, double* reduction) {
+	const double nInv = 1.0 / nEpochs;
+	for(size_t i = 0; i < n; i++) {
+		const double c = sums.c[i], s = sums.s[i];
+		// Normal equations for the mean-subtracted cosine and sine
+		const double cHat = sums.cc[i] - c*c*nInv;
+		const double sHat = (nEpochs - sums.cc[i]) - s*s*nInv;
+		const double xHat = sums.cs[i] - c*s*nInv;
+		const double yc = sums.yc[i], ys = sums.ys[i];
+		
+		const double trace = cHat + sHat;
+		const double det   = cHat*sHat - xHat*xHat;
+		if (det > 1e-10*trace*trace) {
+			reduction[i] += (sHat*yc*yc - 2.0*xHat*yc*ys + cHat*ys*ys) / det;
+		} else if (trace > 0.0) {
+			// The cosine and sine are degenerate (e.g., at the Nyquist 
+			//	frequency of a regular cadence), so fit only their 
+			//	common direction
+			reduction[i] += (yc*yc + ys*ys) / trace;
+		}
+	}
+}
+
+/** Calculates a periodogram of a light curve observed in several filters
+ *
+ * The multiband periodogram of @cite MultibandLs fits every band with a 
+ * sinusoid of the same frequency, with its own offset, amplitude, and 
+ * phase. The power at each frequency is the fraction of the total 
+ * &chi;<sup>2</sup> about the band means that the sinusoids remove, so 
+ * it lies between 0 (no improvement) and 1 (a perfect fit). Bands with 
+ * different cadences fill in each other's aliases, so the combined 
+ * periodogram is cleaner than any single band's.
+ *
+ * All bands are evaluated in one pass over the frequencies. The 
+ * frequencies are processed in blocks, each of which is shared by all 
+ * bands and, if the library was compiled with OpenMP, handled by one 
+ * thread.
+ *
+ * @param[in] times	The times at which each band was observed. Need not 
+ *			be sorted.
+ * @param[in] data	The measurements in each band
+ * @param[in] freqs	The frequency grid over which the periodogram should 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ * @param[out] power	The periodogram power at each frequency.
+ *
+ * @pre @p times.size() = @p data.size() &ge; 1
+ * @pre @p data[b].size() = @p times[b].size() for all b
+ * @pre @p times[b] contains at least two unique values for all b
+ * @pre at least one element of @p data has more than one unique value
+ * @pre all elements of @p freqs are &ge; 0
+ *
+ * @post @p power.size() = @p freqs.size()
+ * @post @p power[i] is the multiband periodogram of the data, evaluated at 
+ *	@p freqs[i], for all i
+ * @post If there is only one band, @p power is the floating-mean 
+ *	periodogram of that band, normalized by its &chi;<sup>2</sup>.
+ *
+ * @perform O(NF) time, where N is the total number of epochs in all bands 
+ *	and F = @p freqs.size()
+ * @perfmore O(N + F) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if some band has at 
+ *	most one distinct time, or if no band has any variability.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::invalid_argument Thrown if there are no bands, or if 
+ *	@p times and @p data do not describe the same number of bands or 
+ *	epochs.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void lombScargleMultiband(const std::vector<DoubleVec> &times, 
+		const std::vector<DoubleVec> &data, const DoubleVec &freqs, 
+		DoubleVec &power) {
+	TraceSpan span("lombScargleMultiband");
+	const size_t nBands = times.size();
+	const size_t nFreq  = freqs.size();
+	
+	// Verify the preconditions
+	if (data.size() != nBands) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'data' in lombScargleMultiband() do not have the same number of bands (gave " 
+			+ lexical_cast<string>(nBands) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'data' in lombScargleMultiband() do not have the same number of bands");
+		}
+	}
+	if (nBands == 0) {
+		throw std::invalid_argument("Parameter 'times' in lombScargleMultiband() has no bands");
+	}
+	
+	// Shift and center each band separately; the model is invariant 
+	//	under both
+	std::vector<DoubleVec> times0(nBands), data0(nBands);
+	double chi2 = 0.0;
+	for(size_t b = 0; b < nBands; b++) {
+		const size_t nEpochs = times[b].size();
+		if (data[b].size() != nEpochs) {
+			try {
+				throw std::invalid_argument("Parameters 'times' and 'data' in lombScargleMultiband() are not the same length for band " 
+				+ lexical_cast<string>(b) + " (gave " 
+				+ lexical_cast<string>(nEpochs) + " for times and " 
+				+ lexical_cast<string>(data[b].size()) + " for data)");
+			} catch (const boost::bad_lexical_cast& e) {
+				throw std::invalid_argument("Parameters 'times' and 'data' in lombScargleMultiband() are not the same length");
+			}
+		}
+		if (nEpochs < 2 || *std::min_element(times[b].begin(), times[b].end()) 
+				== *std::max_element(times[b].begin(), times[b].end())) {
+			throw except::BadLightCurve("Parameter 'times' in lombScargleMultiband() has a band with only one unique date");
+		}
+		
+		const double t0    = *std::min_element(times[b].begin(), times[b].end());
+		const double meanF = kpfutils::mean(data[b].begin(), data[b].end());
+		times0[b].resize(nEpochs);
+		data0 [b].resize(nEpochs);
+		for(size_t j = 0; j < nEpochs; j++) {
+			times0[b][j] = times[b][j] - t0;
+			data0 [b][j] = data[b][j] - meanF;
+			chi2 += data0[b][j] * data0[b][j];
+		}
+	}
+	if (chi2 <= 0.0) {
+		throw except::BadLightCurve("Parameter 'data' in lombScargleMultiband() has no variability");
+	}
+	
+	// Equations are best expressed in angular frequency
+	DoubleVec om(nFreq);
+	for(size_t i = 0; i < nFreq; i++) {
+		if (freqs[i] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in lombScargleMultiband() contains negative frequencies");
+		}
+		om[i] = 2.0 * pi * freqs[i];
+	}
+	
+	// copy-and-swap
+	DoubleVec tempPower(nFreq, 0.0);
+	
+	const size_t block   = currentTuning().freqBlock;
+	const long   nBlocks = static_cast<long>((nFreq + block - 1) / block);
+	
+	// Exceptions must not propagate out of a parallel region
+	bool outOfMemory = false;
+	
+	#ifdef _OPENMP
+	#pragma omp parallel
+	#endif
+	{
+		// One set of sums per thread, allocated inside the loop so 
+		//	that failures can be caught
+		shared_ptr<BandSums> sums;
+		
+		#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+		#endif
+		for(long k = 0; k < nBlocks; k++) {
+			try {
+				if (sums.get() == NULL) {
+					sums.reset(new BandSums(block));
+				}
+				const size_t start = k*block;
+				const size_t end   = std::min(start + block, nFreq);
+				for(size_t b = 0; b < nBands; b++) {
+					bandSums(times0[b], data0[b], om, start, end, *sums);
+					addBandFit(*sums, times0[b].size(), end - start, 
+						&tempPower[start]);
+				}
+				for(size_t i = start; i < end; i++) {
+					tempPower[i] /= chi2;
+				}
+			} catch (const std::bad_alloc& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(multibandError)
+				#endif
+				outOfMemory = true;
+			}
+		}
+	}
+	
+	if (outOfMemory) {
+		throw std::bad_alloc();
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(power, tempPower);
+}
+
+}		// end kpftimes
@@ -0,0 +1,620 @@
+/** Evaluates Fourier sums at nonuniformly spaced points
+ * @file timescales/nufft.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/version.hpp>
+#include <gsl/gsl_fft_complex.h>
+#include "nufft.h"
+#include "timescales.h"
+#include "tuning.h"
+#include "workspace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** Finds the smallest FFT length no shorter than a minimum that has no
+ *	prime factors other than 2, 3, and 5.
+ *
+ * @param[in] minSize The smallest acceptable length
+ *
+ * @return The FFT length
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t niceFftSize(size_t minSize) {
+	for (size_t n = (minSize > 1 ? minSize : 1); ; n++) {
+		size_t m = n;
+		while (m % 2 == 0) { m /= 2; }
+		while (m % 3 == 0) { m /= 3; }
+		while (m % 5 == 0) { m /= 5; }
+		if (m == 1) {
+			return n;
+		}
+	}
+}
+
+/** Evaluates a band-limited Fourier series at arbitrary points (a type 2
+ *	nonuniform FFT)
+ *
+ * The implementation uses the Gaussian gridding algorithm of
+ *	@cite FastNufft with an oversampling factor of 2.
+ *
+ * @param[in] coeffs	The Fourier coefficients of the series. Element m
+ *			is the coefficient of the mode k = m - M/2, where
+ *			M = @p coeffs.size().
+ * @param[in] x		The points at which to evaluate the series. The
+ *			series is periodic with period 2&pi;.
+ * @param[out] values	The series evaluated at each element of @p x.
+ * @param[in] eps	The desired relative precision of the result.
+ *
+ * @pre @p coeffs.size() &ge; 1
+ * @pre 0 < @p eps < 1
+ *
+ * @post @p values.size() = @p x.size()
+ * @post @p values[j] = &sum;<sub>m</sub> @p coeffs[m]
+ *	exp(i (m - M/2) @p x[j]), to within a fraction @p eps of
+ *	&sum;<sub>m</sub> |@p coeffs[m]|
+ *
+ * @perform O(M log M + N log(1/@p eps)) time, where M = @p coeffs.size()
+ *	and N = @p x.size()
+ * @perfmore O(M + N) memory
+ *
+ * @exception std::invalid_argument Thrown if @p coeffs is empty or if
+ *	@p eps is not in (0, 1).
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	perform the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void nufftType2(const ComplexVec &coeffs, const DoubleVec &x,
+		ComplexVec &values, double eps) {
+	nufftType2(coeffs, x, values, eps, threadWorkspace());
+}
+
+/** Evaluates a band-limited Fourier series at arbitrary points (a type 2
+ *	nonuniform FFT), using preallocated memory
+ *
+ * Identical to @ref nufftType2(const ComplexVec&, const DoubleVec&, ComplexVec&, double) 
+ * "nufftType2()", except that the grid, the FFT tables, and all other 
+ * temporaries are drawn from @p workspace.
+ *
+ * @param[in] coeffs	The Fourier coefficients of the series
+ * @param[in] x		The points at which to evaluate the series
+ * @param[out] values	The series evaluated at each element of @p x.
+ * @param[in] eps	The desired relative precision of the result.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @pre @p coeffs.size() &ge; 1
+ * @pre 0 < @p eps < 1
+ *
+ * @post As for the version without a Workspace
+ *
+ * @perform O(M log M + N log(1/@p eps)) time, where M = @p coeffs.size()
+ *	and N = @p x.size()
+ * @perfmore O(M + N) memory, which is allocated only the first time a 
+ *	Workspace is used
+ *
+ * @exception std::invalid_argument Thrown if @p coeffs is empty or if
+ *	@p eps is not in (0, 1).
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	perform the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void nufftType2(const ComplexVec &coeffs, const DoubleVec &x,
+		ComplexVec &values, double eps, Workspace &workspace) {
+	const size_t nModes = coeffs.size();
+	const size_t nPoints = x.size();
+	if (nModes < 1) {
+		throw std::invalid_argument("Need at least one coefficient in nufftType2()");
+	}
+	if (eps <= 0.0 || eps >= 1.0) {
+		try {
+			throw std::invalid_argument("Precision in nufftType2() must be in the interval (0, 1) (gave "
+				+ lexical_cast<string>(eps) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Precision in nufftType2() must be in the interval (0, 1)");
+		}
+	}
+
+	// Kernel parameters from Dutt & Rokhlin (1993) and Greengard & Lee
+	//	(2004), for an oversampling ratio of 2
+	// The error falls as exp(-2 pi nSpread / 3)
+	long nSpread = static_cast<long>(ceil(-1.5*log(eps)/pi));
+	if (nSpread < 2) {
+		nSpread = 2;
+	} else if (nSpread > 16) {
+		nSpread = 16;
+	}
+	const double ratio = 2.0;
+	const size_t nGrid = niceFftSize(static_cast<size_t>(std::max(ratio*nModes,
+			2.0*nSpread)));
+	const double tau = pi * nSpread / (static_cast<double>(nModes)*nModes
+			* ratio*(ratio - 0.5));
+	const double step = 2.0*pi / nGrid;
+	const long   kMin = -static_cast<long>(nModes/2);
+
+	// Deconvolve the coefficients by the kernel, then transform to the
+	//	oversampled grid
+	ScratchFrame frame(workspace);
+	DoubleVec &grid = frame.doubles(2*nGrid);
+	std::fill(grid.begin(), grid.end(), 0.0);
+	const double deconvNorm = sqrt(pi/tau);
+	for (size_t m = 0; m < nModes; m++) {
+		long k = kMin + static_cast<long>(m);
+		std::complex<double> scaled = coeffs[m] * deconvNorm
+				* exp(static_cast<double>(k)*k*tau);
+		long index = k % static_cast<long>(nGrid);
+		if (index < 0) {
+			index += static_cast<long>(nGrid);
+		}
+		grid[2*index  ] += scaled.real();
+		grid[2*index+1] += scaled.imag();
+	}
+
+	gsl_fft_complex_wavetable *theTable = frame.complexTable(nGrid);
+	gsl_fft_complex_workspace *theSpace = frame.complexSpace(nGrid);
+	gsl_fft_complex_backward(&grid[0], 1, nGrid, theTable, theSpace);
+
+	// Interpolate from the grid with the periodized Gaussian, using
+	//	the fast Gaussian gridding factorization of the kernel
+	DoubleVec &e3 = frame.doubles(nSpread+1);
+	for (long l = 0; l <= nSpread; l++) {
+		e3[l] = exp(-(l*step)*(l*step) / (4.0*tau));
+	}
+
+	// copy-and-swap
+	ComplexVec &tempValues = frame.complexes(nPoints);
+	for (size_t j = 0; j < nPoints; j++) {
+		double xj = fmod(x[j], 2.0*pi);
+		if (xj < 0.0) {
+			xj += 2.0*pi;
+		}
+		long m0 = static_cast<long>(floor(xj / step));
+		double d = xj - m0*step;
+
+		double e1 = exp(-d*d / (4.0*tau));
+		double e2 = exp(d*step / (2.0*tau));
+		// Start at l = 1 - nSpread
+		double e2Pow = pow(e2, static_cast<double>(1 - nSpread));
+
+		double sumRe = 0.0, sumIm = 0.0;
+		for (long l = 1 - nSpread; l <= nSpread; l++) {
+			long index = (m0 + l) % static_cast<long>(nGrid);
+			if (index < 0) {
+				index += static_cast<long>(nGrid);
+			}
+			double w = e1 * e2Pow * e3[l < 0 ? -l : l];
+			sumRe += w * grid[2*index  ];
+			sumIm += w * grid[2*index+1];
+			e2Pow *= e2;
+		}
+		tempValues[j] = std::complex<double>(sumRe, sumIm) / static_cast<double>(nGrid);
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	storeResult(tempValues, values);
+}
+
+/** Evaluates a band-limited Fourier series at arbitrary points by direct 
+ *	summation
+ *
+ * Each point needs only one call to sin and cos; the remaining modes are 
+ * reached by repeated multiplication. This is faster than nufftType2() 
+ * for short series, where the FFT and gridding overheads dominate.
+ *
+ * @param[in] coeffs	The Fourier coefficients of the series. Element m
+ *			is the coefficient of the mode k = m - M/2, where
+ *			M = @p coeffs.size().
+ * @param[in] x		The points at which to evaluate the series.
+ * @param[out] values	The series evaluated at each element of @p x.
+ *
+ * @pre @p coeffs.size() &ge; 1
+ *
+ * @post @p values.size() = @p x.size()
+ * @post @p values[j] = &sum;<sub>m</sub> @p coeffs[m]
+ *	exp(i (m - M/2) @p x[j]), to within rounding error that grows 
+ *	linearly with M
+ *
+ * @perform O(MN) time, where M = @p coeffs.size() and N = @p x.size()
+ * @perfmore O(N) memory
+ *
+ * @exception std::invalid_argument Thrown if @p coeffs is empty.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the result.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void directType2(const ComplexVec &coeffs, const DoubleVec &x,
+		ComplexVec &values) {
+	const size_t nModes = coeffs.size();
+	const size_t nPoints = x.size();
+	if (nModes < 1) {
+		throw std::invalid_argument("Need at least one coefficient in directType2()");
+	}
+	const double kMin = -static_cast<double>(nModes/2);
+
+	ComplexVec temp(nPoints);
+	for (size_t j = 0; j < nPoints; j++) {
+		const std::complex<double> step(cos(x[j]), sin(x[j]));
+		std::complex<double> phasor(cos(kMin*x[j]), sin(kMin*x[j]));
+		std::complex<double> sum(0.0, 0.0);
+		for (size_t m = 0; m < nModes; m++) {
+			sum    += coeffs[m] * phasor;
+			phasor *= step;
+		}
+		temp[j] = sum;
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	using std::swap;
+	swap(values, temp);
+}
+
+/** Kernel width of the type 3 transform, as a fraction of the largest 
+ *	width that keeps the deconvolution from amplifying errors by more 
+ *	than 1/sqrt(eps). Narrower kernels need finer grids; wider kernels 
+ *	lose more precision to the deconvolution.
+ */
+const double TYPE3_WIDTH = 0.5;
+
+/** Parameters of the type 3 transform for a given problem size.
+ *
+ * Points x lie within [X - a, X + a] and targets s within [S - b, S + b]. 
+ * The strengths are spread onto a grid with spacing h by a Gaussian of 
+ * standard deviation sigma, truncated at nSpread grid steps.
+ */
+struct Type3Params {
+	/** Finds the parameters for a problem.
+	 *
+	 * @param[in] xHalf	The half-width a of the range of points
+	 * @param[in] sHalf	The half-width b of the range of targets. 
+	 *			Must be positive.
+	 * @param[in] eps	The desired precision
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	Type3Params(double xHalf, double sHalf, double eps) : sigma(0.0), h(0.0), 
+			nSpread(0), nGrid(0), innerEps(0.0) {
+		const double logEps = -log(eps);
+		// The Gaussian's transform falls by exp(-TYPE3_WIDTH^2 logEps/2) 
+		//	at the edge of the targets, and its truncation and aliasing 
+		//	errors are eps times smaller than that
+		sigma    = TYPE3_WIDTH * sqrt(logEps) / sHalf;
+		h        = pi / (2.0*sHalf);
+		nSpread  = static_cast<long>(ceil(sqrt((2.0 + TYPE3_WIDTH*TYPE3_WIDTH) * logEps) 
+				* sigma / h)) + 1;
+		nGrid    = 2*(static_cast<size_t>(ceil(xHalf / h)) + nSpread) + 1;
+		innerEps = eps * exp(-0.5 * TYPE3_WIDTH*TYPE3_WIDTH * logEps);
+	}
+	
+	double sigma, h;
+	long nSpread;
+	size_t nGrid;
+	/** The precision needed from the type 2 step
+	 */
+	double innerEps;
+};
+
+/** Returns the size of the grid used by nufftType3().
+ *
+ * @param[in] xSpan	The range of the points, max(x) - min(x)
+ * @param[in] sSpan	The range of the targets, max(s) - min(s)
+ * @param[in] eps	The desired relative precision
+ *
+ * @return The number of grid points, which grows as @p xSpan &times; 
+ *	@p sSpan plus a constant set by @p eps.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t type3GridSize(double xSpan, double sSpan, double eps) {
+	if (!(sSpan > 0.0)) {
+		return 1;
+	}
+	return Type3Params(0.5*xSpan, 0.5*sSpan, eps).nGrid;
+}
+
+/** Decides whether a sum over arbitrary points and targets should use 
+ *	nufftType3() instead of direct summation.
+ *
+ * @param[in] nPoints	The number of points in the sum
+ * @param[in] nTargets	The number of targets at which to evaluate it
+ * @param[in] xSpan	The range of the points
+ * @param[in] sSpan	The range of the targets
+ * @param[in] eps	The precision that nufftType3() would be asked for
+ *
+ * @return True if there are at least Tuning::type3MinTargets targets, 
+ *	and the transform's grid has fewer than 1/16 as many points as 
+ *	the direct sum has terms. Each grid point costs a step of an FFT, 
+ *	while each term costs a sine and a cosine.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool preferType3(size_t nPoints, size_t nTargets, double xSpan, double sSpan, double eps) {
+	if (nTargets < 2 || nTargets < currentTuning().type3MinTargets) {
+		return false;
+	}
+	const double terms = static_cast<double>(nPoints) * static_cast<double>(nTargets);
+	return 16.0 * static_cast<double>(type3GridSize(xSpan, sSpan, eps)) < terms;
+}
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies (a 
+ *	type 3 nonuniform FFT)
+ *
+ * The implementation follows @cite FastNufft: the strengths are spread 
+ * onto a uniform grid with a Gaussian, the grid is evaluated at the 
+ * targets with nufftType2(), and the Gaussian is divided out. Both sets 
+ * are first shifted to be centered on zero, so the cost depends only on 
+ * their ranges.
+ *
+ * @param[in] x		The points, in any order
+ * @param[in] strengths	The strength of each point
+ * @param[in] s		The targets, in any order
+ * @param[out] values	The sum evaluated at each target.
+ * @param[in] eps	The desired relative precision of the result.
+ *
+ * @pre @p strengths.size() = @p x.size()
+ * @pre 0 < @p eps < 1
+ *
+ * @post @p values.size() = @p s.size()
+ * @post @p values[k] = &sum;<sub>j</sub> @p strengths[j] 
+ *	exp(i @p s[k] @p x[j]), to within a fraction @p eps of 
+ *	&sum;<sub>j</sub> |@p strengths[j]|
+ *
+ * @perform O(N log(1/@p eps) + G log G + K log(1/@p eps)) time, where 
+ *	N = @p x.size(), K = @p s.size(), and G = type3GridSize(), which 
+ *	is proportional to the product of the ranges of @p x and @p s.
+ * @perfmore O(N + G + K) memory
+ *
+ * @exception std::invalid_argument Thrown if @p x and @p strengths have 
+ *	different lengths, or if @p eps is not in (0, 1).
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	perform the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void nufftType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values, double eps) {
+	nufftType3(x, strengths, s, values, eps, threadWorkspace());
+}
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies (a 
+ *	type 3 nonuniform FFT), using preallocated memory
+ *
+ * Identical to @ref nufftType3(const DoubleVec&, const ComplexVec&, const DoubleVec&, ComplexVec&, double) 
+ * "nufftType3()", except that the grid and all other temporaries, 
+ * including those of the inner nufftType2() call, are drawn from 
+ * @p workspace.
+ *
+ * @param[in] x		The points, in any order
+ * @param[in] strengths	The strength of each point
+ * @param[in] s		The targets, in any order
+ * @param[out] values	The sum evaluated at each target.
+ * @param[in] eps	The desired relative precision of the result.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @pre @p strengths.size() = @p x.size()
+ * @pre 0 < @p eps < 1
+ *
+ * @post As for the version without a Workspace
+ *
+ * @perform O(N log(1/@p eps) + G log G + K log(1/@p eps)) time, where 
+ *	N = @p x.size(), K = @p s.size(), and G = type3GridSize().
+ * @perfmore O(N + G + K) memory, which is allocated only the first 
+ *	time a Workspace is used
+ *
+ * @exception std::invalid_argument Thrown if @p x and @p strengths have 
+ *	different lengths, or if @p eps is not in (0, 1).
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	perform the calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void nufftType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values, double eps, Workspace &workspace) {
+	const size_t nPoints = x.size();
+	const size_t nTargets = s.size();
+	if (strengths.size() != nPoints) {
+		throw std::invalid_argument("Points and strengths in nufftType3() are not the same length");
+	}
+	if (eps <= 0.0 || eps >= 1.0) {
+		try {
+			throw std::invalid_argument("Precision in nufftType3() must be in the interval (0, 1) (gave "
+				+ lexical_cast<string>(eps) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Precision in nufftType3() must be in the interval (0, 1)");
+		}
+	}
+	ScratchFrame frame(workspace);
+	if (nPoints == 0 || nTargets == 0) {
+		ComplexVec &temp = frame.complexes(nTargets);
+		std::fill(temp.begin(), temp.end(), 0.0);
+		storeResult(temp, values);
+		return;
+	}
+	
+	const double xMin = *std::min_element(x.begin(), x.end());
+	const double xMax = *std::max_element(x.begin(), x.end());
+	const double sMin = *std::min_element(s.begin(), s.end());
+	const double sMax = *std::max_element(s.begin(), s.end());
+	if (!(sMax > sMin)) {
+		// A single target needs no transform
+		directType3(x, strengths, s, values, workspace);
+		return;
+	}
+	const double xCenter = 0.5*(xMin + xMax), sCenter = 0.5*(sMin + sMax);
+	const Type3Params params(0.5*(xMax - xMin), 0.5*(sMax - sMin), eps);
+	const long nGrid  = static_cast<long>(params.nGrid);
+	const long origin = nGrid/2;
+	const double h = params.h;
+	const double twoVar = 2.0*params.sigma*params.sigma;
+	
+	// Spread the strengths, shifted to the center of the targets, 
+	//	using the fast Gaussian gridding factorization of the kernel
+	DoubleVec &e3 = frame.doubles(params.nSpread+1);
+	for (long l = 0; l <= params.nSpread; l++) {
+		e3[l] = exp(-(l*h)*(l*h) / twoVar);
+	}
+	ComplexVec &grid = frame.complexes(nGrid);
+	std::fill(grid.begin(), grid.end(), 0.0);
+	for (size_t j = 0; j < nPoints; j++) {
+		const double xj = x[j] - xCenter;
+		const std::complex<double> strength = strengths[j] 
+				* std::complex<double>(cos(sCenter*xj), sin(sCenter*xj));
+		const long m0 = static_cast<long>(floor(xj/h + 0.5));
+		const double d = xj - m0*h;
+		
+		const double e1 = exp(-d*d / twoVar);
+		const double e2 = exp(d*h / (0.5*twoVar));
+		double e2Pow = pow(e2, static_cast<double>(-params.nSpread));
+		for (long l = -params.nSpread; l <= params.nSpread; l++) {
+			grid[origin + m0 + l] += strength * (e1 * e2Pow * e3[l < 0 ? -l : l]);
+			e2Pow *= e2;
+		}
+	}
+	
+	DoubleVec &phases = frame.doubles(nTargets);
+	for (size_t k = 0; k < nTargets; k++) {
+		phases[k] = (s[k] - sCenter) * h;
+	}
+	ComplexVec &tempValues = frame.complexes(nTargets);
+	nufftType2(grid, phases, tempValues, params.innerEps, workspace);
+	
+	// Divide out the transform of the Gaussian
+	const double norm = h / (params.sigma * sqrt(2.0*pi));
+	for (size_t k = 0; k < nTargets; k++) {
+		const double ds = s[k] - sCenter;
+		tempValues[k] *= std::complex<double>(cos(s[k]*xCenter), sin(s[k]*xCenter)) 
+				* (norm * exp(0.25*twoVar*ds*ds));
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	storeResult(tempValues, values);
+}
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies by 
+ *	direct summation
+ *
+ * @param[in] x		The points, in any order
+ * @param[in] strengths	The strength of each point
+ * @param[in] s		The targets, in any order
+ * @param[out] values	The sum evaluated at each target.
+ *
+ * @pre @p strengths.size() = @p x.size()
+ *
+ * @post @p values.size() = @p s.size()
+ * @post @p values[k] = &sum;<sub>j</sub> @p strengths[j] 
+ *	exp(i @p s[k] @p x[j])
+ *
+ * @perform O(NK) time, where N = @p x.size() and K = @p s.size()
+ * @perfmore O(K) memory
+ *
+ * @exception std::invalid_argument Thrown if @p x and @p strengths have 
+ *	different lengths.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the result.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void directType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values) {
+	directType3(x, strengths, s, values, threadWorkspace());
+}
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies by 
+ *	direct summation, using preallocated memory
+ *
+ * @param[in] x		The points, in any order
+ * @param[in] strengths	The strength of each point
+ * @param[in] s		The targets, in any order
+ * @param[out] values	The sum evaluated at each target.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @pre @p strengths.size() = @p x.size()
+ *
+ * @post As for the version without a Workspace
+ *
+ * @perform O(NK) time, where N = @p x.size() and K = @p s.size()
+ * @perfmore O(K) memory, which is allocated only the first time a 
+ *	Workspace is used
+ *
+ * @exception std::invalid_argument Thrown if @p x and @p strengths have 
+ *	different lengths.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the result.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void directType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values, Workspace &workspace) {
+	const size_t nPoints = x.size();
+	if (strengths.size() != nPoints) {
+		throw std::invalid_argument("Points and strengths in directType3() are not the same length");
+	}
+	
+	ScratchFrame frame(workspace);
+	ComplexVec &temp = frame.complexes(s.size());
+	for (size_t k = 0; k < s.size(); k++) {
+		std::complex<double> sum(0.0, 0.0);
+		for (size_t j = 0; j < nPoints; j++) {
+			sum += strengths[j] * std::complex<double>(cos(s[k]*x[j]), sin(s[k]*x[j]));
+		}
+		temp[k] = sum;
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	storeResult(temp, values);
+}
+
+}		// end kpftimes
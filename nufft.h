@@ -0,0 +1,120 @@
+/** Evaluates Fourier sums at nonuniformly spaced points
+ * @file timescales/nufft.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NUFFTH
+#define NUFFTH
+
+#include <complex>
+#include <vector>
+
+/** A convenient shorthand for vectors of doubles.
+ */
+typedef std::vector<double               >  DoubleVec;
+/** A convenient shorthand for vectors of complex numbers.
+ */
+typedef std::vector<std::complex<double> > ComplexVec;
+
+namespace kpftimes {
+
+class Workspace;
+
+/** Finds an efficient FFT length no shorter than a minimum
+ * @ingroup util
+ */
+size_t niceFftSize(size_t minSize);
+
+/** Evaluates a band-limited Fourier series at arbitrary points (a type 2
+ *	nonuniform FFT)
+ * @ingroup util
+ */
+void nufftType2(const ComplexVec &coeffs, const DoubleVec &x,
+		ComplexVec &values, double eps);
+
+/** Evaluates a band-limited Fourier series at arbitrary points (a type 2
+ *	nonuniform FFT), using preallocated memory
+ * @ingroup util
+ */
+void nufftType2(const ComplexVec &coeffs, const DoubleVec &x,
+		ComplexVec &values, double eps, Workspace &workspace);
+
+/** Evaluates a band-limited Fourier series at arbitrary points by direct 
+ *	summation
+ * @ingroup util
+ */
+void directType2(const ComplexVec &coeffs, const DoubleVec &x,
+		ComplexVec &values);
+
+/** The precision to which lombScargle() and dft() evaluate sums with 
+ *	nufftType3(), relative to the sum of the magnitudes of the terms
+ * @ingroup util
+ */
+const double TYPE3_PRECISION = 1e-12;
+
+/** Returns the size of the grid used by nufftType3()
+ * @ingroup util
+ */
+size_t type3GridSize(double xSpan, double sSpan, double eps);
+
+/** Decides whether a sum over arbitrary points and targets should use 
+ *	nufftType3() instead of direct summation
+ * @ingroup util
+ */
+bool preferType3(size_t nPoints, size_t nTargets, double xSpan, double sSpan, double eps);
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies (a 
+ *	type 3 nonuniform FFT)
+ * @ingroup util
+ */
+void nufftType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values, double eps);
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies (a 
+ *	type 3 nonuniform FFT), using preallocated memory
+ * @ingroup util
+ */
+void nufftType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values, double eps, Workspace &workspace);
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies by 
+ *	direct summation
+ * @ingroup util
+ */
+void directType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values);
+
+/** Evaluates a sum of complex exponentials at arbitrary frequencies by 
+ *	direct summation, using preallocated memory
+ * @ingroup util
+ */
+void directType3(const DoubleVec &x, const ComplexVec &strengths, const DoubleVec &s, 
+		ComplexVec &values, Workspace &workspace);
+
+}	// end kpftimes::
+
+#endif
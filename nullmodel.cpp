@@ -0,0 +1,308 @@
+/** Stochastic noise processes for simulating the null hypothesis of a
+ *	periodogram
+ * @file timescales/nullmodel.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/version.hpp>
+#include "nufft.h"
+#include "tuning.h"
+#include "timescales.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+NullModel::~NullModel() {
+}
+
+/** Returns the number of independent standard normal deviates needed to
+ *	simulate one light curve.
+ *
+ * The default implementation requests one deviate per observation.
+ *
+ * @param[in] times	Times at which the light curve will be simulated
+ *
+ * @return The number of deviates that simulate() expects.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t NullModel::numDeviates(const DoubleVec &times) const {
+	return times.size();
+}
+
+/** Converts independent standard normal deviates into a light curve of
+ *	white Gaussian noise.
+ *
+ * @param[in] times	Times at which the light curve is simulated
+ * @param[in] deviates	Independent draws from a standard normal distribution
+ * @param[out] fluxes	The simulated light curve
+ *
+ * @pre @p deviates.size() = numDeviates(@p times)
+ *
+ * @post @p fluxes.size() = @p times.size()
+ * @post @p fluxes[i] = @p deviates[i], for all i
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception std::bad_alloc Thrown if @p fluxes was not already of the
+ *	correct size and there is not enough memory to resize it.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void WhiteNoise::simulate(const DoubleVec &times, const DoubleVec &deviates,
+		DoubleVec &fluxes) const {
+	fluxes.resize(times.size());
+	std::copy(deviates.begin(), deviates.begin() + times.size(), fluxes.begin());
+}
+
+/** Defines a damped random walk with a particular timescale.
+ *
+ * @param[in] tau	The damping timescale, in the same units as the
+ *			times at which the process will be simulated.
+ *
+ * @pre @p tau > 0
+ *
+ * @exception std::invalid_argument Thrown if @p tau is not positive.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+DampedRandomWalk::DampedRandomWalk(double tau) : NullModel(), tau(tau) {
+	if (tau <= 0.0) {
+		try {
+			throw std::invalid_argument("DampedRandomWalk needs a positive timescale (gave "
+				+ lexical_cast<string>(tau) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("DampedRandomWalk needs a positive timescale");
+		}
+	}
+}
+
+/** Converts independent standard normal deviates into a light curve
+ *	following a damped random walk.
+ *
+ * The damped random walk (an Ornstein-Uhlenbeck process, or continuous
+ * first-order autoregressive process; see @cite DrwQuasars) is a Markov
+ * process, so it can be simulated exactly on an irregular grid using the
+ * recursion x<sub>i</sub> = a<sub>i</sub> x<sub>i-1</sub> +
+ * (1 - a<sub>i</sub><sup>2</sup>)<sup>1/2</sup> z<sub>i</sub>, where
+ * a<sub>i</sub> = exp(-(t<sub>i</sub> - t<sub>i-1</sub>)/&tau;). The
+ * process is started from its stationary distribution.
+ *
+ * @param[in] times	Times at which the light curve is simulated
+ * @param[in] deviates	Independent draws from a standard normal distribution
+ * @param[out] fluxes	The simulated light curve, with unit variance
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p deviates.size() = numDeviates(@p times)
+ *
+ * @post @p fluxes.size() = @p times.size()
+ *
+ * @perform O(N) time, where N = @p times.size()
+ *
+ * @exception std::bad_alloc Thrown if @p fluxes was not already of the
+ *	correct size and there is not enough memory to resize it.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void DampedRandomWalk::simulate(const DoubleVec &times, const DoubleVec &deviates,
+		DoubleVec &fluxes) const {
+	const size_t nTimes = times.size();
+	fluxes.resize(nTimes);
+	if (nTimes == 0) {
+		return;
+	}
+
+	fluxes[0] = deviates[0];
+	for (size_t i = 1; i < nTimes; i++) {
+		double decay = exp(-(times[i] - times[i-1]) / tau);
+		fluxes[i] = decay*fluxes[i-1] + sqrt(1.0 - decay*decay)*deviates[i];
+	}
+}
+
+/** Defines a power-law noise process that is simulated up to the
+ *	pseudo-Nyquist frequency of the cadence.
+ *
+ * @param[in] alpha	The power law index, such that the power spectral
+ *			density is proportional to f<sup>-@p alpha</sup>.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+PowerLawNoise::PowerLawNoise(double alpha) : NullModel(), alpha(alpha), fMax(0.0) {
+}
+
+/** Defines a power-law noise process that is simulated up to a specific
+ *	frequency.
+ *
+ * @param[in] alpha	The power law index, such that the power spectral
+ *			density is proportional to f<sup>-@p alpha</sup>.
+ * @param[in] fMax	The highest frequency to include in the simulated
+ *			noise, in the inverse of the units of the times
+ *			at which the process will be simulated.
+ *
+ * @pre @p fMax > 0
+ *
+ * @exception std::invalid_argument Thrown if @p fMax is not positive.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+PowerLawNoise::PowerLawNoise(double alpha, double fMax) : NullModel(),
+		alpha(alpha), fMax(fMax) {
+	if (fMax <= 0.0) {
+		try {
+			throw std::invalid_argument("PowerLawNoise needs a positive maximum frequency (gave "
+				+ lexical_cast<string>(fMax) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("PowerLawNoise needs a positive maximum frequency");
+		}
+	}
+}
+
+/** Returns the number of Fourier modes used to simulate power-law noise
+ *	at a particular cadence.
+ *
+ * The noise is synthesized over twice the time span of the data, to
+ * suppress the periodicity inherent in a Fourier synthesis.
+ *
+ * @param[in] times	Times at which the light curve will be simulated
+ * @param[in] fMax	The highest frequency requested by the user,
+ *			or 0 to use the pseudo-Nyquist frequency.
+ * @param[out] span	The time span over which the noise is synthesized
+ *
+ * @return The number of modes, each of which needs two deviates.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has
+ *	at most one distinct value.
+ * @exception std::invalid_argument Thrown if @p times has at most one element.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+size_t powerLawModes(const DoubleVec &times, double fMax, double &span) {
+	double range = deltaT(times);
+	double fHigh = (fMax > 0.0 ? fMax : 0.5 * times.size() / range);
+
+	span = 2.0 * range;
+	return static_cast<size_t>(ceil(fHigh * span));
+}
+
+/** @copydoc NullModel::numDeviates()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has
+ *	at most one distinct value.
+ * @exception std::invalid_argument Thrown if @p times has at most one element.
+ */
+size_t PowerLawNoise::numDeviates(const DoubleVec &times) const {
+	double span;
+	return 2 * powerLawModes(times, fMax, span);
+}
+
+/** Converts independent standard normal deviates into a light curve
+ *	following a power-law power spectrum.
+ *
+ * The light curve is generated using the algorithm of @cite RedNoiseSim:
+ * the real and imaginary parts of each Fourier mode are drawn from a normal
+ * distribution whose variance follows the power spectrum. Since the
+ * observation times are irregular, the Fourier series is evaluated using
+ * a nonuniform FFT rather than an inverse FFT followed by interpolation, 
+ * or, for short series where it is faster, by direct summation.
+ *
+ * @param[in] times	Times at which the light curve is simulated
+ * @param[in] deviates	Independent draws from a standard normal distribution
+ * @param[out] fluxes	The simulated light curve, with arbitrary normalization
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p deviates.size() = numDeviates(@p times)
+ *
+ * @post @p fluxes.size() = @p times.size()
+ *
+ * @perform O(M log M + N) time, where N = @p times.size() and M is
+ *	proportional to N (or to the product of @p fMax and the time
+ *	span of @p times, if @p fMax was specified)
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has
+ *	at most one distinct value.
+ * @exception std::invalid_argument Thrown if @p times has at most one
+ *	element or if @p deviates is too short.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	simulate the light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void PowerLawNoise::simulate(const DoubleVec &times, const DoubleVec &deviates,
+		DoubleVec &fluxes) const {
+	double span;
+	const size_t nModes = powerLawModes(times, fMax, span);
+	if (deviates.size() < 2*nModes) {
+		throw std::invalid_argument("Not enough deviates passed to PowerLawNoise::simulate()");
+	}
+
+	// Modes 1 through nModes, stored with an offset so that the
+	//	nonuniform FFT sees them as the upper half of a symmetric band
+	const size_t offset = nModes + 1;
+	ComplexVec coeffs(2*offset, std::complex<double>(0.0, 0.0));
+	for (size_t k = 1; k <= nModes; k++) {
+		double freq = k / span;
+		double amp  = sqrt(0.5 * pow(freq, -alpha));
+		coeffs[offset + k] = amp * std::complex<double>(deviates[2*k-2],
+				-deviates[2*k-1]);
+	}
+
+	DoubleVec phases(times.size());
+	for (size_t i = 0; i < times.size(); i++) {
+		phases[i] = 2.0*pi * (times[i] - times.front()) / span;
+	}
+
+	ComplexVec series;
+	if (nModes >= currentTuning().nufftMinModes) {
+		nufftType2(coeffs, phases, series, 1e-9);
+	} else {
+		// Short series are faster to sum directly
+		directType2(coeffs, phases, series);
+	}
+
+	fluxes.resize(times.size());
+	for (size_t i = 0; i < times.size(); i++) {
+		fluxes[i] = series[i].real();
+	}
+}
+
+}		// end kpftimes
@@ -2,7 +2,7 @@
  * @file timescales/pairwise.cpp
  * @author Krzysztof Findeisen
  * @date Created July 24, 2011
- * @date Last modified October 29, 2013
+ * @date Last modified October 18, 2026
  */ 
 
 /* Copyright 2014, California Institute of Technology.
@@ -38,6 +38,7 @@
 #include "../common/stats.tmp.h"
 #include "timeexcept.h"
 #include "timescales.h"
+#include "utils.h"
 
 namespace kpftimes {
 
@@ -78,15 +79,76 @@ using boost::lexical_cast;
  */
 void dmdt(const DoubleVec &times, const DoubleVec &mags, 
 		DoubleVec &deltaT, DoubleVec &deltaM) {
+	dmdt(times, mags, BoolVec(times.size(), true), deltaT, deltaM);
+}
+
+/** Calculates a &Delta;m&Delta;t plot for a subset of a time series.
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p mags.
+ * 
+ * @param[in] times	Times at which @p mags were taken
+ * @param[in] mags	Magnitude measurements of a source
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[out] deltaT	A list of the time intervals between all pairs of 
+ *			unmasked sources.
+ * @param[out] deltaM	A list of the magnitude difference between each pair in @p deltaT.
+ *
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p mags.size() = @p mask.size() = @p times.size()
+ * @pre @p mags[i] is the magnitude of the source at @p times[i], for all i
+ *
+ * @post @p deltaT.size() = @p deltaM.size() = M(M-1)/2, where M is the 
+ *	number of unmasked epochs
+ * @post @p deltaT is sorted in ascending order
+ * @post Each element of @p deltaT represents the absolute time separation of 
+ * 	a unique pair of unmasked values in @p times, and each element of 
+ *	@p deltaM represents the absolute magnitude separation of a 
+ *	corresponding pair of values in @p mags
+ * 
+ * @perform O(M<sup>2</sup> log M + N) time, where N = times.size() and M 
+ *	is the number of unmasked epochs
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception std::invalid_argument Thrown if @p times, @p mags, and 
+ *	@p mask have different lengths.
+ * @exception std::bad_alloc Thrown if there is not enough memory to compute 
+ *	the &Delta;m&Delta;t plot
+ * 
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void dmdt(const DoubleVec &times, const DoubleVec &mags, const BoolVec &mask, 
+		DoubleVec &deltaT, DoubleVec &deltaM) {
 	size_t nTimes  = times.size();
 	
+	if (mags.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'mags' in dmdt() are not the same length (gave " 
+			+ lexical_cast<string>(nTimes) + " for times and " 
+			+ lexical_cast<string>(mags.size()) + " for mags)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'mags' in dmdt() are not the same length");
+		}
+	}
+	checkMaskSize(nTimes, mask, "dmdt()");
+
+	IndexVec valid;
+	unmaskedIndices(mask, valid);
+	size_t nValid = valid.size();
+
 	// Test for non-uniqueness and sorting
 	bool diffValues = false, sortedTimes = true;
-	for(size_t i = 0; i < nTimes; i++) {
-		if (!diffValues && times[i] != times.front()) {
+	for(size_t i = 0; i < nValid && !diffValues; i++) {
+		if (times[valid[i]] != times[valid.front()]) {
 			diffValues = true;
 		}
-		if (sortedTimes && i > 0 && times[i-1] > times[i]) {
+	}
+	for(size_t i = 1; i < nTimes && sortedTimes; i++) {
+		if (times[i-1] > times[i]) {
 			sortedTimes = false;
 		}
 	}
@@ -96,25 +158,18 @@ void dmdt(const DoubleVec &times, const DoubleVec &mags,
 		throw except::BadLightCurve("Parameter 'times' in dmdt() contains only one unique date");
 	} else if (!sortedTimes) {
 		throw kpfutils::except::NotSorted("Parameter 'times' in dmdt() is not sorted in ascending order");
-	} else if (mags.size() != nTimes) {
-		try {
-			throw std::invalid_argument("Parameters 'times' and 'mags' in dmdt() are not the same length (gave " 
-			+ lexical_cast<string>(nTimes) + " for times and " 
-			+ lexical_cast<string>(mags.size()) + " for mags)");
-		} catch (const boost::bad_lexical_cast& e) {
-			throw std::invalid_argument("Parameters 'times' and 'mags' in dmdt() are not the same length");
-		}
 	}
 
 	// Needed for sorting by deltaT
 	typedef std::vector<std::pair<double, double> > pairVec;
 	pairVec sortableVec;
+	sortableVec.reserve(nValid*(nValid-1)/2);
 	
-	for(size_t i = 0; i < nTimes; i++) {
-		for(size_t j = i+1; j < nTimes; j++) {
+	for(size_t i = 0; i < nValid; i++) {
+		for(size_t j = i+1; j < nValid; j++) {
 			// Time must be first element so that the pairs get sorted properly
-			sortableVec.push_back(std::make_pair(fabs(times[i]-times[j]), 
-					fabs(mags[i]-mags[j]) ));
+			sortableVec.push_back(std::make_pair(fabs(times[valid[i]]-times[valid[j]]), 
+					fabs(mags[valid[i]]-mags[valid[j]]) ));
 		}
 	}
 	
@@ -125,6 +180,8 @@ void dmdt(const DoubleVec &times, const DoubleVec &mags,
 	
 	// copy-and-swap
 	DoubleVec tempTimes, tempMags;
+	tempTimes.reserve(sortableVec.size());
+	tempMags .reserve(sortableVec.size());
 	
 	for(pairVec::const_iterator it = sortableVec.begin(); it != sortableVec.end(); it++) {
 		tempTimes.push_back(it->first );
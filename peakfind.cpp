@@ -3,7 +3,7 @@
  * @author Based on @c count.pro by Ann Marie Cody. Used with permission.
  * @author Krzysztof Findeisen
  * @date Derived from @c count.pro May 14, 2013
- * @date Last modified August 29, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -40,6 +40,7 @@
 #include "../common/stats.tmp.h"
 #include "timescales.h"
 #include "timeexcept.h"
+#include "utils.h"
 
 namespace kpftimes { 
 
@@ -129,36 +130,86 @@ BOOST_CONCEPT_ASSERT((boost::UnaryPredicate<FartherThan, double>));
  */
 void peakFind(const DoubleVec& times, const DoubleVec& data, 
 		double minAmp, DoubleVec& peakTimes, DoubleVec& peakHeights) {
+	peakFind(times, data, BoolVec(times.size(), true), minAmp, peakTimes, peakHeights);
+}
+
+/** Calculates the number of monotonic intervals in a subset of a light 
+ * curve having a magnitude change greater than a threshold
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p data.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] data	The data (typically fluxes or magnitudes) measured 
+ *			at each time
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] minAmp	The smallest change in the value of data to count
+ * @param[out] peakTimes	The times of the endpoints of significant intervals.
+ * @param[out] peakHeights	The heights of the endpoints of significant intervals.	
+ *
+ * @pre @p times contains at least two unmasked values
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p mask.size() = @p times.size()
+ * @pre @p data[i] is the measurement taken at @p times[i], for all i
+ * @pre neither @p times nor @p data contains NaNs at unmasked epochs
+ * @pre @p minAmp > 0
+ *
+ * @post the data previously in @p peakTimes and @p peakData are erased
+ * @post @p peakTimes and @p peakHeights are the same as the output of 
+ *	@ref peakFind(const DoubleVec&, const DoubleVec&, double, DoubleVec&, DoubleVec&) 
+ *	"peakFind()" when called on the unmasked epochs only
+ *
+ * @perform O(N) time, where N = @p times.size()
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times and @p data do not 
+ *	have at least two unmasked values. 
+ * @exception std::invalid_argument Thrown if @p times, @p data, and @p mask 
+ *	do not have the same length or if @p minAmp is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to find 
+ *	the peaks
+ *
+ * @exceptsafe The function parameters are unchanged in the event of 
+ *	an exception.
+ *
+ * @todo Update implementation to match final version in @cite PeakFind
+ */
+void peakFind(const DoubleVec& times, const DoubleVec& data, const BoolVec& mask, 
+		double minAmp, DoubleVec& peakTimes, DoubleVec& peakHeights) {
 	using std::swap;
 
-	const size_t N = times.size();
+	if (times.size() != data.size()) {
+		throw std::invalid_argument("Data and time arrays passed to peakFind() must have the same length (gave " 
+			+ lexical_cast<string>(times.size()) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+	}
+	checkMaskSize(times.size(), mask, "peakFind()");
+
+	IndexVec valid;
+	unmaskedIndices(mask, valid);
+
+	const size_t N = valid.size();
 	if (N < 2) {
 		throw except::BadLightCurve("Cannot find peaks with fewer than 2 data points in peakFind() (gave " 
 			+ lexical_cast<string>(N) + ").");
 	}
-	if (N != data.size()) {
-		throw std::invalid_argument("Data and time arrays passed to peakFind() must have the same length (gave " 
-			+ lexical_cast<string>(N) + " for times and " 
-			+ lexical_cast<string>(data.size()) + " for data)");
-	}
 	if (minAmp <= 0) {
 		throw std::invalid_argument("Need a positive threshold for magnitude changes in peakFind() (gave " 
 			+ lexical_cast<string>(minAmp) + ")");
 	}
 
 	// copy-and-swap
-	DoubleVec tempTimes(1, times.front());
-	DoubleVec tempPeaks(1,  data.front());
+	DoubleVec tempTimes(1, times[valid.front()]);
+	DoubleVec tempPeaks(1,  data[valid.front()]);
 
-	DoubleVec::const_iterator first = std::find_if(data.begin(), data.end(), 
-		FartherThan(data.front(), minAmp) );
+	FartherThan farFromStart(data[valid.front()], minAmp);
+	size_t offset = 0;
+	while (offset < N && !farFromStart(data[valid[offset]])) {
+		offset++;
+	}
 
-	if (first != data.end()) {
-		// offset always non-negative
-		DoubleVec::const_iterator::difference_type offset = (first - data.begin());
-		
-		tempTimes  .push_back(times[offset]);
-		tempPeaks.push_back( data[offset]);
+	if (offset < N) {
+		tempTimes.push_back(times[valid[offset]]);
+		tempPeaks.push_back( data[valid[offset]]);
 		
 		// assert: tempPeaks[0] != tempPeaks[1] by construction of 
 		// first, given minAmp > 0
@@ -187,7 +238,8 @@ void peakFind(const DoubleVec& times, const DoubleVec& data,
 		//	tempPeaks[back] = max data[tempTimes[back-1] .. times[i-1]], and if 
 		//	tempTimes[back-1] is a local maximum, then tempPeaks[back] = 
 		//	min data[tempTimes[back-1] .. times[i-1]]
-		for (size_t i = offset+1; i < data.size(); i++) {
+		for (size_t k = offset+1; k < N; k++) {
+			const size_t i = valid[k];
 			if ( (sign > 0 && data[i] > tempPeaks.back()) || 
 					(sign < 0 && data[i] < tempPeaks.back()) ) {
 				tempPeaks.back() =  data[i];
@@ -242,18 +294,62 @@ void peakFind(const DoubleVec& times, const DoubleVec& data,
  */
 void peakFindTimescales(const DoubleVec& times, const DoubleVec& data, 
 		const DoubleVec& magCuts, DoubleVec& timescales) {
+	peakFindTimescales(times, data, BoolVec(times.size(), true), magCuts, timescales);
+}
+
+/** Calculates the waiting time for variability of a given amplitude as 
+ *	a function of amplitude, for a subset of a light curve
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p data.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] data	The data (typically fluxes or magnitudes) measured 
+ *			at each time
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] magCuts	The variability amplitudes at which to characterize the timescale
+ * @param[out] timescales	The waiting times
+ *
+ * @pre @p times contains at least two unmasked values
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p mask.size() = @p times.size()
+ * @pre @p data[i] is the measurement taken at @p times[i], for all i
+ * @pre neither @p times nor @p data contains NaNs at unmasked epochs
+ * @pre @p magCuts[i] > 0, for all i
+ *
+ * @post the data previously in @p timescales is erased
+ * @post @p timescales.size() = @p magCuts.size()
+ * @post @p timescales[i] is the waiting time for variability greater 
+ *	than @p magCuts[i] in the unmasked data, for all i
+ *
+ * @perform O(CN log N) time, where C = @p magCuts.size() and N = @p times.size()
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times and @p data 
+ *	do not have at least two unmasked values. 
+ * @exception std::invalid_argument Thrown if @p times, @p data, and @p mask 
+ *	do not have the same length or if @p minAmp contains negative values.
+ * @exception std::bad_alloc Thrown if there is not enough memory to compute 
+ *	the timescales
+ *
+ * @exceptsafe The function parameters are unchanged in the event of 
+ *	an exception.
+ */
+void peakFindTimescales(const DoubleVec& times, const DoubleVec& data, 
+		const BoolVec& mask, const DoubleVec& magCuts, DoubleVec& timescales) {
 	using std::swap;
 
-	const size_t N = times.size();
+	if (times.size() != data.size()) {
+		throw std::invalid_argument("Data and time arrays passed to peakFindTimescales() must have the same length (gave " 
+			+ lexical_cast<string>(times.size()) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+	}
+	checkMaskSize(times.size(), mask, "peakFindTimescales()");
+
+	const size_t N = static_cast<size_t>(std::count(mask.begin(), mask.end(), true));
 	if (N < 2) {
 		throw except::BadLightCurve("Cannot find timescales with fewer than 2 data points in peakFindTimescales() (gave " 
 			+ lexical_cast<string>(N) + ").");
 	}
-	if (N != data.size()) {
-		throw std::invalid_argument("Data and time arrays passed to peakFindTimescales() must have the same length (gave " 
-			+ lexical_cast<string>(N) + " for times and " 
-			+ lexical_cast<string>(data.size()) + " for data)");
-	}
 
 	// copy-and-swap
 	DoubleVec tempTimes;
@@ -266,7 +362,7 @@ void peakFindTimescales(const DoubleVec& times, const DoubleVec& data,
 		}
 		
 		DoubleVec peakTimes, peakHeights;
-		peakFind(times, data, *mag, peakTimes, peakHeights);
+		peakFind(times, data, mask, *mag, peakTimes, peakHeights);
 		
 		if (peakTimes.size() > 1) {
 			/** @todo Reimplement using an iterator adapter
@@ -0,0 +1,433 @@
+/** Iterative prewhitening of multiperiodic light curves
+ * @file timescales/prewhiten.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/version.hpp>
+#include "../common/stats.tmp.h"
+#include "timeexcept.h"
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+#if BOOST_VERSION >= 105000
+using boost::math::double_constants::pi;
+#elif BOOST_VERSION >= 103500
+const double pi = boost::math::constants::pi<double>();
+#endif
+
+/** The number of steps of a phasor recurrence between exact evaluations, 
+ *	which keeps the window sums accurate to near machine precision.
+ */
+const size_t WINDOW_RESEED = 256;
+
+/** Adds the phasors of one epoch to a table of window sums.
+ *
+ * @param[in] t		The time of the epoch
+ * @param[in] omStart	The angular frequency of the first table entry
+ * @param[in] omStep	The spacing between table entries
+ * @param[in,out] re, im	The real and imaginary parts of 
+ *				&sum; exp(i &omega; t), at &omega; = 
+ *				@p omStart + k @p omStep
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void addWindowTerms(double t, double omStart, double omStep, DoubleVec &re, DoubleVec &im) {
+	const double stepCos = cos(omStep*t), stepSin = sin(omStep*t);
+	for(size_t start = 0; start < re.size(); start += WINDOW_RESEED) {
+		const size_t end = std::min(start + WINDOW_RESEED, re.size());
+		const double phase = (omStart + start*omStep)*t;
+		double c = cos(phase), s = sin(phase);
+		for(size_t k = start; k < end; k++) {
+			re[k] += c;
+			im[k] += s;
+			const double next = c*stepCos - s*stepSin;
+			s = s*stepCos + c*stepSin;
+			c = next;
+		}
+	}
+}
+
+/** Prepares a light curve for prewhitening.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] fluxes	Flux measurements of a source
+ * @param[in] freqs	The frequency grid over which to search for 
+ *			sinusoids. See freqGen() for a quick way to 
+ *			generate a grid. The periodogram is updated 
+ *			incrementally only if @p freqs is evenly spaced 
+ *			and in ascending order; otherwise it is 
+ *			recomputed after every extraction.
+ * @param[in] refresh	The number of extractions between exact 
+ *			recalculations of the periodogram.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p fluxes.size() = @p times.size()
+ * @pre @p fluxes contains at least two unique values
+ * @pre @p freqs is not empty
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre @p refresh &ge; 1
+ *
+ * @post getPower() is the Lomb-Scargle periodogram of @p fluxes, as 
+ *	calculated by lombScargle()
+ * @post getNumTerms() = 0
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(N + F) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value or if @p fluxes has no variability.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of 
+ *	@p freqs are negative.
+ * @exception std::invalid_argument Thrown if @p times and @p fluxes have 
+ *	different lengths, if @p freqs is empty, or if @p refresh is zero.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+Prewhitener::Prewhitener(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &freqs, size_t refresh) 
+		: times0(), t0(0.0), resid(), meanF(0.0), om(), 
+		cosSum(), sinSum(), cos2(), sin2(), cosOmTau(), sinOmTau(), tc2(), ts2(), 
+		ch(), sh(), power(), regular(false), sumCos(), sumSin(), diffCos(), diffSin(), 
+		refresh(refresh), nTerms(0) {
+	TraceSpan span("Prewhitener");
+	const size_t nTimes = times.size();
+	const size_t nFreq  = freqs.size();
+	
+	// Verify the preconditions
+	if (fluxes.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'fluxes' in Prewhitener() are not the same length (gave " 
+			+ lexical_cast<string>(nTimes) + " for times and " 
+			+ lexical_cast<string>(fluxes.size()) + " for fluxes)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'fluxes' in Prewhitener() are not the same length");
+		}
+	}
+	if (nTimes < 2 || times.front() == times.back()) {
+		throw except::BadLightCurve("Parameter 'times' in Prewhitener() contains only one unique date");
+	}
+	for(size_t j = 1; j < nTimes; j++) {
+		if (times[j-1] > times[j]) {
+			throw kpfutils::except::NotSorted("Parameter 'times' in Prewhitener() is not sorted in ascending order");
+		}
+	}
+	if (nFreq == 0) {
+		throw std::invalid_argument("Parameter 'freqs' in Prewhitener() is empty");
+	}
+	if (refresh < 1) {
+		throw std::invalid_argument("Parameter 'refresh' in Prewhitener() must be positive");
+	}
+	if (kpfutils::variance(fluxes.begin(), fluxes.end()) <= 0.0) {
+		throw except::BadLightCurve("Parameter 'fluxes' in Prewhitener() has no variability");
+	}
+	
+	t0 = times.front();
+	meanF = kpfutils::mean(fluxes.begin(), fluxes.end());
+	times0.resize(nTimes);
+	resid .resize(nTimes);
+	for(size_t j = 0; j < nTimes; j++) {
+		times0[j] = times[j] - t0;
+		resid [j] = fluxes[j] - meanF;
+	}
+	
+	// Equations are best expressed in angular frequency
+	om.resize(nFreq);
+	for(size_t i = 0; i < nFreq; i++) {
+		if (freqs[i] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in Prewhitener() contains negative frequencies");
+		}
+		om[i] = 2.0 * pi * freqs[i];
+	}
+	
+	// Sums that depend only on the cadence
+	cosSum  .assign(nFreq, 0.0);
+	sinSum  .assign(nFreq, 0.0);
+	cos2    .assign(nFreq, 0.0);
+	sin2    .assign(nFreq, 0.0);
+	for(size_t i = 0; i < nFreq; i++) {
+		for(size_t j = 0; j < nTimes; j++) {
+			const double c = cos(om[i]*times0[j]), s = sin(om[i]*times0[j]);
+			cosSum[i] += c;
+			sinSum[i] += s;
+			cos2  [i] += c*c - s*s;
+			sin2  [i] += 2.0*s*c;
+		}
+	}
+	cosOmTau.resize(nFreq);
+	sinOmTau.resize(nFreq);
+	tc2     .resize(nFreq);
+	ts2     .resize(nFreq);
+	for(size_t i = 0; i < nFreq; i++) {
+		// Ref.: W.H. Press and G.B. Rybicki, 1989, ApJ 338, 277, Eq. (2)
+		const double omTau = 0.5 * atan2(sin2[i], cos2[i]);
+		cosOmTau[i] = cos(omTau);
+		sinOmTau[i] = sin(omTau);
+		
+		// Eq. (7); total(cos(t-tau)^2) and total(sin(t-tau)^2) 
+		const double tmp = cos2[i]*cos(2.0*omTau) + sin2[i]*sin(2.0*omTau);
+		tc2[i] = 0.5*(nTimes+tmp);
+		ts2[i] = 0.5*(nTimes-tmp);
+	}
+	
+	// Subtracting a sinusoid at grid frequency p changes the sums at 
+	//	frequency i by window sums at om[i] + om[p] and om[i] - om[p]. 
+	//	On an even grid these are themselves on even grids, so they 
+	//	can be tabulated once.
+	regular = (nFreq >= 2);
+	const double omStep = (om.back() - om.front()) / (nFreq - 1);
+	for(size_t i = 1; i < nFreq && regular; i++) {
+		if (!(omStep > 0.0) 
+				|| fabs(om[i] - (om.front() + i*omStep)) > 1e-10 * om.back()) {
+			regular = false;
+		}
+	}
+	if (regular) {
+		sumCos .assign(2*nFreq - 1, 0.0);
+		sumSin .assign(2*nFreq - 1, 0.0);
+		diffCos.assign(nFreq, 0.0);
+		diffSin.assign(nFreq, 0.0);
+		for(size_t j = 0; j < nTimes; j++) {
+			addWindowTerms(times0[j], 2.0*om.front(), omStep, sumCos, sumSin);
+			addWindowTerms(times0[j], 0.0, omStep, diffCos, diffSin);
+		}
+	}
+	
+	ch   .resize(nFreq);
+	sh   .resize(nFreq);
+	power.resize(nFreq);
+	recompute();
+	findPower();
+}
+
+/** Removes the strongest remaining sinusoid from the light curve.
+ *
+ * The sinusoid, and a constant offset, are fit by least squares at the 
+ * frequency of the highest peak of getPower(). The residuals of the 
+ * fit become the light curve for the next extraction.
+ *
+ * @param[out] amplitude	The semi-amplitude of the sinusoid
+ * @param[out] phase	The phase of the sinusoid, in radians from 0 to 
+ *			2&pi;, such that the sinusoid is @p amplitude 
+ *			sin(2&pi; f t + @p phase) for the times t passed to 
+ *			the constructor.
+ *
+ * @return The frequency f of the sinusoid, which is one of the 
+ *	frequencies passed to the constructor.
+ *
+ * @post getNumTerms() is increased by 1.
+ * @post getPower() is the Lomb-Scargle periodogram of getResiduals(), 
+ *	to within rounding error that is reset every @p refresh extractions
+ *
+ * @perform O(F + N) time, where N is the number of epochs and F the 
+ *	number of frequencies, if the frequency grid is regular and the 
+ *	periodogram is not due for an exact recalculation; O(NF) time 
+ *	otherwise.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the residuals 
+ *	have no remaining signal.
+ *
+ * @exceptsafe The object and the function arguments are unchanged in 
+ *	the event of an exception.
+ */
+double Prewhitener::extract(double &amplitude, double &phase) {
+	TraceSpan span("Prewhitener::extract", nTerms);
+	const size_t peak = std::max_element(power.begin(), power.end()) - power.begin();
+	if (!(power[peak] > 0.0)) {
+		throw except::BadLightCurve("Residuals in Prewhitener::extract() have no periodic signal");
+	}
+	
+	// Least-squares fit of c + a cos(nu t) + b sin(nu t) to residuals 
+	//	with zero mean; eliminating the offset c leaves a 2x2 system
+	const double n    = static_cast<double>(times0.size());
+	const double c1   = cosSum[peak], s1 = sinSum[peak];
+	const double cHat = 0.5*(n + cos2[peak]) - c1*c1/n;
+	const double sHat = 0.5*(n - cos2[peak]) - s1*s1/n;
+	const double xHat = 0.5*sin2[peak] - c1*s1/n;
+	const double det  = cHat*sHat - xHat*xHat;
+	if (!(det > 1e-10*(cHat + sHat)*(cHat + sHat))) {
+		throw except::BadLightCurve("Residuals in Prewhitener::extract() have no periodic signal");
+	}
+	const double a      = ( sHat*ch[peak] - xHat*sh[peak]) / det;
+	const double b      = (-xHat*ch[peak] + cHat*sh[peak]) / det;
+	const double offset = -(a*c1 + b*s1) / n;
+	
+	const double nu = om[peak];
+	amplitude = sqrt(a*a + b*b);
+	phase = fmod(atan2(a, b) - fmod(nu*t0, 2.0*pi), 2.0*pi);
+	if (phase < 0.0) {
+		phase += 2.0*pi;
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	update(peak, offset, a, b);
+	return nu / (2.0*pi);
+}
+
+/** Subtracts a fitted sinusoid from the residuals and updates the sums.
+ *
+ * @param[in] peak	The index of the sinusoid's frequency
+ * @param[in] offset, a, b	The fitted model, offset + a cos(&nu; t) + 
+ *			b sin(&nu; t), with t relative to the first epoch
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void Prewhitener::update(size_t peak, double offset, double a, double b) {
+	const double nu = om[peak];
+	for(size_t j = 0; j < times0.size(); j++) {
+		resid[j] -= offset + a*cos(nu*times0[j]) + b*sin(nu*times0[j]);
+	}
+	nTerms++;
+	
+	if (!regular || nTerms % refresh == 0) {
+		recompute();
+	} else {
+		// sum(cos(nu t) cos(om t)) = (W(om-nu) + W(om+nu))/2, etc., 
+		//	where W(x) = sum(exp(i x t))
+		for(size_t i = 0; i < om.size(); i++) {
+			const double wSumC = sumCos[i + peak], wSumS = sumSin[i + peak];
+			const double wDiffC = (i >= peak ? diffCos[i - peak] :  diffCos[peak - i]);
+			const double wDiffS = (i >= peak ? diffSin[i - peak] : -diffSin[peak - i]);
+			
+			const double cosCos = 0.5*(wDiffC + wSumC), sinSin = 0.5*(wDiffC - wSumC);
+			const double sinCos = 0.5*(wSumS - wDiffS), cosSin = 0.5*(wSumS + wDiffS);
+			ch[i] -= offset*cosSum[i] + a*cosCos + b*sinCos;
+			sh[i] -= offset*sinSum[i] + a*cosSin + b*sinSin;
+		}
+	}
+	findPower();
+}
+
+/** Calculates the sums of the residuals directly.
+ *
+ * The residuals are first recentered, removing any mean left by 
+ * rounding error.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void Prewhitener::recompute() {
+	double shift = 0.0;
+	for(size_t j = 0; j < resid.size(); j++) {
+		shift += resid[j];
+	}
+	shift /= resid.size();
+	for(size_t j = 0; j < resid.size(); j++) {
+		resid[j] -= shift;
+	}
+	meanF += shift;
+	
+	for(size_t i = 0; i < om.size(); i++) {
+		double c = 0.0, s = 0.0;
+		for(size_t j = 0; j < times0.size(); j++) {
+			c += resid[j]*cos(om[i]*times0[j]);
+			s += resid[j]*sin(om[i]*times0[j]);
+		}
+		ch[i] = c;
+		sh[i] = s;
+	}
+}
+
+/** Calculates the periodogram from the current sums.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void Prewhitener::findPower() {
+	double sumSq = 0.0;
+	for(size_t j = 0; j < resid.size(); j++) {
+		sumSq += resid[j]*resid[j];
+	}
+	const double var = sumSq / (resid.size() - 1);
+	
+	for(size_t i = 0; i < om.size(); i++) {
+		// Eq. (3)
+		if (om[i] != 0.0 && var > 0.0) {
+			const double cc = ch[i]*cosOmTau[i] + sh[i]*sinOmTau[i];
+			const double sc = sh[i]*cosOmTau[i] - ch[i]*sinOmTau[i];
+			power[i] = 0.5*(cc*cc / tc2[i] + sc*sc / ts2[i])/var;
+		} else {
+			power[i] = 0.0;
+		}
+	}
+}
+
+/** Returns the periodogram of the residuals.
+ *
+ * @return The Lomb-Scargle power of the residuals at each frequency 
+ *	passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const DoubleVec& Prewhitener::getPower() const {
+	return power;
+}
+
+/** Returns the residuals from all sinusoids extracted so far.
+ *
+ * @return The light curve minus every extracted sinusoid. The mean of 
+ *	the original light curve is kept.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to copy 
+ *	the residuals.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+DoubleVec Prewhitener::getResiduals() const {
+	DoubleVec result(resid);
+	for(size_t j = 0; j < result.size(); j++) {
+		result[j] += meanF;
+	}
+	return result;
+}
+
+/** Returns the number of sinusoids extracted so far.
+ *
+ * @return The number of successful calls to extract().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t Prewhitener::getNumTerms() const {
+	return nTerms;
+}
+
+}		// end kpftimes
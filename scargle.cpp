@@ -3,7 +3,7 @@
  * @author Based on version 1.7 of <code>[scargle.pro](http://astro.uni-tuebingen.de/software/idl/aitlib/timing/scargle.html)</code> by Jrn Wilms, freely distributed as part of the [IAAT Astronomy IDL Library](http://astro.uni-tuebingen.de/software/idl/aitlib/)
  * @author Krzysztof Findeisen
  * @date Derived from @c scargle.pro January 25, 2010
- * @date Last modified November 25, 2013
+ * @date Last modified October 18, 2026
  */ 
 
 /* Copyright 2014, California Institute of Technology.
@@ -36,12 +36,15 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/math/constants/constants.hpp>
 #include <boost/version.hpp>
-#include <boost/smart_ptr.hpp>
-#include <gsl/gsl_randist.h>
-#include <gsl/gsl_rng.h>
-#include "timescales.h"
+#include "kernels.h"
+#include "lssim.h"
+#include "nufft.h"
+#include "tuning.h"
+#include "sharedcache.h"
 #include "utils.h"
-#include "../common/alloc.tmp.h"
+#include "workspace.h"
+#include "timescales.h"
+#include "trace.h"
 #include "../common/stats.tmp.h"
 #include "timeexcept.h"
 
@@ -49,8 +52,6 @@ namespace kpftimes {
 
 using std::string;
 using boost::lexical_cast;
-using boost::shared_ptr;
-using kpfutils::checkAlloc;
 
 #if BOOST_VERSION >= 105000
 using boost::math::double_constants::pi;
@@ -75,10 +76,13 @@ const double pi = boost::math::constants::pi<double>();
  * @pre all elements of @p freqs are &ge; 0
  * 
  * @post @p power.size() = @p freqs.size()
- * @post @p power[i] is the Lomb-Scargle periodogram evaluated at @p freqs[i], for all i
+ * @post @p power[i] is the Lomb-Scargle periodogram evaluated at @p freqs[i], for all i. 
+ *	If F is large, even on a uniform grid, the periodogram is evaluated 
+ *	with a type 3 nonuniform FFT and is accurate only to TYPE3_PRECISION 
+ *	relative to the sums of the magnitudes of their terms.
  *
  * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size()
- * @perfmore O(N + F) memory
+ * @perfmore O(N + F) memory, drawn from threadWorkspace()
  * 
  * @exception kpftimes::except::BadLightCurve Thrown if @p times or @p data has 
  *	at most one distinct value.
@@ -93,59 +97,240 @@ const double pi = boost::math::constants::pi<double>();
  *
  * @exceptsafe The function arguments are unchanged in the event of an exception
  * 
- * @todo Factor this function
+ * @see @ref lombScargle(const DoubleVec&, const DoubleVec&, const BoolVec&, const DoubleVec&, DoubleVec&) 
+ *	"lombScargle()" to exclude some epochs without copying the data, 
+ *	and @ref lombScargle(const LsPlan&, const DoubleVec&, const BoolVec&, DoubleVec&) 
+ *	"lombScargle()" to analyze many light curves with the same cadence.
+ *
  * @todo Find a faster algorithm
- * @todo Optimize for multiple calls with similar (but not identical) values 
- *	of @p times and @p freqs, as would happen in a large survey where some 
- *	epochs of some stars are removed for technical reasons.
  * @todo Verify that input validation is worth the cost
  */
 void lombScargle(const DoubleVec &times, const DoubleVec &data, 
 		const DoubleVec &freqs, DoubleVec &power) {
+	lombScargle(times, data, freqs, power, threadWorkspace());
+}
+
+/** Calculates the Lomb-Scargle periodogram for a time series, using 
+ *	preallocated memory.
+ * 
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] freqs	The frequency grid over which the periodogram should 
+ *			be calculated.
+ * @param[out] power	The periodogram power at each frequency.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p times.size()
+ * @pre @p data has at least two unique values
+ * @pre @p data[i] is the measurement of the source at @p times[i], for all i
+ * @pre all elements of @p freqs are &ge; 0
+ * 
+ * @post @p power.size() = @p freqs.size()
+ * @post @p power[i] is the Lomb-Scargle periodogram evaluated at @p freqs[i], for all i. 
+ *	If F is large, even on a uniform grid, the periodogram is evaluated 
+ *	with a type 3 nonuniform FFT and is accurate only to TYPE3_PRECISION 
+ *	relative to the sums of the magnitudes of their terms.
+ *
+ * @perform O(NF) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(N + F) memory, which is allocated only the first time a 
+ *	Workspace is used
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times or @p data has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of @p freqs are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void lombScargle(const DoubleVec &times, const DoubleVec &data, 
+		const DoubleVec &freqs, DoubleVec &power, Workspace &workspace) {
+	ScratchFrame frame(workspace);
+	BoolVec &allValid = frame.bools(times.size());
+	allValid.assign(times.size(), true);
+	
+	lombScargle(times, data, allValid, freqs, power, workspace);
+}
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series.
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p data. This spares the caller from 
+ * building filtered copies of each light curve.
+ * 
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] freqs	The frequency grid over which the periodogram should 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ * @param[out] power	The periodogram power at each frequency.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p mask.size() = @p times.size()
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre the unmasked elements of @p data contain at least two unique values
+ * @pre @p data[i] is the measurement of the source at @p times[i], for all i
+ * @pre all elements of @p freqs are &ge; 0
+ * 
+ * @post @p power.size() = @p freqs.size()
+ * @post @p power[i] is the Lomb-Scargle periodogram of the unmasked data, 
+ *	evaluated at @p freqs[i], for all i. If F is large, even on a 
+ *	uniform grid, the periodogram is evaluated with a type 3 nonuniform 
+ *	FFT and is accurate only to TYPE3_PRECISION relative to the sums of 
+ *	the magnitudes of their terms.
+ *
+ * @perform O(MF + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = @p freqs.size()
+ * @perfmore O(M + F) memory, drawn from threadWorkspace()
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times or @p data have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of @p freqs are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and 
+ *	@p mask have different lengths.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception
+ */
+void lombScargle(const DoubleVec &times, const DoubleVec &data, 
+		const BoolVec &mask, const DoubleVec &freqs, DoubleVec &power) {
+	lombScargle(times, data, mask, freqs, power, threadWorkspace());
+}
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series, 
+ *	using preallocated memory.
+ *
+ * Epochs for which @p mask is false are ignored, as if they had been 
+ * removed from both @p times and @p data. This spares the caller from 
+ * building filtered copies of each light curve.
+ * 
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] mask	Flags indicating which epochs to use
+ * @param[in] freqs	The frequency grid over which the periodogram should 
+ *			be calculated. See freqGen() for a quick way to 
+ *			generate a grid.
+ * @param[out] power	The periodogram power at each frequency.
+ * @param[in,out] workspace Memory to use for temporary storage. Its 
+ *			contents are not otherwise changed.
+ *
+ * @pre @p times is sorted in ascending order
+ * @pre @p data.size() = @p mask.size() = @p times.size()
+ * @pre the unmasked elements of @p times contain at least two unique values
+ * @pre the unmasked elements of @p data contain at least two unique values
+ * @pre @p data[i] is the measurement of the source at @p times[i], for all i
+ * @pre all elements of @p freqs are &ge; 0
+ * 
+ * @post @p power.size() = @p freqs.size()
+ * @post @p power[i] is the Lomb-Scargle periodogram of the unmasked data, 
+ *	evaluated at @p freqs[i], for all i. If F is large, even on a 
+ *	uniform grid, the periodogram is evaluated with a type 3 nonuniform 
+ *	FFT and is accurate only to TYPE3_PRECISION relative to the sums of 
+ *	the magnitudes of their terms.
+ *
+ * @perform O(MF + N) time, where N = @p times.size(), M is the number of 
+ *	unmasked epochs, and F = @p freqs.size(). If F is large and the 
+ *	frequencies span a modest range, a type 3 nonuniform FFT reduces 
+ *	this to O((M + F) log(1/&epsilon;) + G log G), where G is 
+ *	proportional to the product of the ranges of @p times and @p freqs.
+ * @perfmore O(M + F) memory, which is allocated only the first time a 
+ *	Workspace is used, plus O(G) memory if the FFT is used
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if the unmasked 
+ *	elements of @p times or @p data have at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of @p freqs are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and 
+ *	@p mask have different lengths.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception, except for the memory held by @p workspace.
+ */
+void lombScargle(const DoubleVec &times, const DoubleVec &data, 
+		const BoolVec &mask, const DoubleVec &freqs, DoubleVec &power, 
+		Workspace &workspace) {
+	TraceSpan span("lombScargle");
 	size_t i, j;
 	// Handy initializations
 	size_t nTimes = times.size();
 	
+	// Verify the preconditions
+	if (data.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'data' in lombScargle() are not the same length (gave " 
+			+ lexical_cast<string>(nTimes) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'data' in lombScargle() are not the same length");
+		}
+	}
+	checkMaskSize(nTimes, mask, "lombScargle()");
+
+	// All temporaries come from the workspace
+	ScratchFrame frame(workspace);
+
+	IndexVec &valid = frame.indices(0);
+	for(i = 0; i < nTimes; i++) {
+		if (mask[i]) {
+			valid.push_back(i);
+		}
+	}
+	size_t nValid = valid.size();
+	
 	// make times of manageable size (Scargle periodogram is time-shift invariant)
 	// while we're at it, test for non-uniqueness
+	// Only the unmasked epochs are copied, so the rest of the 
+	//	calculation never sees the masked ones
 	bool diffValues = false, sortedTimes = true;
-	DoubleVec times0(nTimes);
+	DoubleVec &times0 = frame.doubles(nValid), &data0 = frame.doubles(nValid);
 	double t0 = times.front();
+	for(i = 1; i < nTimes && sortedTimes; i++) {
+		if (times[i-1] > times[i]) {
+			sortedTimes = false;
+		}
+	}
 	// Shift the times so t0 = 0
-	for(i = 0; i < nTimes; i++) {
-		times0[i] = times[i] - t0;
-		if (!diffValues && times[i] != t0) {
+	for(i = 0; i < nValid; i++) {
+		times0[i] = times[valid[i]] - t0;
+		data0 [i] =  data[valid[i]];
+		if (!diffValues && times0[i] != times0[0]) {
 			diffValues = true;
 		}
-		if (sortedTimes && i > 0 && times[i-1] > times[i]) {
-			sortedTimes = false;
-		}
 	}
 
-	// Verify the preconditions
 	if (!diffValues) {
 		throw except::BadLightCurve("Parameter 'times' in lombScargle() contains only one unique date");
 	} else if (!sortedTimes) {
 		throw kpfutils::except::NotSorted("Parameter 'times' in lombScargle() is not sorted in ascending order");
-	} else if (data.size() != nTimes) {
-		try {
-			throw std::invalid_argument("Parameters 'times' and 'data' in lombScargle() are not the same length (gave " 
-			+ lexical_cast<string>(nTimes) + " for times and " 
-			+ lexical_cast<string>(data.size()) + " for data)");
-		} catch (const boost::bad_lexical_cast& e) {
-			throw std::invalid_argument("Parameters 'times' and 'data' in lombScargle() are not the same length");
-		}
 	}
 
 	// Full sample variance
-	double var   = kpfutils::variance(data.begin(), data.end());
+	double var   = kpfutils::variance(data0.begin(), data0.end());
 	if (var <= 0.0) {
 		throw except::BadLightCurve("Parameter 'data' in lombScargle() has no variability");
 	}
 
 	size_t nFreq  = freqs.size();
 	// Equations are best expressed in angular frequency
-	DoubleVec om(nFreq);
+	DoubleVec &om = frame.doubles(nFreq);
 	for(i = 0; i < nFreq; i++) {
 		if(freqs[i] < 0) {
 			throw except::NegativeFreq("Parameter 'freqs' in lombScargle() contains negative frequencies");
@@ -154,21 +339,83 @@ void lombScargle(const DoubleVec &times, const DoubleVec &data,
 		}
 	}
 
+	// Subtract mean from data
+	double meanF = kpfutils::mean(data0.begin(), data0.end());
+	
+	for(i = 0; i < nValid; i++) {
+		data0[i] -= meanF;
+	}
+
 	////////////////////////////////
 	// Periodogram
 	// Ref.: W.H. Press and G.B. Rybicki, 1989, ApJ 338, 277
 
-	DoubleVec cosOmTau(nFreq);
-	DoubleVec sinOmTau(nFreq);
-	DoubleVec tc2(nFreq);
-	DoubleVec ts2(nFreq);
-	for (i = 0; i < nFreq; i++) {
-		double s2 = 0.0, c2 = 0.0;
-		for (j = 0; j < nTimes; j++) {
-			s2 += sin(2.0 * om[i] * times0[j]);
-			c2 += cos(2.0 * om[i] * times0[j]);
+	// Sums of sin(2 om t) and cos(2 om t), which depend only on the 
+	//	experimental procedure
+	DoubleVec &sin2 = frame.doubles(nFreq);
+	DoubleVec &cos2 = frame.doubles(nFreq);
+	// Eq. (5); sh and ch, which depend on the data as well
+	DoubleVec &sh = frame.doubles(nFreq);
+	DoubleVec &ch = frame.doubles(nFreq);
+
+	if (nValid <= currentTuning().smallNLimit) {
+		// Loops over so few epochs are mostly overhead, so run them 
+		//	across frequencies instead
+		lsSumsSmall(times0, data0, om, sin2, cos2, sh, ch);
+	} else if (nFreq > 0 && preferType3(nValid, nFreq, times0.back() - times0.front(), 
+			2.0 * (*std::max_element(om.begin(), om.end()) 
+			- *std::min_element(om.begin(), om.end())), TYPE3_PRECISION)) {
+		// Large frequency sets, uniform or not, are too big to sum directly
+		//	The test uses the span of om2, which needs the bigger grid
+		ComplexVec &strengths = frame.complexes(nValid);
+		ComplexVec &sums      = frame.complexes(nFreq);
+		DoubleVec  &om2       = frame.doubles(nFreq);
+		
+		for (j = 0; j < nValid; j++) {
+			strengths[j] = data0[j];
+		}
+		nufftType3(times0, strengths, om, sums, TYPE3_PRECISION, workspace);
+		for (i = 0; i < nFreq; i++) {
+			ch[i] = sums[i].real();
+			sh[i] = sums[i].imag();
 		}
 		
+		strengths.assign(nValid, 1.0);
+		for (i = 0; i < nFreq; i++) {
+			om2[i] = 2.0 * om[i];
+		}
+		nufftType3(times0, strengths, om2, sums, TYPE3_PRECISION, workspace);
+		for (i = 0; i < nFreq; i++) {
+			cos2[i] = sums[i].real();
+			sin2[i] = sums[i].imag();
+		}
+	} else {
+		for (i = 0; i < nFreq; i++) {
+			double s2 = 0.0, c2 = 0.0;
+			for (j = 0; j < nValid; j++) {
+				s2 += sin(2.0 * om[i] * times0[j]);
+				c2 += cos(2.0 * om[i] * times0[j]);
+			}
+			sin2[i] = s2;
+			cos2[i] = c2;
+		}
+		for (i=0; i < nFreq; i++) {
+			sh[i] = 0.0;
+			ch[i] = 0.0;
+			for(j = 0; j < nValid; j++) {
+				sh[i] += data0[j]*sin(om[i]*times0[j]);
+				ch[i] += data0[j]*cos(om[i]*times0[j]);
+			}
+		}
+	}
+
+	DoubleVec &cosOmTau = frame.doubles(nFreq);
+	DoubleVec &sinOmTau = frame.doubles(nFreq);
+	DoubleVec &tc2      = frame.doubles(nFreq);
+	DoubleVec &ts2      = frame.doubles(nFreq);
+	for (i = 0; i < nFreq; i++) {
+		double s2 = sin2[i], c2 = cos2[i];
+		
 		// Eq. (2): Definition -> tan(2omtau)
 		// --- tan(2omtau)  =  s2 / c2
 		double omTau = 0.5 * atan2(s2, c2);
@@ -177,44 +424,15 @@ void lombScargle(const DoubleVec &times, const DoubleVec &data,
 		
 		// Eq. (7); total(cos(t-tau)^2) and total(sin(t-tau)^2) 
 		double tmp = c2*cos(2.0*omTau) + s2*sin(2.0*omTau);
-		tc2[i] = 0.5*(nTimes+tmp);		// total(cos(t-tau)^2)
-		ts2[i] = 0.5*(nTimes-tmp);		// total(sin(t-tau)^2)
-	}
-   
-	// computing the periodogram for the original lc
-   
-	// Subtract mean from data
-	double meanF = kpfutils::mean(data.begin(), data.end());
-	
-	DoubleVec data0(nTimes);
-	for(i = 0; i < nTimes; i++) {
-		data0[i] = data[i] - meanF;
-	}
-
-	////////////////////////////////
-	// These 2-4 vectors depend on the data as well as the 
-	//	experimental procedure
-	// Eq. (5); sh and ch
-	DoubleVec sh(nFreq);
-	DoubleVec ch(nFreq);
-
-	for (i=0; i < nFreq; i++) {
-		sh[i] = 0.0;
-		ch[i] = 0.0;
-		for(j = 0; j < nTimes; j++) {
-			sh[i] += data0[j]*sin(om[i]*times0[j]);
-			ch[i] += data0[j]*cos(om[i]*times0[j]);
-		}
+		tc2[i] = 0.5*(nValid+tmp);		// total(cos(t-tau)^2)
+		ts2[i] = 0.5*(nValid-tmp);		// total(sin(t-tau)^2)
 	}
 
-	// Clean up what we don't need
-	data0.clear();
-
 	////////////////////////////////
 	// Finally the periodogram itself
 
 	// copy-and-swap
-	DoubleVec tempPower(nFreq);
+	DoubleVec &tempPower = frame.doubles(nFreq);
 	
 	for(i=0; i < nFreq; i++) {
 		// Eq. (3)
@@ -229,8 +447,7 @@ void lombScargle(const DoubleVec &times, const DoubleVec &data,
 		}
 	}
 	
-	using std::swap;
-	swap(power, tempPower);
+	storeResult(tempPower, power);
 }
 
 /** Calculates the significance threshold for a Lomb-Scargle periodogram.
@@ -286,44 +503,76 @@ void lombScargle(const DoubleVec &times, const DoubleVec &data,
  * 
  * @exceptsafe The function arguments are unchanged in the event of an exception
  *
- * @todo Factor this function
- * @todo Test the performance advantage AFTER refactoring
+ * @see @ref lsThreshold(const DoubleVec&, const DoubleVec&, double, long, const NullModel&, unsigned long) 
+ *	"lsThreshold()" for a version that supports red noise and reproducible 
+ *	simulations.
+ *
  * @todo Verify that input validation is worth the cost
  */
 double lsThreshold(const DoubleVec &times, const DoubleVec &freqs, 
 		double fap, long nSims) {
-	size_t i, j;
-	// Handy initializations
-	size_t nTimes = times.size();
-	
-	// make times of manageable size (Scargle periodogram is time-shift invariant)
-	// while we're at it, test for non-uniqueness
-	bool diffValues = false, sortedTimes = true;
-	DoubleVec times0(nTimes);
-	double t0 = times.front();
-	// Shift the times so t0 = 0
-	for(i = 0; i < nTimes; i++) {
-		times0[i] = times[i] - t0;
-		if (!diffValues && times[i] != t0) {
-			diffValues = true;
-		}
-		if (sortedTimes && i > 0 && times[i-1] > times[i]) {
-			sortedTimes = false;
-		}
-	}
+	return lsThreshold(times, freqs, fap, nSims, WhiteNoise(), clockSeed());
+}
 
+/** Calculates the significance threshold for a Lomb-Scargle periodogram, 
+ *	given an arbitrary noise model.
+ * 
+ * This function is a generalization of 
+ * @ref lsThreshold(const DoubleVec&, const DoubleVec&, double, long) "lsThreshold()" 
+ * to noise sources other than white noise. The simulations are run in 
+ * blocks, each with its own random number stream derived from @p seed, so 
+ * the result depends only on the arguments and not on how many threads 
+ * were used to compute it.
+ * 
+ * @param[in] times	Times at which data were taken
+ * @param[in] freqs	The frequency grid over which the periodogram was 
+ *			calculated.
+ * @param[in] fap	Desired false alarm probability
+ * @param[in] nSims	Number of simulations to find the FAP power level.
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The random number seed for the simulations
+ *
+ * @return The peak power level that will be reached, with probability @p fap, 
+ *	in a periodogram of the noise process represented by @p model.
+ *
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre 0 < @p fap < 1
+ * @pre @p nSims &ge; 1
+ * @pre @p fap &times; @p nSims >> 1
+ * 
+ * @post The function returns the peak power level observed in the 
+ *	periodograms of (1-@p fap) of observations of @p model, if @p model 
+ *	is sampled at the cadence represented by @p times and the periodogram 
+ *	is measured at frequencies @p freqs.
+ * @post Calling the function twice with the same arguments gives the 
+ *	same result.
+ *
+ * @perform O(NF &times; @p nSims) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(NF) memory
+ * 
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of @p freqs are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p fap is outside (0, 1) or 
+ *	if @p nSims is nonpositive
+ * @exception std::runtime_error Thrown if @p model could not simulate 
+ *	the light curves.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ * 
+ * @exceptsafe The function arguments are unchanged in the event of an exception
+ */
+double lsThreshold(const DoubleVec &times, const DoubleVec &freqs, 
+		double fap, long nSims, const NullModel &model, unsigned long seed) {
+	TraceSpan span("lsThreshold");
 	// Verify the preconditions
-	if (!diffValues) {
-		throw except::BadLightCurve("Parameter 'times' in lsThreshold() contains only one unique date");
-	} else if (!sortedTimes) {
-		throw kpfutils::except::NotSorted("Parameter 'times' in lsThreshold() is not sorted in ascending order");
-	} else if (nSims < 1) {
-		try {
-			throw std::invalid_argument("Must run at least one simulation in lsThreshold() (gave " + lexical_cast<string>(nSims) + ")");
-		} catch (const boost::bad_lexical_cast& e) {
-			throw std::invalid_argument("Must run at least one simulation in lsThreshold().");
-		}
-	} else if (fap >= 1.0 || fap <= 0.0) {
+	checkNumSims(nSims, "lsThreshold()");
+	if (fap >= 1.0 || fap <= 0.0) {
 		try {
 			throw std::invalid_argument("False alarm probability in lsThreshold() must be in the interval (0, 1) (gave " + lexical_cast<string>(fap) + ")");
 		} catch (const boost::bad_lexical_cast& e) {
@@ -333,130 +582,11 @@ double lsThreshold(const DoubleVec &times, const DoubleVec &freqs,
 		throw std::invalid_argument("Not enough simulations in lsThreshold() to get a significant peak at the desired false alarm probability");
 	}
 
-	size_t nFreq  = freqs.size();
-	// Equations are best expressed in angular frequency
-	DoubleVec om(nFreq);
-	for(i = 0; i < nFreq; i++) {
-		if(freqs[i] < 0) {
-			throw except::NegativeFreq("Parameter 'freqs' in lsThreshold() contains negative frequencies");
-		} else {
-			om[i] = 2.0 * pi*freqs[i];
-		}
-	}
+	// The simulator validates times and freqs
+	LsSimulator simulator(times, freqs, "lsThreshold()");
 
-	////////////////////////////////
-	// These four vectors are functions only of om, t, and t.size(), 
-	//	i.e. they depend on the experimental procedure but 
-	//	not the data. We can reuse them for each simulation
-	// Eq. (6); s2, c2
-	DoubleVec cosOmTau(nFreq);
-	DoubleVec sinOmTau(nFreq);
-	DoubleVec tc2(nFreq);
-	DoubleVec ts2(nFreq);
-	for (i = 0; i < nFreq; i++) {
-		double s2 = 0.0, c2 = 0.0;
-		for (j = 0; j < nTimes; j++) {
-			s2 += sin(2.0 * om[i] * times0[j]);
-			c2 += cos(2.0 * om[i] * times0[j]);
-		}
-		
-		// Eq. (2): Definition -> tan(2omtau)
-		// --- tan(2omtau)  =  s2 / c2
-		double omTau = 0.5 * atan2(s2, c2);
-		cosOmTau[i] = cos(omTau);
-		sinOmTau[i] = sin(omTau);
-		
-		// Eq. (7); total(cos(t-tau)^2) and total(sin(t-tau)^2) 
-		double tmp = c2*cos(2.0*omTau) + s2*sin(2.0*omTau);
-		tc2[i] = 0.5*(nTimes+tmp);		// total(cos(t-tau)^2)
-		ts2[i] = 0.5*(nTimes-tmp);		// total(sin(t-tau)^2)
-	}
-   
-	////////////////////////////////
-	// These 2 tables depend only on om and t as well
-	// Eq. (5); sh and ch
-	FastTable sisi(nFreq, nTimes);
-	FastTable coco(nFreq, nTimes);
-
-	for (i=0; i < nFreq; i++) {
-		for(j = 0; j < nTimes; j++) {
-			sisi.at(i,j) = sin(om[i]*times0[j]);
-			coco.at(i,j) = cos(om[i]*times0[j]);
-		}
-	}
-
-	////////////////////////////////
-	// These 2 vectors depend on the data as well as the 
-	//	experimental procedure
-	// Eq. (5); sh and ch
-	DoubleVec sh(nFreq);
-	DoubleVec ch(nFreq);
-
-	//////////////////////////////////////////////////////////////
-	// Simulations
-	
-	DoubleVec psdPeak(nSims); 
-	DoubleVec data(nTimes);
-	double meanF;
-	shared_ptr<gsl_rng> noiseGen(checkAlloc(
-		gsl_rng_alloc(gsl_rng_ranlxd2)), &gsl_rng_free);
-	// Not the cleverest seed, but we only choose one per run of lsThreshold()
-	// I'm hoping that for any reasonable value of nSims two consecutive 
-	//	runs of lsThreshold() should be far enough apart in time that 
-	//	the seeds will be different
-	time_t foo;
-	gsl_rng_set(noiseGen.get(), static_cast<unsigned long>(time(&foo)));
-
-	for(long m = 0; m < nSims; m++) {
-		// white noise simulation
-		meanF = 0.0;
-		for (i = 0; i < nTimes; i++) {
-			data[i] = gsl_ran_ugaussian(noiseGen.get());
-			meanF += data[i];
-		}
-		meanF /= nTimes;
-		for (i = 0; i < nTimes; i++) {
-			data[i] = data[i]-meanF; 	// .. force OBSERVED count rate to zero
-		}
-
-		// Full sample variance
-		double var   = kpfutils::variance(data.begin(), data.end());
-
-		for (i=0; i < nFreq; i++) {
-			sh[i] = 0.0;
-			ch[i] = 0.0;
-			
-			for(j = 0; j < nTimes; j++) {
-				sh[i] += data[j]*sisi.at(i,j);
-				ch[i] += data[j]*coco.at(i,j);
-			}
-		}
-
-		// Eq. (3) ; computing the periodogram for each simulation
-		//	Since we're only interested in the peak of the 
-		//	periodogram, don't calculate the whole thing 
-		//	-- just keep a running max in psdPeak[]
-		double cc = ch[0]*cosOmTau[0] + sh[0]*sinOmTau[0];
-		double sc = sh[0]*cosOmTau[0] - ch[0]*sinOmTau[0];
-		psdPeak[m] = cc*cc / tc2[0] + sc*sc / ts2[0];
-		for (i = 1; i < nFreq; i++) {
-			double pp;
-			if (om[i] != 0.0) {
-				cc = ch[i]*cosOmTau[i] + sh[i]*sinOmTau[i];
-				sc = sh[i]*cosOmTau[i] - ch[i]*sinOmTau[i];
-				pp = cc*cc / tc2[i] + sc*sc / ts2[i];
-			} else {
-				// Use the limit as frequency goes to zero
-				pp = 0.0;
-			}
-
-			if (pp > psdPeak[m]) {
-				psdPeak[m] = pp;
-			}
-		}
-		// correct normalization
-		psdPeak[m] = 0.5 * psdPeak[m]/var;
-	}
+	DoubleVec psdPeak;
+	simulator.simulatePeaks(model, seed, nSims, psdPeak);
 
 	// False Alarm Probability according to simulations
 	// We have all the peaks, now find the fapth percentile
@@ -545,173 +675,219 @@ double lsThreshold(const DoubleVec &times, const DoubleVec &freqs,
  * @test A 100-element nonuniformly sampled time series, unsorted. Expected 
  *	behavior = throw invalid_argument.
  *
- * @todo Factor this function
+ * @see @ref lsNormalEdf(const DoubleVec&, const DoubleVec&, DoubleVec&, DoubleVec&, long, const NullModel&, unsigned long) 
+ *	"lsNormalEdf()" for a version that supports red noise and reproducible 
+ *	simulations.
  */
 void lsNormalEdf(const DoubleVec &times, const DoubleVec &freqs, 
 		DoubleVec &powers, DoubleVec &probs, long nSims) {
-	size_t i, j;
-	// Handy initializations
-	size_t nTimes = times.size();
+	lsNormalEdf(times, freqs, powers, probs, nSims, WhiteNoise(), clockSeed());
+}
+
+/** Calculates the empirical distribution function of false peaks for a 
+ *	Lomb-Scargle periodogram, given an arbitrary noise model.
+ * 
+ * This function is a generalization of 
+ * @ref lsNormalEdf(const DoubleVec&, const DoubleVec&, DoubleVec&, DoubleVec&, long) "lsNormalEdf()" 
+ * to noise sources other than white noise. Red noise models such as 
+ * DampedRandomWalk and PowerLawNoise produce much higher false peaks at 
+ * low frequencies than white noise does, and should be used whenever the 
+ * variability of a source is dominated by such processes. 
+ *
+ * The simulations are run in blocks, each with its own random number 
+ * stream derived from @p seed, so the result depends only on the arguments 
+ * and not on how many threads were used to compute it.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] freqs	The frequency grid over which the periodogram was 
+ *			calculated.
+ * @param[out] powers	The power levels at which the EDF is measured
+ * @param[out] probs	The probability that a periodogram calculated from 
+ *			the noise model has a peak less than or equal to 
+ *			a power level
+ * @param[in] nSims	Number of simulations to find the EDF.
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The random number seed for the simulations
+ * 
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre @p nSims &ge; 1
+ * 
+ * @post @p powers.size() == @p probs.size() == @p nSims
+ * @post @p powers is sorted in ascending order
+ * @post @p probs is sorted in ascending order
+ * 
+ * @post @p powers and @p probs represent an empirical distribution function, 
+ *	such that probs[i] = EDF(powers[i]). The EDF is that of the peak power 
+ *	level observed in the periodograms of observations of @p model, if 
+ *	@p model is sampled at the cadence represented by @p times and the 
+ *	periodogram is measured at frequencies @p freqs.
+ * @post Calling the function twice with the same arguments gives the 
+ *	same result.
+ * 
+ * @perform O(NF &times; @p nSims) time, where N = @p times.size() and F = @p freqs.size()
+ * @perfmore O(NF) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of @p freqs are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p nSims is nonpositive
+ * @exception std::runtime_error Thrown if @p model could not simulate 
+ *	the light curves.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception
+ */
+void lsNormalEdf(const DoubleVec &times, const DoubleVec &freqs, 
+		DoubleVec &powers, DoubleVec &probs, long nSims, 
+		const NullModel &model, unsigned long seed) {
+	TraceSpan span("lsNormalEdf");
+	// Verify the preconditions
+	checkNumSims(nSims, "lsNormalEdf()");
+
+	// The simulator validates times and freqs
+	LsSimulator simulator(times, freqs, "lsNormalEdf()");
+
+	DoubleVec tempPowers;
+	simulator.simulatePeaks(model, seed, nSims, tempPowers);
+
+	std::sort(tempPowers.begin(), tempPowers.end());
+	size_t nPowers = tempPowers.size();
+	DoubleVec tempProbs;
+	tempProbs.reserve(nPowers);
+	for(size_t i = 1; i <= nPowers; i++) {
+		tempProbs.push_back(static_cast<double>(i)/nPowers);
+	}
 	
-	// make times of manageable size (Scargle periodogram is time-shift invariant)
-	// while we're at it, test for non-uniqueness
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(powers, tempPowers);
+	swap(probs , tempProbs );
+}
+
+/** Computes a white or red noise EDF into a cache table.
+ */
+class EdfBuilder : public TableBuilder {
+public:
+	/** Stores the arguments of lsNormalEdf().
+	 */
+	EdfBuilder(const DoubleVec &times, const DoubleVec &freqs, long nSims, 
+			const NullModel &model, unsigned long seed) 
+			: times(times), freqs(freqs), nSims(nSims), model(model), seed(seed) {
+	}
+
+	/** Runs lsNormalEdf() and stores the powers followed by the 
+	 *	probabilities.
+	 */
+	virtual void build(double* table) const {
+		DoubleVec powers, probs;
+		lsNormalEdf(times, freqs, powers, probs, nSims, model, seed);
+		std::copy(powers.begin(), powers.end(), table);
+		std::copy(probs .begin(), probs .end(), table + nSims);
+	}
+
+private:
+	const DoubleVec &times, &freqs;
+	const long nSims;
+	const NullModel &model;
+	const unsigned long seed;
+};
+
+/** Calculates the empirical distribution function of false peaks for a 
+ *	Lomb-Scargle periodogram, sharing the result between processes.
+ * 
+ * This function gives the same result as 
+ * @ref lsNormalEdf(const DoubleVec&, const DoubleVec&, DoubleVec&, DoubleVec&, long, const NullModel&, unsigned long) "lsNormalEdf()", 
+ * but the first process on a node to ask for a given distribution 
+ * publishes it in @p cache, and every later request with the same 
+ * arguments copies it instead of repeating the simulations. Only 
+ * seeded runs can be shared, since unseeded runs are not reproducible.
+ *
+ * @param[in] times	Times at which data were taken
+ * @param[in] freqs	The frequency grid over which the periodogram was 
+ *			calculated.
+ * @param[out] powers	The power levels at which the EDF is measured
+ * @param[out] probs	The probability that a periodogram calculated from 
+ *			the noise model has a peak less than or equal to 
+ *			a power level
+ * @param[in] nSims	Number of simulations to find the EDF.
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The random number seed for the simulations
+ * @param[in,out] cache	The cache in which to look for, or publish, the 
+ *			distribution
+ * 
+ * @pre @p times contains at least two unique values
+ * @pre @p times is sorted in ascending order
+ * @pre all elements of @p freqs are &ge; 0
+ * @pre @p nSims &ge; 1
+ * 
+ * @post @p powers and @p probs are identical to the output of 
+ *	lsNormalEdf() without a cache.
+ * 
+ * @perform O(NF &times; @p nSims) time for the first request on a node, 
+ *	O(N + F + @p nSims) time for later ones, where N = @p times.size() 
+ *	and F = @p freqs.size()
+ * @perfmore O(NF) memory for the first request on a node, 
+ *	O(N + F + @p nSims) memory for later ones
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p times has 
+ *	at most one distinct value.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not in 
+ *	ascending order.
+ * @exception kpftimes::except::NegativeFreq Thrown if some elements of @p freqs are 
+ *	negative.
+ * @exception std::invalid_argument Thrown if @p nSims is nonpositive
+ * @exception std::runtime_error Thrown if @p model could not simulate 
+ *	the light curves.
+ * @exception std::bad_alloc Thrown if there is not enough memory to do the 
+ *	calculations.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception. The cache is unchanged, except that it may have 
+ *	allocated space for the distribution.
+ */
+void lsNormalEdf(const DoubleVec &times, const DoubleVec &freqs, 
+		DoubleVec &powers, DoubleVec &probs, long nSims, 
+		const NullModel &model, unsigned long seed, SharedCache &cache) {
+	checkNumSims(nSims, "lsNormalEdf()");
+	// Fails fast on an invalid cadence, before the fingerprint needs it
+	//	Only the O(N + F) checks, since a cache hit never needs the trig tables
 	bool diffValues = false, sortedTimes = true;
-	DoubleVec times0(nTimes);
-	double t0 = times.front();
-	// Shift the times so t0 = 0
-	for(i = 0; i < nTimes; i++) {
-		times0[i] = times[i] - t0;
-		if (!diffValues && times[i] != t0) {
+	for (size_t i = 1; i < times.size(); i++) {
+		if (times[i] != times.front()) {
 			diffValues = true;
 		}
-		if (sortedTimes && i > 0 && times[i-1] > times[i]) {
+		if (times[i-1] > times[i]) {
 			sortedTimes = false;
 		}
 	}
-
-	// Verify the preconditions
 	if (!diffValues) {
 		throw except::BadLightCurve("Parameter 'times' in lsNormalEdf() contains only one unique date");
 	} else if (!sortedTimes) {
 		throw kpfutils::except::NotSorted("Parameter 'times' in lsNormalEdf() is not sorted in ascending order");
-	} else if (nSims < 1) {
-		try {
-			throw std::invalid_argument("Must run at least one simulation in lsNormalEdf() (gave " + lexical_cast<string>(nSims) + ")");
-		} catch (const boost::bad_lexical_cast& e) {
-			throw std::invalid_argument("Must run at least one simulation in lsNormalEdf().");
-		}
 	}
-
-	size_t nFreq  = freqs.size();
-	// Equations are best expressed in angular frequency
-	DoubleVec om(nFreq);
-	for(i = 0; i < nFreq; i++) {
-		if(freqs[i] < 0) {
-			throw except::NegativeFreq("Parameter 'freq' in lsThreshold() contains negative frequencies");
-		} else {
-			om[i] = 2.0 * pi*freqs[i];
-		}
-	}
-
-	////////////////////////////////
-	// These four vectors are functions only of om, t, and t.size(), 
-	//	i.e. they depend on the experimental procedure but 
-	//	not the data. We can reuse them for each simulation
-	// Eq. (6); s2, c2
-	DoubleVec cosOmTau(nFreq);
-	DoubleVec sinOmTau(nFreq);
-	DoubleVec tc2(nFreq);
-	DoubleVec ts2(nFreq);
-	for (i = 0; i < nFreq; i++) {
-		double s2 = 0.0, c2 = 0.0;
-		for (j = 0; j < nTimes; j++) {
-			s2 += sin(2.0 * om[i] * times0[j]);
-			c2 += cos(2.0 * om[i] * times0[j]);
-		}
-		
-		// Eq. (2): Definition -> tan(2omtau)
-		// --- tan(2omtau)  =  s2 / c2
-		double omTau = 0.5 * atan2(s2, c2);
-		cosOmTau[i] = cos(omTau);
-		sinOmTau[i] = sin(omTau);
-		
-		// Eq. (7); total(cos(t-tau)^2) and total(sin(t-tau)^2) 
-		double tmp = c2*cos(2.0*omTau) + s2*sin(2.0*omTau);
-		tc2[i] = 0.5*(nTimes+tmp);		// total(cos(t-tau)^2)
-		ts2[i] = 0.5*(nTimes-tmp);		// total(sin(t-tau)^2)
-	}
-
-	////////////////////////////////
-	// These 2 tables depend only on om and t as well
-	// Eq. (5); sh and ch
-	FastTable sisi(nFreq, nTimes);
-	FastTable coco(nFreq, nTimes);
-
-	for (i=0; i < nFreq; i++) {
-		for(j = 0; j < nTimes; j++) {
-			sisi.at(i,j) = sin(om[i]*times0[j]);
-			coco.at(i,j) = cos(om[i]*times0[j]);
+	for (size_t i = 0; i < freqs.size(); i++) {
+		if (freqs[i] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in lsNormalEdf() contains negative frequencies");
 		}
 	}
 
-	////////////////////////////////
-	// These 2 vectors depend on the data as well as the 
-	//	experimental procedure
-	// Eq. (5); sh and ch
-	DoubleVec sh(nFreq);
-	DoubleVec ch(nFreq);
-
-	//////////////////////////////////////////////////////////////
-	// Simulations
-	
-	DoubleVec data(nTimes);
-	DoubleVec tempPowers(nSims);
-	double meanF;
-	gsl_rng* noiseGen = gsl_rng_alloc(gsl_rng_ranlxd2);
-	// Not the cleverest seed, but we only choose one per run of lsThreshold()
-	// I'm hoping that for any reasonable value of nSims two consecutive 
-	//	runs of lsThreshold() should be far enough apart in time that 
-	//	the seeds will be different
-	time_t foo;
-	gsl_rng_set(noiseGen, static_cast<unsigned long>(time(&foo)));
-
-	for(long m = 0; m < nSims; m++) {
-		// white noise simulation
-		meanF = 0.0;
-		for (i = 0; i < nTimes; i++) {
-			data[i] = gsl_ran_ugaussian(noiseGen);
-			meanF += data[i];
-		}
-		meanF /= nTimes;
-		for (i = 0; i < nTimes; i++) {
-			data[i] = data[i]-meanF; 	// .. force OBSERVED count rate to zero
-		}
+	const size_t n = static_cast<size_t>(nSims);
+	// The fingerprint only identifies the noise model; the cadence goes 
+	//	into the key in full so that a hash collision can't mix up runs
+	CacheKey key("lsNormalEdf");
+	key.add(times).add(freqs).add(runFingerprint(times, freqs, model)).add(n).add(seed);
+	boost::shared_ptr<const double> table = CacheAccess::table(cache, key, 2*n, 
+		EdfBuilder(times, freqs, nSims, model, seed));
 
-		// Full sample variance
-		double var   = kpfutils::variance(data.begin(), data.end());
-
-		for (i=0; i < nFreq; i++) {
-			sh[i] = 0.0;
-			ch[i] = 0.0;
-			
-			for(j = 0; j < nTimes; j++) {
-				sh[i] += data[j]*sisi.at(i,j);
-				ch[i] += data[j]*coco.at(i,j);
-			}
-		}
-
-		// Eq. (3) ; computing the periodogram for each simulation
-		//	Since we're only interested in the peak of the 
-		//	periodogram, don't calculate the whole thing 
-		//	-- just keep a running max in tempPowers[]
-		double cc = ch[0]*cosOmTau[0] + sh[0]*sinOmTau[0];
-		double sc = sh[0]*cosOmTau[0] - ch[0]*sinOmTau[0];
-		tempPowers[m] = cc*cc / tc2[0] + sc*sc / ts2[0];
-		for (i = 1; i < nFreq; i++) {
-			double pp;
-			if (om[i] != 0.0) {
-				cc = ch[i]*cosOmTau[i] + sh[i]*sinOmTau[i];
-				sc = sh[i]*cosOmTau[i] - ch[i]*sinOmTau[i];
-				pp = cc*cc / tc2[i] + sc*sc / ts2[i];
-			} else {
-				// Use the limit as frequency goes to zero
-				pp = 0.0;
-			}
-
-			if (pp > tempPowers[m]) {
-				tempPowers[m] = pp;
-			}
-		}
-		// correct normalization
-		tempPowers[m] = 0.5 * tempPowers[m]/var;
-	}
-
-	sort(tempPowers.begin(), tempPowers.end());
-	size_t nPowers = tempPowers.size();
-	DoubleVec tempProbs;
-	for(size_t i = 1; i <= nPowers; i++) {
-		tempProbs.push_back(static_cast<double>(i)/nPowers);
-	}
+	DoubleVec tempPowers(table.get(), table.get() + n);
+	DoubleVec tempProbs (table.get() + n, table.get() + 2*n);
 	
 	// IMPORTANT: no exceptions beyond this point
 	
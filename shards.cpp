@@ -0,0 +1,926 @@
+/** Splitting catalogs into shards that can be processed on many nodes
+ * @file timescales/shards.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include "binaryio.h"
+#include "lssim.h"
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::uint32_t;
+using boost::uint64_t;
+
+/** Identifies shard result files
+ */
+const char SHARD_MAGIC[8] = {'K', 'P', 'F', 'T', 'S', 'H', 'D', '1'};
+
+/** Identifies merged result files
+ */
+const char STORE_MAGIC[8] = {'K', 'P', 'F', 'T', 'R', 'E', 'S', '1'};
+
+/** The first line of every manifest
+ */
+const char MANIFEST_HEADER[] = "# Timescales shard manifest";
+
+/** The contents of a manifest file.
+ */
+struct Manifest {
+	Manifest() : catalogFile(), nObjects(0), firsts(), counts() {
+	}
+
+	/** The catalog being processed */
+	string catalogFile;
+	/** The number of objects in the catalog */
+	size_t nObjects;
+	/** The first object and number of objects in each shard */
+	std::vector<size_t> firsts, counts;
+};
+
+/** The state of an open result store.
+ */
+struct ResultStore::Impl {
+	explicit Impl(const string &fileName);
+
+	string fileName;
+	std::ifstream in;
+	size_t resultSize;
+	// Sorted by ID
+	std::vector<uint64_t> ids, offsets;
+};
+
+/** Does nothing.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+ShardTask::~ShardTask() {
+}
+
+/** Reads a manifest file.
+ *
+ * @param[in] manifestFile	A file written by writeManifest()
+ * @param[out] manifest		The contents of the file
+ *
+ * @exception std::runtime_error Thrown if the file could not be read or 
+ *	is not a valid manifest.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the manifest.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readManifest(const string &manifestFile, Manifest &manifest) {
+	std::ifstream in(manifestFile.c_str());
+	if (!in) {
+		throw std::runtime_error("Could not open manifest file " + manifestFile);
+	}
+	
+	Manifest temp;
+	string header, keyword;
+	size_t nShards = 0;
+	std::getline(in, header);
+	in >> keyword;
+	if (!in || header != MANIFEST_HEADER || keyword != "catalog") {
+		throw std::runtime_error(manifestFile + " is not a Timescales manifest file");
+	}
+	in >> std::ws;
+	std::getline(in, temp.catalogFile);
+	in >> keyword >> temp.nObjects;
+	if (keyword != "objects") {
+		in.setstate(std::ios::failbit);
+	}
+	in >> keyword >> nShards;
+	if (keyword != "shards") {
+		in.setstate(std::ios::failbit);
+	}
+	
+	size_t expected = 0;
+	for(size_t i = 0; i < nShards && in; i++) {
+		size_t first = 0, count = 0;
+		in >> first >> count;
+		if (first != expected || count > temp.nObjects - first) {
+			in.setstate(std::ios::failbit);
+		}
+		temp.firsts.push_back(first);
+		temp.counts.push_back(count);
+		expected = first + count;
+	}
+	if (!in || expected != temp.nObjects) {
+		throw std::runtime_error("Manifest file " + manifestFile + " is corrupted");
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(manifest.catalogFile, temp.catalogFile);
+	manifest.nObjects = temp.nObjects;
+	swap(manifest.firsts, temp.firsts);
+	swap(manifest.counts, temp.counts);
+}
+
+/** Divides a catalog into shards of consecutive objects.
+ *
+ * The division depends only on the number of objects in the catalog and 
+ * on @p shardSize, so every node that reads the manifest sees the same 
+ * shards.
+ *
+ * @param[in] catalogFile	The catalog to divide. Should be an absolute 
+ *				path, or a path relative to the directory in 
+ *				which runShards() will be called.
+ * @param[in] shardSize		The number of objects in each shard. The 
+ *				last shard may be smaller.
+ * @param[in] manifestFile	The file to write. It is first written under 
+ *				a temporary name, then renamed, so an existing 
+ *				manifest is replaced atomically.
+ *
+ * @pre @p shardSize &ge; 1
+ *
+ * @post @p manifestFile lists ceil(M / @p shardSize) shards, where M is 
+ *	the number of objects in the catalog.
+ *
+ * @perform O(M) time
+ *
+ * @exception std::invalid_argument Thrown if @p shardSize is zero.
+ * @exception std::runtime_error Thrown if the catalog could not be read 
+ *	or the manifest could not be written.
+ *
+ * @exceptsafe If an exception is thrown, any existing file named 
+ *	@p manifestFile is unchanged.
+ */
+void writeManifest(const string &catalogFile, size_t shardSize, const string &manifestFile) {
+	if (shardSize == 0) {
+		throw std::invalid_argument("writeManifest() needs at least one object per shard");
+	}
+	const size_t nObjects = CatalogReader(catalogFile).size();
+	const size_t nShards  = (nObjects + shardSize - 1) / shardSize;
+	
+	const string tempName = manifestFile + ".tmp";
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::trunc);
+		out << MANIFEST_HEADER << "\n";
+		out << "catalog " << catalogFile << "\n";
+		out << "objects " << nObjects << "\n";
+		out << "shards " << nShards << "\n";
+		for(size_t first = 0; first < nObjects; first += shardSize) {
+			out << first << " " << std::min(shardSize, nObjects - first) << "\n";
+		}
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write manifest file " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), manifestFile.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not replace manifest file " + manifestFile);
+	}
+}
+
+/** Returns the name of a file belonging to a shard.
+ *
+ * @param[in] workDir	The directory holding the shard files
+ * @param[in] shard	The index of the shard
+ * @param[in] suffix	The kind of file
+ *
+ * @return The path to the file.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the name.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+string shardFile(const string &workDir, size_t shard, const string &suffix) {
+	char number[32];
+	sprintf(number, "%06lu", static_cast<unsigned long>(shard));
+	return workDir + "/shard_" + number + suffix;
+}
+
+/** Tests whether a file exists.
+ *
+ * @param[in] fileName	The file to test
+ *
+ * @return True if @p fileName exists.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool fileExists(const string &fileName) {
+	struct stat info;
+	return stat(fileName.c_str(), &info) == 0;
+}
+
+/** Returns a name for this process that is unique across nodes.
+ *
+ * @return The host name and process ID.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the name.
+ *
+ * @exceptsafe Does not throw exceptions other than bad_alloc.
+ */
+string processTag() {
+	char host[256] = "";
+	if (gethostname(host, sizeof(host) - 1) != 0) {
+		strcpy(host, "unknown");
+	}
+	host[sizeof(host) - 1] = '\0';
+	return string(host) + "." + lexical_cast<string>(getpid());
+}
+
+/** Claims a shard for this process.
+ *
+ * A shard is claimed by creating its claim file exclusively. A claim 
+ * whose file has not been touched for @p staleAfter seconds is assumed 
+ * to belong to a dead process, and is taken over.
+ *
+ * @param[in] claimFile		The claim file of the shard
+ * @param[in] tag		The name of this process
+ * @param[in] staleAfter	The age at which a claim is abandoned, in 
+ *				seconds
+ *
+ * @return True if this process now owns the shard.
+ *
+ * @exception std::runtime_error Thrown if the claim file could not be 
+ *	created for any reason other than an existing claim.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+bool claimShard(const string &claimFile, const string &tag, double staleAfter) {
+	for(int attempt = 0; attempt < 2; attempt++) {
+		int fd = open(claimFile.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+		if (fd >= 0) {
+			ssize_t written = write(fd, tag.c_str(), tag.size());
+			close(fd);
+			return written >= 0;
+		} else if (errno != EEXIST) {
+			throw std::runtime_error("Could not create claim file " + claimFile 
+				+ ": " + strerror(errno));
+		}
+		
+		struct stat info;
+		if (stat(claimFile.c_str(), &info) == 0 
+				&& difftime(time(NULL), info.st_mtime) < staleAfter) {
+			return false;
+		}
+		// Owner presumed dead. If two processes take over at once, the 
+		//	shard is done twice, which wastes time but gives the same files
+		unlink(claimFile.c_str());
+	}
+	return false;
+}
+
+/** Gives up this process's claim on a shard.
+ *
+ * The claim file is only removed if it still names this process. If 
+ * another process has taken over the claim, removing its file would let 
+ * a third process start the same shard.
+ *
+ * @param[in] claimFile	The claim file of the shard
+ * @param[in] tag	The name of this process
+ *
+ * @post If @p claimFile held @p tag, it no longer exists.
+ *
+ * @note A process that takes over the claim between the check and the 
+ *	removal still loses its claim. This needs the claim to go stale 
+ *	at the instant this process finishes, and at worst repeats the 
+ *	shard.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void releaseClaim(const string &claimFile, const string &tag) {
+	int fd = open(claimFile.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+	char owner[512];
+	ssize_t length = read(fd, owner, sizeof(owner));
+	close(fd);
+	if (length >= 0 && static_cast<size_t>(length) == tag.size() 
+			&& tag.compare(0, tag.size(), owner, tag.size()) == 0) {
+		unlink(claimFile.c_str());
+	}
+}
+
+/** Writes a file under a temporary name, then renames it into place.
+ *
+ * @param[in] fileName	The file to create
+ * @param[in] tag	The name of this process, used for the temporary name
+ * @param[in] contents	The text to write
+ * @param[in] description	What the file is, for error messages
+ *
+ * @post @p fileName holds @p contents.
+ *
+ * @exception std::runtime_error Thrown if the file could not be written.
+ *
+ * @exceptsafe No file is created in the event of an exception.
+ */
+void publishText(const string &fileName, const string &tag, const string &contents, 
+		const string &description) {
+	const string tempName = fileName + "." + tag;
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::trunc);
+		out << contents;
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write " + description + " " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not create " + description + " " + fileName);
+	}
+}
+
+/** Processes one shard and publishes its results.
+ *
+ * @param[in] catalog	The catalog being processed
+ * @param[in] manifest	The division of the catalog into shards
+ * @param[in] shard	The shard to process
+ * @param[in] workDir	The directory holding the shard files
+ * @param[in] tag	The name of this process
+ * @param[in,out] task	The calculation to run on each object
+ * @param[in,out] failed	The IDs of the objects in this shard that 
+ *			could not be processed are appended to @p failed.
+ *
+ * @post The shard's result file, failure list, and completion marker 
+ *	exist. The failure list holds the ID of each object for which 
+ *	@p task threw an exception or returned the wrong number of 
+ *	values, one per line; the results of those objects are NaN.
+ *
+ * @exception std::runtime_error Thrown if the catalog could not be read 
+ *	or the results could not be written.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	process the shard, including if @p task throws bad_alloc.
+ *
+ * @exceptsafe No completion marker is created and @p failed is unchanged 
+ *	in the event of an exception.
+ */
+void processShard(const CatalogReader &catalog, const Manifest &manifest, size_t shard, 
+		const string &workDir, const string &tag, ShardTask &task, 
+		std::vector<unsigned long> &failed) {
+	const string resultFile = shardFile(workDir, shard, ".res");
+	const string claimFile  = shardFile(workDir, shard, ".claim");
+	const string tempName   = resultFile + "." + tag;
+	const size_t nValues    = task.resultSize();
+	const size_t first      = manifest.firsts[shard];
+	const size_t count      = manifest.counts[shard];
+	TraceSpan span("processShard", shard);
+	
+	std::vector<unsigned long> shardFailed;
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(SHARD_MAGIC, sizeof(SHARD_MAGIC));
+		writeRaw(out, BYTE_ORDER_MARK);
+		writeRaw(out, static_cast<uint32_t>(0));
+		writeRaw(out, static_cast<uint64_t>(shard));
+		writeRaw(out, static_cast<uint64_t>(first));
+		writeRaw(out, static_cast<uint64_t>(count));
+		writeRaw(out, static_cast<uint64_t>(nValues));
+		
+		DoubleVec times, fluxes, result;
+		double lastTouch = wallClock();
+		try {
+			for(size_t object = first; object < first + count && out; object++) {
+				TraceSpan span("ShardTask::process", catalog.getId(object));
+				catalog.read(object, times, fluxes);
+				result.assign(nValues, 0.0);
+				try {
+					task.process(times, fluxes, result);
+				} catch (const std::bad_alloc &e) {
+					// Not a problem with this object; let runShards() stop 
+					//	without marking the shard complete
+					throw;
+				} catch (const std::exception &e) {
+					result.clear();
+				}
+				if (result.size() != nValues) {
+					result.assign(nValues, std::numeric_limits<double>::quiet_NaN());
+					shardFailed.push_back(catalog.getId(object));
+				}
+				
+				writeRaw(out, static_cast<uint64_t>(catalog.getId(object)));
+				if (nValues > 0) {
+					out.write(reinterpret_cast<const char*>(&result[0]), nValues*sizeof(double));
+				}
+				
+				// Show other nodes that the claim is still alive
+				if (wallClock() - lastTouch > 1.0) {
+					utime(claimFile.c_str(), NULL);
+					lastTouch = wallClock();
+				}
+			}
+		} catch (...) {
+			out.close();
+			std::remove(tempName.c_str());
+			throw;
+		}
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write shard file " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), resultFile.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not create shard file " + resultFile);
+	}
+	
+	string failedList;
+	for(size_t i = 0; i < shardFailed.size(); i++) {
+		failedList += lexical_cast<string>(shardFailed[i]) + "\n";
+	}
+	publishText(shardFile(workDir, shard, ".failed"), tag, failedList, "failure list");
+	failed.reserve(failed.size() + shardFailed.size());
+	
+	// The marker is only created once the results are in place
+	publishText(shardFile(workDir, shard, ".done"), tag, tag + "\n", "completion marker");
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	failed.insert(failed.end(), shardFailed.begin(), shardFailed.end());
+}
+
+/** Processes the unfinished shards of a manifest.
+ *
+ * Any number of processes, on any number of nodes, may call runShards() 
+ * on the same manifest and working directory at once. Each shard is 
+ * claimed by one process, processed, and published with a result file 
+ * and a completion marker. A shard whose claim has not been updated in 
+ * @p staleAfter seconds is assumed to have been abandoned by a process 
+ * that crashed, and is processed again. Completed shards are never 
+ * processed again, so runShards() can simply be rerun after a failure.
+ *
+ * Objects for which @p task throws an exception get NaN for all their 
+ * values. Their IDs are listed, one per line, in a failure list 
+ * (<tt>shard_</tt><i>NNNNNN</i><tt>.failed</tt>) that is published in 
+ * @p workDir with each shard, whichever process ran it.
+ *
+ * A process shows that it is still working on a shard by touching the 
+ * claim file after each object, at most once a second. A single object 
+ * that takes longer than @p staleAfter to process therefore looks like 
+ * an abandoned shard, and other processes will take it over while it 
+ * is still in progress.
+ *
+ * The processes share nothing but the filesystem, so claims only work 
+ * as intended if the nodes' clocks agree to much better than 
+ * @p staleAfter. A shard may occasionally be processed twice, but 
+ * since its results are replaced atomically and depend only on the 
+ * catalog, this wastes time without changing the output.
+ *
+ * @param[in] manifestFile	A file written by writeManifest()
+ * @param[in] workDir		A directory, visible to every node, in which 
+ *				to store shard results and markers
+ * @param[in,out] task		The calculation to run on each object
+ * @param[out] failed		The IDs of the objects, in the shards 
+ *				processed by this call, for which @p task 
+ *				threw an exception.
+ * @param[in] staleAfter	The number of seconds after which a claim 
+ *				with no sign of progress is abandoned
+ *
+ * @return The number of shards processed by this call.
+ *
+ * @pre @p staleAfter > 0
+ * @pre @p staleAfter is much longer than the time needed to process 
+ *	any single object
+ * @pre @p task gives the same results for an object regardless of 
+ *	which process runs it
+ *
+ * @post Every shard is either complete, or claimed by another process 
+ *	that is still making progress.
+ *
+ * @perform O(M) time for M objects in the catalog, plus the time to 
+ *	process the objects in the shards this call claims
+ * @perfmore O(M + N) memory, where N is the length of the longest light 
+ *	curve
+ *
+ * @exception std::invalid_argument Thrown if @p staleAfter is not positive.
+ * @exception std::runtime_error Thrown if the manifest or catalog could 
+ *	not be read, if they do not match, or if results could not be 
+ *	written.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	process a shard, or if @p task throws bad_alloc.
+ *
+ * @exceptsafe Shards completed before an exception remain complete. The 
+ *	shard in progress is not marked complete. @p failed is unchanged.
+ */
+size_t runShards(const string &manifestFile, const string &workDir, ShardTask &task, 
+		std::vector<unsigned long> &failed, double staleAfter) {
+	if (!(staleAfter > 0.0)) {
+		try {
+			throw std::invalid_argument("Argument 'staleAfter' to runShards() must be positive (gave " 
+				+ lexical_cast<string>(staleAfter) + ")");
+		} catch (const boost::bad_lexical_cast &e) {
+			throw std::invalid_argument("Argument 'staleAfter' to runShards() must be positive");
+		}
+	}
+	
+	Manifest manifest;
+	readManifest(manifestFile, manifest);
+	CatalogReader catalog(manifest.catalogFile);
+	if (catalog.size() != manifest.nObjects) {
+		throw std::runtime_error("Catalog " + manifest.catalogFile 
+			+ " does not match manifest " + manifestFile);
+	}
+	const size_t nShards = manifest.firsts.size();
+	if (nShards == 0) {
+		return 0;
+	}
+	
+	// Start each process at a different shard, to reduce contention
+	const string tag = processTag();
+	unsigned long start = 0;
+	for(size_t i = 0; i < tag.size(); i++) {
+		start = 31*start + static_cast<unsigned char>(tag[i]);
+	}
+	start %= nShards;
+	
+	std::vector<unsigned long> tempFailed;
+	size_t nProcessed = 0;
+	for(size_t i = 0; i < nShards; i++) {
+		const size_t shard = (start + i) % nShards;
+		const string doneFile  = shardFile(workDir, shard, ".done");
+		const string claimFile = shardFile(workDir, shard, ".claim");
+		
+		if (fileExists(doneFile) || !claimShard(claimFile, tag, staleAfter)) {
+			continue;
+		}
+		// The previous owner may have finished just before losing its claim
+		if (!fileExists(doneFile)) {
+			try {
+				processShard(catalog, manifest, shard, workDir, tag, task, tempFailed);
+			} catch (...) {
+				releaseClaim(claimFile, tag);
+				throw;
+			}
+			nProcessed++;
+		}
+		releaseClaim(claimFile, tag);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(failed, tempFailed);
+	return nProcessed;
+}
+
+/** Processes the unfinished shards of a manifest, without reporting 
+ *	which objects failed.
+ *
+ * Identical to @ref runShards(const std::string&, const std::string&, ShardTask&, std::vector<unsigned long>&, double) 
+ * "runShards()", except that the IDs of failed objects are only 
+ * recorded in the shards' failure lists.
+ *
+ * @param[in] manifestFile	A file written by writeManifest()
+ * @param[in] workDir		A directory, visible to every node, in which 
+ *				to store shard results and markers
+ * @param[in,out] task		The calculation to run on each object
+ * @param[in] staleAfter	The number of seconds after which a claim 
+ *				with no sign of progress is abandoned
+ *
+ * @return The number of shards processed by this call.
+ *
+ * @pre @p staleAfter > 0
+ * @pre @p staleAfter is much longer than the time needed to process 
+ *	any single object
+ * @pre @p task gives the same results for an object regardless of 
+ *	which process runs it
+ *
+ * @exception std::invalid_argument Thrown if @p staleAfter is not positive.
+ * @exception std::runtime_error Thrown if the manifest or catalog could 
+ *	not be read, if they do not match, or if results could not be 
+ *	written.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	process a shard, or if @p task throws bad_alloc.
+ *
+ * @exceptsafe Shards completed before an exception remain complete. The 
+ *	shard in progress is not marked complete.
+ */
+size_t runShards(const string &manifestFile, const string &workDir, ShardTask &task, 
+		double staleAfter) {
+	std::vector<unsigned long> failed;
+	return runShards(manifestFile, workDir, task, failed, staleAfter);
+}
+
+/** Combines the results of all shards into a single file.
+ *
+ * The merged file lists every object's results in catalog order, with an 
+ * index sorted by object ID. The output depends only on the catalog and 
+ * the task, not on which processes handled which shards.
+ *
+ * @param[in] manifestFile	A file written by writeManifest()
+ * @param[in] workDir		The directory passed to runShards()
+ * @param[in] storeFile		The file to write. It is first written under 
+ *				a temporary name, then renamed, so an existing 
+ *				file is replaced atomically.
+ *
+ * @pre Every shard in the manifest has been completed by runShards()
+ * @pre Object IDs in the catalog are unique
+ *
+ * @post @p storeFile can be read by ResultStore.
+ *
+ * @perform O(MV + M log M) time, where M is the number of objects in the 
+ *	catalog and V is the number of values per object
+ * @perfmore O(M) memory
+ *
+ * @exception std::runtime_error Thrown if some shards are unfinished, if 
+ *	any file could not be read or written, if the shard files are 
+ *	inconsistent with the manifest or each other, or if the catalog 
+ *	has duplicate IDs.
+ * @exception std::bad_alloc Thrown if there is not enough memory for the 
+ *	index.
+ *
+ * @exceptsafe If an exception is thrown, any existing file named 
+ *	@p storeFile is unchanged.
+ */
+void mergeShards(const string &manifestFile, const string &workDir, const string &storeFile) {
+	Manifest manifest;
+	readManifest(manifestFile, manifest);
+	const size_t nShards = manifest.firsts.size();
+	
+	size_t nMissing = 0;
+	for(size_t shard = 0; shard < nShards; shard++) {
+		if (!fileExists(shardFile(workDir, shard, ".done"))) {
+			nMissing++;
+		}
+	}
+	if (nMissing > 0) {
+		throw std::runtime_error(lexical_cast<string>(nMissing) + " of " 
+			+ lexical_cast<string>(nShards) + " shards in " + manifestFile 
+			+ " are unfinished");
+	}
+	
+	// Find the result size before writing the header
+	uint64_t nValues = 0;
+	for(size_t shard = 0; shard < nShards; shard++) {
+		const string resultFile = shardFile(workDir, shard, ".res");
+		std::ifstream in(resultFile.c_str(), std::ios::in | std::ios::binary);
+		char magic[sizeof(SHARD_MAGIC)];
+		uint32_t order = 0, reserved = 0;
+		uint64_t fileShard = 0, first = 0, count = 0, fileValues = 0;
+		in.read(magic, sizeof(magic));
+		readRaw(in, order);
+		readRaw(in, reserved);
+		readRaw(in, fileShard);
+		readRaw(in, first);
+		readRaw(in, count);
+		readRaw(in, fileValues);
+		if (!in || !std::equal(magic, magic+sizeof(magic), SHARD_MAGIC) 
+				|| order != BYTE_ORDER_MARK || fileShard != shard 
+				|| first != manifest.firsts[shard] || count != manifest.counts[shard] 
+				|| (shard > 0 && fileValues != nValues)) {
+			throw std::runtime_error("Shard file " + resultFile 
+				+ " does not match manifest " + manifestFile);
+		}
+		nValues = fileValues;
+	}
+	
+	const string tempName = storeFile + ".tmp";
+	std::vector<std::pair<uint64_t, uint64_t> > index;
+	index.reserve(manifest.nObjects);
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(STORE_MAGIC, sizeof(STORE_MAGIC));
+		writeRaw(out, BYTE_ORDER_MARK);
+		writeRaw(out, static_cast<uint32_t>(0));
+		writeRaw(out, static_cast<uint64_t>(manifest.nObjects));
+		writeRaw(out, nValues);
+		const std::streampos indexStart = out.tellp();
+		const char zeros[2*sizeof(uint64_t)] = {0};
+		for(size_t i = 0; i < manifest.nObjects && out; i++) {
+			out.write(zeros, sizeof(zeros));
+		}
+		
+		DoubleVec values(nValues);
+		for(size_t shard = 0; shard < nShards && out; shard++) {
+			const string resultFile = shardFile(workDir, shard, ".res");
+			std::ifstream in(resultFile.c_str(), std::ios::in | std::ios::binary);
+			in.seekg(sizeof(SHARD_MAGIC) + 2*sizeof(uint32_t) + 4*sizeof(uint64_t));
+			for(size_t i = 0; i < manifest.counts[shard]; i++) {
+				uint64_t id = 0;
+				readRaw(in, id);
+				if (nValues > 0) {
+					in.read(reinterpret_cast<char*>(&values[0]), nValues*sizeof(double));
+				}
+				if (!in) {
+					out.close();
+					std::remove(tempName.c_str());
+					throw std::runtime_error("Shard file " + resultFile + " is truncated");
+				}
+				index.push_back(std::make_pair(id, static_cast<uint64_t>(out.tellp())));
+				if (nValues > 0) {
+					out.write(reinterpret_cast<const char*>(&values[0]), nValues*sizeof(double));
+				}
+			}
+		}
+		
+		std::sort(index.begin(), index.end());
+		for(size_t i = 1; i < index.size(); i++) {
+			if (index[i].first == index[i-1].first) {
+				out.close();
+				std::remove(tempName.c_str());
+				throw std::runtime_error("Catalog " + manifest.catalogFile 
+					+ " has more than one object with ID " 
+					+ lexical_cast<string>(index[i].first));
+			}
+		}
+		out.seekp(indexStart);
+		for(size_t i = 0; i < index.size(); i++) {
+			writeRaw(out, index[i].first);
+			writeRaw(out, index[i].second);
+		}
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write result file " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), storeFile.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not replace result file " + storeFile);
+	}
+}
+
+/** Opens a result store and reads its index.
+ *
+ * @param[in] fileName	The file to read
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, 
+ *	is not a result store, was written on a machine with a different 
+ *	byte order, or is truncated.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+ResultStore::Impl::Impl(const string &fileName) : fileName(fileName), 
+		in(fileName.c_str(), std::ios::in | std::ios::binary), resultSize(0), 
+		ids(), offsets() {
+	if (!in) {
+		throw std::runtime_error("Could not open result file " + fileName);
+	}
+	
+	char magic[sizeof(STORE_MAGIC)];
+	uint32_t order = 0, reserved = 0;
+	uint64_t nObjects = 0, nValues = 0;
+	in.read(magic, sizeof(magic));
+	readRaw(in, order);
+	if (!in || !std::equal(magic, magic+sizeof(magic), STORE_MAGIC)) {
+		throw std::runtime_error(fileName + " is not a Timescales result file");
+	} else if (order != BYTE_ORDER_MARK) {
+		throw std::runtime_error("Result file " + fileName + " was written on a machine with a different byte order");
+	}
+	readRaw(in, reserved);
+	readRaw(in, nObjects);
+	readRaw(in, nValues);
+	
+	const std::streampos indexStart = in.tellg();
+	in.seekg(0, std::ios::end);
+	const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+	if (!in || nObjects > fileSize / (2*sizeof(uint64_t)) 
+			|| nValues > fileSize / sizeof(double)) {
+		throw std::runtime_error("Result file " + fileName + " is truncated");
+	}
+	in.seekg(indexStart);
+	
+	ids    .resize(nObjects);
+	offsets.resize(nObjects);
+	for(size_t i = 0; i < nObjects; i++) {
+		readRaw(in, ids[i]);
+		readRaw(in, offsets[i]);
+		if (in && offsets[i] + nValues*sizeof(double) > fileSize) {
+			throw std::runtime_error("Result file " + fileName + " is truncated");
+		}
+	}
+	if (!in) {
+		throw std::runtime_error("Result file " + fileName + " is truncated");
+	}
+	resultSize = nValues;
+}
+
+/** Opens a file written by mergeShards().
+ *
+ * @param[in] fileName	The file to read
+ *
+ * @perform O(M) time, where M is the number of objects in the file. 
+ *	Results are not read until requested.
+ * @perfmore O(M) memory
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, 
+ *	is not a result store, was written on a machine with a different 
+ *	byte order, or is truncated.
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	the index.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+ResultStore::ResultStore(const string &fileName) : impl(new Impl(fileName)) {
+}
+
+/** Returns the number of objects in the store.
+ *
+ * @return The number of objects in the catalog that was processed.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t ResultStore::size() const {
+	return impl->ids.size();
+}
+
+/** Returns the number of values stored for each object.
+ *
+ * @return The value of ShardTask::resultSize() for the task that 
+ *	produced the results.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t ResultStore::getResultSize() const {
+	return impl->resultSize;
+}
+
+/** Retrieves the values stored for an object.
+ *
+ * @param[in] id	The ID of the object in the catalog
+ * @param[out] result	The values produced by the task for the object. 
+ *			All NaN if the task failed on the object.
+ *
+ * @return True if the store has an object with ID @p id. If false, 
+ *	@p result is unchanged.
+ *
+ * @perform O(log M + V) time, where M = size() and V = getResultSize()
+ *
+ * @exception std::runtime_error Thrown if the result could not be read.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the result.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+bool ResultStore::find(unsigned long id, DoubleVec &result) const {
+	std::vector<uint64_t>::const_iterator it = 
+		std::lower_bound(impl->ids.begin(), impl->ids.end(), static_cast<uint64_t>(id));
+	if (it == impl->ids.end() || *it != id) {
+		return false;
+	}
+	
+	DoubleVec temp(impl->resultSize);
+	impl->in.clear();
+	impl->in.seekg(impl->offsets[it - impl->ids.begin()]);
+	if (!temp.empty()) {
+		impl->in.read(reinterpret_cast<char*>(&temp[0]), temp.size()*sizeof(double));
+	}
+	if (!impl->in) {
+		throw std::runtime_error("Could not read from result file " + impl->fileName);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(result, temp);
+	return true;
+}
+
+}		// end kpftimes
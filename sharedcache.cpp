@@ -0,0 +1,596 @@
+/** Node-local sharing of precomputed tables through POSIX shared memory
+ * @file timescales/sharedcache.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "sharedcache.h"
+#include "timescales.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+using boost::uint32_t;
+
+/** Identifies a segment created by SharedCache
+ */
+const uint32_t CACHE_MAGIC = 0x4B504643u;	// "KPFC"
+
+/** The number of tables a cache can index
+ */
+const uint32_t CACHE_SLOTS = 1024;
+
+/** Alignment of tables within a cache, in bytes
+ */
+const size_t CACHE_ALIGN = 64;
+
+/** States of a table in a cache. 
+ *
+ * Each slot moves from EMPTY to CLAIMED to BUILDING to READY or 
+ * ABANDONED, and never returns to EMPTY. A slot is CLAIMED only while 
+ * its owner fills in the key.
+ */
+enum SlotState {
+	EMPTY = 0,
+	CLAIMED,
+	BUILDING,
+	READY,
+	ABANDONED
+};
+
+/** The start of a cache segment.
+ */
+struct CacheHeader {
+	/** Set to CACHE_MAGIC once the segment has been initialized */
+	volatile uint32_t magic;
+	/** Number of entries following the header */
+	uint32_t nSlots;
+	/** Bytes available for tables */
+	size_t capacity;
+	/** Bytes handed out for tables so far. May exceed @p capacity */
+	volatile size_t used;
+};
+
+/** The index entry for one table in a cache.
+ */
+struct CacheEntry {
+	/** One of the SlotState values */
+	volatile uint32_t state;
+	/** Key of the table, valid unless the state is EMPTY or CLAIMED */
+	uint32_t hash1, hash2;
+	/** Number of doubles in the table */
+	size_t size;
+	/** Process building the table */
+	volatile pid_t owner;
+	/** Location of the table, in doubles from the start of the table area */
+	size_t offset;
+};
+
+/** The mapping of a cache segment into this process.
+ */
+struct SharedCache::Segment {
+	Segment(const string &name, size_t capacity);
+	~Segment();
+
+	CacheHeader& header() const;
+	CacheEntry* entries() const;
+	double* tables() const;
+
+	string name;
+	void* base;
+	size_t length;
+
+private:
+	// Not copyable
+	Segment(const Segment &other);
+	Segment& operator=(const Segment &other);
+};
+
+/** Returns the offset of the table area in a segment.
+ *
+ * @return The number of bytes taken by the header and index, rounded up 
+ *	to a multiple of CACHE_ALIGN.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t tableStart() {
+	size_t index = sizeof(CacheHeader) + CACHE_SLOTS * sizeof(CacheEntry);
+	return (index + CACHE_ALIGN - 1) / CACHE_ALIGN * CACHE_ALIGN;
+}
+
+/** Pauses briefly while another process finishes its work.
+ *
+ * @param[in] attempt	The number of times the caller has already waited
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void backOff(long attempt) {
+	if (attempt < 100) {
+		sched_yield();
+	} else {
+		timespec pause = {0, 100000};
+		nanosleep(&pause, NULL);
+	}
+}
+
+/** Tests whether a process has exited.
+ *
+ * @param[in] pid	The process to test
+ *
+ * @return True if @p pid no longer exists.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool processGone(pid_t pid) {
+	return (kill(pid, 0) != 0 && errno == ESRCH);
+}
+
+/** Opens and maps a cache segment, creating and initializing it if it 
+ *	does not exist.
+ *
+ * @param[in] name	The name of the shared memory object
+ * @param[in] capacity	The number of bytes to reserve for tables, if 
+ *			the segment is created
+ *
+ * @exception std::invalid_argument Thrown if @p capacity is zero.
+ * @exception std::runtime_error Thrown if the segment could not be 
+ *	created or mapped, or if it is not a cache segment.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+SharedCache::Segment::Segment(const string &name, size_t capacity) 
+		: name(name), base(NULL), length(0) {
+	if (capacity == 0) {
+		throw std::invalid_argument("SharedCache needs a positive capacity");
+	}
+	
+	bool created = true;
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0 && errno == EEXIST) {
+		created = false;
+		fd = shm_open(name.c_str(), O_RDWR, 0600);
+	}
+	if (fd < 0) {
+		throw std::runtime_error("Could not open shared cache " + name + ": " 
+			+ strerror(errno));
+	}
+	
+	if (created) {
+		length = tableStart() + capacity;
+		if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+			int error = errno;
+			close(fd);
+			shm_unlink(name.c_str());
+			throw std::runtime_error("Could not size shared cache " + name + ": " 
+				+ strerror(error));
+		}
+	} else {
+		// The creator may not have sized the segment yet
+		struct stat info;
+		for (long attempt = 0; ; attempt++) {
+			if (fstat(fd, &info) != 0) {
+				int error = errno;
+				close(fd);
+				throw std::runtime_error("Could not open shared cache " + name 
+					+ ": " + strerror(error));
+			}
+			if (static_cast<size_t>(info.st_size) > tableStart()) {
+				break;
+			} else if (attempt > 100000) {
+				close(fd);
+				throw std::runtime_error("Shared cache " + name 
+					+ " was never initialized");
+			}
+			backOff(attempt);
+		}
+		length = static_cast<size_t>(info.st_size);
+	}
+	
+	base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	int error = errno;
+	close(fd);
+	if (base == MAP_FAILED) {
+		if (created) {
+			shm_unlink(name.c_str());
+		}
+		throw std::runtime_error("Could not map shared cache " + name + ": " 
+			+ strerror(error));
+	}
+	
+	CacheHeader &head = header();
+	if (created) {
+		// The new segment is already zeroed, so all slots are EMPTY
+		head.nSlots   = CACHE_SLOTS;
+		head.capacity = capacity;
+		head.used     = 0;
+		__sync_synchronize();
+		head.magic    = CACHE_MAGIC;
+	} else {
+		for (long attempt = 0; head.magic != CACHE_MAGIC; attempt++) {
+			if (attempt > 100000) {
+				munmap(base, length);
+				throw std::runtime_error("Shared cache " + name 
+					+ " was never initialized");
+			}
+			backOff(attempt);
+		}
+		__sync_synchronize();
+		if (head.nSlots != CACHE_SLOTS || tableStart() + head.capacity > length) {
+			munmap(base, length);
+			throw std::runtime_error(name + " is not a compatible shared cache");
+		}
+	}
+}
+
+/** Unmaps the segment from this process. The segment itself persists.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+SharedCache::Segment::~Segment() {
+	munmap(base, length);
+}
+
+/** Returns the header of the segment.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CacheHeader& SharedCache::Segment::header() const {
+	return *static_cast<CacheHeader*>(base);
+}
+
+/** Returns the index of the segment.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CacheEntry* SharedCache::Segment::entries() const {
+	return reinterpret_cast<CacheEntry*>(static_cast<char*>(base) + sizeof(CacheHeader));
+}
+
+/** Returns the table area of the segment.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double* SharedCache::Segment::tables() const {
+	return reinterpret_cast<double*>(static_cast<char*>(base) + tableStart());
+}
+
+/** Attaches to a shared cache, creating it if necessary.
+ *
+ * If several processes create the same cache at once, exactly one of 
+ * them initializes it and the others wait for it to be ready.
+ *
+ * @param[in] name	The name of the POSIX shared memory object, 
+ *			which should start with a slash and contain no 
+ *			other slashes.
+ * @param[in] capacity	The number of bytes to reserve for tables. 
+ *			Ignored if the cache already exists.
+ *
+ * @post getName() = @p name
+ *
+ * @exception std::invalid_argument Thrown if @p capacity is zero.
+ * @exception std::runtime_error Thrown if the shared memory could not be 
+ *	created or mapped, or if it was not created by SharedCache.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	open the cache.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+SharedCache::SharedCache(const string &name, size_t capacity) 
+		: segment(new Segment(name, capacity)) {
+}
+
+/** Returns the name of the shared memory segment.
+ *
+ * @return The name passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const string& SharedCache::getName() const {
+	return segment->name;
+}
+
+/** Returns the number of bytes available for tables.
+ *
+ * @return The capacity given when the cache was created.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t SharedCache::getCapacity() const {
+	return segment->header().capacity;
+}
+
+/** Returns the number of bytes used by tables so far.
+ *
+ * @return The memory taken by all tables published by any process, 
+ *	including padding.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t SharedCache::getUsed() const {
+	// A failed allocation may push the counter past the capacity
+	size_t used = segment->header().used;
+	return std::min(used, segment->header().capacity);
+}
+
+/** Deletes a shared cache.
+ *
+ * Processes that have already attached to the cache may keep using it, 
+ * but later attempts to attach will create a new, empty cache.
+ *
+ * @param[in] name	The name of the cache to delete
+ *
+ * @post No cache named @p name exists.
+ *
+ * @exceptsafe Does not throw exceptions. Does nothing if the cache does 
+ *	not exist.
+ */
+void SharedCache::remove(const string &name) {
+	shm_unlink(name.c_str());
+}
+
+/** Starts a key for a kind of table.
+ *
+ * @param[in] kind	A name for the kind of table, so that different 
+ *			tables computed from the same inputs have different 
+ *			keys
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CacheKey::CacheKey(const char* kind) : hash1(2166136261u), hash2(0x9747B28Cu) {
+	add(kind, strlen(kind));
+}
+
+/** Adds a block of memory to the key.
+ *
+ * @param[in] data	The start of the block
+ * @param[in] length	The number of bytes in the block
+ *
+ * @return This key.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CacheKey& CacheKey::add(const void* data, size_t length) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < length; i++) {
+		// FNV-1a and a variant with a different prime and order of 
+		//	operations, so that collisions in one are unlikely to 
+		//	be collisions in the other
+		hash1 ^= bytes[i];
+		hash1 *= 16777619u;
+		hash2 *= 0x5BD1E995u;
+		hash2 ^= bytes[i] + (hash2 >> 15);
+	}
+	return *this;
+}
+
+/** Adds a vector to the key.
+ *
+ * @param[in] x	The vector to add, including its length
+ *
+ * @return This key.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CacheKey& CacheKey::add(const DoubleVec &x) {
+	add(static_cast<unsigned long>(x.size()));
+	if (!x.empty()) {
+		add(&x[0], x.size() * sizeof(double));
+	}
+	return *this;
+}
+
+/** Adds an integer to the key.
+ *
+ * @param[in] x	The value to add
+ *
+ * @return This key.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+CacheKey& CacheKey::add(unsigned long x) {
+	return add(&x, sizeof(x));
+}
+
+TableBuilder::~TableBuilder() {
+}
+
+/** Builds a table in private memory.
+ *
+ * @param[in] size	The number of doubles in the table
+ * @param[in] builder	The calculation that fills the table
+ *
+ * @return A table owned by this process.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	the table.
+ * @exception std::exception Thrown if @p builder fails.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+shared_ptr<const double> CacheAccess::local(size_t size, const TableBuilder &builder) {
+	if (size == 0) {
+		builder.build(NULL);
+		return shared_ptr<const double>();
+	}
+	shared_ptr<DoubleVec> storage(new DoubleVec(size));
+	builder.build(&(*storage)[0]);
+	return shared_ptr<const double>(storage, &(*storage)[0]);
+}
+
+/** Builds a table in a slot that this process has claimed.
+ *
+ * @param[in] segment	The mapping containing @p entry, which must be 
+ *			kept alive as long as the table is in use
+ * @param[in,out] head	The header of the cache containing @p entry
+ * @param[in] tables	The table area of the cache containing @p entry
+ * @param[in,out] entry	A slot in state BUILDING, owned by this process
+ * @param[in] builder	The calculation that fills the table
+ *
+ * @return The published table, or a private copy if the cache is full.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	a private copy of the table.
+ * @exception std::exception Thrown if @p builder fails.
+ *
+ * @exceptsafe If an exception is thrown, @p entry is marked ABANDONED, 
+ *	so that other processes build their own copies.
+ */
+shared_ptr<const double> buildShared(const shared_ptr<void> &segment, 
+		CacheHeader &head, double* tables, CacheEntry &entry, 
+		const TableBuilder &builder) {
+	
+	const size_t bytes = (entry.size * sizeof(double) + CACHE_ALIGN - 1) 
+			/ CACHE_ALIGN * CACHE_ALIGN;
+	const size_t offset = __sync_fetch_and_add(&head.used, bytes);
+	if (offset + bytes > head.capacity) {
+		__sync_synchronize();
+		entry.state = ABANDONED;
+		return CacheAccess::local(entry.size, builder);
+	}
+	
+	double* table = tables + offset / sizeof(double);
+	try {
+		builder.build(table);
+	} catch (...) {
+		__sync_synchronize();
+		entry.state = ABANDONED;
+		throw;
+	}
+	
+	entry.offset = offset / sizeof(double);
+	__sync_synchronize();
+	entry.state = READY;
+	
+	return shared_ptr<const double>(segment, table);
+}
+
+/** Returns a table from a shared cache, building it if necessary.
+ *
+ * If another process is already building the table, waits for it to 
+ * finish. If that process dies first, takes over the build. If the cache 
+ * has no room for the table, or the table could not be built, each 
+ * process builds its own copy.
+ *
+ * @param[in] cache	The cache to search
+ * @param[in] key	The identifier of the table
+ * @param[in] size	The number of doubles in the table
+ * @param[in] builder	The calculation that fills the table
+ *
+ * @return The table, which remains valid as long as the returned pointer 
+ *	or a copy of it exists.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory for 
+ *	a private copy of the table.
+ * @exception std::exception Thrown if @p builder fails.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+shared_ptr<const double> CacheAccess::table(SharedCache &cache, const CacheKey &key, 
+		size_t size, const TableBuilder &builder) {
+	if (size == 0) {
+		return local(size, builder);
+	}
+	
+	const shared_ptr<SharedCache::Segment> &segment = cache.segment;
+	CacheEntry* entries = segment->entries();
+	for (uint32_t probe = 0; probe < CACHE_SLOTS; probe++) {
+		CacheEntry &entry = entries[(key.hash1 + probe) % CACHE_SLOTS];
+		
+		for (long attempt = 0; ; attempt++) {
+			uint32_t state = entry.state;
+			if (state == EMPTY) {
+				if (__sync_bool_compare_and_swap(&entry.state, EMPTY, CLAIMED)) {
+					entry.hash1 = key.hash1;
+					entry.hash2 = key.hash2;
+					entry.size  = size;
+					entry.owner = getpid();
+					__sync_synchronize();
+					entry.state = BUILDING;
+					return buildShared(segment, segment->header(), 
+						segment->tables(), entry, builder);
+				}
+				continue;
+			} else if (state == CLAIMED) {
+				// The key is being written; if its writer died, give up 
+				//	on this table rather than wait forever
+				if (attempt > 100000) {
+					return local(size, builder);
+				}
+				backOff(attempt);
+				continue;
+			}
+			
+			__sync_synchronize();
+			if (entry.hash1 != key.hash1 || entry.hash2 != key.hash2 
+					|| entry.size != size) {
+				// Another table; try the next slot
+				break;
+			}
+			
+			if (state == READY) {
+				return shared_ptr<const double>(segment, 
+					segment->tables() + entry.offset);
+			} else if (state == ABANDONED) {
+				return local(size, builder);
+			}
+			
+			// state == BUILDING
+			pid_t owner = entry.owner;
+			if (processGone(owner) 
+					&& __sync_bool_compare_and_swap(&entry.state, BUILDING, CLAIMED)) {
+				entry.owner = getpid();
+				__sync_synchronize();
+				entry.state = BUILDING;
+				return buildShared(segment, segment->header(), 
+					segment->tables(), entry, builder);
+			}
+			backOff(attempt);
+		}
+	}
+	
+	// Index is full
+	return local(size, builder);
+}
+
+}		// end kpftimes
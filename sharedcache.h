@@ -0,0 +1,108 @@
+/** Access to tables in a SharedCache. None of these routines are intended 
+ *	as part of the public API.
+ * @file timescales/sharedcache.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDCACHEH
+#define SHAREDCACHEH
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include "timescales.h"
+
+namespace kpftimes {
+
+/** Identifies a table in a SharedCache.
+ *
+ * Keys combine two independent hashes of everything the table depends on.
+ *
+ * @ingroup util
+ */
+class CacheKey {
+public:
+	/** Starts a key for a kind of table.
+	 */
+	explicit CacheKey(const char* kind);
+
+	/** Adds a block of memory to the key.
+	 */
+	CacheKey& add(const void* data, size_t length);
+
+	/** Adds a vector to the key.
+	 */
+	CacheKey& add(const DoubleVec &x);
+
+	/** Adds an integer to the key.
+	 */
+	CacheKey& add(unsigned long x);
+
+	/** First hash of the table's inputs */
+	boost::uint32_t hash1;
+	/** Second hash of the table's inputs */
+	boost::uint32_t hash2;
+};
+
+/** Fills a table for a SharedCache.
+ *
+ * @ingroup util
+ */
+class TableBuilder {
+public:
+	virtual ~TableBuilder();
+
+	/** Computes the contents of a table.
+	 *
+	 * @param[out] table	The memory to fill. NULL if the table is 
+	 *			empty, in which case the builder should only 
+	 *			validate its inputs.
+	 *
+	 * @exception std::exception Thrown if the table could not be built.
+	 */
+	virtual void build(double* table) const = 0;
+};
+
+/** Looks up and publishes tables in a SharedCache.
+ *
+ * @ingroup util
+ */
+class CacheAccess {
+public:
+	/** Returns a table from a shared cache, building it if necessary.
+	 */
+	static boost::shared_ptr<const double> table(SharedCache &cache, 
+			const CacheKey &key, size_t size, const TableBuilder &builder);
+
+	/** Builds a table in private memory.
+	 */
+	static boost::shared_ptr<const double> local(size_t size, 
+			const TableBuilder &builder);
+};
+
+}		// end kpftimes
+
+#endif		// end ifndef SHAREDCACHEH
@@ -0,0 +1,299 @@
+/** Order statistics for sliding windows
+ * @file timescales/skiplist.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "skiplist.h"
+
+namespace kpftimes {
+
+/** Creates an empty list.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the list.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+IndexableSkiplist::IndexableSkiplist() : value(), link(), width(), freeNodes(), 
+		count(0), chain(MAX_LEVELS), steps(MAX_LEVELS), state(0) {
+	clear();
+}
+
+/** Removes all elements from the list.
+ *
+ * @post size() = 0
+ * @post The level generator is reset, so that a cleared list behaves 
+ *	exactly like a new one.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	reset the list. This can only happen the first time the list is 
+ *	cleared.
+ *
+ * @exceptsafe The list is unchanged in the event of an exception.
+ */
+void IndexableSkiplist::clear() {
+	if (value.size() < 2) {
+		value.resize(2);
+		link .resize(2);
+		width.resize(2);
+		link [0].resize(MAX_LEVELS);
+		width[0].resize(MAX_LEVELS);
+	}
+
+	// Recycle every node except the head and the sentinel
+	freeNodes.clear();
+	for (size_t node = value.size(); node > 2; node--) {
+		freeNodes.push_back(node-1);
+	}
+
+	value[0] = -std::numeric_limits<double>::infinity();
+	value[1] =  std::numeric_limits<double>::infinity();
+	for (size_t level = 0; level < MAX_LEVELS; level++) {
+		link [0][level] = 1;
+		width[0][level] = 1;
+	}
+	count = 0;
+	state = 0x2545F491u;
+}
+
+/** Returns the number of elements in the list.
+ *
+ * @return The number of values inserted and not yet removed.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t IndexableSkiplist::size() const {
+	return count;
+}
+
+/** Chooses the height of a new node.
+ *
+ * @return A number of levels between 1 and MAX_LEVELS, following a 
+ *	geometric distribution with p = 1/2.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t IndexableSkiplist::randomLevels() {
+	// xorshift32
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	size_t levels = 1;
+	for (boost::uint32_t bits = state; (bits & 1u) && levels < MAX_LEVELS; bits >>= 1) {
+		levels++;
+	}
+	return levels;
+}
+
+/** Allocates or recycles a node.
+ *
+ * @param[in] x		The value to store in the node
+ * @param[in] levels	The number of levels in the node
+ *
+ * @return The index of the node.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the node.
+ *
+ * @exceptsafe The list is unchanged in the event of an exception.
+ */
+size_t IndexableSkiplist::newNode(double x, size_t levels) {
+	size_t node;
+	if (!freeNodes.empty()) {
+		node = freeNodes.back();
+		link [node].resize(levels);
+		width[node].resize(levels);
+		freeNodes.pop_back();
+	} else {
+		node = value.size();
+		std::vector<size_t> newLinks(levels), newWidths(levels);
+		// Reserve everything before modifying anything
+		value.reserve(node+1);
+		link .reserve(node+1);
+		width.reserve(node+1);
+		freeNodes.reserve(node+1);
+		value.push_back(0.0);
+		link .push_back(newLinks);
+		width.push_back(newWidths);
+	}
+	value[node] = x;
+	return node;
+}
+
+/** Adds a value to the list.
+ *
+ * @param[in] x The value to add.
+ *
+ * @pre @p x is not NaN
+ *
+ * @post size() is increased by one
+ * @post The elements of the list remain sorted in ascending order
+ *
+ * @perform O(log N) expected time, where N = size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	add a node.
+ *
+ * @exceptsafe The list is unchanged in the event of an exception.
+ */
+void IndexableSkiplist::insert(double x) {
+	// Find the last node on each level whose successor is greater than x
+	size_t node = 0;
+	for (size_t level = MAX_LEVELS; level-- > 0; ) {
+		steps[level] = 0;
+		while (value[link[node][level]] <= x) {
+			steps[level] += width[node][level];
+			node = link[node][level];
+		}
+		chain[level] = node;
+	}
+
+	const size_t levels = randomLevels();
+	const size_t added = newNode(x, levels);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	// Splice the new node into each of its levels
+	size_t offset = 0;
+	for (size_t level = 0; level < levels; level++) {
+		size_t prev = chain[level];
+		link [added][level] = link[prev][level];
+		link [prev ][level] = added;
+		width[added][level] = width[prev][level] - offset;
+		width[prev ][level] = offset + 1;
+		offset += steps[level];
+	}
+	// Higher links now skip one more element
+	for (size_t level = levels; level < MAX_LEVELS; level++) {
+		width[chain[level]][level]++;
+	}
+	count++;
+}
+
+/** Removes one copy of a value from the list.
+ *
+ * @param[in] x The value to remove.
+ *
+ * @pre @p x is in the list
+ *
+ * @post size() is decreased by one
+ *
+ * @perform O(log N) expected time, where N = size()
+ *
+ * @exception std::invalid_argument Thrown if @p x is not in the list.
+ *
+ * @exceptsafe The list is unchanged in the event of an exception.
+ */
+void IndexableSkiplist::remove(double x) {
+	// Find the last node on each level whose successor is not less than x
+	size_t node = 0;
+	for (size_t level = MAX_LEVELS; level-- > 0; ) {
+		while (value[link[node][level]] < x) {
+			node = link[node][level];
+		}
+		chain[level] = node;
+	}
+
+	const size_t removed = link[chain[0]][0];
+	if (removed == 1 || value[removed] != x) {
+		throw std::invalid_argument("Value not found in IndexableSkiplist::remove()");
+	}
+
+	const size_t levels = link[removed].size();
+	for (size_t level = 0; level < levels; level++) {
+		size_t prev = chain[level];
+		width[prev][level] += width[removed][level] - 1;
+		link [prev][level]  = link [removed][level];
+	}
+	for (size_t level = levels; level < MAX_LEVELS; level++) {
+		width[chain[level]][level]--;
+	}
+	count--;
+
+	// newNode() reserved room for every node in freeNodes, so this 
+	//	cannot throw
+	freeNodes.push_back(removed);
+}
+
+/** Returns the element with a given rank.
+ *
+ * @param[in] rank The number of elements smaller than the desired one.
+ *
+ * @return The (@p rank + 1)th smallest element of the list.
+ *
+ * @pre @p rank < size()
+ *
+ * @perform O(log N) expected time, where N = size()
+ *
+ * @exception std::out_of_range Thrown if @p rank &ge; size()
+ *
+ * @exceptsafe The list is unchanged in the event of an exception.
+ */
+double IndexableSkiplist::at(size_t rank) const {
+	if (rank >= count) {
+		throw std::out_of_range("Rank out of bounds in IndexableSkiplist::at()");
+	}
+
+	size_t node = 0;
+	size_t remaining = rank + 1;
+	for (size_t level = MAX_LEVELS; level-- > 0; ) {
+		while (width[node][level] <= remaining) {
+			remaining -= width[node][level];
+			node = link[node][level];
+		}
+	}
+	return value[node];
+}
+
+/** Returns the number of elements strictly less than a value.
+ *
+ * @param[in] x The value to compare to.
+ *
+ * @return The rank that @p x would have if it were inserted before any 
+ *	equal elements.
+ *
+ * @perform O(log N) expected time, where N = size()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t IndexableSkiplist::countBelow(double x) const {
+	size_t node = 0;
+	size_t rank = 0;
+	for (size_t level = MAX_LEVELS; level-- > 0; ) {
+		while (value[link[node][level]] < x) {
+			rank += width[node][level];
+			node = link[node][level];
+		}
+	}
+	return rank;
+}
+
+}		// end kpftimes
@@ -0,0 +1,104 @@
+/** Order statistics for sliding windows. None of these routines are 
+ * intended as part of the public API.
+ * @file timescales/skiplist.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKIPLISTH
+#define SKIPLISTH
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace kpftimes {
+
+/** Sorted multiset of doubles supporting insertion, deletion, and access 
+ *	by rank in O(log n) expected time.
+ *
+ * The implementation is an indexable skiplist, in which each link records 
+ * how many elements it skips. Nodes are recycled rather than freed, so 
+ * once the list has held its largest number of elements it no longer 
+ * allocates memory.
+ *
+ * @ingroup util
+ */
+class IndexableSkiplist {
+public:
+	/** Creates an empty list.
+	 */
+	IndexableSkiplist();
+
+	/** Removes all elements from the list.
+	 */
+	void clear();
+
+	/** Adds a value to the list.
+	 */
+	void insert(double value);
+
+	/** Removes one copy of a value from the list.
+	 */
+	void remove(double value);
+
+	/** Returns the element with a given rank.
+	 */
+	double at(size_t rank) const;
+
+	/** Returns the number of elements strictly less than a value.
+	 */
+	size_t countBelow(double value) const;
+
+	/** Returns the number of elements in the list.
+	 */
+	size_t size() const;
+
+private:
+	/** Number of levels in the list. Good for up to about 
+	 *	2<sup>MAX_LEVELS</sup> elements.
+	 */
+	static const size_t MAX_LEVELS = 24;
+
+	size_t newNode(double value, size_t levels);
+	size_t randomLevels();
+
+	// Nodes are stored by index, so that the list can be copied
+	// Node 0 is the head, node 1 is a sentinel with value +infinity
+	std::vector<double> value;
+	std::vector<std::vector<size_t> > link, width;
+	std::vector<size_t> freeNodes;
+	size_t count;
+
+	// Scratch space for insert() and remove()
+	std::vector<size_t> chain, steps;
+
+	// Deterministic level generator, so that timings are reproducible
+	boost::uint32_t state;
+};
+
+}		// end kpftimes
+
+#endif		// end ifndef SKIPLISTH
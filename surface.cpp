@@ -0,0 +1,531 @@
+/** Thresholds interpolated across families of cadences
+ * @file timescales/surface.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include "timescales.h"
+
+namespace kpftimes {
+
+using std::string;
+
+/** The false alarm probabilities at which each lattice cell is checked
+ */
+const double CHECK_FAPS[] = {0.5, 0.1, 0.05, 0.01, 0.001};
+
+/** The number of elements of CHECK_FAPS
+ */
+const size_t N_CHECK_FAPS = sizeof(CHECK_FAPS)/sizeof(CHECK_FAPS[0]);
+
+/** The largest fractional difference between a star's highest frequency 
+ *	and that of its family for which the surface may be used
+ */
+const double FMAX_TOLERANCE = 0.01;
+
+/** The largest fractional difference between a star's lowest frequency 
+ *	and the grid spacing of its family for which the surface may be used
+ */
+const double FMIN_TOLERANCE = 0.01;
+
+/** The number of knots kept for each lattice point
+ */
+const size_t SURFACE_KNOTS = 1024;
+
+/** Generates a member of a cadence family.
+ *
+ * The family's times are stretched to the new baseline, then resampled 
+ * at evenly spaced ranks, so that the seasons keep their relative 
+ * positions and lengths.
+ *
+ * @param[in] family	The times defining the family, in ascending order
+ * @param[in] n		The number of epochs to generate
+ * @param[in] baseline	The time between the first and last epochs
+ * @param[out] times	The generated cadence
+ *
+ * @pre @p family.size() &ge; 2
+ * @pre @p n &ge; 2
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the cadence.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception.
+ */
+void familyCadence(const DoubleVec &family, size_t n, double baseline, DoubleVec &times) {
+	const size_t m = family.size();
+	const double scale = baseline / (family.back() - family.front());
+	
+	DoubleVec temp(n);
+	for(size_t i = 0; i < n; i++) {
+		const double rank = static_cast<double>(i)*(m-1)/(n-1);
+		const size_t below = std::min(static_cast<size_t>(rank), m-2);
+		const double frac = rank - below;
+		const double t = (1.0-frac)*family[below] + frac*family[below+1];
+		temp[i] = (t - family.front()) * scale;
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(times, temp);
+}
+
+/** Generates the frequency grid of a member of a cadence family.
+ *
+ * @param[in] fMax	The highest frequency of the grid
+ * @param[in] n		The number of frequencies
+ * @param[out] freqs	A uniform grid from @p fMax/@p n to @p fMax
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the grid.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception.
+ */
+void familyGrid(double fMax, size_t n, DoubleVec &freqs) {
+	DoubleVec temp(n);
+	for(size_t i = 0; i < n; i++) {
+		temp[i] = fMax * (i+1) / n;
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(freqs, temp);
+}
+
+/** Checks that a lattice axis can be interpolated.
+ *
+ * @param[in] axis	The values of the lattice along one axis
+ * @param[in] name	The name of the parameter holding @p axis
+ *
+ * @exception std::invalid_argument Thrown if @p axis has fewer than two 
+ *	values, or its values are not positive and strictly ascending.
+ *
+ * @exceptsafe Does not throw exceptions beyond those listed.
+ */
+void checkAxis(const DoubleVec &axis, const string &name) {
+	if (axis.size() < 2) {
+		throw std::invalid_argument("Parameter '" + name 
+			+ "' in ThresholdSurface() needs at least two values");
+	}
+	for(size_t i = 0; i < axis.size(); i++) {
+		if (!(axis[i] > 0.0) || (i > 0 && !(axis[i] > axis[i-1]))) {
+			throw std::invalid_argument("Parameter '" + name 
+				+ "' in ThresholdSurface() must be positive and strictly ascending");
+		}
+	}
+}
+
+/** Finds where a value falls along a lattice axis.
+ *
+ * Interpolation is linear in the logarithm of each parameter.
+ *
+ * @param[in] axis	The values of the lattice along one axis
+ * @param[in] value	The value to locate
+ * @param[out] index	The lattice point at the low end of the cell 
+ *			containing @p value
+ * @param[out] weight	The relative distance of @p value from 
+ *			axis[@p index], from 0 to 1
+ *
+ * @return True if @p value lies within the lattice, false otherwise.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool axisWeight(const DoubleVec &axis, double value, size_t &index, double &weight) {
+	if (!(value >= axis.front() && value <= axis.back())) {
+		return false;
+	}
+	index = std::min(static_cast<size_t>(std::upper_bound(axis.begin(), axis.end(), value) 
+			- axis.begin()), axis.size() - 1) - 1;
+	weight = log(value / axis[index]) / log(axis[index+1] / axis[index]);
+	return true;
+}
+
+/** Simulates a family of cadences on a lattice.
+ *
+ * Each lattice point is a cadence made by stretching @p familyTimes to 
+ * the baseline and resampling it to the number of epochs of that 
+ * point, together with a uniform frequency grid ending at @p fMax. The 
+ * false peaks of each point are simulated, and then the center of each 
+ * lattice cell is simulated and compared with the interpolation, to 
+ * find how accurate the interpolation is within that cell.
+ *
+ * @param[in] familyTimes	The times of a typical member of the family, 
+ *			in ascending order
+ * @param[in] fMax	The highest frequency of the frequency grids used 
+ *			by the family
+ * @param[in] nEpochs	The numbers of epochs on the lattice, in 
+ *			ascending order
+ * @param[in] baselines	The baselines on the lattice, in ascending order
+ * @param[in] gridSizes	The numbers of frequencies on the lattice, in 
+ *			ascending order
+ * @param[in] nSims	The number of simulations to run at each lattice 
+ *			point, and for stars that cannot be interpolated
+ * @param[in] model	The noise process to simulate
+ * @param[in] seed	The seed for the simulations
+ * @param[in] tolerance	The largest fractional error in the threshold 
+ *			that a cell may have and still be interpolated
+ *
+ * @pre @p familyTimes has at least two distinct values
+ * @pre @p fMax &gt; 0
+ * @pre Each of @p nEpochs, @p baselines, and @p gridSizes has at least 
+ *	two values, which are positive and strictly ascending
+ * @pre Each element of @p nEpochs is at least 2
+ * @pre @p nSims &ge; 20
+ * @pre @p tolerance &gt; 0
+ * @pre @p model exists for as long as the surface does
+ *
+ * @perform O(L &times; NFS) time, where L is the number of lattice 
+ *	points and cells, and NF &times; S is the cost of one 
+ *	lsNormalEdf() call at the largest lattice point
+ * @perfmore O(L) memory
+ *
+ * @exception std::invalid_argument Thrown if any of the preconditions 
+ *	on the arguments is violated.
+ * @exception std::runtime_error Thrown if @p model could not simulate a 
+ *	light curve.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	build the surface.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+ThresholdSurface::ThresholdSurface(const DoubleVec &familyTimes, double fMax, 
+		const DoubleVec &nEpochs, const DoubleVec &baselines, 
+		const DoubleVec &gridSizes, long nSims, 
+		const NullModel &model, unsigned long seed, double tolerance) 
+		: familyTimes(familyTimes), fMax(fMax), axes(), nodes(), 
+		thresholdErrors(), fapErrors(), model(&model), nSims(nSims), 
+		seed(seed), tolerance(tolerance) {
+	if (familyTimes.size() < 2 || !(familyTimes.back() > familyTimes.front())) {
+		throw std::invalid_argument("Parameter 'familyTimes' in ThresholdSurface() needs at least two distinct times");
+	}
+	if (!(fMax > 0.0)) {
+		throw std::invalid_argument("Parameter 'fMax' in ThresholdSurface() must be positive");
+	}
+	checkAxis(nEpochs  , "nEpochs"  );
+	checkAxis(baselines, "baselines");
+	checkAxis(gridSizes, "gridSizes");
+	if (nEpochs.front() < 2.0) {
+		throw std::invalid_argument("Parameter 'nEpochs' in ThresholdSurface() must be at least 2");
+	}
+	if (nSims < 20) {
+		throw std::invalid_argument("ThresholdSurface needs at least 20 simulations per lattice point");
+	}
+	if (!(tolerance > 0.0)) {
+		throw std::invalid_argument("Parameter 'tolerance' in ThresholdSurface() must be positive");
+	}
+	axes[0] = nEpochs;
+	axes[1] = baselines;
+	axes[2] = gridSizes;
+	
+	DoubleVec times, freqs, peaks, probs;
+	unsigned long nodeSeed = seed;
+	nodes.reserve(nEpochs.size() * baselines.size() * gridSizes.size());
+	for(size_t i = 0; i < nEpochs.size(); i++) {
+		for(size_t j = 0; j < baselines.size(); j++) {
+			for(size_t k = 0; k < gridSizes.size(); k++) {
+				familyCadence(familyTimes, static_cast<size_t>(nEpochs[i] + 0.5), 
+					baselines[j], times);
+				familyGrid(fMax, static_cast<size_t>(gridSizes[k] + 0.5), freqs);
+				lsNormalEdf(times, freqs, peaks, probs, nSims, model, nodeSeed++);
+				nodes.push_back(LsEdf(peaks, SURFACE_KNOTS));
+			}
+		}
+	}
+	
+	// Simulate the center of each cell to see how well it interpolates
+	for(size_t i = 0; i+1 < nEpochs.size(); i++) {
+		for(size_t j = 0; j+1 < baselines.size(); j++) {
+			for(size_t k = 0; k+1 < gridSizes.size(); k++) {
+				const size_t n = static_cast<size_t>(sqrt(nEpochs[i]*nEpochs[i+1]) + 0.5);
+				const double baseline = sqrt(baselines[j]*baselines[j+1]);
+				const size_t f = static_cast<size_t>(sqrt(gridSizes[k]*gridSizes[k+1]) + 0.5);
+				familyCadence(familyTimes, n, baseline, times);
+				familyGrid(fMax, f, freqs);
+				lsNormalEdf(times, freqs, peaks, probs, nSims, model, nodeSeed++);
+				const LsEdf center(peaks, SURFACE_KNOTS);
+				
+				size_t corner[3] = {i, j, k};
+				double weight[3];
+				axisWeight(axes[0], static_cast<double>(n), corner[0], weight[0]);
+				axisWeight(axes[1], baseline              , corner[1], weight[1]);
+				axisWeight(axes[2], static_cast<double>(f), corner[2], weight[2]);
+				
+				double thresholdError = 0.0, fapError = 0.0;
+				for(size_t c = 0; c < N_CHECK_FAPS; c++) {
+					const double fap = CHECK_FAPS[c];
+					if (nSims*fap < 10) {
+						continue;
+					}
+					const double simulated = center.threshold(fap);
+					thresholdError = std::max(thresholdError, 
+						fabs(interpolate(corner, weight, fap, false)/simulated - 1.0));
+					fapError = std::max(fapError, 
+						fabs(interpolate(corner, weight, simulated, true) - fap));
+				}
+				thresholdErrors.push_back(thresholdError);
+				fapErrors.push_back(fapError);
+			}
+		}
+	}
+}
+
+/** Finds the lattice cell containing a star.
+ *
+ * @param[in] times	The times at which the star was observed, in 
+ *			ascending order
+ * @param[in] freqs	The frequency grid of the star's periodogram, in 
+ *			ascending order
+ * @param[out] corner	The lattice point at the low corner of the cell, 
+ *			along each axis
+ * @param[out] weight	The position of the star within the cell, along 
+ *			each axis
+ *
+ * @return True if the star lies within the lattice, and its frequency 
+ *	grid starts and ends near that of a family member with the same 
+ *	number of frequencies; false otherwise.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool ThresholdSurface::locate(const DoubleVec &times, const DoubleVec &freqs, 
+		size_t corner[], double weight[]) const {
+	if (times.size() < 2 || freqs.empty() 
+			|| !(fabs(freqs.back() - fMax) <= FMAX_TOLERANCE*fMax)) {
+		return false;
+	}
+	// The family grids run from fMax/F to fMax; a grid that starts 
+	//	elsewhere has a different spacing and a different EDF
+	const double step = fMax / freqs.size();
+	if (!(fabs(freqs.front() - step) <= FMIN_TOLERANCE*step)) {
+		return false;
+	}
+	return axisWeight(axes[0], static_cast<double>(times.size()), corner[0], weight[0]) 
+		&& axisWeight(axes[1], times.back() - times.front()     , corner[1], weight[1]) 
+		&& axisWeight(axes[2], static_cast<double>(freqs.size()), corner[2], weight[2]);
+}
+
+/** Returns the position of a cell in the error tables.
+ *
+ * @param[in] corner	The lattice point at the low corner of the cell
+ *
+ * @return The index of the cell in thresholdErrors and fapErrors.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t ThresholdSurface::cellIndex(const size_t corner[]) const {
+	return (corner[0]*(axes[1].size()-1) + corner[1])*(axes[2].size()-1) + corner[2];
+}
+
+/** Interpolates a threshold or false alarm probability within a cell.
+ *
+ * @param[in] corner	The lattice point at the low corner of the cell
+ * @param[in] weight	The position within the cell, along each axis
+ * @param[in] x		The false alarm probability whose threshold is 
+ *			wanted, or the power whose false alarm probability 
+ *			is wanted
+ * @param[in] isFap	If true, interpolates the false alarm probability 
+ *			of power @p x; if false, the threshold at false 
+ *			alarm probability @p x
+ *
+ * @return The trilinear interpolation of the values at the corners of 
+ *	the cell.
+ *
+ * @exception std::invalid_argument Thrown if a threshold is requested 
+ *	for a false alarm probability that the simulations cannot resolve.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+double ThresholdSurface::interpolate(const size_t corner[], const double weight[], 
+		double x, bool isFap) const {
+	const size_t nT = axes[1].size(), nF = axes[2].size();
+	double sum = 0.0;
+	for(int bits = 0; bits < 8; bits++) {
+		double w = 1.0;
+		size_t point[3];
+		for(int axis = 0; axis < 3; axis++) {
+			const bool high = ((bits >> axis) & 1) != 0;
+			point[axis] = corner[axis] + (high ? 1 : 0);
+			w *= (high ? weight[axis] : 1.0 - weight[axis]);
+		}
+		if (w == 0.0) {
+			continue;
+		}
+		const LsEdf &node = nodes[(point[0]*nT + point[1])*nF + point[2]];
+		sum += w * (isFap ? node.fap(x) : node.threshold(x));
+	}
+	return sum;
+}
+
+/** Tests whether a star can be handled by interpolation.
+ *
+ * @param[in] times	The times at which the star was observed, in 
+ *			ascending order
+ * @param[in] freqs	The frequency grid of the star's periodogram, in 
+ *			ascending order
+ *
+ * @return True if the number of epochs, baseline, and number of 
+ *	frequencies of the star lie within the lattice, the highest 
+ *	frequency is within 1% of the family's, the lowest frequency is 
+ *	within 1% of the family's grid spacing, and the interpolation 
+ *	error of the cell is within the tolerance. False if threshold() 
+ *	and fap() would simulate the star instead.
+ *
+ * @perform O(log L), where L is the number of lattice points
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool ThresholdSurface::covers(const DoubleVec &times, const DoubleVec &freqs) const {
+	size_t corner[3];
+	double weight[3];
+	return locate(times, freqs, corner, weight) 
+		&& thresholdErrors[cellIndex(corner)] <= tolerance;
+}
+
+/** Returns the significance threshold for a star.
+ *
+ * @param[in] times	The times at which the star was observed, in 
+ *			ascending order
+ * @param[in] freqs	The frequency grid of the star's periodogram, in 
+ *			ascending order
+ * @param[in] fap	Desired false alarm probability
+ * @param[out] error	An estimate of the error in the threshold. If 
+ *			the star was interpolated, this is the largest 
+ *			error found at the center of its cell; otherwise 
+ *			it is the sampling error of the simulations.
+ *
+ * @return The peak power level that will be reached, with probability 
+ *	@p fap, in a periodogram of the noise model. If covers() is false, 
+ *	this is computed from the same simulations as lsThreshold() with 
+ *	the surface's number of simulations, model, and seed.
+ *
+ * @pre 0 < @p fap < 1
+ * @pre @p fap  the number of simulations &ge; 10
+ *
+ * @perform O(log K) time if covers() is true, where K is the number of 
+ *	knots per lattice point. Otherwise, the cost of lsNormalEdf().
+ *
+ * @exception std::invalid_argument Thrown if @p fap is outside (0, 1), 
+ *	if the simulations cannot resolve it, or if the star must be 
+ *	simulated and its times or frequencies are invalid.
+ * @exception std::runtime_error Thrown if the noise model could not 
+ *	simulate a light curve.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	simulate the star.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception.
+ */
+double ThresholdSurface::threshold(const DoubleVec &times, const DoubleVec &freqs, 
+		double fap, double &error) const {
+	size_t corner[3];
+	double weight[3];
+	if (locate(times, freqs, corner, weight)) {
+		const double relError = thresholdErrors[cellIndex(corner)];
+		if (relError <= tolerance) {
+			const double result = interpolate(corner, weight, fap, false);
+			
+			// IMPORTANT: no exceptions beyond this point
+			
+			error = relError * result;
+			return result;
+		}
+	}
+	
+	DoubleVec peaks, probs;
+	lsNormalEdf(times, freqs, peaks, probs, nSims, *model, seed);
+	const LsEdf edf(peaks, std::max<size_t>(peaks.size(), 4));
+	const double result = edf.threshold(fap);
+	// The threshold moves by about this much if the fraction of 
+	//	simulations above it changes by one standard deviation
+	const double sigma = sqrt(fap*(1.0-fap)/nSims);
+	const double shifted = edf.threshold(std::min(fap + sigma, 0.5*(1.0 + fap)));
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	error = result - shifted;
+	return result;
+}
+
+/** Returns the false alarm probability of a peak found for a star.
+ *
+ * @param[in] times	The times at which the star was observed, in 
+ *			ascending order
+ * @param[in] freqs	The frequency grid of the star's periodogram, in 
+ *			ascending order
+ * @param[in] power	The height of the periodogram peak
+ * @param[out] error	An estimate of the error in the false alarm 
+ *			probability. If the star was interpolated, this 
+ *			is the largest error found at the center of its 
+ *			cell; otherwise it is the sampling error of the 
+ *			simulations.
+ *
+ * @return The probability that a periodogram of the noise model has a 
+ *	peak higher than @p power.
+ *
+ * @perform O(log K) time if covers() is true, where K is the number of 
+ *	knots per lattice point. Otherwise, the cost of lsNormalEdf().
+ *
+ * @exception std::invalid_argument Thrown if the star must be simulated 
+ *	and its times or frequencies are invalid.
+ * @exception std::runtime_error Thrown if the noise model could not 
+ *	simulate a light curve.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	simulate the star.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an 
+ *	exception.
+ */
+double ThresholdSurface::fap(const DoubleVec &times, const DoubleVec &freqs, 
+		double power, double &error) const {
+	size_t corner[3];
+	double weight[3];
+	if (locate(times, freqs, corner, weight)) {
+		const size_t cell = cellIndex(corner);
+		if (thresholdErrors[cell] <= tolerance) {
+			error = fapErrors[cell];
+			return interpolate(corner, weight, power, true);
+		}
+	}
+	
+	DoubleVec peaks, probs;
+	lsNormalEdf(times, freqs, peaks, probs, nSims, *model, seed);
+	const double result = LsEdf(peaks, std::max<size_t>(peaks.size(), 4)).fap(power);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	error = sqrt(std::max(result*(1.0-result), 1.0/nSims) / nSims);
+	return result;
+}
+
+}		// end kpftimes
@@ -0,0 +1,613 @@
+/** Classification of periodic variables by template matching
+ * @file timescales/templates.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_fft_complex.h>
+#include "../common/alloc.tmp.h"
+#include "../common/stats.tmp.h"
+#include "timeexcept.h"
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Scratch space for scoring one folded light curve against a bank.
+ *
+ * Holds the FFT tables and buffers, so that a batch of light curves 
+ * can be scored without allocating memory for each one.
+ */
+struct TemplateBank::Workspace {
+	/** Allocates scratch space for a given number of phase bins.
+	 *
+	 * @param[in] nPhases	The number of bins in each folded light curve
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	allocate the workspace.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	explicit Workspace(size_t nPhases) : table(checkAlloc(
+			gsl_fft_complex_wavetable_alloc(nPhases)), 
+			&gsl_fft_complex_wavetable_free), 
+		space(checkAlloc(gsl_fft_complex_workspace_alloc(nPhases)), 
+			&gsl_fft_complex_workspace_free), 
+		specRe(nPhases), specIm(nPhases), buffer(2*nPhases), folded() {
+	}
+
+	/** FFT coefficients
+	 */
+	shared_ptr<gsl_fft_complex_wavetable> table;
+	/** FFT scratch space
+	 */
+	shared_ptr<gsl_fft_complex_workspace> space;
+	/** Spectrum of the normalized light curve, split into real and 
+	 *	imaginary parts
+	 */
+	DoubleVec specRe, specIm;
+	/** Interleaved complex data for the FFT
+	 */
+	DoubleVec buffer;
+	/** A folded light curve
+	 */
+	DoubleVec folded;
+};
+
+/** Tests whether a number is a power of two.
+ *
+ * @param[in] n	The number to test
+ *
+ * @return True if @p n = 2<sup>k</sup> for some k &ge; 0.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool isPowerOfTwo(size_t n) {
+	return n > 0 && (n & (n-1)) == 0;
+}
+
+/** Checks that a phase grid is usable for template matching.
+ *
+ * @param[in] nPhases	The number of phase bins
+ * @param[in] caller	The name of the public function, for use in error 
+ *			messages.
+ *
+ * @exception std::invalid_argument Thrown if @p nPhases is not a power of 
+ *	two between 4 and 2<sup>20</sup>.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void checkPhaseGrid(size_t nPhases, const string &caller) {
+	if (!isPowerOfTwo(nPhases) || nPhases < 4 || nPhases > (1UL << 20)) {
+		try {
+			throw std::invalid_argument("Parameter 'nPhases' in " + caller 
+				+ " must be a power of two between 4 and 2^20 (gave " 
+				+ lexical_cast<string>(nPhases) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'nPhases' in " + caller 
+				+ " must be a power of two between 4 and 2^20");
+		}
+	}
+}
+
+/** Folds a light curve into a grid of phase bins, without validating 
+ *	its arguments.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] freq	The frequency at which to fold
+ * @param[in] nPhases	The number of phase bins
+ * @param[out] folded	The mean of @p data in each phase bin
+ *
+ * @pre @p times.size() = @p data.size() &ge; 1
+ * @pre @p nPhases is a power of two, at most 2<sup>20</sup>
+ *
+ * @perform O(N + @p nPhases) time, where N = @p times.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the folded light curve.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p folded are 
+ *	unspecified.
+ */
+void foldUnchecked(const DoubleVec &times, const DoubleVec &data, double freq, 
+		size_t nPhases, DoubleVec &folded) {
+	// Phases are held in 32-bit fixed point, so that each bin index is 
+	//	the top bits of the phase and no epoch can fall off either end 
+	//	of the grid through rounding
+	unsigned int shift = 32;
+	for (size_t n = nPhases; n > 1; n >>= 1) {
+		shift--;
+	}
+	const double scale = 4294967296.0;
+	
+	folded.assign(nPhases, 0.0);
+	std::vector<size_t> counts(nPhases, 0);
+	
+	const double t0 = times.front();
+	double sum = 0.0;
+	for (size_t j = 0; j < times.size(); j++) {
+		const double cycles = (times[j] - t0) * freq;
+		const double frac   = (cycles - floor(cycles)) * scale;
+		const boost::uint32_t phase = (frac < scale ? static_cast<boost::uint32_t>(frac) : 0);
+		const size_t bin = phase >> shift;
+		
+		folded[bin] += data[j];
+		counts[bin]++;
+		sum += data[j];
+	}
+	
+	// Empty bins get the mean of the light curve, so that they do not 
+	//	contribute to the correlation
+	const double mean = sum / times.size();
+	for (size_t k = 0; k < nPhases; k++) {
+		folded[k] = (counts[k] > 0 ? folded[k] / counts[k] : mean);
+	}
+}
+
+/** Folds a light curve into a grid of phase bins.
+ *
+ * @param[in] times	Times at which @p data were taken
+ * @param[in] data	Measurements of a time series
+ * @param[in] freq	The frequency at which to fold
+ * @param[in] nPhases	The number of phase bins
+ * @param[out] folded	The mean of @p data in each phase bin
+ *
+ * @pre @p times.size() = @p data.size() &ge; 1
+ * @pre @p freq &ge; 0
+ * @pre @p nPhases is a power of two between 4 and 2<sup>20</sup>
+ *
+ * @post @p folded.size() = @p nPhases
+ * @post @p folded[k] is the mean of all @p data[j] for which the phase 
+ *	(@p times[j] - @p times[0])  @p freq, modulo 1, lies in 
+ *	[k/@p nPhases, (k+1)/@p nPhases). Bins with no data are set to the 
+ *	mean of @p data.
+ *
+ * @perform O(N + @p nPhases) time, where N = @p times.size()
+ * @perfmore O(@p nPhases) memory
+ *
+ * @exception kpftimes::except::NegativeFreq Thrown if @p freq is negative.
+ * @exception std::invalid_argument Thrown if @p times and @p data have 
+ *	different lengths, if they are empty, or if @p nPhases is not a 
+ *	power of two in the supported range.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the folded light curve.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void foldLightCurve(const DoubleVec &times, const DoubleVec &data, double freq, 
+		size_t nPhases, DoubleVec &folded) {
+	if (data.size() != times.size()) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'data' in foldLightCurve() are not the same length (gave " 
+			+ lexical_cast<string>(times.size()) + " for times and " 
+			+ lexical_cast<string>(data.size()) + " for data)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'data' in foldLightCurve() are not the same length");
+		}
+	}
+	if (times.empty()) {
+		throw std::invalid_argument("Parameter 'times' in foldLightCurve() is empty");
+	}
+	if (freq < 0) {
+		throw except::NegativeFreq("Parameter 'freq' in foldLightCurve() is negative");
+	}
+	checkPhaseGrid(nPhases, "foldLightCurve()");
+	
+	// copy-and-swap
+	DoubleVec temp;
+	foldUnchecked(times, data, freq, nPhases, temp);
+	
+	using std::swap;
+	swap(folded, temp);
+}
+
+/** Creates an empty template bank.
+ *
+ * @param[in] nPhases	The number of phase bins in each template
+ *
+ * @pre @p nPhases is a power of two between 4 and 2<sup>20</sup>
+ *
+ * @post size() = 0
+ * @post getNumPhases() = @p nPhases
+ *
+ * @exception std::invalid_argument Thrown if @p nPhases is not a power of 
+ *	two in the supported range.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+TemplateBank::TemplateBank(size_t nPhases) : nPhases(nPhases), specRe(), specIm() {
+	checkPhaseGrid(nPhases, "TemplateBank()");
+}
+
+/** Returns the number of phase bins in each template.
+ *
+ * @return The number of bins passed to the constructor.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t TemplateBank::getNumPhases() const {
+	return nPhases;
+}
+
+/** Returns the number of templates in the bank.
+ *
+ * @return The number of calls to addTemplate().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t TemplateBank::size() const {
+	return specRe.size() / nPhases;
+}
+
+/** Adds a light curve shape to the bank.
+ *
+ * @param[in] shape	The template light curve, sampled at phases 
+ *			0, 1/getNumPhases(), ..., 1 - 1/getNumPhases().
+ *
+ * @pre @p shape.size() = getNumPhases()
+ * @pre @p shape contains at least two distinct values
+ *
+ * @post size() is increased by one. The new template has index 
+ *	size() - 1 in the output of match() and matchTemplates().
+ *
+ * @perform O(P log P) time, where P = getNumPhases()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p shape is constant.
+ * @exception std::invalid_argument Thrown if @p shape has the wrong length.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the template.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+void TemplateBank::addTemplate(const DoubleVec &shape) {
+	if (shape.size() != nPhases) {
+		try {
+			throw std::invalid_argument("Parameter 'shape' in TemplateBank::addTemplate() must have " 
+				+ lexical_cast<string>(nPhases) + " elements (gave " 
+				+ lexical_cast<string>(shape.size()) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'shape' in TemplateBank::addTemplate() has the wrong length");
+		}
+	}
+	
+	// Normalize to zero mean and unit norm, so that scores are 
+	//	correlation coefficients
+	const double mean = kpfutils::mean(shape.begin(), shape.end());
+	double norm = 0.0;
+	for (size_t k = 0; k < nPhases; k++) {
+		norm += (shape[k] - mean)*(shape[k] - mean);
+	}
+	if (norm <= 0.0) {
+		throw except::BadLightCurve("Parameter 'shape' in TemplateBank::addTemplate() has no variability");
+	}
+	norm = sqrt(norm);
+	
+	Workspace work(nPhases);
+	for (size_t k = 0; k < nPhases; k++) {
+		work.buffer[2*k  ] = (shape[k] - mean) / norm;
+		work.buffer[2*k+1] = 0.0;
+	}
+	gsl_fft_complex_forward(&work.buffer[0], 1, nPhases, work.table.get(), work.space.get());
+	
+	specRe.reserve(specRe.size() + nPhases);
+	specIm.reserve(specIm.size() + nPhases);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	for (size_t k = 0; k < nPhases; k++) {
+		specRe.push_back(work.buffer[2*k  ]);
+		specIm.push_back(work.buffer[2*k+1]);
+	}
+}
+
+/** Scores a folded light curve against every template.
+ *
+ * @param[in,out] work	Scratch space for the calculation, with the 
+ *			folded light curve in work.folded
+ * @param[out] scores	The best correlation with each template
+ * @param[out] phases	The phase shift giving each score
+ *
+ * @pre work.folded.size() = getNumPhases()
+ *
+ * @perform O(T P log P) time, where T = size() and P = getNumPhases()
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if the folded light 
+ *	curve is constant.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the scores.
+ *
+ * @exceptsafe If an exception is thrown, the contents of @p scores and 
+ *	@p phases are unspecified.
+ */
+void TemplateBank::score(Workspace &work, DoubleVec &scores, DoubleVec &phases) const {
+	const size_t nTemplates = size();
+	const DoubleVec &folded = work.folded;
+	
+	const double mean = kpfutils::mean(folded.begin(), folded.end());
+	double norm = 0.0;
+	for (size_t k = 0; k < nPhases; k++) {
+		norm += (folded[k] - mean)*(folded[k] - mean);
+	}
+	if (norm <= 0.0) {
+		throw except::BadLightCurve("Folded light curve has no variability");
+	}
+	norm = sqrt(norm);
+	
+	for (size_t k = 0; k < nPhases; k++) {
+		work.buffer[2*k  ] = (folded[k] - mean) / norm;
+		work.buffer[2*k+1] = 0.0;
+	}
+	gsl_fft_complex_forward(&work.buffer[0], 1, nPhases, work.table.get(), work.space.get());
+	for (size_t k = 0; k < nPhases; k++) {
+		work.specRe[k] = work.buffer[2*k  ];
+		work.specIm[k] = work.buffer[2*k+1];
+	}
+	
+	scores.resize(nTemplates);
+	phases.resize(nTemplates);
+	
+	// Circular cross-correlation: corr[s] = sum_k f[k] T[k+s] 
+	//	= IFFT(conj(F) * T)[s] / P
+	const double* const re  = &work.specRe[0];
+	const double* const im  = &work.specIm[0];
+	double* const out = &work.buffer[0];
+	for (size_t t = 0; t < nTemplates; t++) {
+		const double* const tRe = &specRe[t*nPhases];
+		const double* const tIm = &specIm[t*nPhases];
+		// Contiguous, branch-free loop, so that the compiler can vectorize it
+		for (size_t k = 0; k < nPhases; k++) {
+			out[2*k  ] = re[k]*tRe[k] + im[k]*tIm[k];
+			out[2*k+1] = re[k]*tIm[k] - im[k]*tRe[k];
+		}
+		gsl_fft_complex_backward(out, 1, nPhases, work.table.get(), work.space.get());
+		
+		size_t best = 0;
+		for (size_t s = 1; s < nPhases; s++) {
+			if (out[2*s] > out[2*best]) {
+				best = s;
+			}
+		}
+		scores[t] = out[2*best] / nPhases;
+		phases[t] = static_cast<double>(best) / nPhases;
+	}
+}
+
+/** Scores a folded light curve against every template in the bank.
+ *
+ * Each template is compared to the light curve at every phase shift 
+ * on the grid, using an FFT cross-correlation.
+ *
+ * @param[in] folded	A folded light curve, such as the output of 
+ *			foldLightCurve()
+ * @param[out] scores	The best correlation coefficient between @p folded 
+ *			and each template.
+ * @param[out] phases	The phase shift of each template that gives its 
+ *			score.
+ *
+ * @pre @p folded.size() = getNumPhases()
+ * @pre @p folded contains at least two distinct values
+ *
+ * @post @p scores.size() = @p phases.size() = size()
+ * @post @p scores[t] is the largest Pearson correlation coefficient 
+ *	between @p folded[k] and template t evaluated at k + s, over all 
+ *	circular shifts s. @p phases[t] = s / getNumPhases() for the 
+ *	best s.
+ * @post -1 &le; @p scores[t] &le; 1 and 0 &le; @p phases[t] < 1
+ *
+ * @perform O(T P log P) time, where T = size() and P = getNumPhases()
+ * @perfmore O(P) memory
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if @p folded is constant.
+ * @exception std::invalid_argument Thrown if @p folded has the wrong length.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	compute the scores.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void TemplateBank::match(const DoubleVec &folded, DoubleVec &scores, DoubleVec &phases) const {
+	if (folded.size() != nPhases) {
+		try {
+			throw std::invalid_argument("Parameter 'folded' in TemplateBank::match() must have " 
+				+ lexical_cast<string>(nPhases) + " elements (gave " 
+				+ lexical_cast<string>(folded.size()) + ")");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameter 'folded' in TemplateBank::match() has the wrong length");
+		}
+	}
+	
+	Workspace work(nPhases);
+	work.folded = folded;
+	
+	// copy-and-swap
+	DoubleVec tempScores, tempPhases;
+	score(work, tempScores, tempPhases);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(scores, tempScores);
+	swap(phases, tempPhases);
+}
+
+/** Finds the best-matching template for each of a batch of light curves.
+ *
+ * Each light curve is folded at its own frequency with 
+ * foldLightCurve(), then scored against the bank with 
+ * TemplateBank::match(). 
+ *
+ * @param[in] times	Times at which each light curve was observed
+ * @param[in] data	Measurements of each light curve
+ * @param[in] freqs	The frequency at which to fold each light curve, 
+ *			typically the peak of its periodogram
+ * @param[in] bank	The templates to compare against
+ * @param[out] best	The index in @p bank of the best template for each 
+ *			light curve
+ * @param[out] scores	The correlation coefficient of each light curve 
+ *			with its best template
+ * @param[out] phases	The phase shift of the best template for each 
+ *			light curve
+ *
+ * @pre @p data.size() = @p times.size() = @p freqs.size()
+ * @pre @p times[k].size() = @p data[k].size() &ge; 1, for all k
+ * @pre @p freqs[k] &ge; 0, for all k
+ * @pre @p bank.size() &ge; 1
+ * @pre Each light curve, folded, contains at least two distinct values
+ *
+ * @post @p best.size() = @p scores.size() = @p phases.size() = @p times.size()
+ * @post @p scores[k] and @p phases[k] are the elements @p best[k] of the 
+ *	output of TemplateBank::match() for light curve k, and @p scores[k] 
+ *	is the largest such score.
+ *
+ * @perform O(N + S T P log P) time, where N is the total number of 
+ *	epochs, S = @p times.size(), T = @p bank.size(), and P = 
+ *	@p bank.getNumPhases()
+ * @perfmore If the library was compiled with OpenMP, light curves are 
+ *	processed in parallel.
+ *
+ * @exception kpftimes::except::BadLightCurve Thrown if some folded light 
+ *	curve is constant.
+ * @exception kpftimes::except::NegativeFreq Thrown if some element of 
+ *	@p freqs is negative.
+ * @exception std::invalid_argument Thrown if the arguments have 
+ *	inconsistent lengths, if a light curve is empty, or if @p bank is 
+ *	empty.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	classify the light curves.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void matchTemplates(const std::vector<DoubleVec> &times, const std::vector<DoubleVec> &data, 
+		const DoubleVec &freqs, const TemplateBank &bank, 
+		std::vector<size_t> &best, DoubleVec &scores, DoubleVec &phases) {
+	const size_t nStars = times.size();
+	
+	// Verify the preconditions
+	if (data.size() != nStars || freqs.size() != nStars) {
+		try {
+			throw std::invalid_argument("Parameters 'times', 'data', and 'freqs' in matchTemplates() do not have the same number of light curves (gave " 
+			+ lexical_cast<string>(nStars) + " for times, " 
+			+ lexical_cast<string>(data.size()) + " for data, and " 
+			+ lexical_cast<string>(freqs.size()) + " for freqs)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times', 'data', and 'freqs' in matchTemplates() do not have the same number of light curves");
+		}
+	}
+	if (bank.size() == 0) {
+		throw std::invalid_argument("Parameter 'bank' in matchTemplates() has no templates");
+	}
+	for (size_t k = 0; k < nStars; k++) {
+		if (data[k].size() != times[k].size() || times[k].empty()) {
+			try {
+				throw std::invalid_argument("Light curve " + lexical_cast<string>(k) 
+					+ " in matchTemplates() is empty or has mismatched times and data");
+			} catch (const boost::bad_lexical_cast& e) {
+				throw std::invalid_argument("A light curve in matchTemplates() is empty or has mismatched times and data");
+			}
+		}
+		if (freqs[k] < 0) {
+			throw except::NegativeFreq("Parameter 'freqs' in matchTemplates() contains negative frequencies");
+		}
+	}
+	
+	// copy-and-swap
+	std::vector<size_t> tempBest(nStars);
+	DoubleVec tempScores(nStars), tempPhases(nStars);
+	
+	// Exceptions must not propagate out of a parallel region
+	bool outOfMemory = false;
+	string failure;
+	
+	#ifdef _OPENMP
+	#pragma omp parallel
+	#endif
+	{
+		// One workspace per thread, allocated inside the loop so that 
+		//	failures can be caught
+		shared_ptr<TemplateBank::Workspace> work;
+		DoubleVec starScores, starPhases;
+		
+		#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+		#endif
+		for (long k = 0; k < static_cast<long>(nStars); k++) {
+			try {
+				TraceSpan span("matchTemplates", static_cast<unsigned long>(k));
+				if (work.get() == NULL) {
+					work.reset(new TemplateBank::Workspace(bank.nPhases));
+				}
+				foldUnchecked(times[k], data[k], freqs[k], bank.nPhases, work->folded);
+				bank.score(*work, starScores, starPhases);
+				
+				const size_t t = std::max_element(starScores.begin(), starScores.end()) 
+						- starScores.begin();
+				tempBest  [k] = t;
+				tempScores[k] = starScores[t];
+				tempPhases[k] = starPhases[t];
+			} catch (const std::bad_alloc& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(templateError)
+				#endif
+				outOfMemory = true;
+			} catch (const std::exception& e) {
+				#ifdef _OPENMP
+				#pragma omp critical(templateError)
+				#endif
+				failure = e.what();
+			}
+		}
+	}
+	
+	if (outOfMemory) {
+		throw std::bad_alloc();
+	} else if (!failure.empty()) {
+		// The only other exception score() can throw
+		throw except::BadLightCurve(failure);
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(best  , tempBest  );
+	swap(scores, tempScores);
+	swap(phases, tempPhases);
+}
+
+}		// end kpftimes
@@ -0,0 +1,335 @@
+/** Performs differential testing of the library's fast paths against 
+ *	the calculations they replace
+ * @file timescales/tests/unit_accuracy.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/lcio.h"
+#include "../timescales.h"
+#include "../dft.h"
+#include "../kernels.h"
+#include "../nufft.h"
+#include "../tuning.h"
+
+namespace kpftimes { namespace test {
+
+using boost::lexical_cast;
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains the light curves of the IDL regression corpus and light 
+ * curves with random cadences, each with a frequency grid. The 
+ * tolerances are those enforced by <tt>bench --differential</tt>.
+ */
+class AccuracyData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 * @exception std::runtime_error Thrown if the corpus could not be read.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	AccuracyData(): names(), times(), fluxes(), freqs() {
+		for(int i = 0; i <= 13; i++) {
+			DoubleVec t, y;
+			const std::string fileName = "idl_target_in_" 
+					+ lexical_cast<std::string>(i) + ".txt";
+			kpfutils::readMcLightCurve(fileName, t, y);
+			add(fileName, t, y);
+		}
+		
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		const size_t sizes[] = {16, 48, 400};
+		for(size_t k = 0; k < sizeof(sizes)/sizeof(size_t); k++) {
+			for(int seasonal = 0; seasonal <= 1; seasonal++) {
+				DoubleVec t, y;
+				for(size_t i = 0; i < sizes[k]; i++) {
+					if (seasonal) {
+						t.push_back(365.0*floor(3.0*gsl_rng_uniform(gen.get())) 
+							+ floor(120.0*gsl_rng_uniform(gen.get())) 
+							+ 0.3*gsl_rng_uniform(gen.get()));
+					} else {
+						t.push_back(100.0*gsl_rng_uniform(gen.get()));
+					}
+				}
+				std::sort(t.begin(), t.end());
+				for(size_t i = 0; i < t.size(); i++) {
+					y.push_back(sin(1.9*t[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+				}
+				add((seasonal ? "seasonal N = " : "uniform N = ") 
+					+ lexical_cast<std::string>(sizes[k]), t, y);
+			}
+		}
+	}
+	
+	virtual ~AccuracyData() {
+		forgetWisdom();
+	}
+	
+	/** Adds a light curve, with frequencies up to its pseudo-Nyquist 
+	 *	frequency.
+	 */
+	void add(const std::string &name, const DoubleVec &t, const DoubleVec &y) {
+		const double fMax = pseudoNyquistFreq(t);
+		DoubleVec f;
+		for(size_t i = 1; i <= 500; i++) {
+			f.push_back(fMax * i / 500.0);
+		}
+		names .push_back(name);
+		times .push_back(t);
+		fluxes.push_back(y);
+		freqs .push_back(f);
+	}
+	
+	/** Sets the largest light curve handled by the short light curve 
+	 *	kernels.
+	 */
+	static void setSmallN(size_t limit) {
+		Tuning tuning = currentTuning();
+		tuning.smallNLimit = limit;
+		setTuning(tuning);
+	}
+	
+	/** Returns the largest difference between two results, as a 
+	 *	fraction of the largest value in the reference.
+	 */
+	static double relError(const DoubleVec &expected, const DoubleVec &actual) {
+		BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+		double diff = 0.0, scale = 0.0;
+		for(size_t i = 0; i < expected.size(); i++) {
+			diff  = std::max(diff , fabs(actual[i] - expected[i]));
+			scale = std::max(scale, fabs(expected[i]));
+		}
+		return diff / scale;
+	}
+	
+	/** Returns the largest difference between two complex results, as 
+	 *	a fraction of the largest value in the reference.
+	 */
+	static double relError(const ComplexVec &expected, const ComplexVec &actual) {
+		BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+		double diff = 0.0, scale = 0.0;
+		for(size_t i = 0; i < expected.size(); i++) {
+			diff  = std::max(diff , std::abs(actual[i] - expected[i]));
+			scale = std::max(scale, std::abs(expected[i]));
+		}
+		return diff / scale;
+	}
+	
+	/** A label for each light curve
+	 */
+	std::vector<std::string> names;
+	/** The observation times of each light curve, in ascending order
+	 */
+	std::vector<DoubleVec> times;
+	/** The measurements of each light curve
+	 */
+	std::vector<DoubleVec> fluxes;
+	/** A grid of positive frequencies for each light curve
+	 */
+	std::vector<DoubleVec> freqs;
+};
+
+/** Test cases for fast paths
+ * @class BoostTest::test_accuracy
+ */
+BOOST_FIXTURE_TEST_SUITE(test_accuracy, AccuracyData)
+
+/** Tests whether the short light curve kernels match the direct sums
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(kernels) {
+	for(size_t k = 0; k < times.size(); k++) {
+		if (times[k].size() > MAX_SMALL_N) {
+			continue;
+		}
+		const BoolVec all(times[k].size(), true);
+		DoubleVec expected, actual;
+		ComplexVec expectedDft, actualDft;
+		
+		setSmallN(0);
+		BOOST_REQUIRE_NO_THROW(lombScargle(times[k], fluxes[k], freqs[k], expected));
+		BOOST_REQUIRE_NO_THROW(dft(times[k], fluxes[k], all, freqs[k], expectedDft));
+		setSmallN(MAX_SMALL_N);
+		BOOST_REQUIRE_NO_THROW(lombScargle(times[k], fluxes[k], freqs[k], actual));
+		BOOST_REQUIRE_NO_THROW(dft(times[k], fluxes[k], all, freqs[k], actualDft));
+		
+		/* @test Periodograms and Fourier transforms of each short light 
+		 *	curve. Expected behavior = relative errors below 1e-9 and 
+		 *	1e-10, respectively.
+		 */
+		BOOST_CHECK_MESSAGE(relError(expected, actual) <= 1e-9, names[k] 
+			<< ": relative error " << relError(expected, actual));
+		BOOST_CHECK_MESSAGE(relError(expectedDft, actualDft) <= 1e-10, names[k] 
+			<< ": relative error " << relError(expectedDft, actualDft));
+	}
+}
+
+/** Tests whether the planned and binned periodograms match lombScargle()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(periodograms) {
+	for(size_t k = 0; k < times.size(); k++) {
+		DoubleVec expected, planned, binned;
+		BOOST_REQUIRE_NO_THROW(lombScargle(times[k], fluxes[k], freqs[k], expected));
+		
+		/* @test Periodograms from an LsPlan. Expected behavior = relative 
+		 *	error below 1e-8.
+		 */
+		LsPlan plan(times[k], freqs[k]);
+		BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes[k], 
+				BoolVec(times[k].size(), true), planned));
+		BOOST_CHECK_MESSAGE(relError(expected, planned) <= 1e-8, names[k] 
+			<< ": relative error " << relError(expected, planned));
+		
+		/* @test Periodograms binned with a phase tolerance of 0.01. 
+		 *	Expected behavior = relative error below 0.03.
+		 */
+		BOOST_REQUIRE_NO_THROW(lombScargleMultires(times[k], fluxes[k], freqs[k], 
+				0.01, binned));
+		BOOST_CHECK_MESSAGE(relError(expected, binned) <= 0.03, names[k] 
+			<< ": relative error " << relError(expected, binned));
+	}
+}
+
+/** Tests whether the fast Fourier series evaluations match term-by-term 
+ *	evaluation
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(series) {
+	ComplexVec coeffs;
+	for(size_t m = 0; m < 257; m++) {
+		coeffs.push_back(std::complex<double>(sin(1.0 + m), cos(2.0 + m)) 
+			/ (1.0 + 0.01*m));
+	}
+	const double half = static_cast<double>(coeffs.size() / 2);
+	
+	for(size_t k = 0; k < times.size(); k++) {
+		const double t0 = times[k].front(), span = times[k].back() - t0;
+		DoubleVec x;
+		ComplexVec expected, nufft, recurrence;
+		for(size_t j = 0; j < times[k].size(); j++) {
+			x.push_back(20.0 * (times[k][j] - t0) / span - 10.0);
+			std::complex<double> sum(0.0, 0.0);
+			for(size_t m = 0; m < coeffs.size(); m++) {
+				sum += coeffs[m] * std::polar(1.0, (m - half) * x.back());
+			}
+			expected.push_back(sum);
+		}
+		
+		/* @test The nonuniform FFT with a precision of 1e-9. Expected 
+		 *	behavior = relative error below 1e-7.
+		 */
+		BOOST_REQUIRE_NO_THROW(nufftType2(coeffs, x, nufft, 1e-9));
+		BOOST_CHECK_MESSAGE(relError(expected, nufft) <= 1e-7, names[k] 
+			<< ": relative error " << relError(expected, nufft));
+		
+		/* @test Direct summation with a phasor recurrence. Expected 
+		 *	behavior = relative error below 1e-10.
+		 */
+		BOOST_REQUIRE_NO_THROW(directType2(coeffs, x, recurrence));
+		BOOST_CHECK_MESSAGE(relError(expected, recurrence) <= 1e-10, names[k] 
+			<< ": relative error " << relError(expected, recurrence));
+	}
+}
+
+/** Tests whether rollingMedian() matches sorting each window
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(median) {
+	for(size_t k = 0; k < times.size(); k++) {
+		const DoubleVec &t = times[k], &y = fluxes[k];
+		const double window = 0.1 * (t.back() - t.front());
+		DoubleVec expected, actual;
+		for(size_t i = 0; i < t.size(); i++) {
+			DoubleVec inWindow;
+			for(size_t j = 0; j < t.size(); j++) {
+				if (fabs(t[j] - t[i]) <= 0.5*window) {
+					inWindow.push_back(y[j]);
+				}
+			}
+			std::sort(inWindow.begin(), inWindow.end());
+			const size_t mid = inWindow.size() / 2;
+			expected.push_back(inWindow.size() % 2 == 1 ? inWindow[mid] 
+				: 0.5*(inWindow[mid-1] + inWindow[mid]));
+		}
+		
+		/* @test A window one tenth of the light curve. Expected behavior = 
+		 *	relative error below 1e-12.
+		 */
+		BOOST_REQUIRE_NO_THROW(rollingMedian(t, y, window, actual));
+		BOOST_CHECK_MESSAGE(relError(expected, actual) <= 1e-12, names[k] 
+			<< ": relative error " << relError(expected, actual));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,228 @@
+/** Performs unit testing of the light curve binning functions
+ * @file timescales/tests/unit_binning.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats_except.h"
+#include "../timescales.h"
+#include "../timeexcept.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** This function is a wrapper for a trusted approximate comparison method.
+ */
+bool isClose(double val1, double val2, double frac);
+
+/** Data common to the test cases.
+ *
+ * Contains a densely sampled light curve with a long-period signal
+ */
+class BinningData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	BinningData(): times(), fluxes(), freqs() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		// 30-minute cadence for 90 days, with random gaps
+		for(double t = 0.0; t < 90.0; t += 1.0/48.0) {
+			if (gsl_rng_uniform(gen.get()) > 0.2) {
+				times.push_back(t + 0.001*gsl_rng_uniform(gen.get()));
+			}
+		}
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(2.0*3.14159265358979*times[i]/7.3) 
+				+ gsl_ran_gaussian(gen.get(), 0.5));
+		}
+		
+		for(double f = 0.0; f <= 2.0; f += 0.005) {
+			freqs.push_back(f);
+		}
+	}
+	
+	virtual ~BinningData() {
+	}
+	
+	/** Grid of dense times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy 7.3-day sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Grid of frequencies, starting at zero
+	 */
+	DoubleVec freqs;
+};
+
+/** Test cases for light curve binning
+ * @class BoostTest::test_binning
+ */
+BOOST_FIXTURE_TEST_SUITE(test_binning, BinningData)
+
+/** Tests whether binLightCurve() conserves the light curve
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(bins) {
+	DoubleVec binTimes, binData, binWeights;
+	const double width = maxBinWidth(0.05, 0.1);
+	
+	BOOST_CHECK(isClose(width, 0.5/3.14159265358979, 1e-12));
+	
+	/* @test Dense light curve. Expected behavior = fewer bins, total weight 
+	 *	and weighted mean conserved, bins no wider than requested
+	 */
+	BOOST_REQUIRE_NO_THROW(binLightCurve(times, fluxes, width, 
+			binTimes, binData, binWeights));
+	BOOST_REQUIRE_EQUAL(binData   .size(), binTimes.size());
+	BOOST_REQUIRE_EQUAL(binWeights.size(), binTimes.size());
+	BOOST_CHECK_LT(binTimes.size(), times.size());
+	
+	double totalWeight = 0.0, binSum = 0.0, sum = 0.0;
+	for(size_t i = 0; i < binTimes.size(); i++) {
+		totalWeight += binWeights[i];
+		binSum      += binWeights[i]*binData[i];
+		if (i > 0) {
+			BOOST_CHECK_LT(binTimes[i-1], binTimes[i]);
+		}
+	}
+	for(size_t i = 0; i < fluxes.size(); i++) {
+		sum += fluxes[i];
+	}
+	BOOST_CHECK_EQUAL(totalWeight, static_cast<double>(times.size()));
+	BOOST_CHECK(isClose(binSum, sum, 1e-10));
+	
+	/* @test Bins narrower than the sampling. Expected behavior = light curve 
+	 *	unchanged
+	 */
+	BOOST_REQUIRE_NO_THROW(binLightCurve(times, fluxes, 1e-6, 
+			binTimes, binData, binWeights));
+	BOOST_CHECK(binTimes == times);
+	BOOST_CHECK(binData  == fluxes);
+	BOOST_CHECK(binWeights == DoubleVec(times.size(), 1.0));
+	
+	/* @test Invalid input. Expected behavior = throw exceptions
+	 */
+	BOOST_CHECK_THROW(maxBinWidth(0.0, 0.1), std::invalid_argument);
+	BOOST_CHECK_THROW(maxBinWidth(1.0, -0.1), std::invalid_argument);
+	BOOST_CHECK_THROW(binLightCurve(times, fluxes, 0.0, 
+			binTimes, binData, binWeights), std::invalid_argument);
+	DoubleVec badTimes(times);
+	std::swap(badTimes[3], badTimes[4]);
+	BOOST_CHECK_THROW(binLightCurve(badTimes, fluxes, width, 
+			binTimes, binData, binWeights), kpfutils::except::NotSorted);
+}
+
+/** Tests whether lombScargleMultires() stays within its error bound
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(multires) {
+	DoubleVec expected, actual;
+	
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	
+	/* @test Tight tolerance. Expected behavior = same peak, powers agree 
+	 *	to a fraction of the tolerance of the highest peak
+	 */
+	const double tolerance = 0.1;
+	BOOST_REQUIRE_NO_THROW(lombScargleMultires(times, fluxes, freqs, 
+			tolerance, actual));
+	BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+	
+	const double peak = *std::max_element(expected.begin(), expected.end());
+	for(size_t i = 0; i < freqs.size(); i++) {
+		BOOST_CHECK_MESSAGE(fabs(actual[i] - expected[i]) < tolerance*peak, 
+			"Frequency " << freqs[i] << ": expected " << expected[i] 
+			<< ", got " << actual[i]);
+	}
+	BOOST_CHECK_EQUAL(std::max_element(actual  .begin(), actual  .end()) - actual  .begin(), 
+	                  std::max_element(expected.begin(), expected.end()) - expected.begin());
+	
+	/* @test Tolerance too tight to bin anything. Expected behavior = same 
+	 *	result as lombScargle()
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargleMultires(times, fluxes, freqs, 
+			1e-9, actual));
+	for(size_t i = 0; i < freqs.size(); i++) {
+		if (expected[i] > 1e-8) {
+			BOOST_CHECK(isClose(actual[i], expected[i], 1e-8));
+		}
+	}
+	
+	/* @test Invalid input. Expected behavior = throw exceptions
+	 */
+	BOOST_CHECK_THROW(lombScargleMultires(times, fluxes, freqs, 0.0, actual), 
+			std::invalid_argument);
+	DoubleVec badFreqs(freqs);
+	badFreqs[3] = -1.0;
+	BOOST_CHECK_THROW(lombScargleMultires(times, fluxes, badFreqs, tolerance, actual), 
+			except::NegativeFreq);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,295 @@
+/** Performs unit testing of the C interface
+ * @file timescales/tests/unit_cabi.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../ctimescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve stored both as separate vectors and as a single 
+ * interleaved table, as a caller in another language might hold it
+ */
+class CApiData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	CApiData(): times(), fluxes(), mask(), freqs(), offsets(), table(), flags(), 
+			workspace(kpft_workspace_new(), &kpft_workspace_free) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 100; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+			mask  .push_back(gsl_rng_uniform(gen.get()) > 0.2);
+			
+			// Rows of (time, flux, error)
+			table.push_back(times[i]);
+			table.push_back(fluxes[i]);
+			table.push_back(0.3);
+			flags.push_back(mask[i] ? 1 : 0);
+		}
+		
+		for(double f = 0.0; f < 2.0; f += 0.01) {
+			freqs.push_back(f);
+		}
+		for(double t = 0.0; t < 20.0; t += 0.5) {
+			offsets.push_back(t);
+		}
+		
+		BOOST_REQUIRE(workspace.get() != NULL);
+	}
+	
+	virtual ~CApiData() {
+	}
+	
+	/** Describes a contiguous vector to the C interface.
+	 */
+	static kpft_vector view(const DoubleVec &x) {
+		kpft_vector result = {&x[0], x.size(), 1};
+		return result;
+	}
+	
+	/** Describes a writable contiguous vector to the C interface.
+	 */
+	static kpft_out_vector outView(DoubleVec &x) {
+		kpft_out_vector result = {&x[0], x.size(), 1};
+		return result;
+	}
+	
+	/** Grid with 100 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Mask with roughly 20% of epochs removed
+	 */
+	BoolVec mask;
+	/** Grid of frequencies, starting at zero
+	 */
+	DoubleVec freqs;
+	/** Uniform grid of ACF offsets
+	 */
+	DoubleVec offsets;
+	/** The light curve as a row-major table with three columns
+	 */
+	DoubleVec table;
+	/** @p mask as bytes
+	 */
+	std::vector<unsigned char> flags;
+	/** A workspace for the C interface
+	 */
+	shared_ptr<kpft_workspace> workspace;
+};
+
+/** Test cases for the C interface
+ * @class BoostTest::test_cabi
+ */
+BOOST_FIXTURE_TEST_SUITE(test_cabi, CApiData)
+
+/** Tests whether the C interface matches the C++ interface
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(results) {
+	const kpft_vector tableTimes  = {&table[0], times.size(), 3};
+	const kpft_vector tableFluxes = {&table[1], times.size(), 3};
+	const kpft_flags  byteMask    = {&flags[0], flags.size(), 1};
+	DoubleVec expected, actual(freqs.size(), -1.0);
+	
+	/* @test lombScargle() on columns of a table, with a mask. Expected 
+	 *	behavior = identical output to the C++ interface.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, expected));
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(workspace.get(), tableTimes, tableFluxes, 
+			&byteMask, view(freqs), outView(actual)), KPFT_SUCCESS);
+	BOOST_CHECK(expected == actual);
+	
+	/* @test lombScargle() written into every other element of a buffer, 
+	 *	without a mask or a workspace. Expected behavior = identical output 
+	 *	to the C++ interface, with the other elements untouched.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	DoubleVec strided(2*freqs.size(), -1.0);
+	const kpft_out_vector stridedPower = {&strided[0], freqs.size(), 2};
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(NULL, view(times), view(fluxes), NULL, 
+			view(freqs), stridedPower), KPFT_SUCCESS);
+	for(size_t i = 0; i < freqs.size(); i++) {
+		BOOST_CHECK_EQUAL(strided[2*i  ], expected[i]);
+		BOOST_CHECK_EQUAL(strided[2*i+1], -1.0);
+	}
+	
+	/* @test Planned lombScargle() with a mask. Expected behavior = identical 
+	 *	output to the C++ interface.
+	 */
+	LsPlan plan(times, freqs);
+	BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, mask, expected));
+	kpft_plan *cPlan = NULL;
+	BOOST_REQUIRE_EQUAL(kpft_plan_new(workspace.get(), tableTimes, view(freqs), 
+			&cPlan), KPFT_SUCCESS);
+	BOOST_CHECK_EQUAL(kpft_plan_lomb_scargle(workspace.get(), cPlan, tableFluxes, 
+			&byteMask, outView(actual)), KPFT_SUCCESS);
+	kpft_plan_free(cPlan);
+	BOOST_CHECK(expected == actual);
+	
+	/* @test autoCorr() with a mask. Expected behavior = identical output 
+	 *	to the C++ interface.
+	 */
+	DoubleVec acf(offsets.size());
+	BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, mask, offsets, expected, 0.5));
+	BOOST_CHECK_EQUAL(kpft_autocorr(workspace.get(), tableTimes, tableFluxes, 
+			&byteMask, view(offsets), 0.5, outView(acf)), KPFT_SUCCESS);
+	BOOST_CHECK(expected == acf);
+	
+	/* @test lsThreshold(). Expected behavior = identical output to the 
+	 *	C++ interface.
+	 */
+	double threshold = 0.0;
+	BOOST_CHECK_EQUAL(kpft_ls_threshold(workspace.get(), view(times), view(freqs), 
+			0.05, 1000, 42, &threshold), KPFT_SUCCESS);
+	BOOST_CHECK_EQUAL(threshold, lsThreshold(times, freqs, 0.05, 1000, WhiteNoise(), 42));
+}
+
+/** Tests whether the C interface reports errors
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(errors) {
+	DoubleVec power(freqs.size(), -1.0);
+	
+	/* @test A new workspace. Expected behavior = no error message.
+	 */
+	BOOST_CHECK_EQUAL(std::string(kpft_workspace_error(workspace.get())), "");
+	
+	/* @test An output buffer of the wrong length. Expected behavior = 
+	 *	return KPFT_EINVAL with a message, and leave the buffer unchanged.
+	 */
+	kpft_out_vector shortPower = outView(power);
+	shortPower.size--;
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(workspace.get(), view(times), view(fluxes), 
+			NULL, view(freqs), shortPower), KPFT_EINVAL);
+	BOOST_CHECK(std::string(kpft_workspace_error(workspace.get())) != "");
+	BOOST_CHECK(std::count(power.begin(), power.end(), -1.0) 
+			== static_cast<long>(power.size()));
+	
+	/* @test A light curve with no variability. Expected behavior = 
+	 *	return KPFT_EINVAL, and leave the buffer unchanged.
+	 */
+	DoubleVec flat(times.size(), 1.0);
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(workspace.get(), view(times), view(flat), 
+			NULL, view(freqs), outView(power)), KPFT_EINVAL);
+	BOOST_CHECK(std::count(power.begin(), power.end(), -1.0) 
+			== static_cast<long>(power.size()));
+	
+	/* @test A mask of the wrong length, without a workspace. Expected 
+	 *	behavior = return KPFT_EINVAL.
+	 */
+	const kpft_flags shortMask = {&flags[0], flags.size() - 1, 1};
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(NULL, view(times), view(fluxes), 
+			&shortMask, view(freqs), outView(power)), KPFT_EINVAL);
+	
+	/* @test Null outputs and plans. Expected behavior = return KPFT_EINVAL.
+	 */
+	BOOST_CHECK_EQUAL(kpft_ls_threshold(workspace.get(), view(times), view(freqs), 
+			0.05, 100, 42, NULL), KPFT_EINVAL);
+	BOOST_CHECK_EQUAL(kpft_plan_new(workspace.get(), view(times), view(freqs), 
+			NULL), KPFT_EINVAL);
+	BOOST_CHECK_EQUAL(kpft_plan_lomb_scargle(workspace.get(), NULL, view(fluxes), 
+			NULL, outView(power)), KPFT_EINVAL);
+	
+	/* @test Null arrays with a nonzero length, as input, mask, and 
+	 *	output. Expected behavior = return KPFT_EINVAL, and leave the 
+	 *	buffer unchanged.
+	 */
+	const kpft_vector nullTimes = {NULL, times.size(), 1};
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(workspace.get(), nullTimes, view(fluxes), 
+			NULL, view(freqs), outView(power)), KPFT_EINVAL);
+	BOOST_CHECK(std::string(kpft_workspace_error(workspace.get())) != "");
+	const kpft_vector nullOffsets = {NULL, 10, 1};
+	DoubleVec acf(10, -1.0);
+	BOOST_CHECK_EQUAL(kpft_autocorr(NULL, view(times), view(fluxes), NULL, 
+			nullOffsets, 0.5, outView(acf)), KPFT_EINVAL);
+	const kpft_flags nullMask = {NULL, flags.size(), 1};
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(workspace.get(), view(times), view(fluxes), 
+			&nullMask, view(freqs), outView(power)), KPFT_EINVAL);
+	BOOST_CHECK(std::count(power.begin(), power.end(), -1.0) 
+			== static_cast<long>(power.size()));
+	const kpft_out_vector nullPower = {NULL, freqs.size(), 1};
+	BOOST_CHECK_EQUAL(kpft_lomb_scargle(workspace.get(), view(times), view(fluxes), 
+			NULL, view(freqs), nullPower), KPFT_EINVAL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,283 @@
+/** Performs unit testing of kpftimes::cleanSpectrum()
+ * @file timescales/tests/unit_clean.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../clean.h"
+#include "../dft.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a sinusoid observed once per night, and a frequency grid 
+ * that includes its first daily aliases
+ */
+class CleanData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	CleanData(): times(), fluxes(), freqs(), step(0.005) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 80; i++) {
+			times.push_back(i + 0.1*gsl_rng_uniform(gen.get()));
+			fluxes.push_back(3.0 + sin(2.0*3.14159265358979*0.3*times.back()));
+		}
+		for(size_t k = 0; k <= 300; k++) {
+			freqs.push_back(k*step);
+		}
+	}
+	
+	virtual ~CleanData() {
+	}
+	
+	/** Grid with one observation per night for 80 nights
+	 */
+	DoubleVec times;
+	/** A sinusoid of unit amplitude and frequency 0.3, observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Uniform grid of frequencies from 0 to 1.5
+	 */
+	DoubleVec freqs;
+	/** Spacing of @p freqs
+	 */
+	double step;
+};
+
+/** Test cases for the CLEAN spectrum
+ * @class BoostTest::test_clean
+ */
+BOOST_FIXTURE_TEST_SUITE(test_clean, CleanData)
+
+/** Tests whether cleanSpectrum() rejects invalid parameters
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	DoubleVec amplitude;
+	
+	/* @test A gain of zero or greater than one. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(cleanSpectrum(times, fluxes, freqs, 10, 0.0, amplitude), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(cleanSpectrum(times, fluxes, freqs, 10, 1.5, amplitude), 
+			std::invalid_argument);
+	
+	/* @test A frequency grid that does not start at zero, or is not evenly 
+	 *	spaced. Expected behavior = throw invalid_argument.
+	 */
+	DoubleVec shifted(freqs.begin() + 1, freqs.end());
+	BOOST_CHECK_THROW(cleanSpectrum(times, fluxes, shifted, 10, 0.5, amplitude), 
+			std::invalid_argument);
+	DoubleVec uneven(freqs);
+	uneven[17] += 0.3*step;
+	BOOST_CHECK_THROW(cleanSpectrum(times, fluxes, uneven, 10, 0.5, amplitude), 
+			std::invalid_argument);
+	
+	/* @test Fluxes of the wrong length. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(cleanSpectrum(times, DoubleVec(3, 1.0), freqs, 10, 0.5, amplitude), 
+			std::invalid_argument);
+	
+	/* @test Valid parameters. Expected behavior = one amplitude per frequency.
+	 */
+	BOOST_REQUIRE_NO_THROW(cleanSpectrum(times, fluxes, freqs, 10, 0.5, amplitude));
+	BOOST_CHECK_EQUAL(amplitude.size(), freqs.size());
+}
+
+/** Tests whether a single CLEAN iteration removes an exact sinusoid
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(components) {
+	DoubleVec windowFreqs;
+	for (size_t k = 0; k < 2*freqs.size() - 1; k++) {
+		windowFreqs.push_back(k*step);
+	}
+	ComplexVec window;
+	Workspace workspace;
+	BOOST_REQUIRE_NO_THROW(dft(times, DoubleVec(times.size(), 1.0), 
+			BoolVec(times.size(), true), windowFreqs, window, workspace));
+	for (size_t k = 0; k < window.size(); k++) {
+		window[k] /= static_cast<double>(times.size());
+	}
+	
+	// The spectrum of a sinusoid with complex amplitude a at bin 60
+	const size_t peak = 60;
+	const std::complex<double> a(0.3, -0.4);
+	ComplexVec dirty(freqs.size());
+	for (size_t k = 0; k < dirty.size(); k++) {
+		const std::complex<double> minus = (k >= peak ? window[k - peak] 
+				: std::conj(window[peak - k]));
+		dirty[k] = a*minus + std::conj(a)*window[k + peak];
+	}
+	
+	/* @test One iteration with unit gain on the spectrum of a single 
+	 *	sinusoid. Expected behavior = one component equal to the 
+	 *	sinusoid's amplitude, and no residual.
+	 */
+	ComplexVec components, residual;
+	BOOST_REQUIRE_NO_THROW(cleanComponents(dirty, window, 1, 1.0, components, residual));
+	BOOST_REQUIRE_EQUAL(components.size(), dirty.size());
+	BOOST_REQUIRE_EQUAL(residual.size(), dirty.size());
+	BOOST_CHECK_SMALL(std::abs(components[peak] - a), 1e-10);
+	for (size_t k = 0; k < residual.size(); k++) {
+		BOOST_CHECK_SMALL(std::abs(residual[k]), 1e-10);
+		if (k != peak) {
+			BOOST_CHECK_EQUAL(std::abs(components[k]), 0.0);
+		}
+	}
+	
+	/* @test A window of the wrong length. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(cleanComponents(dirty, ComplexVec(window.begin(), window.end() - 1), 
+			1, 1.0, components, residual), std::invalid_argument);
+}
+
+/** Tests whether the FFT restoration matches direct convolution
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(restore) {
+	shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), &gsl_rng_free);
+	gsl_rng_set(gen.get(), 101);
+	
+	const size_t nFreq = 41;
+	const double beamWidth = 1.7;
+	ComplexVec components(nFreq), residual(nFreq);
+	for (size_t k = 1; k < nFreq; k++) {
+		if (gsl_rng_uniform(gen.get()) < 0.3) {
+			components[k] = std::complex<double>(gsl_ran_gaussian(gen.get(), 1.0), 
+					gsl_ran_gaussian(gen.get(), 1.0));
+		}
+		residual[k] = std::complex<double>(gsl_ran_gaussian(gen.get(), 0.1), 
+				gsl_ran_gaussian(gen.get(), 0.1));
+	}
+	
+	/* @test Random components and residuals. Expected behavior = matches 
+	 *	direct convolution with the Hermitian extension of the components.
+	 */
+	ComplexVec spectrum;
+	BOOST_REQUIRE_NO_THROW(restoreClean(components, residual, beamWidth, spectrum));
+	BOOST_REQUIRE_EQUAL(spectrum.size(), nFreq);
+	const int beamMax = static_cast<int>(ceil(6.0*beamWidth));
+	for (size_t k = 0; k < nFreq; k++) {
+		std::complex<double> expected = residual[k];
+		for (int j = -static_cast<int>(nFreq) + 1; j < static_cast<int>(nFreq); j++) {
+			const int offset = static_cast<int>(k) - j;
+			if (std::abs(offset) <= beamMax) {
+				const std::complex<double> comp = (j >= 0 ? components[j] 
+						: std::conj(components[-j]));
+				expected += comp * exp(-0.5*offset*offset/(beamWidth*beamWidth));
+			}
+		}
+		BOOST_CHECK_SMALL(std::abs(spectrum[k] - expected), 1e-10);
+	}
+	
+	/* @test A beam width of zero. Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(restoreClean(components, residual, 0.0, spectrum), 
+			std::invalid_argument);
+}
+
+/** Tests whether CLEAN suppresses daily aliases
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(aliases) {
+	const size_t truePeak = 60, alias = 140;
+	
+	ComplexVec dirtyCoeffs;
+	Workspace workspace;
+	BOOST_REQUIRE_NO_THROW(dft(times, fluxes, BoolVec(times.size(), true), 
+			freqs, dirtyCoeffs, workspace));
+	const double dirtyRatio = std::abs(dirtyCoeffs[alias]) / std::abs(dirtyCoeffs[truePeak]);
+	
+	/* @test A sinusoid observed nightly. Expected behavior = the highest 
+	 *	peak is at the true frequency, with height about half the 
+	 *	amplitude, and the daily alias is much weaker than in the dirty 
+	 *	spectrum.
+	 */
+	DoubleVec amplitude;
+	BOOST_REQUIRE_NO_THROW(cleanSpectrum(times, fluxes, freqs, 200, 0.5, amplitude));
+	const size_t best = std::max_element(amplitude.begin(), amplitude.end()) 
+			- amplitude.begin();
+	BOOST_CHECK_EQUAL(best, truePeak);
+	BOOST_CHECK_CLOSE(amplitude[truePeak], 0.5, 10.0);
+	BOOST_CHECK_GT(dirtyRatio, 0.5);
+	BOOST_CHECK_LT(amplitude[alias] / amplitude[truePeak], 0.1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
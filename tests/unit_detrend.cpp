@@ -0,0 +1,306 @@
+/** Performs unit testing of the rolling-window detrending functions
+ * @file timescales/tests/unit_detrend.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats_except.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** This function is a wrapper for a trusted approximate comparison method.
+ */
+bool isClose(double val1, double val2, double frac);
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve with gaps, repeated values, and a trend
+ */
+class DetrendData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	DetrendData(): times(), fluxes(), window(3.7) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 500; i++) {
+			double t = 100*gsl_rng_uniform(gen.get());
+			// Leave a gap wider than the window
+			if (t < 40.0 || t > 50.0) {
+				times.push_back(t);
+			}
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			double flux = 0.05*times[i] + gsl_ran_gaussian(gen.get(), 0.3);
+			// Quantized values, to exercise duplicates
+			if (i % 7 == 0) {
+				flux = floor(flux);
+			}
+			fluxes.push_back(flux);
+		}
+	}
+	
+	virtual ~DetrendData() {
+	}
+	
+	/** Finds the epochs in a window the slow way.
+	 */
+	DoubleVec inWindow(size_t i) const {
+		DoubleVec result;
+		for(size_t j = 0; j < times.size(); j++) {
+			if (fabs(times[j] - times[i]) <= 0.5*window) {
+				result.push_back(fluxes[j]);
+			}
+		}
+		return result;
+	}
+	
+	/** Finds the median of a vector the slow way.
+	 */
+	static double slowMedian(DoubleVec x) {
+		std::sort(x.begin(), x.end());
+		const size_t n = x.size();
+		return 0.5*(x[(n-1)/2] + x[n/2]);
+	}
+	
+	/** Grid of random times in ascending order, with a gap
+	 */
+	DoubleVec times;
+	/** A noisy linear trend observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Width of the rolling window
+	 */
+	double window;
+};
+
+/** Test cases for rolling-window statistics
+ * @class BoostTest::test_detrend
+ */
+BOOST_FIXTURE_TEST_SUITE(test_detrend, DetrendData)
+
+/** Tests whether the rolling statistics match direct computation
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(correctness) {
+	DoubleVec medians, mads, means, residuals;
+	
+	/* @test Irregularly sampled light curve with a gap and repeated values. 
+	 *	Expected behavior = each statistic matches a sort of the 
+	 *	epochs in each window
+	 */
+	BOOST_REQUIRE_NO_THROW(rollingMedian(times, fluxes, window, medians));
+	BOOST_REQUIRE_NO_THROW(rollingMad   (times, fluxes, window, mads));
+	BOOST_REQUIRE_NO_THROW(rollingMean  (times, fluxes, window, means));
+	BOOST_REQUIRE_NO_THROW(detrend      (times, fluxes, window, residuals));
+	BOOST_REQUIRE_EQUAL(medians  .size(), times.size());
+	BOOST_REQUIRE_EQUAL(mads     .size(), times.size());
+	BOOST_REQUIRE_EQUAL(means    .size(), times.size());
+	BOOST_REQUIRE_EQUAL(residuals.size(), times.size());
+	
+	for(size_t i = 0; i < times.size(); i++) {
+		DoubleVec local = inWindow(i);
+		double med = slowMedian(local);
+		double sum = 0.0;
+		DoubleVec devs;
+		for(size_t j = 0; j < local.size(); j++) {
+			sum += local[j];
+			devs.push_back(fabs(local[j] - med));
+		}
+		
+		BOOST_CHECK_EQUAL(medians[i], med);
+		BOOST_CHECK_EQUAL(mads[i], slowMedian(devs));
+		BOOST_CHECK_EQUAL(residuals[i], fluxes[i] - med);
+		BOOST_CHECK(isClose(means[i], sum/local.size(), 1e-10));
+	}
+	
+	/* @test Window narrower than the spacing of the data. Expected behavior 
+	 *	= medians equal the data, deviations are zero
+	 */
+	BOOST_REQUIRE_NO_THROW(rollingMedian(times, fluxes, 1e-9, medians));
+	BOOST_REQUIRE_NO_THROW(rollingMad   (times, fluxes, 1e-9, mads));
+	BOOST_CHECK(medians == fluxes);
+	BOOST_CHECK(mads == DoubleVec(times.size(), 0.0));
+}
+
+/** Tests whether RollingStats objects can be reused
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(reuse) {
+	DoubleVec expected, actual, shortTimes, shortFluxes;
+	RollingStats stats(window);
+	
+	BOOST_CHECK_EQUAL(stats.getWindow(), window);
+	
+	for(size_t i = 0; i < 50; i++) {
+		shortTimes .push_back(times [i]);
+		shortFluxes.push_back(fluxes[i]);
+	}
+	
+	/* @test Same object applied to a long light curve, then a short one, 
+	 *	then a copy of itself. Expected behavior = same results as 
+	 *	the free functions
+	 */
+	BOOST_REQUIRE_NO_THROW(stats.mad(times, fluxes, actual));
+	BOOST_REQUIRE_NO_THROW(rollingMad(times, fluxes, window, expected));
+	BOOST_CHECK(actual == expected);
+	
+	BOOST_REQUIRE_NO_THROW(stats.detrend(shortTimes, shortFluxes, actual));
+	BOOST_REQUIRE_NO_THROW(detrend(shortTimes, shortFluxes, window, expected));
+	BOOST_CHECK(actual == expected);
+	
+	RollingStats copy(stats);
+	BOOST_REQUIRE_NO_THROW(copy.median(times, fluxes, actual));
+	BOOST_REQUIRE_NO_THROW(rollingMedian(times, fluxes, window, expected));
+	BOOST_CHECK(actual == expected);
+	
+	/* @test Output aliased to the input. Expected behavior = same result 
+	 *	as separate output
+	 */
+	actual = fluxes;
+	BOOST_REQUIRE_NO_THROW(stats.detrend(times, actual, actual));
+	BOOST_REQUIRE_NO_THROW(detrend(times, fluxes, window, expected));
+	BOOST_CHECK(actual == expected);
+}
+
+/** Tests whether batch detrending matches one light curve at a time
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(batch) {
+	std::vector<DoubleVec> allTimes, allFluxes, allResiduals;
+	
+	for(size_t k = 0; k < 20; k++) {
+		DoubleVec t, f;
+		for(size_t i = k; i < times.size(); i += k+1) {
+			t.push_back(times [i]);
+			f.push_back(fluxes[i]);
+		}
+		allTimes .push_back(t);
+		allFluxes.push_back(f);
+	}
+	
+	/* @test 20 light curves with different cadences. Expected behavior = 
+	 *	same as detrending each one separately
+	 */
+	BOOST_REQUIRE_NO_THROW(detrend(allTimes, allFluxes, window, allResiduals));
+	BOOST_REQUIRE_EQUAL(allResiduals.size(), allTimes.size());
+	for(size_t k = 0; k < allTimes.size(); k++) {
+		DoubleVec expected;
+		BOOST_REQUIRE_NO_THROW(detrend(allTimes[k], allFluxes[k], window, expected));
+		BOOST_CHECK(allResiduals[k] == expected);
+	}
+	
+	/* @test One light curve out of order. Expected behavior = throw 
+	 *	NotSorted
+	 */
+	std::swap(allTimes[5][0], allTimes[5][1]);
+	BOOST_CHECK_THROW(detrend(allTimes, allFluxes, window, allResiduals), 
+			kpfutils::except::NotSorted);
+}
+
+/** Tests whether invalid input is rejected
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(invalid) {
+	DoubleVec out;
+	
+	/* @test Non-positive window. Expected behavior = throw invalid_argument
+	 */
+	BOOST_CHECK_THROW(RollingStats(0.0), std::invalid_argument);
+	BOOST_CHECK_THROW(rollingMedian(times, fluxes, -1.0, out), std::invalid_argument);
+	BOOST_CHECK_THROW(rollingMean(times, fluxes, 
+			std::numeric_limits<double>::quiet_NaN(), out), std::invalid_argument);
+	
+	/* @test Times and data of different lengths. Expected behavior = throw 
+	 *	invalid_argument
+	 */
+	DoubleVec shortFluxes(fluxes.begin(), fluxes.end()-1);
+	BOOST_CHECK_THROW(detrend(times, shortFluxes, window, out), std::invalid_argument);
+	
+	/* @test Data containing NaN. Expected behavior = throw invalid_argument
+	 */
+	DoubleVec badFluxes(fluxes);
+	badFluxes[10] = std::numeric_limits<double>::quiet_NaN();
+	BOOST_CHECK_THROW(rollingMad(times, badFluxes, window, out), std::invalid_argument);
+	
+	/* @test Unsorted times. Expected behavior = throw NotSorted
+	 */
+	DoubleVec badTimes(times);
+	std::swap(badTimes[3], badTimes[4]);
+	BOOST_CHECK_THROW(rollingMedian(badTimes, fluxes, window, out), 
+			kpfutils::except::NotSorted);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
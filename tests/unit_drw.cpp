@@ -0,0 +1,300 @@
+/** Performs unit testing of kpftimes::drwLogLikelihood() and 
+ *	kpftimes::fitDrw()
+ * @file timescales/tests/unit_drw.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats_except.h"
+#include "../timescales.h"
+#include "../timeexcept.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains damped random walks observed with measurement errors
+ */
+class DrwData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	DrwData(): times(), fluxes(), errors() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for (size_t star = 0; star < 3; star++) {
+			DoubleVec t, f, e, deviates;
+			for (size_t i = 0; i < 1000; i++) {
+				t.push_back(2000.0*gsl_rng_uniform(gen.get()));
+				deviates.push_back(gsl_ran_gaussian(gen.get(), 1.0));
+			}
+			std::sort(t.begin(), t.end());
+			DampedRandomWalk(20.0).simulate(t, deviates, f);
+			for (size_t i = 0; i < t.size(); i++) {
+				e.push_back(0.1);
+				f[i] = 10.0 + 2.0*f[i] + gsl_ran_gaussian(gen.get(), e[i]);
+			}
+			times .push_back(t);
+			fluxes.push_back(f);
+			errors.push_back(e);
+		}
+	}
+	
+	virtual ~DrwData() {
+	}
+	
+	/** Times for three stars, 1000 random epochs each
+	 */
+	std::vector<DoubleVec> times;
+	/** Damped random walks with tau = 20 and sigma = 2, observed at 
+	 *	@p times
+	 */
+	std::vector<DoubleVec> fluxes;
+	/** Measurement errors of @p fluxes
+	 */
+	std::vector<DoubleVec> errors;
+};
+
+/** Calculates the damped random walk likelihood directly from its 
+ *	covariance matrix, with the mean set to its maximum likelihood value.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double gpLogLikelihood(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, double tau, double sigma) {
+	const size_t n = times.size();
+	// Cholesky decomposition, stored in the lower triangle
+	std::vector<DoubleVec> chol(n, DoubleVec(n, 0.0));
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j <= i; j++) {
+			double sum = sigma*sigma*exp(-fabs(times[i] - times[j])/tau) 
+					+ (i == j ? errors[i]*errors[i] : 0.0);
+			for (size_t k = 0; k < j; k++) {
+				sum -= chol[i][k]*chol[j][k];
+			}
+			chol[i][j] = (i == j ? sqrt(sum) : sum / chol[j][j]);
+		}
+	}
+	// Whiten the fluxes and a constant
+	DoubleVec y(fluxes), one(n, 1.0);
+	double logDet = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		for (size_t k = 0; k < i; k++) {
+			y  [i] -= chol[i][k]*y  [k];
+			one[i] -= chol[i][k]*one[k];
+		}
+		y  [i] /= chol[i][i];
+		one[i] /= chol[i][i];
+		logDet += 2.0*log(chol[i][i]);
+	}
+	double yy = 0.0, yOne = 0.0, oneOne = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		yy     += y  [i]*y  [i];
+		yOne   += y  [i]*one[i];
+		oneOne += one[i]*one[i];
+	}
+	return -0.5*(yy - yOne*yOne/oneOne + logDet + n*log(2.0*3.14159265358979));
+}
+
+/** Test cases for damped random walk fitting
+ * @class BoostTest::test_drw
+ */
+BOOST_FIXTURE_TEST_SUITE(test_drw, DrwData)
+
+/** Tests whether the damped random walk functions reject invalid 
+ *	parameters
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	const DoubleVec &t = times[0], &f = fluxes[0], &e = errors[0];
+	double tau, sigma;
+	
+	/* @test A zero timescale or amplitude. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(drwLogLikelihood(t, f, e, 0.0, 1.0), std::invalid_argument);
+	BOOST_CHECK_THROW(drwLogLikelihood(t, f, e, 1.0, 0.0), std::invalid_argument);
+	
+	/* @test Errors of the wrong length, or a negative error. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(drwLogLikelihood(t, f, DoubleVec(3, 0.1), 1.0, 1.0), 
+			std::invalid_argument);
+	DoubleVec badErrors(e);
+	badErrors[5] = -0.1;
+	BOOST_CHECK_THROW(fitDrw(t, f, badErrors, tau, sigma), std::invalid_argument);
+	
+	/* @test Unsorted times. Expected behavior = throw NotSorted.
+	 */
+	DoubleVec unsorted(t);
+	std::swap(unsorted[3], unsorted[50]);
+	BOOST_CHECK_THROW(fitDrw(unsorted, f, e, tau, sigma), kpfutils::except::NotSorted);
+	
+	/* @test A repeated date without measurement errors. Expected behavior = 
+	 *	throw invalid_argument.
+	 */
+	DoubleVec repeated(t);
+	repeated[11] = repeated[10];
+	BOOST_CHECK_THROW(drwLogLikelihood(repeated, f, DoubleVec(t.size(), 0.0), 1.0, 1.0), 
+			std::invalid_argument);
+	BOOST_CHECK_NO_THROW(drwLogLikelihood(repeated, f, e, 1.0, 1.0));
+	
+	/* @test A constant light curve. Expected behavior = throw BadLightCurve.
+	 */
+	BOOST_CHECK_THROW(fitDrw(t, DoubleVec(t.size(), 1.0), e, tau, sigma), 
+			except::BadLightCurve);
+}
+
+/** Tests whether the Kalman filter matches the Gaussian process likelihood
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(likelihood) {
+	const DoubleVec t(times[0].begin(), times[0].begin() + 60);
+	const DoubleVec f(fluxes[0].begin(), fluxes[0].begin() + 60);
+	DoubleVec e(errors[0].begin(), errors[0].begin() + 60);
+	e[7] = 0.0;
+	e[30] = 0.5;
+	
+	DoubleVec taus, sigmas;
+	taus.push_back(0.5);
+	taus.push_back(20.0);
+	taus.push_back(3000.0);
+	sigmas.push_back(0.3);
+	sigmas.push_back(2.0);
+	
+	/* @test A grid of parameters, with heterogeneous errors. Expected 
+	 *	behavior = matches the likelihood calculated from the covariance 
+	 *	matrix, and the single-parameter version.
+	 */
+	DoubleVec grid;
+	BOOST_REQUIRE_NO_THROW(drwLogLikelihood(t, f, e, taus, sigmas, grid));
+	BOOST_REQUIRE_EQUAL(grid.size(), taus.size()*sigmas.size());
+	for (size_t i = 0; i < taus.size(); i++) {
+		for (size_t j = 0; j < sigmas.size(); j++) {
+			const double expected = gpLogLikelihood(t, f, e, taus[i], sigmas[j]);
+			BOOST_CHECK_CLOSE(grid[i*sigmas.size() + j], expected, 1e-6);
+			BOOST_CHECK_EQUAL(grid[i*sigmas.size() + j], 
+					drwLogLikelihood(t, f, e, taus[i], sigmas[j]));
+		}
+	}
+	
+	/* @test Fluxes shifted by a constant. Expected behavior = same 
+	 *	likelihood, since the mean is fit.
+	 */
+	DoubleVec shifted(f);
+	for (size_t i = 0; i < shifted.size(); i++) {
+		shifted[i] += 100.0;
+	}
+	BOOST_CHECK_CLOSE(drwLogLikelihood(t, shifted, e, 20.0, 2.0), 
+			drwLogLikelihood(t, f, e, 20.0, 2.0), 1e-10);
+}
+
+/** Tests whether fitDrw() recovers the simulated parameters
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(fit) {
+	/* @test Damped random walks with tau = 20 and sigma = 2, observed 
+	 *	1000 times over 100 timescales. Expected behavior = parameters 
+	 *	recovered within their statistical errors, at a likelihood 
+	 *	maximum.
+	 */
+	double tau = 0.0, sigma = 0.0;
+	BOOST_REQUIRE_NO_THROW(fitDrw(times[0], fluxes[0], errors[0], tau, sigma));
+	BOOST_CHECK_CLOSE(tau, 20.0, 40.0);
+	BOOST_CHECK_CLOSE(sigma, 2.0, 20.0);
+	const double best = drwLogLikelihood(times[0], fluxes[0], errors[0], tau, sigma);
+	BOOST_CHECK_GE(best, drwLogLikelihood(times[0], fluxes[0], errors[0], 1.01*tau, sigma));
+	BOOST_CHECK_GE(best, drwLogLikelihood(times[0], fluxes[0], errors[0], 0.99*tau, sigma));
+	BOOST_CHECK_GE(best, drwLogLikelihood(times[0], fluxes[0], errors[0], tau, 1.01*sigma));
+	BOOST_CHECK_GE(best, drwLogLikelihood(times[0], fluxes[0], errors[0], tau, 0.99*sigma));
+	
+	/* @test A batch of three stars. Expected behavior = same results as 
+	 *	fitting each star separately.
+	 */
+	DoubleVec taus, sigmas;
+	BOOST_REQUIRE_NO_THROW(fitDrw(times, fluxes, errors, taus, sigmas));
+	BOOST_REQUIRE_EQUAL(taus.size(), times.size());
+	BOOST_REQUIRE_EQUAL(sigmas.size(), times.size());
+	for (size_t k = 0; k < times.size(); k++) {
+		BOOST_REQUIRE_NO_THROW(fitDrw(times[k], fluxes[k], errors[k], tau, sigma));
+		BOOST_CHECK_EQUAL(taus  [k], tau  );
+		BOOST_CHECK_EQUAL(sigmas[k], sigma);
+	}
+	
+	/* @test A batch with one unsorted star. Expected behavior = throw 
+	 *	NotSorted.
+	 */
+	std::swap(times[1][3], times[1][50]);
+	BOOST_CHECK_THROW(fitDrw(times, fluxes, errors, taus, sigmas), 
+			kpfutils::except::NotSorted);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
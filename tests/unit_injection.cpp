@@ -0,0 +1,206 @@
+/** Performs unit testing of kpftimes::injectionRecovery()
+ * @file timescales/tests/unit_injection.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats_except.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a cadence, a frequency grid, and a grid of injected signals
+ */
+class InjectionData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	InjectionData(): times(), freqs(), periods(), amplitudes(), threshold(0.0) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 100; i++) {
+			times.push_back(45.0*gsl_rng_uniform(gen.get()));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 1; i < 100; i++) {
+			freqs.push_back(0.01*i);
+		}
+		
+		periods.push_back(2.5);
+		periods.push_back(5.0);
+		amplitudes.push_back(0.0);
+		amplitudes.push_back(0.3);
+		amplitudes.push_back(2.0);
+		
+		threshold = lsThreshold(times, freqs, 0.01, 1000, WhiteNoise(), 42);
+	}
+	
+	virtual ~InjectionData() {
+	}
+	
+	/** Grid with 100 random times in ascending order
+	 */
+	DoubleVec times;
+	/** Grid of frequencies from 0.01 to 0.99
+	 */
+	DoubleVec freqs;
+	/** Periods of the injected signals
+	 */
+	DoubleVec periods;
+	/** Amplitudes of the injected signals, relative to the noise
+	 */
+	DoubleVec amplitudes;
+	/** Significance threshold for white noise, at 1% false alarm 
+	 *	probability
+	 */
+	double threshold;
+};
+
+/** Test cases for the injection-recovery engine
+ * @class BoostTest::test_injection
+ */
+BOOST_FIXTURE_TEST_SUITE(test_injection, InjectionData)
+
+/** Tests whether injectionRecovery() rejects invalid parameters
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	DoubleVec completeness;
+	
+	/* @test Zero injections. Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(injectionRecovery(times, freqs, periods, amplitudes, 0, 
+			WhiteNoise(), threshold, 0.02, 42, completeness), std::invalid_argument);
+	
+	/* @test A zero period or a negative amplitude. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	DoubleVec badPeriods(periods);
+	badPeriods.push_back(0.0);
+	BOOST_CHECK_THROW(injectionRecovery(times, freqs, badPeriods, amplitudes, 10, 
+			WhiteNoise(), threshold, 0.02, 42, completeness), std::invalid_argument);
+	DoubleVec badAmps(amplitudes);
+	badAmps.push_back(-1.0);
+	BOOST_CHECK_THROW(injectionRecovery(times, freqs, periods, badAmps, 10, 
+			WhiteNoise(), threshold, 0.02, 42, completeness), std::invalid_argument);
+	
+	/* @test A negative frequency tolerance. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(injectionRecovery(times, freqs, periods, amplitudes, 10, 
+			WhiteNoise(), threshold, -0.02, 42, completeness), std::invalid_argument);
+	
+	/* @test Unsorted times. Expected behavior = throw NotSorted.
+	 */
+	DoubleVec unsorted(times);
+	std::swap(unsorted[3], unsorted[50]);
+	BOOST_CHECK_THROW(injectionRecovery(unsorted, freqs, periods, amplitudes, 10, 
+			WhiteNoise(), threshold, 0.02, 42, completeness), 
+			kpfutils::except::NotSorted);
+}
+
+/** Tests whether completeness behaves as expected with amplitude
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(completeness) {
+	DoubleVec completeness;
+	
+	/* @test A grid of injections, with a number of injections that is not 
+	 *	a multiple of the block size. Expected behavior = one result per 
+	 *	period and amplitude, no recoveries without a signal, and all 
+	 *	signals recovered at high amplitude.
+	 */
+	BOOST_REQUIRE_NO_THROW(injectionRecovery(times, freqs, periods, amplitudes, 100, 
+			WhiteNoise(), threshold, 0.02, 42, completeness));
+	BOOST_REQUIRE_EQUAL(completeness.size(), periods.size()*amplitudes.size());
+	for (size_t p = 0; p < periods.size(); p++) {
+		const double* row = &completeness[p*amplitudes.size()];
+		BOOST_CHECK_LT(row[0], 0.05);
+		BOOST_CHECK_LE(row[0], row[1]);
+		BOOST_CHECK_LE(row[1], row[2]);
+		BOOST_CHECK_EQUAL(row[2], 1.0);
+	}
+	
+	/* @test The same injections repeated with the same seed. Expected 
+	 *	behavior = identical output.
+	 */
+	DoubleVec repeat;
+	BOOST_REQUIRE_NO_THROW(injectionRecovery(times, freqs, periods, amplitudes, 100, 
+			WhiteNoise(), threshold, 0.02, 42, repeat));
+	BOOST_CHECK(completeness == repeat);
+	
+	/* @test A threshold too high for any periodogram to reach. Expected 
+	 *	behavior = nothing recovered.
+	 */
+	BOOST_REQUIRE_NO_THROW(injectionRecovery(times, freqs, periods, amplitudes, 100, 
+			WhiteNoise(), 1e6, 0.02, 42, repeat));
+	BOOST_CHECK(repeat == DoubleVec(completeness.size(), 0.0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,216 @@
+/** Performs unit testing of the short light curve kernels
+ * @file timescales/tests/unit_kernels.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats.tmp.h"
+#include "../timescales.h"
+#include "../dft.h"
+#include "../kernels.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a long random light curve and a frequency grid
+ */
+class KernelData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	KernelData(): times(), fluxes(), freqs() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 2*MAX_SMALL_N; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+		}
+		
+		// More frequencies than one block of the kernels
+		for(double f = 0.0; f < 3.0; f += 0.005) {
+			freqs.push_back(f);
+		}
+	}
+	
+	virtual ~KernelData() {
+	}
+	
+	/** Computes the Lomb-Scargle periodogram directly from its definition.
+	 */
+	static DoubleVec reference(const DoubleVec &t, const DoubleVec &y, 
+			const DoubleVec &f) {
+		const double pi = 3.14159265358979323846;
+		double mean = kpfutils::mean(y.begin(), y.end());
+		double var  = kpfutils::variance(y.begin(), y.end());
+		
+		DoubleVec result;
+		for(size_t i = 0; i < f.size(); i++) {
+			double om = 2.0*pi*f[i];
+			if (om == 0.0) {
+				result.push_back(0.0);
+				continue;
+			}
+			double s2 = 0.0, c2 = 0.0;
+			for(size_t j = 0; j < t.size(); j++) {
+				s2 += sin(2.0*om*(t[j]-t[0]));
+				c2 += cos(2.0*om*(t[j]-t[0]));
+			}
+			double tau = 0.5*atan2(s2, c2)/om;
+			double yc = 0.0, ys = 0.0, cc = 0.0, ss = 0.0;
+			for(size_t j = 0; j < t.size(); j++) {
+				double phase = om*(t[j]-t[0]-tau);
+				yc += (y[j]-mean)*cos(phase);
+				ys += (y[j]-mean)*sin(phase);
+				cc += cos(phase)*cos(phase);
+				ss += sin(phase)*sin(phase);
+			}
+			result.push_back(0.5*(yc*yc/cc + ys*ys/ss)/var);
+		}
+		return result;
+	}
+	
+	/** Grid with 128 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Grid of frequencies, starting at zero
+	 */
+	DoubleVec freqs;
+};
+
+/** Test cases for the short light curve kernels
+ * @class BoostTest::test_kernels
+ */
+BOOST_FIXTURE_TEST_SUITE(test_kernels, KernelData)
+
+/** Tests whether lombScargle() is correct for every size of light curve
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(periodogram) {
+	/* @test Light curves with sizes at, just below, and just above each 
+	 *	kernel size, and just above MAX_SMALL_N. Expected behavior = 
+	 *	matches the definition of the periodogram.
+	 */
+	const size_t sizes[] = {3, 8, 9, 16, 23, 24, 31, 33, 47, 49, 63, 64, 65, 100};
+	for(size_t k = 0; k < sizeof(sizes)/sizeof(size_t); k++) {
+		DoubleVec t(times.begin(), times.begin() + sizes[k]);
+		DoubleVec y(fluxes.begin(), fluxes.begin() + sizes[k]);
+		DoubleVec expected = reference(t, y, freqs), actual;
+		
+		BOOST_REQUIRE_NO_THROW(lombScargle(t, y, freqs, actual));
+		BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+		double maxErr = 0.0, maxPower = 0.0;
+		for(size_t i = 0; i < actual.size(); i++) {
+			maxErr   = std::max(maxErr, fabs(actual[i] - expected[i]));
+			maxPower = std::max(maxPower, expected[i]);
+		}
+		BOOST_CHECK_MESSAGE(maxErr < 1e-9 * maxPower, "N = " << sizes[k] 
+			<< ": error of " << maxErr << " for maximum power " << maxPower);
+	}
+}
+
+/** Tests whether dft() gives the same answer for short light curves 
+ *	with and without a mask
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(transform) {
+	/* @test Masks leaving 10, 40, and 64 epochs. Expected behavior = 
+	 *	same result as the unmasked dft() on a filtered copy of the 
+	 *	data.
+	 */
+	const size_t sizes[] = {10, 40, 64};
+	for(size_t k = 0; k < sizeof(sizes)/sizeof(size_t); k++) {
+		BoolVec mask(times.size(), false);
+		DoubleVec t, y;
+		for(size_t j = 0; j < sizes[k]; j++) {
+			mask[2*j] = true;
+			t.push_back(times[2*j]);
+			y.push_back(fluxes[2*j]);
+		}
+		
+		ComplexVec expected, actual;
+		BOOST_REQUIRE_NO_THROW(dft(t, y, freqs, expected));
+		BOOST_REQUIRE_NO_THROW(dft(times, fluxes, mask, freqs, actual));
+		BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+		double maxErr = 0.0;
+		for(size_t i = 0; i < actual.size(); i++) {
+			maxErr = std::max(maxErr, std::abs(actual[i] - expected[i]));
+		}
+		BOOST_CHECK_MESSAGE(maxErr < 1e-10 * sizes[k], "N = " << sizes[k] 
+			<< ": error of " << maxErr);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
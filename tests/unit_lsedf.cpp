@@ -0,0 +1,262 @@
+/** Performs unit testing of kpftimes::LsEdf
+ * @file timescales/tests/unit_lsedf.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a simulated distribution of false peaks
+ */
+class LsEdfData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	LsEdfData(): times(), freqs(), peaks(), probs(), probes(), fileName("test_lsedf.bin") {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_taus2)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 100; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(double i = 0.01; i < 1.0; i+=0.01) {
+			freqs.push_back(i);
+		}
+		
+		lsNormalEdf(times, freqs, peaks, probs, 4000, WhiteNoise(), 1729);
+		
+		// Covers the whole distribution, including both ends and 
+		//	every simulated peak
+		for(size_t i = 0; i < 2000; i++) {
+			probes.push_back(peaks.front() - 1.0 
+				+ (peaks.back() - peaks.front() + 2.0) * gsl_rng_uniform(gen.get()));
+		}
+		probes.insert(probes.end(), peaks.begin(), peaks.end());
+	}
+	
+	virtual ~LsEdfData() {
+		std::remove(fileName.c_str());
+	}
+	
+	/** The false alarm probability of a power under the full distribution
+	 */
+	double exactFap(double power) const {
+		return 1.0 - static_cast<double>(std::upper_bound(peaks.begin(), peaks.end(), power) 
+			- peaks.begin()) / peaks.size();
+	}
+	
+	/** Grid with 100 random times in ascending order
+	 */
+	DoubleVec times;
+	/** Grid with only positive frequencies, in ascending order
+	 */
+	DoubleVec freqs;
+	/** Sorted peak powers of 4000 white noise simulations
+	 */
+	DoubleVec peaks;
+	/** The distribution function at @p peaks
+	 */
+	DoubleVec probs;
+	/** Powers at which to test the distribution
+	 */
+	DoubleVec probes;
+	/** Name of a file used only by this test
+	 */
+	std::string fileName;
+};
+
+/** Test cases for LsEdf
+ * @class BoostTest::test_lsedf
+ */
+BOOST_FIXTURE_TEST_SUITE(test_lsedf, LsEdfData)
+
+/** Tests whether LsEdf rejects invalid input
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	/* @test No peaks, a peak that is NaN, or too few knots. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(LsEdf edf(DoubleVec(), 64), std::invalid_argument);
+	DoubleVec bad(peaks);
+	bad[17] = std::numeric_limits<double>::quiet_NaN();
+	BOOST_CHECK_THROW(LsEdf edf(bad), std::invalid_argument);
+	BOOST_CHECK_THROW(LsEdf edf(peaks, 3), std::invalid_argument);
+	
+	/* @test A threshold outside (0, 1), or beyond the simulations. 
+	 *	Expected behavior = throw invalid_argument.
+	 */
+	LsEdf edf(peaks, 64);
+	BOOST_CHECK_THROW(edf.threshold(0.0), std::invalid_argument);
+	BOOST_CHECK_THROW(edf.threshold(1.0), std::invalid_argument);
+	BOOST_CHECK_THROW(edf.threshold(0.001), std::invalid_argument);
+	
+	/* @test Loading a missing file, or one of the wrong type. Expected 
+	 *	behavior = throw runtime_error.
+	 */
+	BOOST_CHECK_THROW(LsEdf edf2("no_such_file.bin"), std::runtime_error);
+	BOOST_CHECK_THROW(LsEdf edf2("../makefile"), std::runtime_error);
+}
+
+/** Tests whether LsEdf matches the distribution it summarizes
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(accuracy) {
+	/* @test A distribution with fewer peaks than knots. Expected behavior 
+	 *	= exact false alarm probabilities, and the same distribution 
+	 *	as lsNormalEdf().
+	 */
+	LsEdf exact(peaks, 8192);
+	BOOST_CHECK_EQUAL(exact.getNumSims(), 4000);
+	for(size_t i = 0; i < probes.size(); i++) {
+		BOOST_CHECK_SMALL(exact.fap(probes[i]) - exactFap(probes[i]), 1e-12);
+	}
+	for(size_t i = 0; i < peaks.size(); i++) {
+		if (i+1 == peaks.size() || peaks[i+1] > peaks[i]) {
+			BOOST_CHECK_SMALL(1.0 - exact.fap(peaks[i]) - probs[i], 1e-12);
+		}
+	}
+	
+	/* @test A distribution with 256 knots. Expected behavior = at most 
+	 *	256 knots, false alarm probabilities within 1% overall, and 
+	 *	exact in the highest 128 peaks.
+	 */
+	LsEdf compact(peaks, 256);
+	BOOST_CHECK_LE(compact.size(), 256U);
+	const double tailStart = peaks[peaks.size() - 128];
+	for(size_t i = 0; i < probes.size(); i++) {
+		const double error = compact.fap(probes[i]) - exactFap(probes[i]);
+		BOOST_CHECK_SMALL(error, 0.01);
+		if (probes[i] >= tailStart) {
+			BOOST_CHECK_SMALL(error, 1e-12);
+		}
+	}
+	
+	/* @test Powers below and above every simulated peak. Expected behavior 
+	 *	= false alarm probabilities of 1 and 0.
+	 */
+	BOOST_CHECK_EQUAL(compact.fap(peaks.front() - 1.0), 1.0);
+	BOOST_CHECK_EQUAL(compact.fap(peaks.back()), 0.0);
+	BOOST_CHECK_EQUAL(compact.fap(peaks.back() + 1.0), 0.0);
+	
+	/* @test Thresholds at false alarm probabilities of 5% and 1%. Expected 
+	 *	behavior = close to lsThreshold() with the same simulations, and 
+	 *	consistent with fap().
+	 */
+	const double fap[] = {0.05, 0.01};
+	for(size_t i = 0; i < 2; i++) {
+		const double expected = lsThreshold(times, freqs, fap[i], 4000, WhiteNoise(), 1729);
+		const double actual   = compact.threshold(fap[i]);
+		BOOST_CHECK_CLOSE(actual, expected, 1.0);
+		BOOST_CHECK_LE(compact.fap(actual), fap[i] + 1e-12);
+	}
+}
+
+/** Tests whether batched lookup and saved files agree with the original
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(batch) {
+	LsEdf edf(peaks, 256);
+	
+	/* @test Many powers looked up at once, including NaN. Expected 
+	 *	behavior = same results as looking them up one at a time.
+	 */
+	DoubleVec powers(probes);
+	powers.push_back(std::numeric_limits<double>::quiet_NaN());
+	DoubleVec faps;
+	BOOST_REQUIRE_NO_THROW(edf.fap(powers, faps));
+	BOOST_REQUIRE_EQUAL(faps.size(), powers.size());
+	for(size_t i = 0; i+1 < powers.size(); i++) {
+		BOOST_CHECK_EQUAL(faps[i], edf.fap(powers[i]));
+	}
+	BOOST_CHECK(faps.back() != faps.back());
+	BOOST_CHECK(edf.fap(powers.back()) != edf.fap(powers.back()));
+	
+	/* @test A distribution saved and loaded again. Expected behavior = 
+	 *	identical results.
+	 */
+	BOOST_REQUIRE_NO_THROW(edf.save(fileName));
+	LsEdf loaded(fileName);
+	BOOST_CHECK_EQUAL(loaded.getNumSims(), edf.getNumSims());
+	BOOST_CHECK_EQUAL(loaded.size(), edf.size());
+	DoubleVec loadedFaps;
+	BOOST_REQUIRE_NO_THROW(loaded.fap(powers, loadedFaps));
+	for(size_t i = 0; i+1 < powers.size(); i++) {
+		BOOST_CHECK_EQUAL(loadedFaps[i], faps[i]);
+	}
+	BOOST_CHECK_EQUAL(loaded.threshold(0.01), edf.threshold(0.01));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,293 @@
+/** Performs unit testing of the mask-aware analysis functions
+ * @file timescales/tests/unit_masks.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** This function is a wrapper for a trusted approximate comparison method.
+ */
+bool isClose(double val1, double val2, double frac);
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve and several masks
+ */
+class MaskData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	MaskData(): times(), fluxes(), freqs(), offsets(), fewMasked(), mostMasked(), 
+			allValid(), oneValid() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 200; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+			
+			fewMasked .push_back(gsl_rng_uniform(gen.get()) > 0.1);
+			mostMasked.push_back(gsl_rng_uniform(gen.get()) > 0.8);
+		}
+		allValid = BoolVec(times.size(), true );
+		oneValid = BoolVec(times.size(), false);
+		oneValid[17] = true;
+		
+		for(double f = 0.0; f < 2.0; f += 0.01) {
+			freqs.push_back(f);
+		}
+		for(double t = 0.0; t < 20.0; t += 0.5) {
+			offsets.push_back(t);
+		}
+	}
+	
+	virtual ~MaskData() {
+	}
+	
+	/** Copies the unmasked elements of a vector, the way users had to 
+	 *	before masks were supported.
+	 */
+	static DoubleVec filter(const DoubleVec &x, const BoolVec &mask) {
+		DoubleVec result;
+		for(size_t i = 0; i < x.size(); i++) {
+			if (mask[i]) {
+				result.push_back(x[i]);
+			}
+		}
+		return result;
+	}
+	
+	/** Grid with 200 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Grid of frequencies, starting at zero
+	 */
+	DoubleVec freqs;
+	/** Uniform grid of ACF offsets
+	 */
+	DoubleVec offsets;
+	/** Mask with roughly 10% of epochs removed
+	 */
+	BoolVec fewMasked;
+	/** Mask with roughly 80% of epochs removed
+	 */
+	BoolVec mostMasked;
+	/** Mask with no epochs removed
+	 */
+	BoolVec allValid;
+	/** Mask with all but one epoch removed
+	 */
+	BoolVec oneValid;
+};
+
+/** Checks that two vectors agree element by element
+ *
+ * @param[in] expected, actual The vectors to compare
+ * @param[in] frac The fractional difference allowed between elements
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void checkClose(const DoubleVec &expected, const DoubleVec &actual, double frac) {
+	BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+	for(size_t i = 0; i < expected.size(); i++) {
+		if (fabs(expected[i]) > 1e-8 || fabs(actual[i]) > 1e-8) {
+			BOOST_CHECK_MESSAGE(isClose(expected[i], actual[i], frac), 
+				"Element " << i << ": expected " << expected[i] 
+				<< ", got " << actual[i]);
+		}
+	}
+}
+
+/** Test cases for mask-aware analysis functions
+ * @class BoostTest::test_masks
+ */
+BOOST_FIXTURE_TEST_SUITE(test_masks, MaskData)
+
+/** Tests whether masked periodograms match periodograms of filtered data
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(periodogram) {
+	DoubleVec expected, direct, planned;
+	LsPlan plan(times, freqs);
+	
+	/* @test A mask with no epochs removed. Expected behavior = same 
+	 *	result as the unmasked lombScargle()
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, allValid, freqs, direct));
+	BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, allValid, planned));
+	checkClose(expected, direct , 1e-12);
+	checkClose(expected, planned, 1e-8);
+	
+	/* @test A mask with 10% of epochs removed. Expected behavior = same 
+	 *	result as lombScargle() on a filtered copy of the data
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(filter(times, fewMasked), filter(fluxes, fewMasked), 
+			freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, fewMasked, freqs, direct));
+	BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, fewMasked, planned));
+	checkClose(expected, direct , 1e-8);
+	checkClose(expected, planned, 1e-8);
+	
+	/* @test A mask with 80% of epochs removed. Expected behavior = same 
+	 *	result as lombScargle() on a filtered copy of the data
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(filter(times, mostMasked), filter(fluxes, mostMasked), 
+			freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mostMasked, freqs, direct));
+	BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, mostMasked, planned));
+	checkClose(expected, direct , 1e-8);
+	checkClose(expected, planned, 1e-8);
+	
+	/* @test A mask with only one epoch left. Expected behavior = throw 
+	 *	invalid_argument
+	 */
+	BOOST_CHECK_THROW(lombScargle(times, fluxes, oneValid, freqs, direct), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(lombScargle(plan, fluxes, oneValid, planned), 
+			std::invalid_argument);
+	
+	/* @test A mask of the wrong length. Expected behavior = throw 
+	 *	invalid_argument
+	 */
+	BOOST_CHECK_THROW(lombScargle(times, fluxes, BoolVec(3, true), freqs, direct), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(lombScargle(plan, fluxes, BoolVec(3, true), planned), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(lombScargle(plan, DoubleVec(3, 1.0), BoolVec(3, true), planned), 
+			std::invalid_argument);
+}
+
+/** Tests whether masked ACFs, &Delta;m&Delta;t plots, and peak-finding 
+ *	plots match those of filtered data
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(others) {
+	DoubleVec expected1, expected2, actual1, actual2;
+	
+	/* @test autoCorr() with 10% of epochs removed. Expected behavior = same 
+	 *	result as autoCorr() on a filtered copy of the data
+	 */
+	BOOST_REQUIRE_NO_THROW(autoCorr(filter(times, fewMasked), filter(fluxes, fewMasked), 
+			offsets, expected1));
+	BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, fewMasked, offsets, actual1));
+	checkClose(expected1, actual1, 1e-8);
+	
+	/* @test dmdt() with 80% of epochs removed. Expected behavior = same 
+	 *	result as dmdt() on a filtered copy of the data
+	 */
+	BOOST_REQUIRE_NO_THROW(dmdt(filter(times, mostMasked), filter(fluxes, mostMasked), 
+			expected1, expected2));
+	BOOST_REQUIRE_NO_THROW(dmdt(times, fluxes, mostMasked, actual1, actual2));
+	BOOST_CHECK(expected1 == actual1);
+	BOOST_CHECK(expected2 == actual2);
+	
+	/* @test peakFind() with 10% of epochs removed. Expected behavior = same 
+	 *	result as peakFind() on a filtered copy of the data
+	 */
+	BOOST_REQUIRE_NO_THROW(peakFind(filter(times, fewMasked), filter(fluxes, fewMasked), 
+			0.5, expected1, expected2));
+	BOOST_REQUIRE_NO_THROW(peakFind(times, fluxes, fewMasked, 0.5, actual1, actual2));
+	BOOST_CHECK(expected1 == actual1);
+	BOOST_CHECK(expected2 == actual2);
+	
+	/* @test peakFindTimescales() with 80% of epochs removed. Expected behavior 
+	 *	= same result as peakFindTimescales() on a filtered copy of the data
+	 */
+	DoubleVec cuts;
+	cuts.push_back(0.2);
+	cuts.push_back(0.5);
+	cuts.push_back(1.0);
+	BOOST_REQUIRE_NO_THROW(peakFindTimescales(filter(times, mostMasked), 
+			filter(fluxes, mostMasked), cuts, expected1));
+	BOOST_REQUIRE_NO_THROW(peakFindTimescales(times, fluxes, mostMasked, cuts, actual1));
+	BOOST_CHECK(expected1 == actual1);
+	
+	/* @test Each function with only one epoch left. Expected behavior = throw 
+	 *	invalid_argument
+	 */
+	BOOST_CHECK_THROW(autoCorr(times, fluxes, oneValid, offsets, actual1), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(dmdt(times, fluxes, oneValid, actual1, actual2), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(peakFind(times, fluxes, oneValid, 0.5, actual1, actual2), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(peakFindTimescales(times, fluxes, oneValid, cuts, actual1), 
+			std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
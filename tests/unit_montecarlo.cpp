@@ -0,0 +1,318 @@
+/** Performs unit testing of the interruptible Monte Carlo interface
+ * @file timescales/tests/unit_montecarlo.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains generic time and frequency grids
+ */
+class MonteCarloData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	MonteCarloData(): times(), freqs(), model(), seed(1729) {
+		shared_ptr<gsl_rng> timeGen(checkAlloc(gsl_rng_alloc(gsl_rng_taus2)), 
+			&gsl_rng_free);
+		gsl_rng_set(timeGen.get(), 42);
+		
+		for(size_t i = 0; i < 100; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(timeGen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		
+		for(double i = 0.01; i < 1.0; i+=0.01) {
+			freqs.push_back(i);
+		}
+	}
+	
+	virtual ~MonteCarloData() {
+	}
+	
+	/** Grid with 100 random times in ascending order
+	 */
+	DoubleVec times;
+	/** Grid with only positive frequencies, in ascending order
+	 */
+	DoubleVec freqs;
+	/** Noise model to simulate
+	 */
+	WhiteNoise model;
+	/** Seed for all simulations
+	 */
+	unsigned long seed;
+};
+
+/** Progress monitor that records its reports and cancels after a set 
+ *	number of them.
+ */
+class CountingMonitor : public ProgressMonitor {
+public:
+	explicit CountingMonitor(long maxReports) : maxReports(maxReports), 
+			reports(0), lastDone(0), lastTotal(0) {
+	}
+	
+	virtual bool update(long done, long total, double) {
+		reports++;
+		lastDone  = done;
+		lastTotal = total;
+		return reports < maxReports;
+	}
+	
+	long maxReports;
+	long reports;
+	long lastDone;
+	long lastTotal;
+};
+
+/** Test cases for LsMonteCarlo
+ * @class BoostTest::test_montecarlo
+ */
+BOOST_FIXTURE_TEST_SUITE(test_montecarlo, MonteCarloData)
+
+/** Tests whether a complete run matches lsThreshold() and lsNormalEdf()
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(complete) {
+	const long nSims = 1000;
+	LsMonteCarlo job(times, freqs, nSims, model, seed);
+	CountingMonitor monitor(1000000);
+	job.setMonitor(&monitor);
+	
+	BOOST_CHECK_EQUAL(job.getNumSims(), nSims);
+	BOOST_CHECK_EQUAL(job.getNumDone(), 0);
+	BOOST_CHECK(!job.isDone());
+	BOOST_CHECK_LT(job.estimateRemaining(), 0.0);
+	
+	/* @test Run to completion. Expected behavior = same results as 
+	 *	lsThreshold() and lsNormalEdf() with the same seed
+	 */
+	BOOST_REQUIRE(job.run());
+	BOOST_CHECK(job.isDone());
+	BOOST_CHECK(!job.isCancelled());
+	BOOST_CHECK_EQUAL(job.getNumDone(), nSims);
+	BOOST_CHECK_EQUAL(job.estimateRemaining(), 0.0);
+	BOOST_CHECK_GT(monitor.reports, 0);
+	BOOST_CHECK_EQUAL(monitor.lastDone , nSims);
+	BOOST_CHECK_EQUAL(monitor.lastTotal, nSims);
+	
+	BOOST_CHECK_EQUAL(job.threshold(0.05), 
+			lsThreshold(times, freqs, 0.05, nSims, model, seed));
+	
+	DoubleVec powers, probs, expectedPowers, expectedProbs;
+	BOOST_REQUIRE_NO_THROW(job.edf(powers, probs));
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, expectedPowers, expectedProbs, 
+			nSims, model, seed));
+	BOOST_CHECK(powers == expectedPowers);
+	BOOST_CHECK(probs  == expectedProbs );
+	
+	/* @test Invalid false alarm probability. Expected behavior = throw 
+	 *	invalid_argument
+	 */
+	BOOST_CHECK_THROW(job.threshold(0.0), std::invalid_argument);
+	BOOST_CHECK_THROW(job.threshold(0.001), std::invalid_argument);
+}
+
+/** Tests whether an interrupted run gives a consistent partial result
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(partial) {
+	const long nSims = 1000;
+	
+	/* @test Cancelled before running. Expected behavior = nothing run
+	 */
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed);
+		job.cancel();
+		BOOST_CHECK(!job.run());
+		BOOST_CHECK(job.isCancelled());
+		BOOST_CHECK_EQUAL(job.getNumDone(), 0);
+		DoubleVec powers, probs;
+		BOOST_CHECK_THROW(job.edf(powers, probs), std::invalid_argument);
+	}
+	
+	/* @test Cancelled by the monitor after the first report. Expected 
+	 *	behavior = partial results equal a shorter run with the same 
+	 *	seed
+	 */
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed);
+		CountingMonitor monitor(1);
+		job.setMonitor(&monitor);
+		BOOST_CHECK(!job.run());
+		BOOST_CHECK(job.isCancelled());
+		BOOST_CHECK_EQUAL(monitor.reports, 1);
+		
+		const long nDone = job.getNumDone();
+		BOOST_CHECK_GT(nDone, 0);
+		BOOST_CHECK_LT(nDone, nSims);
+		BOOST_CHECK_GT(job.estimateRemaining(), 0.0);
+		
+		DoubleVec powers, probs, expectedPowers, expectedProbs;
+		BOOST_REQUIRE_NO_THROW(job.edf(powers, probs));
+		BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, expectedPowers, expectedProbs, 
+				nDone, model, seed));
+		BOOST_CHECK(powers == expectedPowers);
+		BOOST_CHECK(probs  == expectedProbs );
+	}
+	
+	/* @test Run in time-limited stages. Expected behavior = each stage 
+	 *	makes progress, and the final result is the same as an 
+	 *	uninterrupted run
+	 */
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed);
+		long stages = 0;
+		long lastDone = 0;
+		while (!job.runFor(0.0)) {
+			BOOST_REQUIRE_GT(job.getNumDone(), lastDone);
+			lastDone = job.getNumDone();
+			stages++;
+		}
+		BOOST_CHECK_GT(stages, 0);
+		BOOST_CHECK_EQUAL(job.threshold(0.05), 
+				lsThreshold(times, freqs, 0.05, nSims, model, seed));
+	}
+}
+
+/** Tests whether a run resumed from a checkpoint matches an 
+ *	uninterrupted run
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(checkpoint) {
+	const long nSims = 1000;
+	const char* const fileName = "checkpoint_test.dat";
+	
+	DoubleVec expectedPowers, expectedProbs;
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, expectedPowers, expectedProbs, 
+			nSims, model, seed));
+	
+	/* @test Run interrupted after one report, then resumed by a new 
+	 *	object. Expected behavior = same result as an uninterrupted run
+	 */
+	long nSaved = 0;
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed);
+		CountingMonitor monitor(1);
+		job.setMonitor(&monitor);
+		BOOST_REQUIRE_NO_THROW(job.setCheckpoint(fileName, 1000.0));
+		BOOST_CHECK(!job.run());
+		nSaved = job.getNumDone();
+	}
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed);
+		BOOST_REQUIRE_NO_THROW(job.restore(fileName));
+		BOOST_CHECK_EQUAL(job.getNumDone(), nSaved);
+		BOOST_CHECK(job.run());
+		
+		DoubleVec powers, probs;
+		BOOST_REQUIRE_NO_THROW(job.edf(powers, probs));
+		BOOST_CHECK(powers == expectedPowers);
+		BOOST_CHECK(probs  == expectedProbs );
+	}
+	
+	/* @test Checkpoint restored into runs with different inputs. Expected 
+	 *	behavior = throw invalid_argument
+	 */
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed+1);
+		BOOST_CHECK_THROW(job.restore(fileName), std::invalid_argument);
+		BOOST_CHECK_EQUAL(job.getNumDone(), 0);
+	}
+	{
+		LsMonteCarlo job(times, freqs, nSims, DampedRandomWalk(3.0), seed);
+		BOOST_CHECK_THROW(job.restore(fileName), std::invalid_argument);
+	}
+	{
+		DoubleVec otherFreqs(freqs.begin(), freqs.end()-1);
+		LsMonteCarlo job(times, otherFreqs, nSims, model, seed);
+		BOOST_CHECK_THROW(job.restore(fileName), std::invalid_argument);
+	}
+	
+	/* @test Restoring from a file that is not a checkpoint. Expected 
+	 *	behavior = throw runtime_error
+	 */
+	{
+		std::ofstream junk(fileName);
+		junk << "Not a checkpoint file\n";
+	}
+	{
+		LsMonteCarlo job(times, freqs, nSims, model, seed);
+		BOOST_CHECK_THROW(job.restore(fileName), std::runtime_error);
+		BOOST_CHECK_THROW(job.restore("no_such_checkpoint.dat"), std::runtime_error);
+	}
+	
+	std::remove(fileName);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,292 @@
+/** Performs unit testing of kpftimes::lombScargleMultiband()
+ * @file timescales/tests/unit_multiband.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../timeexcept.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a variable star observed in three filters, each with its own 
+ * cadence, offset, and amplitude
+ */
+class MultibandData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	MultibandData(): times(3), fluxes(3), freqs(), trueFreq(0.37) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		const size_t sizes[]   = {40, 25, 60};
+		const double offsets[] = {12.0, 11.5, 13.2};
+		const double amps[]    = {1.0, 0.6, 0.3};
+		const double phases[]  = {0.0, 0.4, 1.1};
+		for(size_t b = 0; b < 3; b++) {
+			for(size_t i = 0; i < sizes[b]; i++) {
+				// Nightly visits, so each band alone has strong aliases
+				const double t = floor(100.0*gsl_rng_uniform(gen.get())) 
+						+ 0.1*gsl_rng_uniform(gen.get());
+				times [b].push_back(t);
+				fluxes[b].push_back(offsets[b] 
+					+ amps[b]*sin(2.0*3.14159265358979*trueFreq*t + phases[b]) 
+					+ gsl_ran_gaussian(gen.get(), 0.05));
+			}
+		}
+		
+		for(double f = 0.005; f < 2.0; f += 0.005) {
+			freqs.push_back(f);
+		}
+	}
+	
+	virtual ~MultibandData() {
+	}
+	
+	/** Calculates the multiband periodogram by fitting each band 
+	 *	separately with the normal equations.
+	 */
+	static double directPower(const std::vector<DoubleVec> &times, 
+			const std::vector<DoubleVec> &fluxes, double freq) {
+		double chi2Const = 0.0, chi2Sine = 0.0;
+		for(size_t b = 0; b < times.size(); b++) {
+			// Normal equations for y = a + b cos(wt) + c sin(wt)
+			double m[3][3] = {{0.0}}, v[3] = {0.0};
+			double mean = 0.0;
+			for(size_t j = 0; j < times[b].size(); j++) {
+				const double basis[3] = {1.0, cos(2.0*3.14159265358979*freq*times[b][j]), 
+						sin(2.0*3.14159265358979*freq*times[b][j])};
+				for(size_t r = 0; r < 3; r++) {
+					for(size_t c = 0; c < 3; c++) {
+						m[r][c] += basis[r]*basis[c];
+					}
+					v[r] += basis[r]*fluxes[b][j];
+				}
+				mean += fluxes[b][j] / times[b].size();
+			}
+			const double x[3] = {solve(m, v, 0), solve(m, v, 1), solve(m, v, 2)};
+			for(size_t j = 0; j < times[b].size(); j++) {
+				const double model = x[0] + x[1]*cos(2.0*3.14159265358979*freq*times[b][j]) 
+						+ x[2]*sin(2.0*3.14159265358979*freq*times[b][j]);
+				chi2Const += (fluxes[b][j] - mean )*(fluxes[b][j] - mean );
+				chi2Sine  += (fluxes[b][j] - model)*(fluxes[b][j] - model);
+			}
+		}
+		return 1.0 - chi2Sine/chi2Const;
+	}
+	
+	/** Solves a 3&times;3 system for one unknown by Cramer's rule.
+	 */
+	static double solve(const double m[3][3], const double v[3], size_t k) {
+		double mk[3][3];
+		for(size_t r = 0; r < 3; r++) {
+			for(size_t c = 0; c < 3; c++) {
+				mk[r][c] = (c == k ? v[r] : m[r][c]);
+			}
+		}
+		return det(mk) / det(m);
+	}
+	
+	/** Returns the determinant of a 3&times;3 matrix.
+	 */
+	static double det(const double m[3][3]) {
+		return m[0][0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1]) 
+			- m[0][1]*(m[1][0]*m[2][2] - m[1][2]*m[2][0]) 
+			+ m[0][2]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+	}
+	
+	/** The times at which each band was observed
+	 */
+	std::vector<DoubleVec> times;
+	/** A noisy sine wave observed in each band
+	 */
+	std::vector<DoubleVec> fluxes;
+	/** Grid of positive frequencies, in ascending order
+	 */
+	DoubleVec freqs;
+	/** The frequency of the sine wave
+	 */
+	const double trueFreq;
+};
+
+/** Test cases for the multiband periodogram
+ * @class BoostTest::test_multiband
+ */
+BOOST_FIXTURE_TEST_SUITE(test_multiband, MultibandData)
+
+/** Tests whether lombScargleMultiband() rejects invalid input
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	DoubleVec power;
+	
+	/* @test No bands, or different numbers of bands for times and data. 
+	 *	Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(lombScargleMultiband(std::vector<DoubleVec>(), 
+		std::vector<DoubleVec>(), freqs, power), std::invalid_argument);
+	std::vector<DoubleVec> fewer(fluxes.begin(), fluxes.begin() + 2);
+	BOOST_CHECK_THROW(lombScargleMultiband(times, fewer, freqs, power), 
+		std::invalid_argument);
+	/* @test A band whose times and data have different lengths. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	std::vector<DoubleVec> shorter(fluxes);
+	shorter[1].pop_back();
+	BOOST_CHECK_THROW(lombScargleMultiband(times, shorter, freqs, power), 
+		std::invalid_argument);
+	/* @test A band with only one distinct time. Expected behavior = throw 
+	 *	BadLightCurve.
+	 */
+	std::vector<DoubleVec> oneDate(times);
+	oneDate[2].assign(oneDate[2].size(), 42.0);
+	BOOST_CHECK_THROW(lombScargleMultiband(oneDate, fluxes, freqs, power), 
+		except::BadLightCurve);
+	/* @test Constant data in every band. Expected behavior = throw 
+	 *	BadLightCurve.
+	 */
+	std::vector<DoubleVec> constant(fluxes);
+	for(size_t b = 0; b < constant.size(); b++) {
+		constant[b].assign(constant[b].size(), 1.0 + b);
+	}
+	BOOST_CHECK_THROW(lombScargleMultiband(times, constant, freqs, power), 
+		except::BadLightCurve);
+	/* @test A negative frequency. Expected behavior = throw NegativeFreq.
+	 */
+	BOOST_CHECK_THROW(lombScargleMultiband(times, fluxes, DoubleVec(1, -0.1), power), 
+		except::NegativeFreq);
+}
+
+/** Tests whether lombScargleMultiband() matches separate least-squares 
+ *	fits to each band
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(fits) {
+	DoubleVec power;
+	
+	/* @test Three bands with different cadences, offsets, and amplitudes. 
+	 *	Expected behavior = matches a direct fit of the normal equations 
+	 *	at every frequency.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargleMultiband(times, fluxes, freqs, power));
+	BOOST_REQUIRE_EQUAL(power.size(), freqs.size());
+	for(size_t i = 0; i < freqs.size(); i++) {
+		BOOST_CHECK_SMALL(power[i] - directPower(times, fluxes, freqs[i]), 1e-9);
+		BOOST_CHECK_GE(power[i], -1e-12);
+		BOOST_CHECK_LE(power[i], 1.0 + 1e-12);
+	}
+	
+	/* @test A single band. Expected behavior = matches a direct fit of 
+	 *	that band alone.
+	 */
+	std::vector<DoubleVec> oneTimes(1, times[1]), oneFluxes(1, fluxes[1]);
+	BOOST_REQUIRE_NO_THROW(lombScargleMultiband(oneTimes, oneFluxes, freqs, power));
+	for(size_t i = 0; i < freqs.size(); i++) {
+		BOOST_CHECK_SMALL(power[i] - directPower(oneTimes, oneFluxes, freqs[i]), 1e-9);
+	}
+	
+	/* @test The bands in a different order. Expected behavior = same 
+	 *	periodogram.
+	 */
+	DoubleVec reordered;
+	std::vector<DoubleVec> revTimes(times.rbegin(), times.rend()), 
+		revFluxes(fluxes.rbegin(), fluxes.rend());
+	BOOST_REQUIRE_NO_THROW(lombScargleMultiband(times, fluxes, freqs, power));
+	BOOST_REQUIRE_NO_THROW(lombScargleMultiband(revTimes, revFluxes, freqs, reordered));
+	for(size_t i = 0; i < freqs.size(); i++) {
+		BOOST_CHECK_SMALL(power[i] - reordered[i], 1e-12);
+	}
+	
+	/* @test A zero frequency. Expected behavior = zero power.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargleMultiband(times, fluxes, DoubleVec(1, 0.0), power));
+	BOOST_CHECK_EQUAL(power[0], 0.0);
+}
+
+/** Tests whether lombScargleMultiband() finds the common period
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(period) {
+	DoubleVec power;
+	
+	/* @test Three bands with nightly cadences. Expected behavior = the 
+	 *	highest peak is at the true frequency, not at a daily alias, 
+	 *	and the sinusoids explain almost all of the variance.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargleMultiband(times, fluxes, freqs, power));
+	const size_t best = std::max_element(power.begin(), power.end()) - power.begin();
+	BOOST_CHECK_SMALL(freqs[best] - trueFreq, 0.005);
+	BOOST_CHECK_GT(power[best], 0.9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,239 @@
+/** Performs unit testing of the red noise versions of kpftimes::lsThreshold() 
+ *	and kpftimes::lsNormalEdf()
+ * @file timescales/tests/unit_nullmodels.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../nufft.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains generic time and frequency grids
+ */
+class NullModelData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	NullModelData(): times100randsort(), posFreq() {
+		shared_ptr<gsl_rng> timeGen(checkAlloc(gsl_rng_alloc(gsl_rng_taus2)), 
+			&gsl_rng_free);
+		gsl_rng_set(timeGen.get(), 42);
+		
+		for(size_t i = 0; i < 100; i++) {
+			times100randsort.push_back(0.452*(100*gsl_rng_uniform(timeGen.get())+42));
+		}
+		std::sort(times100randsort.begin(), times100randsort.end());
+		
+		for(double i = 0.01; i < 1.0; i+=0.01) {
+			posFreq.push_back(i);
+		}
+	}
+	
+	virtual ~NullModelData() {
+	}
+	
+	/** Grid with 100 random times in ascending order
+	 */
+	DoubleVec times100randsort;
+	/** Grid with only positive frequencies, in ascending order
+	 */
+	DoubleVec posFreq;
+};
+
+/** Test cases for the noise models
+ * @class BoostTest::test_nullmodels
+ */
+BOOST_FIXTURE_TEST_SUITE(test_nullmodels, NullModelData)
+
+/** Tests whether the noise models reject invalid parameters
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	/* @test A damped random walk with zero or negative timescale. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(DampedRandomWalk( 0.0), std::invalid_argument);
+	BOOST_CHECK_THROW(DampedRandomWalk(-1.0), std::invalid_argument);
+	/* @test Power law noise with zero or negative maximum frequency. 
+	 *	Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(PowerLawNoise(2.0,  0.0), std::invalid_argument);
+	BOOST_CHECK_THROW(PowerLawNoise(2.0, -1.0), std::invalid_argument);
+	/* @test Power law noise with a positive maximum frequency. Expected 
+	 *	behavior = no exception.
+	 */
+	BOOST_CHECK_NO_THROW(PowerLawNoise(2.0, 1.0));
+}
+
+/** Tests whether seeded simulations are reproducible
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(seeds) {
+	DoubleVec powers1, probs1, powers2, probs2;
+
+	/* @test Two calls to lsNormalEdf() with the same model and seed, and 
+	 *	a number of simulations that is not a multiple of the block size. 
+	 *	Expected behavior = identical output.
+	 */
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times100randsort, posFreq, powers1, probs1, 
+			1001, DampedRandomWalk(10.0), 42));
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times100randsort, posFreq, powers2, probs2, 
+			1001, DampedRandomWalk(10.0), 42));
+	BOOST_CHECK(powers1 == powers2);
+	BOOST_CHECK(probs1  == probs2 );
+	BOOST_CHECK_EQUAL(powers1.size(), 1001U);
+
+	/* @test Two calls to lsNormalEdf() with the same model and different 
+	 *	seeds. Expected behavior = different output.
+	 */
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times100randsort, posFreq, powers2, probs2, 
+			1001, DampedRandomWalk(10.0), 43));
+	BOOST_CHECK(powers1 != powers2);
+
+	/* @test A call to lsNormalEdf() with nSims = 0. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(lsNormalEdf(times100randsort, posFreq, powers2, probs2, 
+			0, WhiteNoise(), 42), std::invalid_argument);
+}
+
+/** Tests whether red noise raises the significance threshold
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(rednoise) {
+	double white = 0.0, drw = 0.0, powerLaw = 0.0;
+
+	BOOST_REQUIRE_NO_THROW(white = lsThreshold(times100randsort, posFreq, 0.05, 
+			1000, WhiteNoise(), 42));
+	/* @test A damped random walk with a timescale comparable to the 
+	 *	observing baseline. Expected behavior = higher threshold than 
+	 *	white noise.
+	 */
+	BOOST_REQUIRE_NO_THROW(drw = lsThreshold(times100randsort, posFreq, 0.05, 
+			1000, DampedRandomWalk(20.0), 42));
+	BOOST_CHECK_GT(drw, 2.0*white);
+	/* @test Brownian (alpha = 2) noise. Expected behavior = higher threshold 
+	 *	than white noise.
+	 */
+	BOOST_REQUIRE_NO_THROW(powerLaw = lsThreshold(times100randsort, posFreq, 0.05, 
+			1000, PowerLawNoise(2.0), 42));
+	BOOST_CHECK_GT(powerLaw, 2.0*white);
+}
+
+/** Tests whether the nonuniform FFT matches direct summation
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(nufft) {
+	shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), &gsl_rng_free);
+	gsl_rng_set(gen.get(), 101);
+
+	const size_t nModes = 37;
+	ComplexVec coeffs;
+	double norm = 0.0;
+	for (size_t m = 0; m < nModes; m++) {
+		coeffs.push_back(std::complex<double>(gsl_ran_gaussian(gen.get(), 1.0), 
+				gsl_ran_gaussian(gen.get(), 1.0)));
+		norm += std::abs(coeffs.back());
+	}
+	DoubleVec x;
+	for (size_t j = 0; j < 200; j++) {
+		x.push_back(20.0*(gsl_rng_uniform(gen.get()) - 0.5));
+	}
+
+	/* @test A random set of 37 coefficients evaluated at 200 random points. 
+	 *	Expected behavior = matches direct summation to the requested 
+	 *	precision.
+	 */
+	ComplexVec fast;
+	BOOST_REQUIRE_NO_THROW(nufftType2(coeffs, x, fast, 1e-9));
+	BOOST_REQUIRE_EQUAL(fast.size(), x.size());
+	double maxErr = 0.0;
+	for (size_t j = 0; j < x.size(); j++) {
+		std::complex<double> slow(0.0, 0.0);
+		for (size_t m = 0; m < nModes; m++) {
+			double k = static_cast<double>(m) - static_cast<double>(nModes/2);
+			slow += coeffs[m] * std::complex<double>(cos(k*x[j]), sin(k*x[j]));
+		}
+		maxErr = std::max(maxErr, std::abs(fast[j] - slow));
+	}
+	BOOST_CHECK_LT(maxErr, 1e-8 * norm);
+
+	/* @test An empty coefficient list, or an invalid precision. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(nufftType2(ComplexVec(), x, fast, 1e-9), std::invalid_argument);
+	BOOST_CHECK_THROW(nufftType2(coeffs, x, fast, 0.0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,245 @@
+/** Performs unit testing of kpftimes::Prewhitener
+ * @file timescales/tests/unit_prewhiten.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats.tmp.h"
+#include "../timescales.h"
+#include "../timeexcept.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a multiperiodic light curve and two frequency grids
+ */
+class PrewhitenData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	PrewhitenData(): times(), fluxes(), freqs(), logFreqs(), 
+			trueFreqs(), trueAmps(), truePhases() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		trueFreqs .push_back(0.31); trueAmps.push_back(1.0 ); truePhases.push_back(0.3);
+		trueFreqs .push_back(0.77); trueAmps.push_back(0.5 ); truePhases.push_back(1.0);
+		trueFreqs .push_back(1.13); trueAmps.push_back(0.25); truePhases.push_back(2.0);
+		
+		for(size_t i = 0; i < 150; i++) {
+			times.push_back(500.0*gsl_rng_uniform(gen.get()));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			double flux = 10.0 + gsl_ran_gaussian(gen.get(), 0.02);
+			for(size_t k = 0; k < trueFreqs.size(); k++) {
+				flux += trueAmps[k] * sin(2.0*3.14159265358979*trueFreqs[k]*times[i] 
+						+ truePhases[k]);
+			}
+			fluxes.push_back(flux);
+		}
+		
+		for(size_t i = 1; i <= 1500; i++) {
+			freqs.push_back(0.001 * i);
+		}
+		for(size_t i = 0; i < 600; i++) {
+			logFreqs.push_back(0.01 * pow(200.0, i / 600.0));
+		}
+	}
+	
+	virtual ~PrewhitenData() {
+	}
+	
+	/** Returns the largest difference between two periodograms, as a 
+	 *	fraction of the largest value in the reference.
+	 */
+	static double relError(const DoubleVec &expected, const DoubleVec &actual) {
+		BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+		double diff = 0.0, scale = 0.0;
+		for(size_t i = 0; i < expected.size(); i++) {
+			diff  = std::max(diff , fabs(actual[i] - expected[i]));
+			scale = std::max(scale, fabs(expected[i]));
+		}
+		return diff / scale;
+	}
+	
+	/** Grid with 150 random times over 500 days, in ascending order
+	 */
+	DoubleVec times;
+	/** The sum of three sine waves with different amplitudes, plus 
+	 *	a little noise
+	 */
+	DoubleVec fluxes;
+	/** A regular frequency grid that includes the frequencies of the 
+	 *	sine waves
+	 */
+	DoubleVec freqs;
+	/** A logarithmically spaced frequency grid
+	 */
+	DoubleVec logFreqs;
+	/** The frequencies, amplitudes, and phases of the sine waves, from 
+	 *	strongest to weakest
+	 */
+	DoubleVec trueFreqs, trueAmps, truePhases;
+};
+
+/** Test cases for iterative prewhitening
+ * @class BoostTest::test_prewhiten
+ */
+BOOST_FIXTURE_TEST_SUITE(test_prewhiten, PrewhitenData)
+
+/** Tests whether Prewhitener rejects invalid input
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	/* @test Times and fluxes of different lengths, an empty frequency 
+	 *	grid, or a refresh interval of zero. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(Prewhitener(times, DoubleVec(3, 1.0), freqs), std::invalid_argument);
+	BOOST_CHECK_THROW(Prewhitener(times, fluxes, DoubleVec()), std::invalid_argument);
+	BOOST_CHECK_THROW(Prewhitener(times, fluxes, freqs, 0), std::invalid_argument);
+	/* @test Unsorted times, a single date, or constant fluxes. Expected 
+	 *	behavior = throw NotSorted or BadLightCurve.
+	 */
+	DoubleVec unsorted(times);
+	std::swap(unsorted[3], unsorted[40]);
+	BOOST_CHECK_THROW(Prewhitener(unsorted, fluxes, freqs), kpfutils::except::NotSorted);
+	BOOST_CHECK_THROW(Prewhitener(DoubleVec(times.size(), 42.0), fluxes, freqs), 
+		except::BadLightCurve);
+	BOOST_CHECK_THROW(Prewhitener(times, DoubleVec(times.size(), 1.0), freqs), 
+		except::BadLightCurve);
+	/* @test A negative frequency. Expected behavior = throw NegativeFreq.
+	 */
+	BOOST_CHECK_THROW(Prewhitener(times, fluxes, DoubleVec(1, -0.1)), except::NegativeFreq);
+}
+
+/** Tests whether the incremental periodogram matches lombScargle() on 
+ *	the residuals
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(periodogram) {
+	DoubleVec expected;
+	double amp = 0.0, phase = 0.0;
+	
+	/* @test A regular grid, never recomputed exactly, and a logarithmic 
+	 *	grid, which is always recomputed. Expected behavior = the 
+	 *	periodogram matches lombScargle() on the residuals before and 
+	 *	after each extraction.
+	 */
+	Prewhitener incremental(times, fluxes, freqs, 1000);
+	Prewhitener irregular(times, fluxes, logFreqs);
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	BOOST_CHECK_LT(relError(expected, incremental.getPower()), 1e-10);
+	for(size_t k = 0; k < 6; k++) {
+		BOOST_REQUIRE_NO_THROW(incremental.extract(amp, phase));
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, incremental.getResiduals(), freqs, expected));
+		BOOST_CHECK_LT(relError(expected, incremental.getPower()), 1e-8);
+		
+		BOOST_REQUIRE_NO_THROW(irregular.extract(amp, phase));
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, irregular.getResiduals(), logFreqs, expected));
+		BOOST_CHECK_LT(relError(expected, irregular.getPower()), 1e-10);
+	}
+	BOOST_CHECK_EQUAL(incremental.getNumTerms(), 6U);
+	BOOST_CHECK_EQUAL(irregular  .getNumTerms(), 6U);
+	
+	/* @test The same light curve with periodic exact recalculations. 
+	 *	Expected behavior = same extracted frequencies as without them.
+	 */
+	Prewhitener refreshed(times, fluxes, freqs, 2);
+	Prewhitener unrefreshed(times, fluxes, freqs, 1000);
+	for(size_t k = 0; k < 6; k++) {
+		double amp2 = 0.0, phase2 = 0.0;
+		BOOST_CHECK_EQUAL(refreshed.extract(amp, phase), unrefreshed.extract(amp2, phase2));
+		BOOST_CHECK_CLOSE(amp, amp2, 1e-6);
+	}
+}
+
+/** Tests whether Prewhitener recovers the sinusoids in a light curve
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(recovery) {
+	/* @test Three sinusoids with frequencies on the grid. Expected 
+	 *	behavior = extracted from strongest to weakest, with the right 
+	 *	amplitudes and phases, leaving residuals at the noise level.
+	 */
+	Prewhitener engine(times, fluxes, freqs);
+	for(size_t k = 0; k < trueFreqs.size(); k++) {
+		double amp = 0.0, phase = 0.0;
+		BOOST_CHECK_CLOSE(engine.extract(amp, phase), trueFreqs[k], 1e-6);
+		BOOST_CHECK_CLOSE(amp, trueAmps[k], 5.0);
+		BOOST_CHECK_SMALL(phase - truePhases[k], 0.05);
+	}
+	const DoubleVec residuals = engine.getResiduals();
+	BOOST_CHECK_LT(kpfutils::variance(residuals.begin(), residuals.end()), 0.001);
+	BOOST_CHECK_CLOSE(kpfutils::mean(residuals.begin(), residuals.end()), 10.0, 0.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,376 @@
+/** Performs unit testing of catalogs and kpftimes::runShards()
+ * @file timescales/tests/unit_shards.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats.tmp.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a small catalog in a scratch directory
+ */
+class ShardData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 * @exception std::runtime_error Thrown if the scratch directory 
+	 *	could not be created.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	ShardData(): dir(), catalogFile(), ids(), times(), fluxes() {
+		char pattern[] = "/tmp/kpft_unit_shards_XXXXXX";
+		if (mkdtemp(pattern) == NULL) {
+			throw std::runtime_error("Could not create scratch directory");
+		}
+		dir = pattern;
+		catalogFile = dir + "/catalog.bin";
+		
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 25; i++) {
+			// IDs deliberately out of order
+			ids.push_back(1000 - 13*i);
+			// One empty light curve
+			size_t n = (i == 11 ? 0 : 5 + gsl_rng_uniform_int(gen.get(), 50));
+			DoubleVec t, f;
+			for(size_t j = 0; j < n; j++) {
+				t.push_back(j + gsl_rng_uniform(gen.get()));
+				f.push_back(gsl_ran_gaussian(gen.get(), 1.0));
+			}
+			times .push_back(t);
+			fluxes.push_back(f);
+		}
+	}
+	
+	virtual ~ShardData() {
+		std::system(("rm -rf " + dir).c_str());
+	}
+	
+	/** Writes the test light curves to catalogFile
+	 */
+	void writeCatalog() const {
+		CatalogWriter writer(catalogFile, ids.size());
+		for(size_t i = 0; i < ids.size(); i++) {
+			writer.add(ids[i], times[i], fluxes[i]);
+		}
+		writer.close();
+	}
+	
+	/** Tests whether a file exists
+	 */
+	static bool fileExists(const std::string &fileName) {
+		struct stat info;
+		return stat(fileName.c_str(), &info) == 0;
+	}
+	
+	/** Reads a whole file into a string
+	 */
+	static std::string slurp(const std::string &fileName) {
+		std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), 
+			std::istreambuf_iterator<char>());
+	}
+	
+	/** Scratch directory for the test's files
+	 */
+	std::string dir;
+	/** Name of the test catalog
+	 */
+	std::string catalogFile;
+	/** The IDs of the test light curves
+	 */
+	std::vector<unsigned long> ids;
+	/** The times of each test light curve
+	 */
+	std::vector<DoubleVec> times;
+	/** The fluxes of each test light curve
+	 */
+	std::vector<DoubleVec> fluxes;
+};
+
+/** Finds the length and mean flux of each light curve, failing for 
+ *	light curves with no data
+ */
+class MeanTask : public ShardTask {
+public:
+	virtual size_t resultSize() const {
+		return 2;
+	}
+	
+	virtual void process(const DoubleVec &times, const DoubleVec &fluxes, 
+			DoubleVec &result) {
+		if (fluxes.empty()) {
+			throw std::invalid_argument("Empty light curve");
+		}
+		result[0] = times.size();
+		result[1] = kpfutils::mean(fluxes.begin(), fluxes.end());
+	}
+};
+
+/** Simulates another process taking over a shard while it is being 
+ *	processed, by rewriting the shard's claim
+ */
+class TakeoverTask : public MeanTask {
+public:
+	explicit TakeoverTask(const std::string &claimFile) : claimFile(claimFile) {
+	}
+	
+	virtual void process(const DoubleVec &times, const DoubleVec &fluxes, 
+			DoubleVec &result) {
+		std::ofstream claim(claimFile.c_str());
+		claim << "elsewhere";
+		claim.close();
+		MeanTask::process(times, fluxes, result);
+	}
+
+private:
+	std::string claimFile;
+};
+
+/** Runs out of memory on every light curve
+ */
+class OutOfMemoryTask : public MeanTask {
+public:
+	virtual void process(const DoubleVec &, const DoubleVec &, DoubleVec &) {
+		throw std::bad_alloc();
+	}
+};
+
+/** Test cases for catalogs and sharding
+ * @class BoostTest::test_shards
+ */
+BOOST_FIXTURE_TEST_SUITE(test_shards, ShardData)
+
+/** Tests whether catalogs preserve light curves exactly
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(catalog) {
+	/* @test A catalog of 25 light curves, including an empty one. 
+	 *	Expected behavior = every light curve and ID read back exactly.
+	 */
+	BOOST_REQUIRE_NO_THROW(writeCatalog());
+	CatalogReader reader(catalogFile);
+	BOOST_REQUIRE_EQUAL(reader.size(), ids.size());
+	DoubleVec t, f;
+	for(size_t i = 0; i < ids.size(); i++) {
+		BOOST_CHECK_EQUAL(reader.getId(i), ids[i]);
+		BOOST_CHECK_EQUAL(reader.getLength(i), times[i].size());
+		BOOST_REQUIRE_NO_THROW(reader.read(i, t, f));
+		BOOST_CHECK(t == times [i]);
+		BOOST_CHECK(f == fluxes[i]);
+	}
+	
+	/* @test An object past the end of the catalog. Expected behavior = 
+	 *	throw out_of_range.
+	 */
+	BOOST_CHECK_THROW(reader.read(ids.size(), t, f), std::out_of_range);
+	BOOST_CHECK_THROW(reader.getId(ids.size()), std::out_of_range);
+	
+	/* @test Misuse of CatalogWriter. Expected behavior = throw 
+	 *	invalid_argument for mismatched vectors, logic_error for the 
+	 *	wrong number of objects, and no file left behind.
+	 */
+	{
+		CatalogWriter writer(dir + "/bad.bin", 2);
+		BOOST_CHECK_THROW(writer.add(1, DoubleVec(3), DoubleVec(2)), std::invalid_argument);
+		BOOST_CHECK_NO_THROW(writer.add(1, DoubleVec(3), DoubleVec(3)));
+		BOOST_CHECK_THROW(writer.close(), std::logic_error);
+		BOOST_CHECK_NO_THROW(writer.add(2, DoubleVec(1), DoubleVec(1)));
+		BOOST_CHECK_THROW(writer.add(3, DoubleVec(1), DoubleVec(1)), std::logic_error);
+	}
+	BOOST_CHECK_THROW(CatalogReader(dir + "/bad.bin"), std::runtime_error);
+	
+	/* @test A file that is not a catalog. Expected behavior = throw 
+	 *	runtime_error.
+	 */
+	std::ofstream(((dir + "/junk.bin").c_str())) << "Not a catalog at all, really";
+	BOOST_CHECK_THROW(CatalogReader(dir + "/junk.bin"), std::runtime_error);
+}
+
+/** Tests whether sharded processing gives complete, deterministic results
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(shards) {
+	const std::string manifest = dir + "/manifest.txt";
+	const std::string store = dir + "/results.bin";
+	MeanTask task;
+	
+	BOOST_REQUIRE_NO_THROW(writeCatalog());
+	BOOST_REQUIRE_NO_THROW(writeManifest(catalogFile, 4, manifest));
+	
+	/* @test A shard claimed by a live process. Expected behavior = all 
+	 *	other shards are processed, and merging is refused.
+	 */
+	std::ofstream((dir + "/shard_000002.claim").c_str()) << "elsewhere";
+	std::vector<unsigned long> failed;
+	BOOST_CHECK_EQUAL(runShards(manifest, dir, task, failed), 6U);
+	BOOST_CHECK(failed.empty());
+	BOOST_CHECK_THROW(mergeShards(manifest, dir, store), std::runtime_error);
+	
+	/* @test The same shard after its claim goes stale. Expected behavior = 
+	 *	the shard is taken over, completed shards are not repeated, and 
+	 *	the empty light curve in it is reported as failed.
+	 */
+	utimbuf old;
+	old.actime = old.modtime = time(NULL) - 3600;
+	BOOST_REQUIRE_EQUAL(utime((dir + "/shard_000002.claim").c_str(), &old), 0);
+	BOOST_CHECK_EQUAL(runShards(manifest, dir, task, failed), 1U);
+	BOOST_REQUIRE_EQUAL(failed.size(), 1U);
+	BOOST_CHECK_EQUAL(failed[0], ids[11]);
+	BOOST_CHECK_EQUAL(runShards(manifest, dir, task, failed), 0U);
+	BOOST_CHECK(failed.empty());
+	
+	/* @test The failure lists. Expected behavior = one per shard, listing 
+	 *	only the empty light curve.
+	 */
+	BOOST_CHECK_EQUAL(slurp(dir + "/shard_000002.failed"), 
+		boost::lexical_cast<std::string>(ids[11]) + "\n");
+	BOOST_CHECK(fileExists(dir + "/shard_000000.failed"));
+	BOOST_CHECK_EQUAL(slurp(dir + "/shard_000000.failed"), "");
+	
+	/* @test The merged results. Expected behavior = one entry per object, 
+	 *	found by ID, with NaN for the failed object.
+	 */
+	BOOST_REQUIRE_NO_THROW(mergeShards(manifest, dir, store));
+	ResultStore results(store);
+	BOOST_REQUIRE_EQUAL(results.size(), ids.size());
+	BOOST_REQUIRE_EQUAL(results.getResultSize(), 2U);
+	DoubleVec value;
+	for(size_t i = 0; i < ids.size(); i++) {
+		BOOST_REQUIRE(results.find(ids[i], value));
+		BOOST_REQUIRE_EQUAL(value.size(), 2U);
+		if (fluxes[i].empty()) {
+			BOOST_CHECK(value[0] != value[0]);
+		} else {
+			BOOST_CHECK_EQUAL(value[0], times[i].size());
+			BOOST_CHECK_EQUAL(value[1], kpfutils::mean(fluxes[i].begin(), fluxes[i].end()));
+		}
+	}
+	BOOST_CHECK(!results.find(1, value));
+	
+	/* @test The same catalog processed in one go, in another directory. 
+	 *	Expected behavior = byte-for-byte identical merged file.
+	 */
+	const std::string otherDir = dir + "/other";
+	BOOST_REQUIRE_EQUAL(mkdir(otherDir.c_str(), 0700), 0);
+	BOOST_CHECK_EQUAL(runShards(manifest, otherDir, task), 7U);
+	BOOST_REQUIRE_NO_THROW(mergeShards(manifest, otherDir, otherDir + "/results.bin"));
+	BOOST_CHECK(slurp(store) == slurp(otherDir + "/results.bin"));
+	
+	/* @test Invalid shard sizes and timeouts. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(writeManifest(catalogFile, 0, manifest), std::invalid_argument);
+	BOOST_CHECK_THROW(runShards(manifest, dir, task, 0.0), std::invalid_argument);
+}
+
+/** Tests whether runShards() leaves other processes' claims alone and 
+ *	does not hide running out of memory
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(claims) {
+	const std::string manifest = dir + "/manifest.txt";
+	const std::string claim = dir + "/shard_000000.claim";
+	
+	BOOST_REQUIRE_NO_THROW(writeCatalog());
+	BOOST_REQUIRE_NO_THROW(writeManifest(catalogFile, ids.size(), manifest));
+	
+	/* @test A task that runs out of memory. Expected behavior = runShards() 
+	 *	throws bad_alloc, the shard is not marked complete, and its 
+	 *	claim is released.
+	 */
+	OutOfMemoryTask hungry;
+	BOOST_CHECK_THROW(runShards(manifest, dir, hungry), std::bad_alloc);
+	BOOST_CHECK(!fileExists(dir + "/shard_000000.done"));
+	BOOST_CHECK(!fileExists(claim));
+	
+	/* @test A shard taken over by another process while in progress. 
+	 *	Expected behavior = the shard is completed, but the other 
+	 *	process's claim is not removed.
+	 */
+	TakeoverTask task(claim);
+	BOOST_CHECK_EQUAL(runShards(manifest, dir, task), 1U);
+	BOOST_CHECK(fileExists(dir + "/shard_000000.done"));
+	BOOST_REQUIRE(fileExists(claim));
+	BOOST_CHECK_EQUAL(slurp(claim), "elsewhere");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
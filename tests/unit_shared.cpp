@@ -0,0 +1,345 @@
+/** Performs unit testing of kpftimes::SharedCache and kpftimes::processBatch()
+ * @file timescales/tests/unit_shared.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../../common/alloc.tmp.h"
+#include "../../common/stats_except.h"
+#include "../timescales.h"
+#include "../timeexcept.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve, grids for the periodogram and ACF, and a 
+ *	shared cache private to the test
+ */
+class SharedData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	SharedData(): times(), fluxes(), freqs(), offsets(), allValid(), 
+			name("/kpft_unit_shared_" + boost::lexical_cast<std::string>(getpid())) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 150; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+		}
+		allValid = BoolVec(times.size(), true);
+		
+		for(double f = 0.01; f < 2.0; f += 0.01) {
+			freqs.push_back(f);
+		}
+		for(double t = 0.0; t < 20.0; t += 0.5) {
+			offsets.push_back(t);
+		}
+		
+		SharedCache::remove(name);
+	}
+	
+	virtual ~SharedData() {
+		SharedCache::remove(name);
+	}
+	
+	/** Grid with 150 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Grid of positive frequencies
+	 */
+	DoubleVec freqs;
+	/** Uniform grid of ACF offsets
+	 */
+	DoubleVec offsets;
+	/** Mask with no epochs removed
+	 */
+	BoolVec allValid;
+	/** Name of a shared cache used only by this test
+	 */
+	std::string name;
+};
+
+/** Produces two values per object, failing on purpose for some objects
+ */
+class TestTask : public BatchTask {
+public:
+	virtual size_t resultSize() const {
+		return 2;
+	}
+	
+	virtual void process(size_t item, DoubleVec &result) {
+		if (item == 3) {
+			throw std::runtime_error("Bad object");
+		} else if (item == 5) {
+			abort();
+		}
+		result[0] = 2.0*item;
+		result[1] = item + 1.0;
+	}
+};
+
+/** Test cases for node-local sharing
+ * @class BoostTest::test_shared
+ */
+BOOST_FIXTURE_TEST_SUITE(test_shared, SharedData)
+
+/** Tests whether plans built from a shared cache match private plans
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(plans) {
+	SharedCache cache(name, 1 << 22);
+	DoubleVec expected, actual;
+	
+	/* @test A plan built in a new cache. Expected behavior = identical 
+	 *	periodogram to a private plan, and the cache is no longer empty.
+	 */
+	BOOST_CHECK_EQUAL(cache.getUsed(), 0U);
+	LsPlan local(times, freqs);
+	LsPlan shared(times, freqs, cache);
+	BOOST_REQUIRE_NO_THROW(lombScargle(local , fluxes, allValid, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(shared, fluxes, allValid, actual  ));
+	BOOST_CHECK(expected == actual);
+	const size_t used = cache.getUsed();
+	BOOST_CHECK_GE(used, 2*times.size()*freqs.size()*sizeof(double));
+	
+	/* @test A second plan with the same inputs. Expected behavior = the 
+	 *	existing tables are reused.
+	 */
+	LsPlan again(times, freqs, cache);
+	BOOST_REQUIRE_NO_THROW(lombScargle(again, fluxes, allValid, actual));
+	BOOST_CHECK(expected == actual);
+	BOOST_CHECK_EQUAL(cache.getUsed(), used);
+	
+	/* @test A plan built by another process. Expected behavior = this 
+	 *	process maps the tables instead of building them again.
+	 */
+	DoubleVec otherFreqs(freqs.begin(), freqs.begin() + 50);
+	pid_t child = fork();
+	if (child == 0) {
+		try {
+			SharedCache childCache(name, 1 << 22);
+			LsPlan childPlan(times, otherFreqs, childCache);
+			_exit(0);
+		} catch (...) {
+			_exit(1);
+		}
+	}
+	BOOST_REQUIRE_GT(child, 0);
+	int status = 0;
+	BOOST_REQUIRE_EQUAL(waitpid(child, &status, 0), child);
+	BOOST_REQUIRE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	const size_t childUsed = cache.getUsed();
+	BOOST_CHECK_GT(childUsed, used);
+	
+	LsPlan otherShared(times, otherFreqs, cache);
+	LsPlan otherLocal (times, otherFreqs);
+	BOOST_CHECK_EQUAL(cache.getUsed(), childUsed);
+	BOOST_REQUIRE_NO_THROW(lombScargle(otherLocal , fluxes, allValid, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(otherShared, fluxes, allValid, actual  ));
+	BOOST_CHECK(expected == actual);
+	
+	/* @test A cache too small for the tables. Expected behavior = the plan 
+	 *	falls back to private tables and gives the same result.
+	 */
+	SharedCache::remove(name);
+	SharedCache tiny(name, 64);
+	LsPlan fallback(times, freqs, tiny);
+	BOOST_REQUIRE_NO_THROW(lombScargle(fallback, fluxes, allValid, actual));
+	lombScargle(local, fluxes, allValid, expected);
+	BOOST_CHECK(expected == actual);
+	
+	/* @test Invalid cache parameters or plan inputs. Expected behavior = 
+	 *	throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(SharedCache(name + "_empty", 0), std::invalid_argument);
+	BOOST_CHECK_THROW(LsPlan(DoubleVec(10, 1.0), freqs, tiny), std::invalid_argument);
+}
+
+/** Tests whether shared window functions and false-peak distributions 
+ *	match unshared ones
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(tables) {
+	SharedCache cache(name, 1 << 22);
+	DoubleVec expected1, expected2, actual1, actual2;
+	
+	/* @test acWindow() with and without a cache. Expected behavior = 
+	 *	identical output, computed only once.
+	 */
+	BOOST_REQUIRE_NO_THROW(acWindow(times, offsets, expected1, 2.0));
+	BOOST_REQUIRE_NO_THROW(acWindow(times, offsets, actual1, 2.0, cache));
+	BOOST_CHECK(expected1 == actual1);
+	size_t used = cache.getUsed();
+	BOOST_REQUIRE_NO_THROW(acWindow(times, offsets, actual1, 2.0, cache));
+	BOOST_CHECK(expected1 == actual1);
+	BOOST_CHECK_EQUAL(cache.getUsed(), used);
+	
+	/* @test lsNormalEdf() with and without a cache. Expected behavior = 
+	 *	identical output, computed only once.
+	 */
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, expected1, expected2, 
+			200, DampedRandomWalk(10.0), 42));
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, actual1, actual2, 
+			200, DampedRandomWalk(10.0), 42, cache));
+	BOOST_CHECK(expected1 == actual1);
+	BOOST_CHECK(expected2 == actual2);
+	used = cache.getUsed();
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, actual1, actual2, 
+			200, DampedRandomWalk(10.0), 42, cache));
+	BOOST_CHECK(expected1 == actual1);
+	BOOST_CHECK_EQUAL(cache.getUsed(), used);
+	
+	/* @test lsNormalEdf() with a different model. Expected behavior = a 
+	 *	new distribution, not the cached one.
+	 */
+	BOOST_REQUIRE_NO_THROW(lsNormalEdf(times, freqs, actual1, actual2, 
+			200, DampedRandomWalk(20.0), 42, cache));
+	BOOST_CHECK(expected1 != actual1);
+	BOOST_CHECK_GT(cache.getUsed(), used);
+	
+	/* @test Invalid inputs. Expected behavior = the same exceptions as 
+	 *	without a cache.
+	 */
+	BOOST_CHECK_THROW(acWindow(times, DoubleVec(), actual1, 2.0, cache), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(acWindow(times, offsets, actual1, -1.0, cache), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(lsNormalEdf(times, freqs, actual1, actual2, 
+			0, WhiteNoise(), 42, cache), std::invalid_argument);
+	BOOST_CHECK_THROW(lsNormalEdf(DoubleVec(10, 1.0), freqs, actual1, actual2, 
+			200, WhiteNoise(), 42, cache), kpftimes::except::BadLightCurve);
+	DoubleVec backwards(times.rbegin(), times.rend());
+	BOOST_CHECK_THROW(lsNormalEdf(backwards, freqs, actual1, actual2, 
+			200, WhiteNoise(), 42, cache), kpfutils::except::NotSorted);
+	DoubleVec negative(freqs);
+	negative.front() = -1.0;
+	BOOST_CHECK_THROW(lsNormalEdf(times, negative, actual1, actual2, 
+			200, WhiteNoise(), 42, cache), kpftimes::except::NegativeFreq);
+}
+
+/** Tests whether processBatch() isolates failures
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(batch) {
+	TestTask task;
+	DoubleVec results;
+	std::vector<size_t> failed;
+	
+	/* @test A batch where one object throws and another crashes its 
+	 *	worker. Expected behavior = only those two objects fail.
+	 */
+	BOOST_REQUIRE_NO_THROW(processBatch(task, 20, 3, results, failed));
+	BOOST_REQUIRE_EQUAL(results.size(), 40U);
+	BOOST_REQUIRE_EQUAL(failed.size(), 2U);
+	BOOST_CHECK_EQUAL(failed[0], 3U);
+	BOOST_CHECK_EQUAL(failed[1], 5U);
+	for(size_t i = 0; i < 20; i++) {
+		if (i == 3 || i == 5) {
+			BOOST_CHECK(results[2*i] != results[2*i]);
+		} else {
+			BOOST_CHECK_EQUAL(results[2*i  ], 2.0*i);
+			BOOST_CHECK_EQUAL(results[2*i+1], i + 1.0);
+		}
+	}
+	
+	/* @test A batch with more workers than objects. Expected behavior = 
+	 *	same result.
+	 */
+	BOOST_REQUIRE_NO_THROW(processBatch(task, 3, 8, results, failed));
+	BOOST_CHECK_EQUAL(results.size(), 6U);
+	BOOST_CHECK(failed.empty());
+	
+	/* @test An empty batch. Expected behavior = empty output.
+	 */
+	BOOST_REQUIRE_NO_THROW(processBatch(task, 0, 2, results, failed));
+	BOOST_CHECK(results.empty());
+	BOOST_CHECK(failed.empty());
+	
+	/* @test No workers. Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(processBatch(task, 10, 0, results, failed), 
+			std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
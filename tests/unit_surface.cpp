@@ -0,0 +1,249 @@
+/** Performs unit testing of kpftimes::ThresholdSurface
+ * @file timescales/tests/unit_surface.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a seasonal cadence family and the lattice to simulate it on
+ */
+class SurfaceData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	SurfaceData(): gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), &gsl_rng_free), 
+			family(), nEpochs(), baselines(), gridSizes(), model() {
+		gsl_rng_set(gen.get(), 42);
+		
+		// Three 60-day seasons a year apart
+		for(size_t season = 0; season < 3; season++) {
+			for(size_t i = 0; i < 40; i++) {
+				family.push_back(365.0*season + 60.0*gsl_rng_uniform(gen.get()));
+			}
+		}
+		std::sort(family.begin(), family.end());
+		
+		nEpochs.push_back(40);
+		nEpochs.push_back(80);
+		baselines.push_back(600);
+		baselines.push_back(900);
+		gridSizes.push_back(100);
+		gridSizes.push_back(200);
+	}
+	
+	virtual ~SurfaceData() {
+	}
+	
+	/** Creates a member of the family, with its epochs chosen at random.
+	 */
+	void makeStar(size_t n, double baseline, size_t nFreqs, double fMax, 
+			DoubleVec &times, DoubleVec &freqs) const {
+		times.clear();
+		const double scale = baseline / (family.back() - family.front());
+		for(size_t i = 0; i < family.size(); i++) {
+			if (gsl_rng_uniform(gen.get()) < static_cast<double>(n)/family.size()) {
+				times.push_back((family[i] - family.front()) * scale);
+			}
+		}
+		freqs.clear();
+		for(size_t i = 1; i <= nFreqs; i++) {
+			freqs.push_back(fMax * i / nFreqs);
+		}
+	}
+	
+	/** Random number generator for choosing epochs
+	 */
+	shared_ptr<gsl_rng> gen;
+	/** The times defining the cadence family
+	 */
+	DoubleVec family;
+	/** The lattice to simulate
+	 */
+	DoubleVec nEpochs, baselines, gridSizes;
+	/** Noise model to simulate
+	 */
+	WhiteNoise model;
+};
+
+/** Test cases for ThresholdSurface
+ * @class BoostTest::test_surface
+ */
+BOOST_FIXTURE_TEST_SUITE(test_surface, SurfaceData)
+
+/** Tests whether ThresholdSurface rejects invalid lattices
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	/* @test A family with one time, or a nonpositive maximum frequency. 
+	 *	Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(ThresholdSurface(DoubleVec(1, 0.0), 0.5, nEpochs, baselines, 
+			gridSizes, 100, model, 42), std::invalid_argument);
+	BOOST_CHECK_THROW(ThresholdSurface(family, 0.0, nEpochs, baselines, 
+			gridSizes, 100, model, 42), std::invalid_argument);
+	/* @test An axis with one value, or with values out of order. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(ThresholdSurface(family, 0.5, DoubleVec(1, 40.0), baselines, 
+			gridSizes, 100, model, 42), std::invalid_argument);
+	DoubleVec reversed(baselines.rbegin(), baselines.rend());
+	BOOST_CHECK_THROW(ThresholdSurface(family, 0.5, nEpochs, reversed, 
+			gridSizes, 100, model, 42), std::invalid_argument);
+	/* @test Too few simulations, or a nonpositive tolerance. Expected 
+	 *	behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(ThresholdSurface(family, 0.5, nEpochs, baselines, 
+			gridSizes, 19, model, 42), std::invalid_argument);
+	BOOST_CHECK_THROW(ThresholdSurface(family, 0.5, nEpochs, baselines, 
+			gridSizes, 100, model, 42, 0.0), std::invalid_argument);
+}
+
+/** Tests whether interpolated thresholds match direct simulation
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(interpolate) {
+	const long nSims = 1000;
+	const ThresholdSurface surface(family, 0.5, nEpochs, baselines, gridSizes, 
+			nSims, model, 42, 0.1);
+	
+	/* @test A star near the middle of the lattice. Expected behavior = 
+	 *	interpolated, with a threshold and false alarm probability 
+	 *	close to direct simulation.
+	 */
+	DoubleVec times, freqs;
+	makeStar(60, 750.0, 141, 0.5, times, freqs);
+	BOOST_REQUIRE(surface.covers(times, freqs));
+	
+	double error = -1.0;
+	const double direct = lsThreshold(times, freqs, 0.05, nSims, model, 1729);
+	const double interp = surface.threshold(times, freqs, 0.05, error);
+	BOOST_CHECK_GE(error, 0.0);
+	BOOST_CHECK_LE(error, 0.1*interp);
+	BOOST_CHECK_CLOSE(interp, direct, 10.0);
+	
+	const double fap = surface.fap(times, freqs, direct, error);
+	BOOST_CHECK_GE(error, 0.0);
+	BOOST_CHECK_SMALL(fap - 0.05, 0.03);
+	
+	/* @test A star with too few epochs, or a different frequency range. 
+	 *	Expected behavior = simulated directly, with a nonzero error.
+	 */
+	makeStar(20, 750.0, 141, 0.5, times, freqs);
+	BOOST_CHECK(!surface.covers(times, freqs));
+	const double fallback = surface.threshold(times, freqs, 0.05, error);
+	BOOST_CHECK_CLOSE(fallback, lsThreshold(times, freqs, 0.05, nSims, model, 42), 2.0);
+	BOOST_CHECK_GT(error, 0.0);
+	
+	makeStar(60, 750.0, 141, 0.8, times, freqs);
+	BOOST_CHECK(!surface.covers(times, freqs));
+	BOOST_CHECK_NO_THROW(surface.fap(times, freqs, direct, error));
+	BOOST_CHECK_GT(error, 0.0);
+	
+	/* @test A star whose grid ends at the family's maximum frequency, but 
+	 *	starts elsewhere. Expected behavior = simulated directly, with 
+	 *	a nonzero error.
+	 */
+	makeStar(60, 750.0, 141, 0.5, times, freqs);
+	for(size_t i = 0; i < freqs.size(); i++) {
+		freqs[i] = 0.25 + 0.25 * i / (freqs.size() - 1);
+	}
+	BOOST_CHECK(!surface.covers(times, freqs));
+	BOOST_CHECK_CLOSE(surface.threshold(times, freqs, 0.05, error), 
+			lsThreshold(times, freqs, 0.05, nSims, model, 42), 2.0);
+	BOOST_CHECK_GT(error, 0.0);
+	
+	/* @test A star that cannot be simulated. Expected behavior = throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(surface.threshold(DoubleVec(1, 0.0), freqs, 0.05, error), 
+			std::invalid_argument);
+}
+
+/** Tests whether cells that fail validation are simulated instead
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(tolerance) {
+	/* @test A surface with a tolerance too small to meet. Expected 
+	 *	behavior = no star is interpolated.
+	 */
+	const ThresholdSurface surface(family, 0.5, nEpochs, baselines, gridSizes, 
+			100, model, 42, 1e-9);
+	DoubleVec times, freqs;
+	makeStar(60, 750.0, 141, 0.5, times, freqs);
+	BOOST_CHECK(!surface.covers(times, freqs));
+	
+	double error = 0.0;
+	BOOST_CHECK_CLOSE(surface.threshold(times, freqs, 0.1, error), 
+			lsThreshold(times, freqs, 0.1, 100, model, 42), 5.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
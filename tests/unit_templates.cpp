@@ -0,0 +1,260 @@
+/** Performs unit testing of the template-matching functions
+ * @file timescales/tests/unit_templates.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../timeexcept.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** This function is a wrapper for a trusted approximate comparison method.
+ */
+bool isClose(double val1, double val2, double frac);
+
+/** Data common to the test cases.
+ *
+ * Contains a bank of three templates and light curves resembling each
+ */
+class TemplateData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	TemplateData(): nPhases(64), bank(nPhases), shapes(), 
+			times(), fluxes(), freqs() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for (size_t t = 0; t < 3; t++) {
+			DoubleVec shape;
+			for (size_t k = 0; k < nPhases; k++) {
+				shape.push_back(profile(t, static_cast<double>(k)/nPhases));
+			}
+			shapes.push_back(shape);
+			bank.addTemplate(shape);
+		}
+		
+		// One star of each class, with different periods and phases
+		for (size_t t = 0; t < 3; t++) {
+			const double period = 0.37 + 1.3*t;
+			const double offset = 0.25*(t+1);
+			DoubleVec time, flux;
+			for (size_t i = 0; i < 400; i++) {
+				time.push_back(100.0*gsl_rng_uniform(gen.get()));
+			}
+			std::sort(time.begin(), time.end());
+			for (size_t i = 0; i < time.size(); i++) {
+				double phase = time[i]/period - time[0]/period - offset;
+				phase -= floor(phase);
+				flux.push_back(3.0*profile(t, phase) + 10.0
+					+ gsl_ran_gaussian(gen.get(), 0.1));
+			}
+			times .push_back(time);
+			fluxes.push_back(flux);
+			freqs .push_back(1.0/period);
+		}
+	}
+	
+	virtual ~TemplateData() {
+	}
+	
+	/** Light curve shapes: sine, sawtooth, and eclipse
+	 */
+	static double profile(size_t type, double phase) {
+		switch(type) {
+		case 0:
+			return sin(2.0*3.14159265358979*phase);
+		case 1:
+			return phase;
+		default:
+			return (fabs(phase - 0.5) < 0.05 ? -1.0 : 0.0);
+		}
+	}
+	
+	/** Number of phase bins
+	 */
+	size_t nPhases;
+	/** Bank of three templates
+	 */
+	TemplateBank bank;
+	/** The shapes in @p bank
+	 */
+	std::vector<DoubleVec> shapes;
+	/** Light curves matching each template
+	 */
+	std::vector<DoubleVec> times, fluxes;
+	/** Frequency of each light curve
+	 */
+	DoubleVec freqs;
+};
+
+/** Test cases for template matching
+ * @class BoostTest::test_templates
+ */
+BOOST_FIXTURE_TEST_SUITE(test_templates, TemplateData)
+
+/** Tests whether match() finds the correlation at the best phase shift
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(scores) {
+	DoubleVec folded, scores, phases;
+	
+	BOOST_CHECK_EQUAL(bank.size(), 3);
+	BOOST_CHECK_EQUAL(bank.getNumPhases(), nPhases);
+	
+	/* @test Each star folded at its own period. Expected behavior = scores 
+	 *	equal a direct search over all circular shifts
+	 */
+	for (size_t star = 0; star < times.size(); star++) {
+		BOOST_REQUIRE_NO_THROW(foldLightCurve(times[star], fluxes[star], 
+				freqs[star], nPhases, folded));
+		BOOST_REQUIRE_EQUAL(folded.size(), nPhases);
+		BOOST_REQUIRE_NO_THROW(bank.match(folded, scores, phases));
+		BOOST_REQUIRE_EQUAL(scores.size(), bank.size());
+		BOOST_REQUIRE_EQUAL(phases.size(), bank.size());
+		
+		for (size_t t = 0; t < bank.size(); t++) {
+			const DoubleVec &shape = shapes[t];
+			double fMean = 0.0, tMean = 0.0;
+			for (size_t k = 0; k < nPhases; k++) {
+				fMean += folded[k] / nPhases;
+				tMean += shape [k] / nPhases;
+			}
+			double best = -2.0;
+			size_t bestShift = 0;
+			for (size_t s = 0; s < nPhases; s++) {
+				double cross = 0.0, fNorm = 0.0, tNorm = 0.0;
+				for (size_t k = 0; k < nPhases; k++) {
+					double f = folded[k] - fMean;
+					double g = shape[(k+s) % nPhases] - tMean;
+					cross += f*g;
+					fNorm += f*f;
+					tNorm += g*g;
+				}
+				if (cross / sqrt(fNorm*tNorm) > best) {
+					best = cross / sqrt(fNorm*tNorm);
+					bestShift = s;
+				}
+			}
+			BOOST_CHECK(isClose(scores[t], best, 1e-8));
+			BOOST_CHECK(isClose(phases[t], static_cast<double>(bestShift)/nPhases, 1e-12));
+		}
+	}
+	
+	/* @test Invalid input. Expected behavior = throw exceptions
+	 */
+	BOOST_CHECK_THROW(TemplateBank(48), std::invalid_argument);
+	BOOST_CHECK_THROW(bank.addTemplate(DoubleVec(nPhases-1, 1.0)), std::invalid_argument);
+	BOOST_CHECK_THROW(bank.addTemplate(DoubleVec(nPhases, 1.0)), except::BadLightCurve);
+	BOOST_CHECK_EQUAL(bank.size(), 3);
+	BOOST_CHECK_THROW(bank.match(DoubleVec(nPhases, 1.0), scores, phases), 
+			except::BadLightCurve);
+	BOOST_CHECK_THROW(foldLightCurve(times[0], fluxes[0], -1.0, nPhases, folded), 
+			except::NegativeFreq);
+}
+
+/** Tests whether matchTemplates() classifies a batch of stars
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(batch) {
+	std::vector<size_t> best;
+	DoubleVec scores, phases;
+	
+	/* @test Three stars, one of each class. Expected behavior = each star 
+	 *	matches its own template, with the phase offset used to 
+	 *	simulate it
+	 */
+	BOOST_REQUIRE_NO_THROW(matchTemplates(times, fluxes, freqs, bank, 
+			best, scores, phases));
+	BOOST_REQUIRE_EQUAL(best.size(), times.size());
+	for (size_t star = 0; star < times.size(); star++) {
+		BOOST_CHECK_EQUAL(best[star], star);
+		BOOST_CHECK_GT(scores[star], 0.9);
+		
+		// The star lags the template by its offset, so the template 
+		//	must be advanced by the same amount
+		double error = phases[star] + 0.25*(star+1);
+		error -= floor(error + 0.5);
+		BOOST_CHECK_LT(fabs(error), 2.0/nPhases);
+		
+		DoubleVec folded, oneScores, onePhases;
+		BOOST_REQUIRE_NO_THROW(foldLightCurve(times[star], fluxes[star], 
+				freqs[star], nPhases, folded));
+		BOOST_REQUIRE_NO_THROW(bank.match(folded, oneScores, onePhases));
+		BOOST_CHECK_EQUAL(scores[star], oneScores[best[star]]);
+	}
+	
+	/* @test Empty bank. Expected behavior = throw invalid_argument
+	 */
+	BOOST_CHECK_THROW(matchTemplates(times, fluxes, freqs, TemplateBank(nPhases), 
+			best, scores, phases), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
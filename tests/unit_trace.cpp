@@ -0,0 +1,247 @@
+/** Performs unit testing of kpftimes::startTrace() and kpftimes::stopTrace()
+ * @file timescales/tests/unit_trace.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "../timescales.h"
+
+namespace kpftimes { namespace test {
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve and the name of a trace file
+ */
+class TraceData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	TraceData(): times(), fluxes(), freqs(), traceFile("test_trace.json") {
+		for(size_t i = 0; i < 100; i++) {
+			times.push_back(0.37*i + 0.1*sin(3.0*i));
+			fluxes.push_back(sin(0.8*times.back()));
+		}
+		for(double f = 0.01; f < 1.0; f += 0.01) {
+			freqs.push_back(f);
+		}
+	}
+	
+	virtual ~TraceData() {
+		remove(traceFile.c_str());
+	}
+	
+	/** Reads the trace file.
+	 */
+	std::string readTrace() const {
+		std::ifstream in(traceFile.c_str());
+		return std::string(std::istreambuf_iterator<char>(in), 
+			std::istreambuf_iterator<char>());
+	}
+	
+	/** Counts the occurrences of a string in the trace.
+	 */
+	static size_t count(const std::string &trace, const std::string &text) {
+		size_t n = 0;
+		for(size_t pos = trace.find(text); pos != std::string::npos; 
+				pos = trace.find(text, pos+1)) {
+			n++;
+		}
+		return n;
+	}
+	
+	/** Grid with 100 nearly uniform times in ascending order
+	 */
+	DoubleVec times;
+	/** A sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Grid with only positive frequencies, in ascending order
+	 */
+	DoubleVec freqs;
+	/** Name of a trace file used only by this test
+	 */
+	std::string traceFile;
+};
+
+/** Calculates a periodogram for each object
+ */
+class PeriodogramTask : public BatchTask {
+public:
+	PeriodogramTask(const TraceData &data) : data(data) {
+	}
+	
+	virtual size_t resultSize() const {
+		return 1;
+	}
+	
+	virtual void process(size_t, DoubleVec &result) {
+		DoubleVec power;
+		lombScargle(data.times, data.fluxes, data.freqs, power);
+		result[0] = *std::max_element(power.begin(), power.end());
+	}
+	
+private:
+	const TraceData &data;
+};
+
+/** Test cases for execution tracing
+ * @class BoostTest::test_trace
+ */
+BOOST_FIXTURE_TEST_SUITE(test_trace, TraceData)
+
+/** Tests whether traces are started and stopped correctly
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(params) {
+	/* @test stopTrace() without startTrace(). Expected behavior = throw 
+	 *	logic_error.
+	 */
+	BOOST_CHECK_THROW(stopTrace(), std::logic_error);
+	/* @test startTrace() with no room for events. Expected behavior = 
+	 *	throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(startTrace(traceFile, 0), std::invalid_argument);
+	/* @test startTrace() in a directory that does not exist. Expected 
+	 *	behavior = throw runtime_error.
+	 */
+	BOOST_CHECK_THROW(startTrace("no_such_dir/trace.json"), std::runtime_error);
+	BOOST_CHECK_THROW(stopTrace(), std::logic_error);
+	
+	/* @test A trace with more spans than fit in the buffer. Expected 
+	 *	behavior = the most recent spans are kept, and the others are 
+	 *	counted as dropped.
+	 */
+	DoubleVec power;
+	BOOST_REQUIRE_NO_THROW(startTrace(traceFile, 2));
+	for(int i = 0; i < 5; i++) {
+		lombScargle(times, fluxes, freqs, power);
+	}
+	BOOST_REQUIRE_NO_THROW(stopTrace());
+	const std::string trace = readTrace();
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"lombScargle\""), 2U);
+	BOOST_CHECK(trace.find("\"dropped_events\":3}") != std::string::npos);
+	
+	/* @test Calls made after stopTrace(). Expected behavior = not recorded.
+	 */
+	lombScargle(times, fluxes, freqs, power);
+	BOOST_CHECK_THROW(stopTrace(), std::logic_error);
+	BOOST_CHECK_EQUAL(readTrace(), trace);
+}
+
+/** Tests whether spans from worker processes and threads are collected
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(batch) {
+	PeriodogramTask task(*this);
+	DoubleVec results;
+	std::vector<size_t> failed;
+	
+	/* @test A batch of 8 periodograms in 3 worker processes, followed by 
+	 *	batch detrending. Expected behavior = a well-formed trace with 
+	 *	one span per object and per call, from at least two processes.
+	 */
+	BOOST_REQUIRE_NO_THROW(startTrace(traceFile));
+	BOOST_REQUIRE_NO_THROW(processBatch(task, 8, 3, results, failed));
+	std::vector<DoubleVec> batchTimes(4, times), batchFluxes(4, fluxes), residuals;
+	BOOST_REQUIRE_NO_THROW(detrend(batchTimes, batchFluxes, 5.0, residuals));
+	BOOST_REQUIRE_NO_THROW(stopTrace());
+	BOOST_CHECK(failed.empty());
+	
+	const std::string trace = readTrace();
+	BOOST_CHECK_EQUAL(trace.compare(0, 16, "{\"traceEvents\":["), 0);
+	BOOST_CHECK_EQUAL(count(trace, "{"), count(trace, "}"));
+	BOOST_CHECK_EQUAL(count(trace, "["), count(trace, "]"));
+	BOOST_CHECK_EQUAL(count(trace, ",\n]"), 0U);
+	BOOST_CHECK(trace.find("\"dropped_events\":0}") != std::string::npos);
+	
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"processBatch\""), 1U);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"BatchTask::process\""), 8U);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"lombScargle\""), 8U);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"detrend\""), 4U);
+	for(int item = 0; item < 8; item++) {
+		BOOST_CHECK_MESSAGE(trace.find("\"args\":{\"id\":" + std::string(1, '0'+item) + "}") 
+			!= std::string::npos, "Object " << item << " missing from trace");
+	}
+	
+	// Every span is tagged with the process that ran it
+	std::set<std::string> pids;
+	const std::string tag = "\"ph\":\"X\",\"pid\":";
+	for(size_t pos = trace.find(tag); pos != std::string::npos; 
+			pos = trace.find(tag, pos+1)) {
+		const size_t start = pos + tag.size();
+		pids.insert(trace.substr(start, trace.find(',', start) - start));
+	}
+	BOOST_CHECK_GE(pids.size(), 2U);
+	
+	/* @test The files left by the workers. Expected behavior = removed.
+	 */
+	for(std::set<std::string>::const_iterator it = pids.begin(); it != pids.end(); it++) {
+		std::ifstream leftover((traceFile + ".part." + *it).c_str());
+		BOOST_CHECK(!leftover);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
@@ -0,0 +1,287 @@
+/** Performs unit testing of kpftimes::autotune() and wisdom files
+ * @file timescales/tests/unit_tuning.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include <unistd.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../nufft.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Checks that two vectors agree element by element
+ */
+void checkClose(const DoubleVec &expected, const DoubleVec &actual, double frac);
+
+/** Data common to the test cases.
+ *
+ * Contains a short light curve and the name of a scratch wisdom file
+ */
+class TuningData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	TuningData(): times(), fluxes(), freqs(), 
+			wisdomFile("/tmp/kpft_unit_tuning_" + boost::lexical_cast<std::string>(getpid())) {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 40; i++) {
+			times.push_back(100.0*gsl_rng_uniform(gen.get()));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+		}
+		for(double f = 0.01; f < 3.0; f += 0.01) {
+			freqs.push_back(f);
+		}
+	}
+	
+	virtual ~TuningData() {
+		forgetWisdom();
+		std::remove(wisdomFile.c_str());
+	}
+	
+	/** Writes a wisdom file with the given body
+	 */
+	void writeWisdom(const std::string &body) const {
+		std::ofstream out(wisdomFile.c_str());
+		out << "# Timescales wisdom 1\n" << body;
+	}
+	
+	/** Grid with 40 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Grid of positive frequencies
+	 */
+	DoubleVec freqs;
+	/** Name of a scratch wisdom file
+	 */
+	std::string wisdomFile;
+};
+
+/** Test cases for tuning
+ * @class BoostTest::test_tuning
+ */
+BOOST_FIXTURE_TEST_SUITE(test_tuning, TuningData)
+
+/** Tests whether wisdom files are read and validated correctly
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(wisdom) {
+	DoubleVec expected, actual;
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	
+	/* @test Wisdom that disables the short light curve kernels. Expected 
+	 *	behavior = the same periodogram to rounding error.
+	 */
+	writeWisdom("small_n_limit 0\n");
+	BOOST_REQUIRE_NO_THROW(importWisdom(wisdomFile));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, actual));
+	checkClose(expected, actual, 1e-10);
+	
+	/* @test Wisdom with an unusual block size. Expected behavior = the 
+	 *	same periodogram to rounding error.
+	 */
+	writeWisdom("small_n_limit 64\nfreq_block 7\n");
+	BOOST_REQUIRE_NO_THROW(importWisdom(wisdomFile));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, actual));
+	checkClose(expected, actual, 1e-10);
+	
+	/* @test Exporting and reimporting wisdom. Expected behavior = the 
+	 *	same file.
+	 */
+	BOOST_REQUIRE_NO_THROW(exportWisdom(wisdomFile));
+	std::string first, second;
+	{
+		std::ifstream in(wisdomFile.c_str());
+		std::getline(in, first, '\0');
+	}
+	forgetWisdom();
+	BOOST_REQUIRE_NO_THROW(importWisdom(wisdomFile));
+	BOOST_REQUIRE_NO_THROW(exportWisdom(wisdomFile));
+	{
+		std::ifstream in(wisdomFile.c_str());
+		std::getline(in, second, '\0');
+	}
+	BOOST_CHECK_EQUAL(first, second);
+	BOOST_CHECK(first.find("freq_block 7\n") != std::string::npos);
+	
+	/* @test Invalid wisdom files. Expected behavior = throw runtime_error, 
+	 *	and keep the previous parameters.
+	 */
+	writeWisdom("small_n_limit 65\n");
+	BOOST_CHECK_THROW(importWisdom(wisdomFile), std::runtime_error);
+	writeWisdom("freq_block 0\n");
+	BOOST_CHECK_THROW(importWisdom(wisdomFile), std::runtime_error);
+	writeWisdom("fastest yes\n");
+	BOOST_CHECK_THROW(importWisdom(wisdomFile), std::runtime_error);
+	{
+		std::ofstream out(wisdomFile.c_str());
+		out << "small_n_limit 0\n";
+	}
+	BOOST_CHECK_THROW(importWisdom(wisdomFile), std::runtime_error);
+	BOOST_CHECK_THROW(importWisdom(wisdomFile + ".missing"), std::runtime_error);
+	BOOST_REQUIRE_NO_THROW(exportWisdom(wisdomFile));
+	{
+		std::ifstream in(wisdomFile.c_str());
+		std::getline(in, second, '\0');
+	}
+	BOOST_CHECK_EQUAL(first, second);
+}
+
+/** Tests whether the algorithms chosen by tuning agree
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(algorithms) {
+	shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), &gsl_rng_free);
+	gsl_rng_set(gen.get(), 101);
+	
+	/* @test Direct summation of a Fourier series. Expected behavior = 
+	 *	matches the nonuniform FFT to its precision.
+	 */
+	ComplexVec coeffs;
+	double norm = 0.0;
+	for (size_t m = 0; m < 301; m++) {
+		coeffs.push_back(std::complex<double>(gsl_ran_gaussian(gen.get(), 1.0), 
+				gsl_ran_gaussian(gen.get(), 1.0)));
+		norm += std::abs(coeffs.back());
+	}
+	DoubleVec x;
+	for (size_t j = 0; j < 200; j++) {
+		x.push_back(20.0*(gsl_rng_uniform(gen.get()) - 0.5));
+	}
+	ComplexVec fast, direct;
+	BOOST_REQUIRE_NO_THROW(nufftType2(coeffs, x, fast, 1e-12));
+	BOOST_REQUIRE_NO_THROW(directType2(coeffs, x, direct));
+	BOOST_REQUIRE_EQUAL(direct.size(), x.size());
+	double maxErr = 0.0;
+	for (size_t j = 0; j < x.size(); j++) {
+		maxErr = std::max(maxErr, std::abs(fast[j] - direct[j]));
+	}
+	BOOST_CHECK_LT(maxErr, 1e-10 * norm);
+	BOOST_CHECK_THROW(directType2(ComplexVec(), x, direct), std::invalid_argument);
+	
+	/* @test Power law noise simulated with either algorithm. Expected 
+	 *	behavior = the same light curve to the NUFFT precision.
+	 */
+	DoubleVec deviates, viaNufft, viaDirect;
+	PowerLawNoise model(2.0);
+	for (size_t i = 0; i < model.numDeviates(times); i++) {
+		deviates.push_back(gsl_ran_gaussian(gen.get(), 1.0));
+	}
+	writeWisdom("nufft_min_modes 0\n");
+	BOOST_REQUIRE_NO_THROW(importWisdom(wisdomFile));
+	BOOST_REQUIRE_NO_THROW(model.simulate(times, deviates, viaNufft));
+	writeWisdom("nufft_min_modes 100000\n");
+	BOOST_REQUIRE_NO_THROW(importWisdom(wisdomFile));
+	BOOST_REQUIRE_NO_THROW(model.simulate(times, deviates, viaDirect));
+	BOOST_REQUIRE_EQUAL(viaNufft.size(), viaDirect.size());
+	double scale = 0.0;
+	for (size_t i = 0; i < viaNufft.size(); i++) {
+		scale = std::max(scale, fabs(viaNufft[i]));
+	}
+	for (size_t i = 0; i < viaNufft.size(); i++) {
+		BOOST_CHECK_SMALL(viaNufft[i] - viaDirect[i], 1e-7 * scale);
+	}
+}
+
+/** Tests whether autotune() produces usable wisdom
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(tune) {
+	DoubleVec expected, actual;
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	
+	/* @test A full tuning run. Expected behavior = a wisdom file that can 
+	 *	be imported, and an unchanged periodogram.
+	 */
+	BOOST_REQUIRE_NO_THROW(autotune(wisdomFile));
+	forgetWisdom();
+	BOOST_REQUIRE_NO_THROW(importWisdom(wisdomFile));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, actual));
+	checkClose(expected, actual, 1e-10);
+	
+	/* @test A tuning run that cannot save its results. Expected behavior 
+	 *	= throw runtime_error.
+	 */
+	BOOST_CHECK_THROW(autotune("/nonexistent/directory/wisdom"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
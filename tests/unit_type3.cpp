@@ -0,0 +1,294 @@
+/** Performs unit testing of the type 3 nonuniform FFT and the 
+ *	periodograms that use it
+ * @file timescales/tests/unit_type3.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <cmath>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../dft.h"
+#include "../nufft.h"
+#include "../tuning.h"
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve and several frequency sets that are not 
+ * regular grids
+ */
+class Type3Data {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	Type3Data(): times(), fluxes(), logFreqs(), harmonics() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 300; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(1.3*times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+		}
+		
+		for(size_t i = 0; i < 1000; i++) {
+			logFreqs.push_back(0.01 * pow(200.0, i / 1000.0));
+		}
+		// The first 20 harmonics of 50 trial periods
+		for(size_t p = 0; p < 50; p++) {
+			const double f0 = 0.05 + 0.002*p;
+			for(size_t h = 1; h <= 20; h++) {
+				harmonics.push_back(h*f0);
+			}
+		}
+	}
+	
+	virtual ~Type3Data() {
+		forgetWisdom();
+	}
+	
+	/** Sets the smallest number of frequencies for which the type 3 
+	 *	transform is used.
+	 */
+	static void setMinTargets(size_t limit) {
+		Tuning tuning = currentTuning();
+		tuning.type3MinTargets = limit;
+		setTuning(tuning);
+	}
+	
+	/** Returns the largest difference between two results, as a 
+	 *	fraction of the largest value in the reference.
+	 */
+	template <typename Vec>
+	static double relError(const Vec &expected, const Vec &actual) {
+		BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+		double diff = 0.0, scale = 0.0;
+		for(size_t i = 0; i < expected.size(); i++) {
+			diff  = std::max(diff , std::abs(actual[i] - expected[i]));
+			scale = std::max(scale, std::abs(expected[i]));
+		}
+		return diff / scale;
+	}
+	
+	/** Grid with 300 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** 1000 logarithmically spaced frequencies
+	 */
+	DoubleVec logFreqs;
+	/** The harmonics of a set of trial frequencies, in no particular order
+	 */
+	DoubleVec harmonics;
+};
+
+/** Test cases for the type 3 nonuniform FFT
+ * @class BoostTest::test_type3
+ */
+BOOST_FIXTURE_TEST_SUITE(test_type3, Type3Data)
+
+/** Tests whether the type 3 transform matches direct summation
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(transform) {
+	shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), &gsl_rng_free);
+	gsl_rng_set(gen.get(), 101);
+
+	DoubleVec x, s;
+	ComplexVec strengths;
+	double norm = 0.0;
+	for (size_t j = 0; j < 200; j++) {
+		x.push_back(30.0*gsl_rng_uniform(gen.get()) + 1000.0);
+		strengths.push_back(std::complex<double>(gsl_ran_gaussian(gen.get(), 1.0), 
+				gsl_ran_gaussian(gen.get(), 1.0)));
+		norm += std::abs(strengths.back());
+	}
+	for (size_t k = 0; k < 150; k++) {
+		s.push_back(8.0*gsl_rng_uniform(gen.get()) - 3.0);
+	}
+
+	/* @test 200 random points with random strengths, evaluated at 150 
+	 *	random targets that are not centered on zero. Expected behavior 
+	 *	= matches direct summation to the requested precision.
+	 */
+	ComplexVec fast, slow;
+	BOOST_REQUIRE_NO_THROW(nufftType3(x, strengths, s, fast, 1e-10));
+	BOOST_REQUIRE_NO_THROW(directType3(x, strengths, s, slow));
+	BOOST_REQUIRE_EQUAL(fast.size(), s.size());
+	double maxErr = 0.0;
+	for (size_t k = 0; k < s.size(); k++) {
+		maxErr = std::max(maxErr, std::abs(fast[k] - slow[k]));
+	}
+	BOOST_CHECK_LT(maxErr, 1e-10 * norm);
+
+	/* @test A single target, and a transform with no points. Expected 
+	 *	behavior = matches direct summation.
+	 */
+	BOOST_REQUIRE_NO_THROW(nufftType3(x, strengths, DoubleVec(1, 0.7), fast, 1e-10));
+	BOOST_REQUIRE_NO_THROW(directType3(x, strengths, DoubleVec(1, 0.7), slow));
+	BOOST_REQUIRE_EQUAL(fast.size(), 1U);
+	BOOST_CHECK_SMALL(std::abs(fast[0] - slow[0]), 1e-12 * norm);
+	BOOST_REQUIRE_NO_THROW(nufftType3(DoubleVec(), ComplexVec(), s, fast, 1e-10));
+	BOOST_REQUIRE_EQUAL(fast.size(), s.size());
+	BOOST_CHECK(fast == ComplexVec(s.size(), 0.0));
+
+	/* @test Points and strengths of different lengths, or an invalid 
+	 *	precision. Expected behavior = throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(nufftType3(x, ComplexVec(3), s, fast, 1e-10), std::invalid_argument);
+	BOOST_CHECK_THROW(directType3(x, ComplexVec(3), s, slow), std::invalid_argument);
+	BOOST_CHECK_THROW(nufftType3(x, strengths, s, fast, 0.0), std::invalid_argument);
+	BOOST_CHECK_THROW(nufftType3(x, strengths, s, fast, 1.0), std::invalid_argument);
+}
+
+/** Tests whether the choice of algorithm follows the tuning parameters
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(choice) {
+	/* @test Fewer frequencies than Tuning::type3MinTargets. Expected 
+	 *	behavior = direct summation.
+	 */
+	setMinTargets(512);
+	BOOST_CHECK(!preferType3(300, 511, 45.0, 12.0, TYPE3_PRECISION));
+	/* @test Many frequencies spanning a range comparable to the 
+	 *	pseudo-Nyquist frequency. Expected behavior = type 3 transform.
+	 */
+	BOOST_CHECK( preferType3(300, 1000, 45.0, 12.0, TYPE3_PRECISION));
+	/* @test Many frequencies spanning a range so wide that the transform's 
+	 *	grid is larger than the direct sum. Expected behavior = direct 
+	 *	summation.
+	 */
+	BOOST_CHECK(!preferType3(300, 1000, 45.0, 1e5, TYPE3_PRECISION));
+	/* @test The grid size grows with the product of the ranges. Expected 
+	 *	behavior = doubling one range roughly doubles the grid.
+	 */
+	const size_t small = type3GridSize(1000.0, 10.0, TYPE3_PRECISION);
+	const size_t large = type3GridSize(1000.0, 20.0, TYPE3_PRECISION);
+	BOOST_CHECK_GT(large, 3*small/2);
+	BOOST_CHECK_LT(large, 2*small + 2);
+}
+
+/** Tests whether periodograms and DFTs over arbitrary frequency sets 
+ *	match direct summation
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(periodogram) {
+	const double fSpan = 2.0 * 3.14159 * (logFreqs.back() - logFreqs.front());
+	BOOST_REQUIRE(preferType3(times.size(), logFreqs.size(), 
+		times.back() - times.front(), fSpan, TYPE3_PRECISION));
+	
+	const BoolVec allValid(times.size(), true);
+	DoubleVec power, expectedPower;
+	ComplexVec transform, expectedTransform;
+	
+	/* @test lombScargle() and the masked dft() over logarithmically spaced 
+	 *	frequencies. Expected behavior = same result as direct summation.
+	 */
+	setMinTargets(0);
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, logFreqs, power));
+	BOOST_REQUIRE_NO_THROW(dft(times, fluxes, allValid, logFreqs, transform));
+	setMinTargets(static_cast<size_t>(-1));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, logFreqs, expectedPower));
+	BOOST_REQUIRE_NO_THROW(dft(times, fluxes, allValid, logFreqs, expectedTransform));
+	BOOST_CHECK_LT(relError(expectedPower, power), 1e-8);
+	BOOST_CHECK_LT(relError(expectedTransform, transform), 1e-8);
+	
+	/* @test lombScargle() and dft() over the harmonics of many trial 
+	 *	periods, in no particular order. Expected behavior = same 
+	 *	result as direct summation.
+	 */
+	setMinTargets(0);
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, harmonics, power));
+	BOOST_REQUIRE_NO_THROW(dft(times, fluxes, allValid, harmonics, transform));
+	setMinTargets(static_cast<size_t>(-1));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, harmonics, expectedPower));
+	BOOST_REQUIRE_NO_THROW(dft(times, fluxes, allValid, harmonics, expectedTransform));
+	BOOST_CHECK_LT(relError(expectedPower, power), 1e-8);
+	BOOST_CHECK_LT(relError(expectedTransform, transform), 1e-8);
+	
+	/* @test A periodogram with a mask. Expected behavior = same result 
+	 *	as direct summation.
+	 */
+	BoolVec mask(times.size(), true);
+	for(size_t i = 0; i < mask.size(); i += 3) {
+		mask[i] = false;
+	}
+	setMinTargets(0);
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, logFreqs, power));
+	setMinTargets(static_cast<size_t>(-1));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, logFreqs, expectedPower));
+	BOOST_CHECK_LT(relError(expectedPower, power), 1e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
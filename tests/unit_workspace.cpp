@@ -0,0 +1,452 @@
+/** Performs unit testing of kpftimes::Workspace
+ * @file timescales/tests/unit_workspace.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../common/warnflags.h"
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_COARSEWARN
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+// Boost.Test uses C-style casts and non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+// Re-enable all compiler warnings
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <new>
+#include <stdexcept>
+#include <cmath>
+#include <cstdlib>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+#include "../../common/alloc.tmp.h"
+#include "../timescales.h"
+#include "../ctimescales.h"
+#include "../dft.h"
+#include "../tuning.h"
+
+namespace kpftimes { namespace test {
+
+/** Whether operator new is counting allocations
+ */
+bool countingAllocations = false;
+/** The number of allocations made while countingAllocations was true
+ */
+unsigned long allocationCount = 0;
+
+}}		// end kpftimes::test
+
+/** Allocates memory, counting the call if requested by a test.
+ *
+ * @param[in] size	The number of bytes needed
+ *
+ * @return A pointer to the new memory
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory.
+ *
+ * @note The standard operator delete frees memory from malloc(), so it 
+ *	needs no replacement.
+ */
+void* operator new(std::size_t size) throw(std::bad_alloc) {
+	if (kpftimes::test::countingAllocations) {
+		kpftimes::test::allocationCount++;
+	}
+	void *memory = std::malloc(size > 0 ? size : 1);
+	if (memory == NULL) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+namespace kpftimes { namespace test {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Counts the allocations made while it exists.
+ */
+class AllocationCounter {
+public:
+	/** Starts counting.
+	 */
+	AllocationCounter() {
+		allocationCount     = 0;
+		countingAllocations = true;
+	}
+	/** Stops counting.
+	 */
+	~AllocationCounter() {
+		countingAllocations = false;
+	}
+	/** Returns the number of allocations so far.
+	 */
+	unsigned long getCount() const {
+		return allocationCount;
+	}
+};
+
+/** Restores the tuning parameters in effect when it was created.
+ */
+class TuningGuard {
+public:
+	TuningGuard() : saved(currentTuning()) {
+	}
+	~TuningGuard() {
+		setTuning(saved);
+	}
+private:
+	const Tuning saved;
+};
+
+/** Data common to the test cases.
+ *
+ * Contains a light curve, a mask, and grids for the periodogram and ACF
+ */
+class WorkspaceData {
+public: 
+	/** Defines the data for each test case.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the testing data.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	WorkspaceData(): times(), fluxes(), mask(), freqs(), offsets() {
+		shared_ptr<gsl_rng> gen(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(gen.get(), 42);
+		
+		for(size_t i = 0; i < 150; i++) {
+			times.push_back(0.452*(100*gsl_rng_uniform(gen.get())+42));
+		}
+		std::sort(times.begin(), times.end());
+		for(size_t i = 0; i < times.size(); i++) {
+			fluxes.push_back(sin(times[i]) + gsl_ran_gaussian(gen.get(), 0.3));
+			mask  .push_back(gsl_rng_uniform(gen.get()) > 0.2);
+		}
+		
+		for(double f = 0.0; f < 2.0; f += 0.01) {
+			freqs.push_back(f);
+		}
+		for(double t = 0.0; t < 20.0; t += 0.5) {
+			offsets.push_back(t);
+		}
+	}
+	
+	virtual ~WorkspaceData() {
+	}
+	
+	/** Grid with 150 random times in ascending order
+	 */
+	DoubleVec times;
+	/** A noisy sine wave observed at @p times
+	 */
+	DoubleVec fluxes;
+	/** Mask with roughly 20% of epochs removed
+	 */
+	BoolVec mask;
+	/** Grid of frequencies, starting at zero
+	 */
+	DoubleVec freqs;
+	/** Uniform grid of ACF offsets
+	 */
+	DoubleVec offsets;
+};
+
+/** Test cases for reusable temporary memory
+ * @class BoostTest::test_workspace
+ */
+BOOST_FIXTURE_TEST_SUITE(test_workspace, WorkspaceData)
+
+/** Tests whether functions give the same results with and without a workspace
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(results) {
+	Workspace workspace;
+	DoubleVec expected, actual;
+	
+	/* @test lombScargle() with and without a workspace, with and without 
+	 *	a mask. Expected behavior = identical output.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, freqs, actual, workspace));
+	BOOST_CHECK(expected == actual);
+	
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, actual, workspace));
+	BOOST_CHECK(expected == actual);
+	
+	/* @test autoCorr() with and without a workspace, with and without 
+	 *	a mask. Expected behavior = identical output.
+	 */
+	BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, offsets, expected, 0.5));
+	BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, offsets, actual, 0.5, workspace));
+	BOOST_CHECK(expected == actual);
+	
+	BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, mask, offsets, expected, 0.5));
+	BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, mask, offsets, actual, 0.5, workspace));
+	BOOST_CHECK(expected == actual);
+	
+	/* @test A workspace that has been used for a larger light curve. 
+	 *	Expected behavior = identical output to a fresh calculation.
+	 */
+	DoubleVec shortTimes(times.begin(), times.begin() + 50);
+	DoubleVec shortFluxes(fluxes.begin(), fluxes.begin() + 50);
+	BOOST_REQUIRE_NO_THROW(lombScargle(shortTimes, shortFluxes, freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(shortTimes, shortFluxes, freqs, actual, workspace));
+	BOOST_CHECK(expected == actual);
+	
+	/* @test Invalid input with a workspace. Expected behavior = throw 
+	 *	the same exception as without a workspace, and leave the 
+	 *	workspace usable.
+	 */
+	BOOST_CHECK_THROW(lombScargle(times, DoubleVec(3, 1.0), freqs, actual, workspace), 
+			std::invalid_argument);
+	BOOST_CHECK_THROW(autoCorr(times, fluxes, BoolVec(3, true), offsets, actual, 0.5, 
+			workspace), std::invalid_argument);
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, expected));
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, actual, workspace));
+	BOOST_CHECK(expected == actual);
+}
+
+/** Tests whether a workspace stops allocating memory once warmed up
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(reuse) {
+	Workspace workspace;
+	DoubleVec power, acf;
+	
+	/* @test A new workspace. Expected behavior = holds no memory.
+	 */
+	BOOST_CHECK_EQUAL(workspace.getBytes(), 0U);
+	
+	/* @test Repeated calls with the same inputs. Expected behavior = the 
+	 *	memory held by the workspace stops changing once each buffer has 
+	 *	been used by both functions.
+	 */
+	for(int i = 0; i < 2; i++) {
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, power, workspace));
+		BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, mask, offsets, acf, 0.5, workspace));
+	}
+	size_t warm = workspace.getBytes();
+	BOOST_CHECK_GT(warm, 0U);
+	for(int i = 0; i < 5; i++) {
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, power, workspace));
+		BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, mask, offsets, acf, 0.5, workspace));
+		BOOST_CHECK_EQUAL(workspace.getBytes(), warm);
+	}
+	
+	/* @test A copy of a warmed-up workspace. Expected behavior = the copy 
+	 *	holds no memory, and the original is unchanged.
+	 */
+	Workspace copy(workspace);
+	BOOST_CHECK_EQUAL(copy.getBytes(), 0U);
+	BOOST_CHECK_EQUAL(workspace.getBytes(), warm);
+	copy = workspace;
+	BOOST_CHECK_EQUAL(copy.getBytes(), 0U);
+	
+	/* @test release(). Expected behavior = holds no memory, but can still 
+	 *	be used.
+	 */
+	workspace.release();
+	BOOST_CHECK_EQUAL(workspace.getBytes(), 0U);
+	BOOST_CHECK_NO_THROW(lombScargle(times, fluxes, freqs, power, workspace));
+}
+
+/** Tests whether each algorithm behind the workspace functions stops 
+ *	allocating memory once warmed up
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(paths) {
+	TuningGuard guard;
+	Workspace workspace;
+	DoubleVec power, acf;
+	ComplexVec spectrum;
+	unsigned long allocated = 0;
+	
+	DoubleVec shortTimes(times.begin(), times.begin() + 20);
+	DoubleVec shortFluxes(fluxes.begin(), fluxes.begin() + 20);
+	
+	/* @test Repeated calls that use direct summation, the short light 
+	 *	curve kernels, the type 3 transform, and the FFT-based ACF. 
+	 *	Expected behavior = no allocations after the first pass.
+	 */
+	Tuning tuning = currentTuning();
+	tuning.smallNLimit     = 64;
+	tuning.type3MinTargets = 1000000;
+	setTuning(tuning);
+	for(int i = 0; i < 2; i++) {
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, power, workspace));
+		BOOST_REQUIRE_NO_THROW(lombScargle(shortTimes, shortFluxes, freqs, power, workspace));
+		BOOST_REQUIRE_NO_THROW(autoCorr(times, fluxes, mask, offsets, acf, 0.5, workspace));
+	}
+	{
+		AllocationCounter counter;
+		for(int i = 0; i < 3; i++) {
+			lombScargle(times, fluxes, mask, freqs, power, workspace);
+			lombScargle(shortTimes, shortFluxes, freqs, power, workspace);
+			autoCorr(times, fluxes, mask, offsets, acf, 0.5, workspace);
+		}
+		allocated = counter.getCount();
+	}
+	BOOST_CHECK_EQUAL(allocated, 0UL);
+	
+	tuning.type3MinTargets = 2;
+	setTuning(tuning);
+	for(int i = 0; i < 2; i++) {
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, power, workspace));
+		BOOST_REQUIRE_NO_THROW(dft(times, fluxes, mask, freqs, spectrum, workspace));
+	}
+	{
+		AllocationCounter counter;
+		for(int i = 0; i < 3; i++) {
+			lombScargle(times, fluxes, mask, freqs, power, workspace);
+			dft(times, fluxes, mask, freqs, spectrum, workspace);
+		}
+		allocated = counter.getCount();
+	}
+	BOOST_CHECK_EQUAL(allocated, 0UL);
+	
+	/* @test Repeated calls without a workspace. Expected behavior = the 
+	 *	calling thread's default workspace is used, so there are no 
+	 *	allocations after the first pass.
+	 */
+	for(int i = 0; i < 2; i++) {
+		BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, power));
+		BOOST_REQUIRE_NO_THROW(lombScargle(shortTimes, shortFluxes, freqs, power));
+	}
+	BOOST_CHECK_GT(threadWorkspace().getBytes(), 0U);
+	{
+		AllocationCounter counter;
+		for(int i = 0; i < 3; i++) {
+			lombScargle(times, fluxes, mask, freqs, power);
+			lombScargle(shortTimes, shortFluxes, freqs, power);
+		}
+		allocated = counter.getCount();
+	}
+	BOOST_CHECK_EQUAL(allocated, 0UL);
+	
+	/* @test The type 3 and short light curve paths with a workspace. 
+	 *	Expected behavior = identical output to a fresh calculation.
+	 */
+	DoubleVec expected;
+	lombScargle(times, fluxes, mask, freqs, power, workspace);
+	BOOST_REQUIRE_NO_THROW(lombScargle(times, fluxes, mask, freqs, expected));
+	BOOST_CHECK(expected == power);
+	lombScargle(shortTimes, shortFluxes, freqs, power, workspace);
+	BOOST_REQUIRE_NO_THROW(lombScargle(shortTimes, shortFluxes, freqs, expected));
+	BOOST_CHECK(expected == power);
+	
+	threadWorkspace().release();
+	BOOST_CHECK_EQUAL(threadWorkspace().getBytes(), 0U);
+}
+
+/** Tests whether planned periodograms stop allocating memory once warmed up
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(plans) {
+	Workspace workspace;
+	DoubleVec expected, power;
+	unsigned long allocated = 0;
+	const LsPlan plan(times, freqs);
+	
+	/* @test Planned lombScargle() with and without a workspace. Expected 
+	 *	behavior = identical output, and no allocations after the 
+	 *	first pass.
+	 */
+	BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, mask, expected));
+	for(int i = 0; i < 2; i++) {
+		BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, mask, power, workspace));
+		BOOST_REQUIRE_NO_THROW(lombScargle(plan, fluxes, mask, power));
+	}
+	BOOST_CHECK(expected == power);
+	{
+		AllocationCounter counter;
+		for(int i = 0; i < 3; i++) {
+			lombScargle(plan, fluxes, mask, power, workspace);
+			lombScargle(plan, fluxes, mask, power);
+		}
+		allocated = counter.getCount();
+	}
+	BOOST_CHECK_EQUAL(allocated, 0UL);
+	BOOST_CHECK(expected == power);
+	
+	/* @test Planned periodograms through the C interface. Expected 
+	 *	behavior = identical output, and no allocations after the 
+	 *	first pass.
+	 */
+	std::vector<unsigned char> flags(mask.begin(), mask.end());
+	const kpft_vector cTimes  = {&times [0], times .size(), 1};
+	const kpft_vector cFluxes = {&fluxes[0], fluxes.size(), 1};
+	const kpft_vector cFreqs  = {&freqs [0], freqs .size(), 1};
+	const kpft_flags  cMask   = {&flags [0], flags .size(), 1};
+	const kpft_out_vector cPower = {&power[0], power.size(), 1};
+	
+	kpft_workspace *cWorkspace = kpft_workspace_new();
+	BOOST_REQUIRE(cWorkspace != NULL);
+	kpft_plan *cPlan = NULL;
+	BOOST_REQUIRE_EQUAL(kpft_plan_new(cWorkspace, cTimes, cFreqs, &cPlan), 
+			KPFT_SUCCESS);
+	for(int i = 0; i < 2; i++) {
+		BOOST_CHECK_EQUAL(kpft_plan_lomb_scargle(cWorkspace, cPlan, cFluxes, 
+				&cMask, cPower), KPFT_SUCCESS);
+	}
+	{
+		AllocationCounter counter;
+		for(int i = 0; i < 3; i++) {
+			kpft_plan_lomb_scargle(cWorkspace, cPlan, cFluxes, &cMask, cPower);
+		}
+		allocated = counter.getCount();
+	}
+	kpft_plan_free(cPlan);
+	kpft_workspace_free(cWorkspace);
+	BOOST_CHECK_EQUAL(allocated, 0UL);
+	BOOST_CHECK(expected == power);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}		// end kpftimes::test
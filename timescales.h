@@ -2,7 +2,7 @@
  *  @file timescales.h
  *  @author Krzysztof Findeisen
  *  @date Created January 25, 2010
- *  @date Last modified February 28, 2014
+ *  @date Last modified October 18, 2026
  */
  
 /** @mainpage
@@ -107,6 +107,85 @@
  * All version numbers are to be interpreted as described therein. 
  * This documentation constitutes the public API for the library.
  *
+ * @section v1_1_0 1.1.0
+ *
+ * @subsection v1_1_0_new New Features 
+ * 
+ * - lsThreshold() and lsNormalEdf() can now simulate red noise, using the 
+ *	new NullModel classes DampedRandomWalk and PowerLawNoise
+ * - lsThreshold() and lsNormalEdf() now accept a seed, so that the 
+ *	simulations can be reproduced exactly
+ * - lsThreshold() and lsNormalEdf() can now run their simulations in 
+ *	parallel, if the library is compiled with OpenMP support
+ * - lombScargle(), autoCorr(), dmdt(), peakFind(), and peakFindTimescales() 
+ *	now accept a mask of valid epochs, so that light curves with 
+ *	flagged data need not be copied
+ * - Added LsPlan, which lets lombScargle() reuse the cadence-dependent 
+ *	parts of the calculation for every light curve observed with a 
+ *	common cadence
+ * - Added rolling median, median absolute deviation, and mean filters for 
+ *	detrending irregularly sampled light curves
+ * - Added binLightCurve() and lombScargleMultires(), which bin densely 
+ *	sampled light curves to a resolution set by the highest frequency 
+ *	of interest, with a bounded error in the periodogram
+ * - Added TemplateBank, foldLightCurve(), and matchTemplates() for 
+ *	classifying periodic variables by the shapes of their folded light 
+ *	curves
+ * - Added LsMonteCarlo, which runs the simulations of lsThreshold() and 
+ *	lsNormalEdf() in stages with progress reports, time limits, 
+ *	cancellation, and access to partial results
+ * - LsMonteCarlo can save its progress to a checkpoint file and resume 
+ *	from it, with results identical to an uninterrupted run
+ * - Added Workspace, which lets lombScargle() and autoCorr() reuse their 
+ *	temporary memory from one call to the next
+ * - lombScargle() and autoCorr() are roughly twice as fast for light 
+ *	curves with 64 or fewer epochs
+ * - Added a C interface, declared in ctimescales.h, that reads and 
+ *	writes caller-owned strided arrays
+ * - Added SharedCache, which lets processes on the same node share LsPlan 
+ *	tables, window functions, and false-peak distributions, and 
+ *	processBatch(), which runs a calculation in a pool of worker 
+ *	processes
+ * - Added a binary light curve catalog format, and a manifest-driven 
+ *	runner that splits a catalog into shards for any number of nodes 
+ *	sharing a filesystem and merges the results into one indexed store
+ * - Added autotune(), which measures the fastest algorithms and block 
+ *	sizes for the host and saves them in a wisdom file that later 
+ *	programs load with importWisdom() or at startup
+ * - Added startTrace() and stopTrace(), which record per-object and 
+ *	per-stage timings from every thread and worker process and save 
+ *	them for the Chrome trace viewer
+ * - Added LsEdf, a compact and serializable distribution of false peaks 
+ *	that assigns false alarm probabilities to observed peaks in 
+ *	logarithmic time
+ * - Added ThresholdSurface, which interpolates thresholds and false 
+ *	alarm probabilities across a family of similar cadences, with an 
+ *	error estimate and a fallback to direct simulation
+ * - lombScargle() and dft() evaluate large sets of frequencies, whether 
+ *	uniform grids or arbitrary sets such as harmonics or logarithmic 
+ *	grids, with a type 3 nonuniform FFT, choosing between it and direct 
+ *	summation by the number of frequencies and the ranges of the times 
+ *	and frequencies. The results of such periodograms are no longer 
+ *	exact, but accurate to TYPE3_PRECISION (1e-12 of the sum of the 
+ *	magnitudes of the terms).
+ * - Added lombScargleMultiband(), which finds a common period in light 
+ *	curves observed in several filters with different cadences
+ * - Added Prewhitener, which extracts the frequencies of multiperiodic 
+ *	light curves one at a time, updating the periodogram after each 
+ *	extraction without recomputing it
+ * - Added cleanSpectrum(), which removes aliases from the spectra of 
+ *	irregularly sampled light curves with the CLEAN algorithm
+ * - Added injectionRecovery(), which measures the completeness of a 
+ *	periodogram search over a grid of periods and amplitudes
+ * - Added drwLogLikelihood() and fitDrw(), which measure the timescale 
+ *	of a damped random walk in time linear in the length of the 
+ *	light curve
+ * 
+ * @subsection v1_1_0_fix Bug Fixes 
+ * 
+ * - lsThreshold() and lsNormalEdf() no longer return NaN if the first 
+ *	element of the frequency grid is zero
+ * 
  * @section v1_0_0 1.0.0
  *
  * @subsection v1_0_0_diff Changes 
@@ -162,26 +241,419 @@
  * @internal "+build" tag can be used to distinguish which development 
  *	version was used to create which output
  */
-#define TIMESCALES_VERSION_STRING "1.0.0"
+#define TIMESCALES_VERSION_STRING "1.1.0"
 
 /** Machine-readable version information
  */
 #define TIMESCALES_MAJOR_VERSION 1
 /** Machine-readable version information
  */
-#define TIMESCALES_MINOR_VERSION 0
+#define TIMESCALES_MINOR_VERSION 1
 
 #include <stdexcept>
+#include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 /** A convenient shorthand for vectors of doubles.
  */
 typedef std::vector<double> DoubleVec;
+/** A convenient shorthand for per-epoch validity flags. An epoch is 
+ *	used in a calculation if and only if its flag is true.
+ */
+typedef std::vector<bool> BoolVec;
 
 /** The kpftimes namespace uniquely identifies member functions of the Timescales library.
  */
 namespace kpftimes {
 
+//----------------------------------------------------------
+/** @defgroup workspace Memory reuse
+ *
+ * Support for processing many light curves without repeated allocation
+ *
+ * lombScargle() and autoCorr() accept a Workspace, from which they draw 
+ * their temporary vectors and FFT tables instead of the heap. Once a 
+ * Workspace has served a call, further calls with inputs no larger 
+ * allocate no memory other than, possibly, the output vector, so a loop 
+ * over many short light curves runs at a steady memory footprint. When 
+ * called without a Workspace, these functions use threadWorkspace(). 
+ * Other functions in the library still allocate their temporaries on 
+ * each call.
+ *
+ *  @{
+ */
+
+class ScratchFrame;
+
+/** Reusable scratch memory for library calls.
+ *
+ * A Workspace may not be used by more than one thread at once; give each 
+ * thread its own, or use threadWorkspace().
+ */
+class Workspace {
+public:
+	/** Creates a workspace that holds no memory.
+	 */
+	Workspace();
+	Workspace(const Workspace &other);
+	Workspace& operator=(const Workspace &other);
+	~Workspace();
+
+	/** Frees all memory held by the workspace.
+	 */
+	void release();
+
+	/** Returns the amount of memory held for reuse.
+	 */
+	size_t getBytes() const;
+
+private:
+	friend class ScratchFrame;
+	struct Pools;
+
+	Pools& getPools();
+
+	// Allocated on first use, so that construction never runs out of memory
+	Pools* pools;
+};
+
+/** Returns the calling thread's default workspace.
+ */
+Workspace& threadWorkspace();
+
+/** @} */	// end Memory reuse
+
+//----------------------------------------------------------
+/** @defgroup shared Node-local sharing
+ *
+ * Support for running one process per core without each process 
+ * repeating the same precomputations
+ *
+ * A SharedCache is a named block of POSIX shared memory that holds 
+ * read-only tables: the trigonometric tables of an LsPlan, 
+ * autocorrelation window functions, and false-peak distributions. The 
+ * first process to need a table builds it directly in shared memory, and 
+ * every other process on the node maps the finished copy instead of 
+ * building its own. Tables are published with atomic operations only, 
+ * so a process that dies while building a table never blocks the others.
+ *
+ * processBatch() runs a task over many objects in a pool of worker 
+ * processes, so that a crash while processing one object costs only 
+ * that object.
+ *
+ *  @{
+ */
+
+class CacheAccess;
+
+/** Read-only precomputations shared by all processes on a node.
+ *
+ * Copies of a SharedCache refer to the same shared memory. Tables 
+ * obtained from a cache remain valid after the cache object is 
+ * destroyed.
+ */
+class SharedCache {
+public:
+	/** Attaches to a shared cache, creating it if necessary.
+	 */
+	SharedCache(const std::string &name, size_t capacity);
+
+	/** Returns the name of the shared memory segment.
+	 */
+	const std::string& getName() const;
+
+	/** Returns the number of bytes available for tables.
+	 */
+	size_t getCapacity() const;
+
+	/** Returns the number of bytes used by tables so far.
+	 */
+	size_t getUsed() const;
+
+	/** Deletes a shared cache.
+	 */
+	static void remove(const std::string &name);
+
+private:
+	friend class CacheAccess;
+	struct Segment;
+
+	boost::shared_ptr<Segment> segment;
+};
+
+/** A calculation to be run over many objects by processBatch().
+ *
+ * Subclass BatchTask to describe the work to be done for each object. 
+ * Each worker process runs on its own copy of the task.
+ */
+class BatchTask {
+public:
+	virtual ~BatchTask();
+
+	/** Returns the number of values produced for each object.
+	 *
+	 * @exceptsafe Must not throw exceptions.
+	 */
+	virtual size_t resultSize() const = 0;
+
+	/** Processes one object.
+	 *
+	 * @param[in] item	The index of the object to process
+	 * @param[out] result	The values produced for the object. Has 
+	 *			resultSize() elements on entry, and must 
+	 *			keep that length.
+	 *
+	 * @exception std::exception Thrown if the object could not be 
+	 *	processed. processBatch() reports the object as failed.
+	 */
+	virtual void process(size_t item, DoubleVec &result) = 0;
+};
+
+/** Runs a task over many objects in a pool of worker processes.
+ */
+void processBatch(BatchTask &task, size_t nItems, size_t nWorkers, 
+		DoubleVec &results, std::vector<size_t> &failed);
+
+/** @} */	// end Node-local sharing
+
+//----------------------------------------------------------
+/** @defgroup survey Survey processing
+ *
+ * Support for processing large catalogs of light curves on many nodes
+ *
+ * A catalog is a binary file holding any number of light curves, each 
+ * with an integer ID, written by CatalogWriter and read by CatalogReader. 
+ * Catalog files use the byte order of the machine that wrote them.
+ *
+ * writeManifest() divides a catalog into shards of consecutive objects. 
+ * Any process that can see the manifest and a shared working directory 
+ * may call runShards() to process whatever shards are still unfinished; 
+ * there is no coordinating process. A shard's results are published by 
+ * renaming a finished file and a list of the objects that failed, 
+ * followed by a completion marker, so an interrupted shard is simply 
+ * processed again. Once every shard is 
+ * complete, mergeShards() combines the results, in catalog order, into 
+ * a single file that ResultStore can search by object ID.
+ *
+ *  @{
+ */
+
+/** Writes light curves to a catalog file.
+ *
+ * The catalog is written under a temporary name, and only appears under 
+ * its real name once close() succeeds.
+ */
+class CatalogWriter {
+public:
+	/** Starts a catalog with a fixed number of objects.
+	 */
+	CatalogWriter(const std::string &fileName, size_t nObjects);
+
+	/** Discards the catalog if it was never closed.
+	 */
+	~CatalogWriter();
+
+	/** Appends a light curve to the catalog.
+	 */
+	void add(unsigned long id, const DoubleVec &times, const DoubleVec &fluxes);
+
+	/** Finishes the catalog.
+	 */
+	void close();
+
+private:
+	// Not copyable
+	CatalogWriter(const CatalogWriter &other);
+	CatalogWriter& operator=(const CatalogWriter &other);
+
+	struct Impl;
+	boost::shared_ptr<Impl> impl;
+};
+
+/** Reads light curves from a catalog file.
+ *
+ * Copies of a CatalogReader share the same open file, so a reader and 
+ * its copies must not be used by more than one thread at a time.
+ */
+class CatalogReader {
+public:
+	/** Opens a catalog.
+	 */
+	explicit CatalogReader(const std::string &fileName);
+
+	/** Returns the number of objects in the catalog.
+	 */
+	size_t size() const;
+
+	/** Returns the ID of an object.
+	 */
+	unsigned long getId(size_t object) const;
+
+	/** Returns the number of epochs in an object's light curve.
+	 */
+	size_t getLength(size_t object) const;
+
+	/** Reads an object's light curve.
+	 */
+	void read(size_t object, DoubleVec &times, DoubleVec &fluxes) const;
+
+private:
+	struct Impl;
+	boost::shared_ptr<Impl> impl;
+};
+
+/** A calculation to be run on every object in a catalog by runShards().
+ */
+class ShardTask {
+public:
+	virtual ~ShardTask();
+
+	/** Returns the number of values produced for each object.
+	 *
+	 * @exceptsafe Must not throw exceptions.
+	 */
+	virtual size_t resultSize() const = 0;
+
+	/** Processes one light curve.
+	 *
+	 * @param[in] times	The times of the light curve
+	 * @param[in] fluxes	The fluxes of the light curve
+	 * @param[out] result	The values produced for the object. Has 
+	 *			resultSize() elements on entry, and must 
+	 *			keep that length.
+	 *
+	 * @exception std::exception Thrown if the object could not be 
+	 *	processed. runShards() stores NaN for all its values and 
+	 *	reports the object as failed.
+	 * @exception std::bad_alloc Thrown if there is not enough memory. 
+	 *	runShards() stops without completing the shard, so that it 
+	 *	can be retried.
+	 */
+	virtual void process(const DoubleVec &times, const DoubleVec &fluxes, 
+			DoubleVec &result) = 0;
+};
+
+/** Divides a catalog into shards of consecutive objects.
+ */
+void writeManifest(const std::string &catalogFile, size_t shardSize, 
+		const std::string &manifestFile);
+
+/** Processes the unfinished shards of a manifest.
+ */
+size_t runShards(const std::string &manifestFile, const std::string &workDir, 
+		ShardTask &task, std::vector<unsigned long> &failed, 
+		double staleAfter = 600.0);
+
+/** Processes the unfinished shards of a manifest, without reporting 
+ *	which objects failed.
+ */
+size_t runShards(const std::string &manifestFile, const std::string &workDir, 
+		ShardTask &task, double staleAfter = 600.0);
+
+/** Combines the results of all shards into a single file.
+ */
+void mergeShards(const std::string &manifestFile, const std::string &workDir, 
+		const std::string &storeFile);
+
+/** Looks up the results of mergeShards() by object ID.
+ *
+ * Copies of a ResultStore share the same open file, so a store and its 
+ * copies must not be used by more than one thread at a time.
+ */
+class ResultStore {
+public:
+	/** Opens a file written by mergeShards().
+	 */
+	explicit ResultStore(const std::string &fileName);
+
+	/** Returns the number of objects in the store.
+	 */
+	size_t size() const;
+
+	/** Returns the number of values stored for each object.
+	 */
+	size_t getResultSize() const;
+
+	/** Retrieves the values stored for an object.
+	 */
+	bool find(unsigned long id, DoubleVec &result) const;
+
+private:
+	struct Impl;
+	boost::shared_ptr<Impl> impl;
+};
+
+/** @} */	// end Survey processing
+
+//----------------------------------------------------------
+/** @defgroup tuning Performance tuning
+ *
+ * Support for adapting the library to the machine it runs on
+ *
+ * Several calculations can be done by more than one algorithm, or with 
+ * different block sizes, and the fastest choice depends on the processor 
+ * and its caches. autotune() measures the candidates on the host and 
+ * records the winners in a wisdom file, much as FFTW does. Programs then 
+ * load the file with importWisdom(), or automatically at startup if the 
+ * @c TIMESCALES_WISDOM environment variable names it. Without wisdom, 
+ * built-in defaults that suit most machines are used.
+ *
+ * Tuning never changes results beyond rounding error. The functions in 
+ * this group must not be called while any other thread is using the 
+ * library.
+ *
+ *  @{
+ */
+
+/** Measures the fastest algorithms and block sizes for this machine.
+ */
+void autotune(const std::string &wisdomFile);
+
+/** Loads tuning parameters from a wisdom file.
+ */
+void importWisdom(const std::string &wisdomFile);
+
+/** Saves the tuning parameters currently in effect to a wisdom file.
+ */
+void exportWisdom(const std::string &wisdomFile);
+
+/** Returns to the built-in tuning parameters.
+ */
+void forgetWisdom();
+
+/** @} */	// end Performance tuning
+
+//----------------------------------------------------------
+/** @defgroup trace Execution tracing
+ *
+ * Support for seeing where a batch run spends its time
+ *
+ * While tracing is on, the library records a span for each object 
+ * handled by processBatch(), runShards(), and the batch detrending and 
+ * template functions, and for the main stages of each calculation: 
+ * periodograms, autocorrelation functions, and false-peak simulations. 
+ * Each span records what ran, on which thread and process, when it 
+ * started and ended, and the ID of the light curve, if any. Threads 
+ * record into buffers of their own without locking, so tracing barely 
+ * disturbs the timings it measures, and costs almost nothing when off.
+ *
+ * stopTrace() writes the spans in the Chrome trace-event format, which 
+ * chrome://tracing and Perfetto display as a timeline.
+ *
+ *  @{
+ */
+
+/** Starts recording spans.
+ */
+void startTrace(const std::string &traceFile, size_t eventsPerThread = 65536);
+
+/** Stops recording spans and writes the trace.
+ */
+void stopTrace();
+
+/** @} */	// end Execution tracing
+
 //----------------------------------------------------------
 /** @defgroup period Periodogram generation
  *
@@ -201,6 +673,164 @@ namespace kpftimes {
 void lombScargle(const DoubleVec &times, const DoubleVec &fluxes, 
 		const DoubleVec &freq, DoubleVec &power);
 
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series.
+ */
+void lombScargle(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &freq, DoubleVec &power);
+
+/** Calculates the Lomb-Scargle periodogram for a time series, using 
+ *	preallocated memory.
+ */
+void lombScargle(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &freq, DoubleVec &power, Workspace &workspace);
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series, 
+ *	using preallocated memory.
+ */
+void lombScargle(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &freq, DoubleVec &power, 
+		Workspace &workspace);
+
+/** Calculates the Lomb-Scargle periodogram for a densely sampled time 
+ *	series, binning the data wherever the frequency allows.
+ */
+void lombScargleMultires(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &freq, double tolerance, DoubleVec &power);
+
+/** Calculates a periodogram of a light curve observed in several filters, 
+ *	with a common period and separate offsets and amplitudes.
+ */
+void lombScargleMultiband(const std::vector<DoubleVec> &times, 
+		const std::vector<DoubleVec> &fluxes, const DoubleVec &freq, 
+		DoubleVec &power);
+
+/** Calculates the CLEAN spectrum of a light curve, removing the aliases 
+ *	and sidelobes of its cadence.
+ */
+void cleanSpectrum(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &freq, size_t nIter, double gain, DoubleVec &amplitude);
+
+/** Iterative prewhitening of a multiperiodic light curve.
+ *
+ * A Prewhitener repeatedly finds the highest peak of the Lomb-Scargle 
+ * periodogram, fits a sinusoid at that frequency, and subtracts it from 
+ * the light curve. The trigonometric sums of the periodogram are linear 
+ * in the data, so on a regular frequency grid the effect of each 
+ * subtraction on every frequency is found from a precomputed table of 
+ * window sums, without revisiting the light curve. The sums are 
+ * recomputed exactly every few extractions to remove accumulated 
+ * rounding error.
+ */
+class Prewhitener {
+public:
+	/** Prepares a light curve for prewhitening.
+	 */
+	Prewhitener(const DoubleVec &times, const DoubleVec &fluxes, 
+			const DoubleVec &freq, size_t refresh = 8);
+
+	/** Removes the strongest remaining sinusoid from the light curve.
+	 */
+	double extract(double &amplitude, double &phase);
+
+	/** Returns the periodogram of the residuals.
+	 */
+	const DoubleVec& getPower() const;
+
+	/** Returns the residuals from all sinusoids extracted so far.
+	 */
+	DoubleVec getResiduals() const;
+
+	/** Returns the number of sinusoids extracted so far.
+	 */
+	size_t getNumTerms() const;
+
+private:
+	void recompute();
+	void update(size_t peak, double offset, double a, double b);
+	void findPower();
+
+	// The light curve, with times relative to the first epoch
+	DoubleVec times0;
+	double t0;
+	// The residuals, which always have zero mean, and the offset 
+	//	removed from the original data
+	DoubleVec resid;
+	double meanF;
+	
+	DoubleVec om;
+	// Sums that depend only on the cadence
+	DoubleVec cosSum, sinSum, cos2, sin2;
+	DoubleVec cosOmTau, sinOmTau, tc2, ts2;
+	// Sums that depend on the residuals
+	DoubleVec ch, sh;
+	DoubleVec power;
+	
+	// Window sums at the sums and differences of grid frequencies, 
+	//	if the grid is regular
+	bool regular;
+	DoubleVec sumCos, sumSin, diffCos, diffSin;
+	
+	size_t refresh;
+	size_t nTerms;
+};
+
+/** Precomputed state for calculating Lomb-Scargle periodograms of many 
+ *	light curves that share a cadence and a frequency grid.
+ *
+ * An LsPlan stores the trigonometric tables for the full cadence, so 
+ * that each periodogram computed from it needs no trigonometric function 
+ * calls. Light curves that are missing some of the epochs in the cadence 
+ * can share the same plan; the parts of the calculation that depend 
+ * only on the cadence are corrected for the missing epochs instead of 
+ * being recomputed.
+ *
+ * An LsPlan is not modified by the periodograms computed from it, so a 
+ * single plan may be used by several threads at once.
+ */
+class LsPlan {
+public:
+	/** Precomputes the periodogram tables for a cadence and 
+	 *	frequency grid.
+	 */
+	LsPlan(const DoubleVec &times, const DoubleVec &freqs);
+
+	/** Precomputes the periodogram tables for a cadence and 
+	 *	frequency grid, or maps them from another process.
+	 */
+	LsPlan(const DoubleVec &times, const DoubleVec &freqs, SharedCache &cache);
+
+	/** Returns the times at which the cadence was observed.
+	 */
+	const DoubleVec& getTimes() const;
+
+	/** Returns the frequency grid of the periodograms.
+	 */
+	const DoubleVec& getFreqs() const;
+
+	friend void lombScargle(const LsPlan &plan, const DoubleVec &fluxes, 
+			const BoolVec &mask, DoubleVec &power, Workspace &workspace);
+private:
+	void init(SharedCache *cache);
+
+	DoubleVec times, freqs, om;
+	// sin(om t) and cos(om t), one row per frequency, followed by 
+	//	Eq. (6) of Press & Rybicki (1989) summed over the full cadence
+	// Shared between copies, and possibly with other processes
+	boost::shared_ptr<const double> tables;
+};
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series, 
+ *	using a precomputed plan.
+ */
+void lombScargle(const LsPlan &plan, const DoubleVec &fluxes, 
+		const BoolVec &mask, DoubleVec &power);
+
+/** Calculates the Lomb-Scargle periodogram for a subset of a time series, 
+ *	using a precomputed plan and preallocated memory.
+ */
+void lombScargle(const LsPlan &plan, const DoubleVec &fluxes, 
+		const BoolVec &mask, DoubleVec &power, Workspace &workspace);
+
 /** Calculates the significance threshold for a Lomb-Scargle periodogram.
  */
 double lsThreshold(const DoubleVec &times, const DoubleVec &freq, double fap, long nSims);
@@ -211,6 +841,365 @@ double lsThreshold(const DoubleVec &times, const DoubleVec &freq, double fap, lo
 void lsNormalEdf(const DoubleVec &times, const DoubleVec &freqs, 
 		DoubleVec &powers, DoubleVec &probs, long nSims);
 
+/** Interface for stochastic processes that may be used as the null 
+ *	hypothesis of a periodogram.
+ *
+ * Each model converts a vector of independent standard normal deviates into 
+ * a simulated light curve. Since the deviates are supplied by the caller, 
+ * a model has no state of its own, and may be shared by simulations 
+ * running in parallel.
+ */
+class NullModel {
+public:
+	virtual ~NullModel();
+
+	/** Returns the number of independent standard normal deviates 
+	 *	needed to simulate one light curve.
+	 */
+	virtual size_t numDeviates(const DoubleVec &times) const;
+
+	/** Converts independent standard normal deviates into a simulated 
+	 *	light curve.
+	 */
+	virtual void simulate(const DoubleVec &times, const DoubleVec &deviates, 
+			DoubleVec &fluxes) const = 0;
+};
+
+/** Uncorrelated Gaussian noise. This is the null hypothesis assumed by 
+ *	the versions of lsThreshold() and lsNormalEdf() that do not take 
+ *	a model.
+ */
+class WhiteNoise : public NullModel {
+public:
+	/** Converts independent standard normal deviates into a light 
+	 *	curve of white Gaussian noise.
+	 */
+	virtual void simulate(const DoubleVec &times, const DoubleVec &deviates, 
+			DoubleVec &fluxes) const;
+};
+
+/** Gaussian noise following a damped random walk (a continuous first-order 
+ *	autoregressive process), whose power spectrum is flat below 
+ *	1/(2&pi;&tau;) and falls as f<sup>-2</sup> above it.
+ */
+class DampedRandomWalk : public NullModel {
+public:
+	/** Defines a damped random walk with a particular timescale.
+	 */
+	explicit DampedRandomWalk(double tau);
+
+	/** Converts independent standard normal deviates into a light 
+	 *	curve following a damped random walk.
+	 */
+	virtual void simulate(const DoubleVec &times, const DoubleVec &deviates, 
+			DoubleVec &fluxes) const;
+private:
+	double tau;
+};
+
+/** Gaussian noise with a power-law power spectrum.
+ */
+class PowerLawNoise : public NullModel {
+public:
+	/** Defines a power-law noise process that is simulated up to the 
+	 *	pseudo-Nyquist frequency of the cadence.
+	 */
+	explicit PowerLawNoise(double alpha);
+
+	/** Defines a power-law noise process that is simulated up to a 
+	 *	specific frequency.
+	 */
+	PowerLawNoise(double alpha, double fMax);
+
+	virtual size_t numDeviates(const DoubleVec &times) const;
+
+	/** Converts independent standard normal deviates into a light 
+	 *	curve following a power-law power spectrum.
+	 */
+	virtual void simulate(const DoubleVec &times, const DoubleVec &deviates, 
+			DoubleVec &fluxes) const;
+private:
+	double alpha;
+	double fMax;
+};
+
+/** Calculates the significance threshold for a Lomb-Scargle periodogram, 
+ *	given an arbitrary noise model.
+ */
+double lsThreshold(const DoubleVec &times, const DoubleVec &freq, double fap, long nSims, 
+		const NullModel &model, unsigned long seed);
+
+/** Calculates the empirical distribution function of false peaks for a 
+ *	Lomb-Scargle periodogram, given an arbitrary noise model.
+ */
+void lsNormalEdf(const DoubleVec &times, const DoubleVec &freqs, 
+		DoubleVec &powers, DoubleVec &probs, long nSims, 
+		const NullModel &model, unsigned long seed);
+
+/** Calculates the empirical distribution function of false peaks for a 
+ *	Lomb-Scargle periodogram, sharing the result with other processes.
+ */
+void lsNormalEdf(const DoubleVec &times, const DoubleVec &freqs, 
+		DoubleVec &powers, DoubleVec &probs, long nSims, 
+		const NullModel &model, unsigned long seed, SharedCache &cache);
+
+/** Receives progress reports from long-running calculations.
+ *
+ * Subclass ProgressMonitor and pass it to LsMonteCarlo::setMonitor() to 
+ * display progress or to stop a calculation early.
+ */
+class ProgressMonitor {
+public:
+	virtual ~ProgressMonitor();
+
+	/** Reports the progress of a calculation.
+	 *
+	 * @param[in] done	The number of simulations completed
+	 * @param[in] total	The number of simulations requested
+	 * @param[in] secondsLeft The estimated wall-clock time needed to 
+	 *			finish, in seconds
+	 *
+	 * @return False to cancel the calculation, true to continue.
+	 *
+	 * @exceptsafe Must not throw exceptions.
+	 */
+	virtual bool update(long done, long total, double secondsLeft) = 0;
+};
+
+class LsSimulator;
+
+/** A Monte Carlo calculation of false peaks that can be run in stages, 
+ *	monitored, and cancelled.
+ *
+ * LsMonteCarlo runs the same simulations as lsThreshold() and 
+ * lsNormalEdf(), but lets the caller bound how long each call blocks, 
+ * follow its progress, stop it from another thread, and use the 
+ * simulations finished so far. Simulations are run in blocks, and the 
+ * result of each block depends only on the seed and the block's index, 
+ * so a partial result is exactly the start of the full one.
+ *
+ * One thread may run the simulations while others call cancel(), 
+ * getNumDone(), or estimateRemaining().
+ */
+class LsMonteCarlo {
+public:
+	/** Sets up a run of simulations, without running any of them.
+	 */
+	LsMonteCarlo(const DoubleVec &times, const DoubleVec &freqs, long nSims, 
+			const NullModel &model, unsigned long seed);
+	~LsMonteCarlo();
+
+	/** Chooses an object to be told of the progress of the simulations.
+	 */
+	void setMonitor(ProgressMonitor* monitor);
+
+	/** Runs the remaining simulations.
+	 */
+	bool run();
+
+	/** Runs simulations for at most a given time.
+	 */
+	bool runFor(double seconds);
+
+	/** Asks the simulations to stop.
+	 */
+	void cancel();
+
+	/** Tests whether the simulations have been cancelled.
+	 */
+	bool isCancelled() const;
+
+	/** Tests whether all simulations have been run.
+	 */
+	bool isDone() const;
+
+	/** Returns the total number of simulations requested.
+	 */
+	long getNumSims() const;
+
+	/** Returns the number of simulations completed so far.
+	 */
+	long getNumDone() const;
+
+	/** Estimates how long the remaining simulations will take.
+	 */
+	double estimateRemaining() const;
+
+	/** Calculates the significance threshold from the simulations run 
+	 *	so far.
+	 */
+	double threshold(double fap) const;
+
+	/** Calculates the empirical distribution function of false peaks 
+	 *	from the simulations run so far.
+	 */
+	void edf(DoubleVec &powers, DoubleVec &probs) const;
+
+	/** Saves the progress of the simulations at regular intervals.
+	 */
+	void setCheckpoint(const std::string &fileName, double interval);
+
+	/** Writes the state of the simulations to a file.
+	 */
+	void checkpoint(const std::string &fileName);
+
+	/** Returns the simulations to the state saved in a file.
+	 */
+	void restore(const std::string &fileName);
+
+private:
+	// Not copyable
+	LsMonteCarlo(const LsMonteCarlo &other);
+	LsMonteCarlo& operator=(const LsMonteCarlo &other);
+
+	bool runUntil(double deadline);
+
+	LsSimulator* simulator;
+	const NullModel* model;
+	unsigned long seed;
+	long nSims;
+	// Identifies the cadence, frequencies, and model in checkpoint files
+	unsigned long fingerprint;
+
+	// Peak power of each simulation; the first getNumDone() are valid
+	DoubleVec peaks;
+	volatile long blocksDone;
+	// Wall-clock time spent running blocks
+	double elapsed;
+	ProgressMonitor* monitor;
+	volatile bool cancelled;
+
+	std::string checkpointFile;
+	double checkpointInterval;
+	double lastCheckpoint;
+};
+
+/** A compact distribution of false peaks, for assigning false alarm 
+ *	probabilities to many observed peaks.
+ *
+ * LsEdf summarizes the peak powers simulated by lsNormalEdf() or 
+ * LsMonteCarlo in a bounded number of knots. The highest simulated peaks, 
+ * which decide the significance of real detections, are kept exactly; 
+ * the rest of the distribution is kept at evenly spaced ranks and 
+ * interpolated. An LsEdf can be saved to a file, so that the simulations 
+ * for a cadence need to be run only once.
+ */
+class LsEdf {
+public:
+	/** Summarizes a set of simulated peak powers.
+	 */
+	explicit LsEdf(const DoubleVec &peaks, size_t maxKnots = 4096);
+
+	/** Loads a distribution saved by save().
+	 */
+	explicit LsEdf(const std::string &fileName);
+
+	/** Returns the number of simulations summarized.
+	 */
+	long getNumSims() const;
+
+	/** Returns the number of knots stored.
+	 */
+	size_t size() const;
+
+	/** Returns the false alarm probability of a peak.
+	 */
+	double fap(double power) const;
+
+	/** Returns the false alarm probabilities of many peaks.
+	 */
+	void fap(const DoubleVec &powers, DoubleVec &faps) const;
+
+	/** Returns the peak power needed for a given false alarm probability.
+	 */
+	double threshold(double fap) const;
+
+	/** Writes the distribution to a file.
+	 */
+	void save(const std::string &fileName) const;
+
+private:
+	double lookup(size_t knot, double power) const;
+
+	long nSims;
+	// Knots in ascending order of power, and the number of simulations 
+	//	with a peak no higher than each knot
+	DoubleVec powers;
+	DoubleVec counts;
+};
+
+/** Significance thresholds for a family of similar cadences, 
+ *	interpolated from simulations on a lattice.
+ *
+ * Surveys often observe many stars with nearly the same cadence: the 
+ * same season structure, but a slightly different number of epochs or 
+ * baseline, and a frequency grid whose size follows the baseline. A 
+ * ThresholdSurface runs the false-peak simulations once for each point 
+ * of a lattice in the number of epochs, the baseline, and the number 
+ * of frequencies, and then interpolates the threshold or false alarm 
+ * probability for any star in between.
+ *
+ * The surface checks its own accuracy by simulating the center of every 
+ * lattice cell. Stars outside the lattice, or in a cell whose 
+ * interpolation error exceeds the tolerance, are simulated directly.
+ */
+class ThresholdSurface {
+public:
+	/** Simulates a family of cadences on a lattice.
+	 */
+	ThresholdSurface(const DoubleVec &familyTimes, double fMax, 
+			const DoubleVec &nEpochs, const DoubleVec &baselines, 
+			const DoubleVec &gridSizes, long nSims, 
+			const NullModel &model, unsigned long seed, 
+			double tolerance = 0.02);
+
+	/** Tests whether a star can be handled by interpolation.
+	 */
+	bool covers(const DoubleVec &times, const DoubleVec &freqs) const;
+
+	/** Returns the significance threshold for a star.
+	 */
+	double threshold(const DoubleVec &times, const DoubleVec &freqs, 
+			double fap, double &error) const;
+
+	/** Returns the false alarm probability of a peak found for a star.
+	 */
+	double fap(const DoubleVec &times, const DoubleVec &freqs, 
+			double power, double &error) const;
+
+private:
+	// Not copyable
+	ThresholdSurface(const ThresholdSurface &other);
+	ThresholdSurface& operator=(const ThresholdSurface &other);
+
+	bool locate(const DoubleVec &times, const DoubleVec &freqs, 
+			size_t corner[], double weight[]) const;
+	size_t cellIndex(const size_t corner[]) const;
+	double interpolate(const size_t corner[], const double weight[], 
+			double x, bool isFap) const;
+
+	DoubleVec familyTimes;
+	double fMax;
+	// Lattice values along each axis, in ascending order
+	DoubleVec axes[3];
+	// One distribution per lattice point, last axis varying fastest
+	std::vector<LsEdf> nodes;
+	// Interpolation errors found at the center of each cell
+	DoubleVec thresholdErrors, fapErrors;
+	const NullModel* model;
+	long nSims;
+	unsigned long seed;
+	double tolerance;
+};
+
+/** Measures the fraction of periodic signals that a periodogram search 
+ *	would recover, over a grid of periods and amplitudes.
+ */
+void injectionRecovery(const DoubleVec &times, const DoubleVec &freqs, 
+		const DoubleVec &periods, const DoubleVec &amplitudes, long nInject, 
+		const NullModel &model, double threshold, double tolerance, 
+		unsigned long seed, DoubleVec &completeness);
+
 /** @} */	// end Periodogram generation
 
 //----------------------------------------------------------
@@ -234,6 +1223,31 @@ void autoCorr(const DoubleVec &times, const DoubleVec &fluxes,
 void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
 		const DoubleVec &offsets, DoubleVec &acf, double maxFreq);
 
+/** Calculates the autocorrelation function for a subset of a time series. 
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &offsets, DoubleVec &acf);
+
+/** Calculates the autocorrelation function for a subset of a time series. 
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &offsets, DoubleVec &acf, 
+		double maxFreq);
+
+/** Calculates the autocorrelation function for a time series, using 
+ *	preallocated memory.
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &offsets, DoubleVec &acf, double maxFreq, 
+		Workspace &workspace);
+
+/** Calculates the autocorrelation function for a subset of a time series, 
+ *	using preallocated memory.
+ */
+void autoCorr(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, const DoubleVec &offsets, DoubleVec &acf, 
+		double maxFreq, Workspace &workspace);
+
 /** Calculates the autocorrelation window function for a time sampling. 
  */
 void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf);
@@ -243,6 +1257,12 @@ void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf);
 void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf, 
 		double maxFreq);
 
+/** Calculates the autocorrelation window function for a time sampling, 
+ *	sharing the result with other processes.
+ */
+void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf, 
+		double maxFreq, SharedCache &cache);
+
 /** @} */	// end Autocorrelation function generation
 
 //----------------------------------------------------------
@@ -261,6 +1281,11 @@ void acWindow(const DoubleVec &times, const DoubleVec &offsets, DoubleVec &wf,
 void dmdt(const DoubleVec &times, const DoubleVec &fluxes, 
 		DoubleVec &deltaT, DoubleVec &deltaM);
 
+/** Calculates a &Delta;m&Delta;t plot for a subset of a time series.
+ */
+void dmdt(const DoubleVec &times, const DoubleVec &fluxes, 
+		const BoolVec &mask, DoubleVec &deltaT, DoubleVec &deltaM);
+
 /** Computes the fraction of pairs of magnitudes above some threshold found 
  *	in each &Delta;t bin of a &Delta;m&Delta;t plot.
  */
@@ -293,14 +1318,264 @@ void deltaMBinQuantile(const DoubleVec &deltaT, const DoubleVec &deltaM,
 void peakFind(const DoubleVec& times, const DoubleVec& data, 
 		double minAmp, DoubleVec& peakTimes, DoubleVec& peakHeights);
 
+/** Calculates the number of monotonic intervals in a subset of a light 
+ * curve having a magnitude change greater than a threshold
+ */
+void peakFind(const DoubleVec& times, const DoubleVec& data, 
+		const BoolVec& mask, double minAmp, 
+		DoubleVec& peakTimes, DoubleVec& peakHeights);
+
 /** Calculates the waiting time for variability of a given amplitude as 
  *	a function of amplitude
  */
 void peakFindTimescales(const DoubleVec& times, const DoubleVec& data, 
 		const DoubleVec& magCuts, DoubleVec& timescales);
 
+/** Calculates the waiting time for variability of a given amplitude as 
+ *	a function of amplitude, for a subset of a light curve
+ */
+void peakFindTimescales(const DoubleVec& times, const DoubleVec& data, 
+		const BoolVec& mask, const DoubleVec& magCuts, DoubleVec& timescales);
+
 /** @} */	// end peak-finding generation
 
+//----------------------------------------------------------
+/** @defgroup detrend Light curve detrending
+ *
+ * Rolling-window statistics for irregularly sampled light curves.
+ *
+ * The statistic at each epoch is computed from all epochs no more than 
+ * half a window away, so that the window spans a fixed time interval 
+ * rather than a fixed number of points. The window is advanced with two 
+ * pointers, and the median and median absolute deviation are maintained 
+ * in an indexable skiplist, so that each epoch costs O(log w) rather 
+ * than O(w log w) time, where w is the number of epochs in a window.
+ *
+ *  @{
+ */
+
+class IndexableSkiplist;
+
+/** Reusable workspace for rolling-window statistics.
+ *
+ * A RollingStats object keeps its working storage between calls, and 
+ * writes its results into the caller's vectors without reallocating them 
+ * if they are already large enough. Once it has processed its largest 
+ * window, detrending further light curves allocates no memory.
+ *
+ * A RollingStats object may not be used by more than one thread at once; 
+ * give each thread its own.
+ */
+class RollingStats {
+public:
+	/** Defines the window over which statistics are computed.
+	 */
+	explicit RollingStats(double window);
+	RollingStats(const RollingStats &other);
+	RollingStats& operator=(const RollingStats &other);
+	~RollingStats();
+
+	/** Returns the width of the window.
+	 */
+	double getWindow() const;
+
+	/** Computes the median of a light curve in a sliding time window.
+	 */
+	void median(const DoubleVec &times, const DoubleVec &data, DoubleVec &medians);
+
+	/** Computes the median absolute deviation of a light curve in a 
+	 *	sliding time window.
+	 */
+	void mad(const DoubleVec &times, const DoubleVec &data, DoubleVec &mads);
+
+	/** Computes the mean of a light curve in a sliding time window.
+	 */
+	void mean(const DoubleVec &times, const DoubleVec &data, DoubleVec &means);
+
+	/** Subtracts the rolling median from a light curve.
+	 */
+	void detrend(const DoubleVec &times, const DoubleVec &data, DoubleVec &residuals);
+
+private:
+	/** The statistics that can be computed
+	 */
+	enum Statistic {MEDIAN, MAD, MEAN, RESIDUAL};
+
+	void run(const DoubleVec &times, const DoubleVec &data, Statistic stat, 
+			DoubleVec &out, const std::string &caller);
+
+	double window;
+	// Allocated on first use, so that construction never runs out of memory
+	IndexableSkiplist* sorted;
+};
+
+/** Computes the median of a light curve in a sliding time window.
+ */
+void rollingMedian(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &medians);
+
+/** Computes the median absolute deviation of a light curve in a sliding 
+ *	time window.
+ */
+void rollingMad(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &mads);
+
+/** Computes the mean of a light curve in a sliding time window.
+ */
+void rollingMean(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &means);
+
+/** Subtracts the rolling median from a light curve.
+ */
+void detrend(const DoubleVec &times, const DoubleVec &data, double window, 
+		DoubleVec &residuals);
+
+/** Subtracts the rolling median from each of a batch of light curves.
+ */
+void detrend(const std::vector<DoubleVec> &times, const std::vector<DoubleVec> &data, 
+		double window, std::vector<DoubleVec> &residuals);
+
+/** @} */	// end Light curve detrending
+
+//----------------------------------------------------------
+/** @defgroup binning Light curve binning
+ *
+ * Downsampling of densely sampled light curves
+ *
+ * Light curves from space photometry may have far more epochs than are 
+ * needed to study long timescales. Binning them to a resolution chosen 
+ * from the highest frequency of interest gives a much smaller light 
+ * curve whose periodogram has a known maximum error.
+ *
+ *  @{
+ */
+
+/** Chooses the widest bins that keep a periodogram within a given error.
+ */
+double maxBinWidth(double fMax, double tolerance);
+
+/** Bins a light curve to a coarser time resolution.
+ */
+void binLightCurve(const DoubleVec &times, const DoubleVec &data, double width, 
+		DoubleVec &binTimes, DoubleVec &binData, DoubleVec &binWeights);
+
+/** @} */	// end Light curve binning
+
+//----------------------------------------------------------
+/** @defgroup templates Template matching
+ *
+ * Classification of periodic variables by their folded light curves
+ *
+ * Each light curve is folded once at its period onto a fixed grid of 
+ * phase bins, then compared with a bank of class templates. The 
+ * templates are stored as one contiguous block of spectra, and each is 
+ * compared at every phase shift with an FFT cross-correlation, so that 
+ * classifying a star costs O(T P log P) for T templates of P bins.
+ *
+ *  @{
+ */
+
+/** Folds a light curve into a grid of phase bins.
+ */
+void foldLightCurve(const DoubleVec &times, const DoubleVec &data, double freq, 
+		size_t nPhases, DoubleVec &folded);
+
+class TemplateBank;
+
+/** Finds the best-matching template for each of a batch of light curves.
+ */
+void matchTemplates(const std::vector<DoubleVec> &times, const std::vector<DoubleVec> &data, 
+		const DoubleVec &freqs, const TemplateBank &bank, 
+		std::vector<size_t> &best, DoubleVec &scores, DoubleVec &phases);
+
+/** A collection of light curve shapes to compare folded light curves 
+ *	against.
+ *
+ * A TemplateBank may be shared by any number of threads, as long as 
+ * none of them calls addTemplate().
+ */
+class TemplateBank {
+public:
+	/** Creates an empty template bank.
+	 */
+	explicit TemplateBank(size_t nPhases);
+
+	/** Returns the number of phase bins in each template.
+	 */
+	size_t getNumPhases() const;
+
+	/** Returns the number of templates in the bank.
+	 */
+	size_t size() const;
+
+	/** Adds a light curve shape to the bank.
+	 */
+	void addTemplate(const DoubleVec &shape);
+
+	/** Scores a folded light curve against every template in the bank.
+	 */
+	void match(const DoubleVec &folded, DoubleVec &scores, DoubleVec &phases) const;
+
+	friend void matchTemplates(const std::vector<DoubleVec> &times, 
+			const std::vector<DoubleVec> &data, 
+			const DoubleVec &freqs, const TemplateBank &bank, 
+			std::vector<size_t> &best, DoubleVec &scores, DoubleVec &phases);
+
+private:
+	struct Workspace;
+
+	void score(Workspace &work, DoubleVec &scores, DoubleVec &phases) const;
+
+	size_t nPhases;
+	// Spectra of the normalized templates, one after another
+	DoubleVec specRe;
+	DoubleVec specIm;
+};
+
+/** @} */	// end Template matching
+
+//----------------------------------------------------------
+/** @defgroup drw Stochastic timescales
+ *
+ * Fitting of stochastic variability models
+ *
+ * The damped random walk is a Markov process, so its likelihood on an 
+ * irregular cadence can be found with a Kalman filter in O(N) time, 
+ * rather than the O(N<sup>3</sup>) of a general Gaussian process. The 
+ * filters for many parameter values are run together, so that a grid 
+ * of likelihoods, or a batch of fits, costs little more than a single 
+ * pass over each light curve.
+ *
+ *  @{
+ */
+
+/** Calculates the log-likelihood of a light curve under a damped random 
+ *	walk model.
+ */
+double drwLogLikelihood(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, double tau, double sigma);
+
+/** Calculates the log-likelihood of a light curve under a damped random 
+ *	walk model, for every combination of a set of timescales and 
+ *	amplitudes.
+ */
+void drwLogLikelihood(const DoubleVec &times, const DoubleVec &fluxes, 
+		const DoubleVec &errors, const DoubleVec &taus, const DoubleVec &sigmas, 
+		DoubleVec &logLike);
+
+/** Finds the damped random walk that best describes a light curve.
+ */
+void fitDrw(const DoubleVec &times, const DoubleVec &fluxes, const DoubleVec &errors, 
+		double &tau, double &sigma);
+
+/** Finds the damped random walk that best describes each of a batch of 
+ *	light curves.
+ */
+void fitDrw(const std::vector<DoubleVec> &times, const std::vector<DoubleVec> &fluxes, 
+		const std::vector<DoubleVec> &errors, DoubleVec &taus, DoubleVec &sigmas);
+
+/** @} */	// end Stochastic timescales
+
 //----------------------------------------------------------
 /** @defgroup grid Frequency/offset grid generation
  *
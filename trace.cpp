@@ -0,0 +1,482 @@
+/** Recording of execution spans for timeline viewers
+ * @file timescales/trace.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <dirent.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "timescales.h"
+#include "trace.h"
+
+namespace kpftimes {
+
+using std::string;
+
+/** A finished span.
+ */
+struct TraceEvent {
+	/** The label of the span
+	 */
+	const char *name;
+	/** The ID of the object being processed, or NO_TRACE_ID
+	 */
+	unsigned long id;
+	/** The start and end of the span, in microseconds
+	 */
+	double start, end;
+};
+
+/** The spans recorded by one thread.
+ *
+ * Each buffer is written only by the thread that owns it, so recording 
+ * a span takes no locks. When a buffer is full the oldest spans are 
+ * overwritten.
+ */
+struct TraceBuffer {
+	/** Creates an empty buffer.
+	 *
+	 * @param[in] capacity	The number of spans to keep
+	 * @param[in] thread	The number shown for this thread in the trace
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory for 
+	 *	the buffer.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	TraceBuffer(size_t capacity, unsigned long thread) : events(capacity), count(0), 
+			thread(thread), next(NULL) {
+	}
+	
+	/** Storage for the spans, used as a ring
+	 */
+	std::vector<TraceEvent> events;
+	/** The number of spans recorded, including those overwritten
+	 */
+	size_t count;
+	/** The number shown for this thread in the trace
+	 */
+	unsigned long thread;
+	/** The buffer of the next thread
+	 */
+	TraceBuffer *next;
+
+private:
+	// Not copyable
+	TraceBuffer(const TraceBuffer &other);
+	TraceBuffer& operator=(const TraceBuffer &other);
+};
+
+volatile int traceActive = 0;
+
+/** All buffers of the current trace, as a list that threads add to 
+ *	without locking
+ */
+TraceBuffer * volatile traceBuffers = NULL;
+/** Counts calls to startTrace(), so that threads notice when their 
+ *	buffer belongs to an earlier trace
+ */
+volatile unsigned long traceEpoch = 0;
+/** The number of threads that have recorded spans in the current trace
+ */
+volatile unsigned long traceThreads = 0;
+/** The number of spans kept per thread
+ */
+size_t traceCapacity = 0;
+/** The file passed to startTrace()
+ */
+string tracePath;
+
+/** The calling thread's buffer, if it has one
+ */
+__thread TraceBuffer *threadBuffer = NULL;
+/** The trace that threadBuffer belongs to
+ */
+__thread unsigned long threadEpoch = 0;
+
+/** Returns the time stamp used for spans.
+ *
+ * @return The time on a monotonic clock, in microseconds.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+double traceClock() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return 1e6*static_cast<double>(now.tv_sec) + 1e-3*static_cast<double>(now.tv_nsec);
+}
+
+/** Returns the calling thread's buffer, creating it if needed.
+ *
+ * @return The buffer, or NULL if there was not enough memory to create it.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+TraceBuffer* getThreadBuffer() {
+	const unsigned long epoch = traceEpoch;
+	if (threadBuffer == NULL || threadEpoch != epoch) {
+		TraceBuffer *buffer = NULL;
+		try {
+			buffer = new TraceBuffer(traceCapacity, 
+				__sync_add_and_fetch(&traceThreads, 1));
+		} catch (const std::bad_alloc &) {
+			return NULL;
+		}
+		do {
+			buffer->next = traceBuffers;
+		} while (!__sync_bool_compare_and_swap(&traceBuffers, buffer->next, buffer));
+		
+		threadBuffer = buffer;
+		threadEpoch  = epoch;
+	}
+	return threadBuffer;
+}
+
+/** Records a finished span in the calling thread's buffer.
+ *
+ * @param[in] name	The label of the span
+ * @param[in] id	The ID of the object processed, or NO_TRACE_ID
+ * @param[in] start, end	The times, from traceClock(), at which the 
+ *			span started and ended
+ *
+ * @post If tracing is on, the span is in the calling thread's buffer. 
+ *	Spans that do not fit in memory are dropped.
+ *
+ * @perform Constant time, except for the first span of each thread
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void recordSpan(const char *name, unsigned long id, double start, double end) {
+	if (!traceActive) {
+		return;
+	}
+	TraceBuffer *buffer = getThreadBuffer();
+	if (buffer == NULL) {
+		return;
+	}
+	
+	TraceEvent &event = buffer->events[buffer->count % buffer->events.size()];
+	event.name  = name;
+	event.id    = id;
+	event.start = start;
+	event.end   = end;
+	buffer->count++;
+}
+
+/** Discards the spans copied from the parent into a forked process.
+ *
+ * Must be called by the child right after fork(), before any other 
+ * thread is started.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void resetTraceAfterFork() {
+	for(TraceBuffer *buffer = traceBuffers; buffer != NULL; buffer = buffer->next) {
+		buffer->count = 0;
+	}
+}
+
+/** Frees all buffers.
+ *
+ * @pre No thread is recording spans
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void freeBuffers() {
+	TraceBuffer *buffer = traceBuffers;
+	traceBuffers = NULL;
+	while (buffer != NULL) {
+		TraceBuffer *next = buffer->next;
+		delete buffer;
+		buffer = next;
+	}
+}
+
+/** Writes the spans of this process as lines of a Chrome trace.
+ *
+ * Each event is followed by a comma and a newline.
+ *
+ * @param[in,out] out	The stream to write to
+ * @param[in] process	The name of this process in the trace
+ *
+ * @return The number of spans overwritten because a buffer was full.
+ *
+ * @exceptsafe Does not throw exceptions beyond those of @p out.
+ */
+unsigned long writeEvents(std::ostream &out, const string &process) {
+	const long pid = static_cast<long>(getpid());
+	unsigned long dropped = 0;
+	out.precision(15);
+	
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid 
+		<< ",\"args\":{\"name\":\"" << process << "\"}},\n";
+	for(TraceBuffer *buffer = traceBuffers; buffer != NULL; buffer = buffer->next) {
+		if (buffer->count == 0) {
+			continue;
+		}
+		const size_t capacity = buffer->events.size();
+		const size_t first = (buffer->count > capacity ? buffer->count - capacity : 0);
+		dropped += first;
+		
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid 
+			<< ",\"tid\":" << buffer->thread 
+			<< ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}},\n";
+		for(size_t i = first; i < buffer->count; i++) {
+			const TraceEvent &event = buffer->events[i % capacity];
+			out << "{\"name\":\"" << event.name << "\",\"cat\":\"timescales\",\"ph\":\"X\"" 
+				<< ",\"pid\":" << pid << ",\"tid\":" << buffer->thread 
+				<< ",\"ts\":" << event.start << ",\"dur\":" << (event.end - event.start);
+			if (event.id != NO_TRACE_ID) {
+				out << ",\"args\":{\"id\":" << event.id << "}";
+			}
+			out << "},\n";
+		}
+	}
+	if (dropped > 0) {
+		out << "{\"name\":\"process_labels\",\"ph\":\"M\",\"pid\":" << pid 
+			<< ",\"args\":{\"labels\":\"dropped " << dropped << " spans\"}},\n";
+	}
+	return dropped;
+}
+
+/** Returns the directory and name prefix of the files saved by workers.
+ *
+ * @param[out] dir	The directory holding the files
+ * @param[out] prefix	The start of the name of each file
+ *
+ * @exceptsafe Does not throw exceptions beyond std::bad_alloc.
+ */
+void workerFiles(string &dir, string &prefix) {
+	const string part = tracePath + ".part.";
+	const size_t slash = part.rfind('/');
+	if (slash == string::npos) {
+		dir    = ".";
+		prefix = part;
+	} else {
+		dir    = part.substr(0, slash+1);
+		prefix = part.substr(slash+1);
+	}
+}
+
+/** Lists the files saved by workers.
+ *
+ * @return The full name of each file.
+ *
+ * @exceptsafe Does not throw exceptions beyond std::bad_alloc.
+ */
+std::vector<string> listWorkerFiles() {
+	string dir, prefix;
+	workerFiles(dir, prefix);
+	
+	std::vector<string> files;
+	DIR *listing = opendir(dir.c_str());
+	if (listing != NULL) {
+		try {
+			for(dirent *entry = readdir(listing); entry != NULL; entry = readdir(listing)) {
+				const string name(entry->d_name);
+				if (name.compare(0, prefix.size(), prefix) == 0) {
+					files.push_back(dir == "." ? name : dir + name);
+				}
+			}
+		} catch (...) {
+			closedir(listing);
+			throw;
+		}
+		closedir(listing);
+	}
+	return files;
+}
+
+/** Saves the spans of a forked worker for stopTrace() to collect.
+ *
+ * The spans are written to a file next to the trace, named after the 
+ * worker's process ID. Spans of a worker that crashes are lost.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void flushWorkerTrace() {
+	if (!traceActive) {
+		return;
+	}
+	try {
+		std::ostringstream name;
+		name << tracePath << ".part." << static_cast<long>(getpid());
+		std::ofstream out(name.str().c_str());
+		std::ostringstream label;
+		label << "worker " << static_cast<long>(getpid());
+		writeEvents(out, label.str());
+	} catch (...) {
+		// A missing worker shows up as a gap in the trace
+	}
+}
+
+/** Starts recording spans.
+ *
+ * Once tracing is on, each thread records the tasks and stages it runs 
+ * in a buffer of its own, without locks. Spans recorded by batch 
+ * workers are collected as well. Nothing is written until stopTrace() 
+ * is called.
+ *
+ * If a trace is already running, its spans are discarded.
+ *
+ * @param[in] traceFile	The file to which stopTrace() will write the trace
+ * @param[in] eventsPerThread	The number of spans to keep for each thread. 
+ *			If a thread records more, the oldest are discarded.
+ *
+ * @pre No library function is running
+ * @pre @p eventsPerThread &gt; 0
+ *
+ * @perform O(F) time, where F is the number of files in the directory 
+ *	of @p traceFile
+ * @perfmore O(@p eventsPerThread) memory for each thread that records a 
+ *	span
+ *
+ * @exception std::invalid_argument Thrown if @p eventsPerThread = 0.
+ * @exception std::runtime_error Thrown if @p traceFile cannot be written.
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	start the trace.
+ *
+ * @exceptsafe Tracing is off in the event of an exception.
+ */
+void startTrace(const string &traceFile, size_t eventsPerThread) {
+	traceActive = 0;
+	freeBuffers();
+	
+	if (eventsPerThread == 0) {
+		throw std::invalid_argument("Trace must keep at least one event per thread");
+	}
+	{
+		const string temp = traceFile + ".tmp";
+		std::ofstream test(temp.c_str(), std::ios::app);
+		if (!test) {
+			throw std::runtime_error("Cannot write trace file " + traceFile);
+		}
+		test.close();
+		remove(temp.c_str());
+	}
+	
+	tracePath = traceFile;
+	// Clear out workers of an earlier trace that was never stopped
+	std::vector<string> stale = listWorkerFiles();
+	for(size_t i = 0; i < stale.size(); i++) {
+		remove(stale[i].c_str());
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	traceCapacity = eventsPerThread;
+	traceThreads  = 0;
+	traceEpoch++;
+	__sync_synchronize();
+	traceActive = 1;
+}
+
+/** Stops recording spans and writes the trace.
+ *
+ * The trace is written in the Chrome trace-event format, which can be 
+ * opened by chrome://tracing or Perfetto. Each span becomes a complete 
+ * ("X") event, with the process and thread that ran it, its start time 
+ * and duration in microseconds, and the ID of the object it processed, 
+ * if any. Threads are numbered in the order they recorded their first 
+ * span.
+ *
+ * @pre No library function is running
+ *
+ * @post Tracing is off, and the memory used by the trace has been freed.
+ *
+ * @perform O(S) time, where S is the number of spans kept
+ *
+ * @exception std::logic_error Thrown if startTrace() has not been called.
+ * @exception std::runtime_error Thrown if the trace could not be written.
+ *
+ * @exceptsafe Tracing is off in the event of an exception. The trace 
+ *	file is either completely written or unchanged.
+ */
+void stopTrace() {
+	if (!traceActive) {
+		throw std::logic_error("stopTrace() called without startTrace()");
+	}
+	traceActive = 0;
+	__sync_synchronize();
+	
+	const string temp = tracePath + ".tmp";
+	std::vector<string> parts;
+	bool ok = false;
+	try {
+		std::ofstream out(temp.c_str());
+		out.precision(15);
+		out << "{\"traceEvents\":[\n";
+		std::ostringstream label;
+		label << "process " << static_cast<long>(getpid());
+		unsigned long dropped = writeEvents(out, label.str());
+		
+		parts = listWorkerFiles();
+		for(size_t i = 0; i < parts.size(); i++) {
+			std::ifstream part(parts[i].c_str());
+			string line;
+			while (std::getline(part, line)) {
+				const string labels = "\"labels\":\"dropped ";
+				const size_t pos = line.find(labels);
+				if (pos != string::npos) {
+					dropped += strtoul(line.c_str() + pos + labels.size(), NULL, 10);
+				}
+				out << line << '\n';
+			}
+		}
+		
+		// Every line so far ends in a comma, so close the list with one more event
+		out << "{\"name\":\"trace_end\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" 
+			<< static_cast<long>(getpid()) << ",\"tid\":0,\"ts\":" << traceClock() 
+			<< "}\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" 
+			<< dropped << "}}\n";
+		out.close();
+		ok = !out.fail();
+	} catch (...) {
+		ok = false;
+	}
+	
+	for(size_t i = 0; i < parts.size(); i++) {
+		remove(parts[i].c_str());
+	}
+	freeBuffers();
+	
+	if (!ok || rename(temp.c_str(), tracePath.c_str()) != 0) {
+		remove(temp.c_str());
+		throw std::runtime_error("Could not write trace file " + tracePath);
+	}
+}
+
+}		// end kpftimes
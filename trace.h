@@ -0,0 +1,115 @@
+/** Recording of execution spans for timeline viewers. None of these 
+ *	routines are intended as part of the public API.
+ * @file timescales/trace.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACEH
+#define TRACEH
+
+namespace kpftimes {
+
+/** The ID recorded for spans that do not belong to a particular object.
+ *
+ * @ingroup util
+ */
+const unsigned long NO_TRACE_ID = static_cast<unsigned long>(-1);
+
+/** Flag read by TraceSpan before doing any work. Nonzero between 
+ *	startTrace() and stopTrace().
+ *
+ * @ingroup util
+ */
+extern volatile int traceActive;
+
+/** Returns the time stamp used for spans.
+ *
+ * @ingroup util
+ */
+double traceClock();
+
+/** Records a finished span in the calling thread's buffer.
+ *
+ * @ingroup util
+ */
+void recordSpan(const char *name, unsigned long id, double start, double end);
+
+/** Discards the spans copied from the parent into a forked process.
+ *
+ * @ingroup util
+ */
+void resetTraceAfterFork();
+
+/** Saves the spans of a forked worker for stopTrace() to collect.
+ *
+ * @ingroup util
+ */
+void flushWorkerTrace();
+
+/** Records the time between its construction and destruction as a span.
+ *
+ * Declaring a TraceSpan at the top of a block traces the block. When 
+ * tracing is off, a TraceSpan costs one test of a global flag.
+ *
+ * @ingroup util
+ */
+class TraceSpan {
+public:
+	/** Starts a span.
+	 *
+	 * @param[in] name	The label of the span. Must be a string literal, 
+	 *			or otherwise outlive the trace.
+	 * @param[in] id	The ID of the object being processed, or 
+	 *			NO_TRACE_ID
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	explicit TraceSpan(const char *name, unsigned long id = NO_TRACE_ID) 
+			: name(name), id(id), start(traceActive ? traceClock() : -1.0) {
+	}
+	/** Ends the span and records it.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	~TraceSpan() {
+		if (start >= 0.0) {
+			recordSpan(name, id, start, traceClock());
+		}
+	}
+private:
+	// Not copyable
+	TraceSpan(const TraceSpan &other);
+	TraceSpan& operator=(const TraceSpan &other);
+
+	const char * const name;
+	const unsigned long id;
+	const double start;
+};
+
+}		// end kpftimes
+
+#endif		// end ifndef TRACEH
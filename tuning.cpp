@@ -0,0 +1,674 @@
+/** Selection of machine-dependent algorithm parameters
+ * @file timescales/tuning.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "kernels.h"
+#include "lssim.h"
+#include "nufft.h"
+#include "timescales.h"
+#include "tuning.h"
+
+namespace kpftimes {
+
+using std::string;
+using boost::lexical_cast;
+
+/** The first line of every wisdom file
+ */
+const char WISDOM_HEADER[] = "# Timescales wisdom 1";
+
+/** The environment variable naming a wisdom file to load at startup
+ */
+const char WISDOM_VARIABLE[] = "TIMESCALES_WISDOM";
+
+/** Returns the parameters that apply when no wisdom has been loaded.
+ *
+ * The defaults reproduce the behavior of the library before tuning was 
+ * introduced, and are reasonable on most x86-64 machines.
+ *
+ * @return The built-in parameters.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Tuning defaultTuning() {
+	Tuning tuning;
+	tuning.smallNLimit   = MAX_SMALL_N;
+	tuning.freqBlock     = 256;
+	tuning.nufftMinModes = 0;
+	tuning.type3MinTargets = 512;
+	tuning.simThreads    = 0;
+	return tuning;
+}
+
+/** Reads parameters from a wisdom file.
+ *
+ * @param[in] wisdomFile	The file to read
+ * @param[in,out] tuning	The parameters to update. Parameters not 
+ *				mentioned in the file are unchanged.
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, is 
+ *	not a wisdom file, or contains invalid values.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readWisdom(const string &wisdomFile, Tuning &tuning) {
+	std::ifstream in(wisdomFile.c_str());
+	if (!in) {
+		throw std::runtime_error("Could not open wisdom file " + wisdomFile);
+	}
+	
+	string line;
+	std::getline(in, line);
+	if (!in || line != WISDOM_HEADER) {
+		throw std::runtime_error(wisdomFile + " is not a Timescales wisdom file");
+	}
+	
+	Tuning temp = tuning;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream parser(line);
+		string key;
+		long value = -1;
+		parser >> key >> value;
+		if (!parser || value < 0) {
+			throw std::runtime_error("Invalid line in wisdom file " + wisdomFile 
+				+ ": " + line);
+		}
+		
+		if (key == "small_n_limit" && static_cast<size_t>(value) <= MAX_SMALL_N) {
+			temp.smallNLimit = value;
+		} else if (key == "freq_block" && value >= 1) {
+			temp.freqBlock = value;
+		} else if (key == "nufft_min_modes") {
+			temp.nufftMinModes = value;
+		} else if (key == "type3_min_targets") {
+			temp.type3MinTargets = value;
+		} else if (key == "sim_threads" && value <= 4096) {
+			temp.simThreads = static_cast<int>(value);
+		} else {
+			throw std::runtime_error("Invalid line in wisdom file " + wisdomFile 
+				+ ": " + line);
+		}
+	}
+	
+	tuning = temp;
+}
+
+/** Returns the parameters to use when the library is loaded.
+ *
+ * @return The contents of the wisdom file named by the TIMESCALES_WISDOM 
+ *	environment variable, if it exists and is valid, otherwise the 
+ *	defaults.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Tuning startupTuning() {
+	Tuning tuning = defaultTuning();
+	const char* wisdomFile = getenv(WISDOM_VARIABLE);
+	if (wisdomFile != NULL && wisdomFile[0] != '\0') {
+		try {
+			readWisdom(wisdomFile, tuning);
+		} catch (const std::exception &e) {
+			// Nobody to report to this early; fall back to the defaults
+			tuning = defaultTuning();
+		}
+	}
+	return tuning;
+}
+
+/** Returns the storage for the parameters currently in effect.
+ *
+ * The parameters are loaded on first use rather than during static 
+ * initialization, so that library functions called from other static 
+ * initializers never see a zeroed Tuning.
+ *
+ * @return A reference to the parameters, loaded by startupTuning() if 
+ *	this is the first call.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Tuning& activeTuning() {
+	static Tuning tuning = startupTuning();
+	return tuning;
+}
+
+/** Returns the parameters currently in effect.
+ *
+ * @return The parameters loaded at startup, or by the most recent call 
+ *	to importWisdom(), forgetWisdom(), or autotune().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+const Tuning& currentTuning() {
+	return activeTuning();
+}
+
+/** Replaces the parameters currently in effect.
+ *
+ * @param[in] tuning	The new parameters
+ *
+ * @pre No other thread is calling library functions
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void setTuning(const Tuning &tuning) {
+	activeTuning() = tuning;
+}
+
+/** Returns the number of threads to use for simulations.
+ *
+ * @return The number of threads set by the current tuning parameters, 
+ *	the OpenMP default if the parameters leave the choice to OpenMP, 
+ *	or 1 if the library was compiled without OpenMP.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+int simulationThreads() {
+	#ifdef _OPENMP
+	const int threads = currentTuning().simThreads;
+	return std::max(1, threads > 0 ? threads : omp_get_max_threads());
+	#else
+	return 1;
+	#endif
+}
+
+/** Loads tuning parameters from a wisdom file.
+ *
+ * Parameters not mentioned in the file keep their current values. The 
+ * library also loads the file named by the @c TIMESCALES_WISDOM 
+ * environment variable, if any, when a program starts; a missing or 
+ * invalid file is then silently ignored.
+ *
+ * @param[in] wisdomFile	A file written by autotune() or exportWisdom()
+ *
+ * @pre No other thread is calling library functions
+ *
+ * @post Library functions use the algorithms and block sizes listed in 
+ *	@p wisdomFile.
+ *
+ * @exception std::runtime_error Thrown if the file could not be read, is 
+ *	not a wisdom file, or contains invalid values.
+ *
+ * @exceptsafe The parameters in effect are unchanged in the event of an 
+ *	exception.
+ */
+void importWisdom(const string &wisdomFile) {
+	Tuning tuning = currentTuning();
+	readWisdom(wisdomFile, tuning);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	setTuning(tuning);
+}
+
+/** Saves the tuning parameters currently in effect to a wisdom file.
+ *
+ * @param[in] wisdomFile	The file to write. It is first written under 
+ *				a temporary name, then renamed, so an existing 
+ *				file is replaced atomically.
+ *
+ * @post importWisdom(@p wisdomFile) restores the current parameters.
+ *
+ * @exception std::runtime_error Thrown if the file could not be written.
+ *
+ * @exceptsafe If an exception is thrown, any existing file named 
+ *	@p wisdomFile is unchanged.
+ */
+void exportWisdom(const string &wisdomFile) {
+	const Tuning &tuning = currentTuning();
+	char host[256] = "unknown";
+	gethostname(host, sizeof(host) - 1);
+	host[sizeof(host) - 1] = '\0';
+	
+	const string tempName = wisdomFile + ".tmp";
+	{
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::trunc);
+		out << WISDOM_HEADER << "\n";
+		out << "# Measured on " << host << "\n";
+		out << "small_n_limit "   << tuning.smallNLimit   << "\n";
+		out << "freq_block "      << tuning.freqBlock     << "\n";
+		out << "nufft_min_modes " << tuning.nufftMinModes << "\n";
+		out << "type3_min_targets " << tuning.type3MinTargets << "\n";
+		out << "sim_threads "     << tuning.simThreads    << "\n";
+		out.close();
+		if (!out) {
+			std::remove(tempName.c_str());
+			throw std::runtime_error("Could not write wisdom file " + tempName);
+		}
+	}
+	if (std::rename(tempName.c_str(), wisdomFile.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw std::runtime_error("Could not replace wisdom file " + wisdomFile);
+	}
+}
+
+/** Returns to the built-in tuning parameters.
+ *
+ * @pre No other thread is calling library functions
+ *
+ * @post Library functions behave as if no wisdom had ever been loaded.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void forgetWisdom() {
+	setTuning(defaultTuning());
+}
+
+/** A calculation whose speed is measured by autotune().
+ */
+class Benchmark {
+public:
+	virtual ~Benchmark() {
+	}
+
+	/** Runs the calculation once.
+	 */
+	virtual void run() = 0;
+};
+
+/** Measures the time taken by one run of a calculation.
+ *
+ * Each measurement repeats the calculation enough times to span about 
+ * 10 ms, and the best of three measurements is kept, so that timer 
+ * resolution and interruptions by other processes matter little.
+ *
+ * @param[in,out] benchmark	The calculation to time
+ *
+ * @return The time per run, in seconds.
+ *
+ * @exception std::exception Thrown if the calculation throws.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+double timeBenchmark(Benchmark &benchmark) {
+	// Warm up caches and workspaces
+	benchmark.run();
+	
+	double best = 0.0;
+	for(int trial = 0; trial < 3; trial++) {
+		long reps = 0;
+		const double start = wallClock();
+		double elapsed = 0.0;
+		do {
+			benchmark.run();
+			reps++;
+			elapsed = wallClock() - start;
+		} while (elapsed < 0.01);
+		
+		const double perRun = elapsed / reps;
+		if (trial == 0 || perRun < best) {
+			best = perRun;
+		}
+	}
+	return best;
+}
+
+/** Times lombScargle() on a fixed light curve.
+ */
+class PeriodogramBenchmark : public Benchmark {
+public:
+	/** Sets up a random light curve and a frequency grid.
+	 */
+	PeriodogramBenchmark(size_t nTimes, size_t nFreqs) : times(nTimes), 
+			fluxes(nTimes), freqs(nFreqs), power(), workspace() {
+		for(size_t i = 0; i < nTimes; i++) {
+			// Deterministic, irregular sampling
+			times [i] = 100.0 * (i + 0.5 + 0.4*sin(3.7*i)) / nTimes;
+			fluxes[i] = sin(times[i]) + 0.3*cos(17.0*i);
+		}
+		for(size_t i = 0; i < nFreqs; i++) {
+			freqs[i] = 0.001 * (i + 1);
+		}
+	}
+	
+	virtual void run() {
+		lombScargle(times, fluxes, freqs, power, workspace);
+	}
+
+private:
+	DoubleVec times, fluxes, freqs, power;
+	Workspace workspace;
+};
+
+/** Times the two ways of evaluating a Fourier series.
+ */
+class SeriesBenchmark : public Benchmark {
+public:
+	/** Sets up a random series and evaluation points.
+	 */
+	SeriesBenchmark(size_t nModes, bool useNufft) : coeffs(2*nModes + 2), 
+			x(nModes), values(), useNufft(useNufft) {
+		for(size_t m = nModes + 2; m < coeffs.size(); m++) {
+			coeffs[m] = std::complex<double>(sin(1.0 + m), cos(2.0 + m));
+		}
+		for(size_t j = 0; j < x.size(); j++) {
+			x[j] = 6.0 * (j + 0.5 + 0.4*sin(3.7*j)) / x.size();
+		}
+	}
+	
+	virtual void run() {
+		if (useNufft) {
+			nufftType2(coeffs, x, values, 1e-9);
+		} else {
+			directType2(coeffs, x, values);
+		}
+	}
+
+private:
+	ComplexVec coeffs;
+	DoubleVec x;
+	ComplexVec values;
+	const bool useNufft;
+};
+
+/** Times the two ways of evaluating a sum at arbitrary frequencies.
+ */
+class Type3Benchmark : public Benchmark {
+public:
+	/** Sets up a light curve and a log-spaced set of frequencies.
+	 */
+	Type3Benchmark(size_t nTargets, bool useNufft) : x(200), strengths(200), 
+			s(nTargets), values(), useNufft(useNufft) {
+		for(size_t j = 0; j < x.size(); j++) {
+			x[j] = 100.0 * (j + 0.5 + 0.4*sin(3.7*j)) / x.size();
+			strengths[j] = std::complex<double>(sin(x[j]) + 0.3*cos(17.0*j), 0.0);
+		}
+		for(size_t k = 0; k < s.size(); k++) {
+			s[k] = 0.01 * pow(300.0, static_cast<double>(k) / s.size());
+		}
+	}
+	
+	virtual void run() {
+		if (useNufft) {
+			nufftType3(x, strengths, s, values, 1e-12);
+		} else {
+			directType3(x, strengths, s, values);
+		}
+	}
+
+private:
+	DoubleVec x;
+	ComplexVec strengths;
+	DoubleVec s;
+	ComplexVec values;
+	const bool useNufft;
+};
+
+/** Times a seeded significance calculation.
+ */
+class SimulationBenchmark : public Benchmark {
+public:
+	/** Sets up a cadence and frequency grid.
+	 */
+	SimulationBenchmark() : times(100), freqs(400) {
+		for(size_t i = 0; i < times.size(); i++) {
+			times[i] = 100.0 * (i + 0.5 + 0.4*sin(3.7*i)) / times.size();
+		}
+		for(size_t i = 0; i < freqs.size(); i++) {
+			freqs[i] = 0.001 * (i + 1);
+		}
+	}
+	
+	virtual void run() {
+		lsThreshold(times, freqs, 0.05, 512, WhiteNoise(), 42);
+	}
+
+private:
+	DoubleVec times, freqs;
+};
+
+/** Chooses the largest light curve for the short light curve kernels.
+ *
+ * @param[in,out] tuning	The parameters to use and update
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to run 
+ *	the benchmarks.
+ *
+ * @exceptsafe If an exception is thrown, the parameters in effect are 
+ *	unspecified.
+ */
+void tuneSmallN(Tuning &tuning) {
+	const size_t sizes[] = {8, 16, 24, 32, 48, 64};
+	const size_t nSizes = sizeof(sizes) / sizeof(sizes[0]);
+	
+	tuning.smallNLimit = 0;
+	for(size_t i = 0; i < nSizes && sizes[i] <= MAX_SMALL_N; i++) {
+		PeriodogramBenchmark benchmark(sizes[i], 2000);
+		Tuning trial = tuning;
+		
+		trial.smallNLimit = MAX_SMALL_N;
+		setTuning(trial);
+		const double small = timeBenchmark(benchmark);
+		trial.smallNLimit = 0;
+		setTuning(trial);
+		const double general = timeBenchmark(benchmark);
+		
+		if (small >= general) {
+			break;
+		}
+		tuning.smallNLimit = sizes[i];
+	}
+	setTuning(tuning);
+}
+
+/** Chooses the frequency block size for the short light curve kernels.
+ *
+ * @param[in,out] tuning	The parameters to use and update
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to run 
+ *	the benchmarks.
+ *
+ * @exceptsafe If an exception is thrown, the parameters in effect are 
+ *	unspecified.
+ */
+void tuneFreqBlock(Tuning &tuning) {
+	PeriodogramBenchmark benchmark(std::min<size_t>(32, MAX_SMALL_N), 8192);
+	Tuning trial = tuning;
+	trial.smallNLimit = MAX_SMALL_N;
+	
+	double best = 0.0;
+	for(size_t block = 32; block <= 4096; block *= 2) {
+		trial.freqBlock = block;
+		setTuning(trial);
+		const double time = timeBenchmark(benchmark);
+		if (block == 32 || time < best) {
+			best = time;
+			tuning.freqBlock = block;
+		}
+	}
+	setTuning(tuning);
+}
+
+/** Chooses the crossover between direct summation and the nonuniform FFT.
+ *
+ * @param[in,out] tuning	The parameters to update
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to run 
+ *	the benchmarks.
+ *
+ * @exceptsafe If an exception is thrown, @p tuning is unspecified.
+ */
+void tuneNufft(Tuning &tuning) {
+	const size_t maxModes = 1024;
+	// Direct summation unless the NUFFT wins at every larger size
+	tuning.nufftMinModes = 2*maxModes;
+	for(size_t nModes = maxModes; nModes >= 8; nModes /= 2) {
+		SeriesBenchmark nufft(nModes, true), direct(nModes, false);
+		if (timeBenchmark(nufft) >= timeBenchmark(direct)) {
+			break;
+		}
+		tuning.nufftMinModes = nModes;
+	}
+	if (tuning.nufftMinModes == 8) {
+		tuning.nufftMinModes = 0;
+	}
+}
+
+/** Chooses the crossover between direct summation and the type 3 
+ *	nonuniform FFT.
+ *
+ * @param[in,out] tuning	The parameters to update
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to run 
+ *	the benchmarks.
+ *
+ * @exceptsafe If an exception is thrown, @p tuning is unspecified.
+ */
+void tuneType3(Tuning &tuning) {
+	const size_t maxTargets = 8192;
+	// Direct summation unless the NUFFT wins at every larger size
+	tuning.type3MinTargets = 2*maxTargets;
+	for(size_t nTargets = maxTargets; nTargets >= 64; nTargets /= 2) {
+		Type3Benchmark nufft(nTargets, true), direct(nTargets, false);
+		if (timeBenchmark(nufft) >= timeBenchmark(direct)) {
+			break;
+		}
+		tuning.type3MinTargets = nTargets;
+	}
+}
+
+/** Chooses the number of threads for simulations.
+ *
+ * @param[in,out] tuning	The parameters to use and update
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to run 
+ *	the benchmarks.
+ * @exception std::runtime_error Thrown if the simulations fail.
+ *
+ * @exceptsafe If an exception is thrown, the parameters in effect are 
+ *	unspecified.
+ */
+void tuneThreads(Tuning &tuning) {
+	tuning.simThreads = 0;
+	#ifdef _OPENMP
+	const int maxThreads = omp_get_max_threads();
+	SimulationBenchmark benchmark;
+	Tuning trial = tuning;
+	
+	double best = 0.0;
+	for(int threads = 1; ; threads = std::min(2*threads, maxThreads)) {
+		trial.simThreads = threads;
+		setTuning(trial);
+		const double time = timeBenchmark(benchmark);
+		if (threads == 1 || time < best) {
+			best = time;
+			tuning.simThreads = threads;
+		}
+		if (threads >= maxThreads) {
+			break;
+		}
+	}
+	// Leave room for a machine that gains cores between runs
+	if (tuning.simThreads == maxThreads) {
+		tuning.simThreads = 0;
+	}
+	#endif
+	setTuning(tuning);
+}
+
+/** Measures the fastest algorithms and block sizes for this machine.
+ *
+ * autotune() times each candidate algorithm on representative inputs, 
+ * in the spirit of FFTW's planner, and keeps the fastest. It chooses:
+ * - the largest light curve handled by the kernels for short light 
+ *	curves in lombScargle() and dft()
+ * - the number of frequencies those kernels process at a time
+ * - the number of Fourier modes above which PowerLawNoise switches from 
+ *	direct summation to a nonuniform FFT
+ * - the number of arbitrary frequencies above which lombScargle() and 
+ *	dft() may switch from direct summation to a type 3 nonuniform FFT
+ * - the number of threads used by lsThreshold() and lsNormalEdf(), if 
+ *	the library was compiled with OpenMP
+ *
+ * None of these choices changes results beyond rounding error. Timings 
+ * are only meaningful if the machine is otherwise idle.
+ *
+ * @param[in] wisdomFile	The file in which to save the parameters. 
+ *				Pass it to importWisdom(), or name it in the 
+ *				@c TIMESCALES_WISDOM environment variable, to 
+ *				use the parameters in later programs.
+ *
+ * @pre No other thread is calling library functions
+ *
+ * @post The measured parameters are in effect, and saved to @p wisdomFile.
+ *
+ * @perform Takes a few seconds.
+ *
+ * @exception std::runtime_error Thrown if the file could not be written.
+ * @exception std::bad_alloc Thrown if there is not enough memory to run 
+ *	the benchmarks.
+ *
+ * @exceptsafe The parameters in effect are unchanged in the event of an 
+ *	exception.
+ */
+void autotune(const string &wisdomFile) {
+	// Fail before the benchmarks, not after
+	{
+		const string tempName = wisdomFile + ".tmp";
+		std::ofstream out(tempName.c_str(), std::ios::out | std::ios::app);
+		if (!out) {
+			throw std::runtime_error("Could not write wisdom file " + tempName);
+		}
+		out.close();
+		std::remove(tempName.c_str());
+	}
+	
+	const Tuning original = currentTuning();
+	try {
+		Tuning tuning = original;
+		tuneSmallN(tuning);
+		tuneFreqBlock(tuning);
+		tuneNufft(tuning);
+		tuneType3(tuning);
+		tuneThreads(tuning);
+		setTuning(tuning);
+		exportWisdom(wisdomFile);
+	} catch (...) {
+		setTuning(original);
+		throw;
+	}
+}
+
+}		// end kpftimes
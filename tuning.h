@@ -0,0 +1,85 @@
+/** Machine-dependent algorithm parameters. None of these routines are 
+ *	intended as part of the public API.
+ * @file timescales/tuning.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TUNINGH
+#define TUNINGH
+
+#include <cstddef>
+
+namespace kpftimes {
+
+/** Parameters that trade one algorithm or block size for another, 
+ *	without affecting results beyond rounding error.
+ *
+ * @ingroup util
+ */
+struct Tuning {
+	/** The largest light curve handled by the short light curve 
+	 *	kernels. At most MAX_SMALL_N; zero disables the kernels. */
+	size_t smallNLimit;
+	/** The number of frequencies processed together by the short light 
+	 *	curve kernels. Should be small enough that the accumulators for 
+	 *	one block stay in L1 cache while every epoch is applied to them. */
+	size_t freqBlock;
+	/** The smallest number of Fourier modes for which PowerLawNoise uses 
+	 *	a nonuniform FFT instead of direct summation. */
+	size_t nufftMinModes;
+	/** The smallest number of arbitrary frequencies for which 
+	 *	lombScargle() and dft() may use a type 3 nonuniform FFT 
+	 *	instead of direct summation. */
+	size_t type3MinTargets;
+	/** The number of threads used to run simulations, or zero to let 
+	 *	OpenMP decide. */
+	int simThreads;
+};
+
+/** Returns the parameters that apply when no wisdom has been loaded.
+ * @ingroup util
+ */
+Tuning defaultTuning();
+
+/** Returns the parameters currently in effect.
+ * @ingroup util
+ */
+const Tuning& currentTuning();
+
+/** Replaces the parameters currently in effect.
+ * @ingroup util
+ */
+void setTuning(const Tuning &tuning);
+
+/** Returns the number of threads to use for simulations.
+ * @ingroup util
+ */
+int simulationThreads();
+
+}		// end kpftimes
+
+#endif		// end ifndef TUNINGH
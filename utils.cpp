@@ -3,7 +3,7 @@
  * @file timescales/utils.cpp
  * @author Krzysztof Findeisen
  * @date Created April 13, 2011
- * @date Last modified November 19, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -197,4 +197,114 @@ double& FastTable::at(size_t x, size_t y) {
 	return table[dimY*x + y];
 }
 
+/** @copydoc at(size_t, size_t)
+ */
+const double& FastTable::at(size_t x, size_t y) const {
+	return table[dimY*x + y];
+}
+
+/** Returns the X (outer) dimension of the FastTable
+ *
+ * @return The number of rows in the table
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t FastTable::getX() const {
+	return dimX;
+}
+
+/** Returns the Y (inner) dimension of the FastTable
+ *
+ * @return The number of elements in each row of the table
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t FastTable::getY() const {
+	return dimY;
+}
+
+/** Verifies that a validity mask has one flag per epoch.
+ *
+ * @param[in] nTimes	The number of epochs in the light curve
+ * @param[in] mask	The validity flags for the light curve
+ * @param[in] caller	The name of the public function, for use in error 
+ *			messages.
+ *
+ * @exception std::invalid_argument Thrown if @p mask.size() &ne; @p nTimes
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void checkMaskSize(size_t nTimes, const BoolVec &mask, const string &caller) {
+	if (mask.size() != nTimes) {
+		try {
+			throw std::invalid_argument("Parameters 'times' and 'mask' in " + caller + " are not the same length (gave " 
+			+ lexical_cast<string>(nTimes) + " for times and " 
+			+ lexical_cast<string>(mask.size()) + " for mask)");
+		} catch (const boost::bad_lexical_cast& e) {
+			throw std::invalid_argument("Parameters 'times' and 'mask' in " + caller + " are not the same length");
+		}
+	}
+}
+
+/** Lists the unmasked epochs of a light curve.
+ *
+ * @param[in] mask	The validity flags for the light curve
+ * @param[out] valid	The indices i for which @p mask[i] is true, in 
+ *			ascending order
+ *
+ * @perform O(N) time, where N = @p mask.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the list.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void unmaskedIndices(const BoolVec &mask, IndexVec &valid) {
+	// copy-and-swap
+	IndexVec tempValid;
+	tempValid.reserve(static_cast<size_t>(std::count(mask.begin(), mask.end(), true)));
+	for (size_t i = 0; i < mask.size(); i++) {
+		if (mask[i]) {
+			tempValid.push_back(i);
+		}
+	}
+
+	using std::swap;
+	swap(valid, tempValid);
+}
+
+/** Lists the masked and unmasked epochs of a light curve.
+ *
+ * @param[in] mask	The validity flags for the light curve
+ * @param[out] valid	The indices i for which @p mask[i] is true, in 
+ *			ascending order
+ * @param[out] masked	The indices i for which @p mask[i] is false, in 
+ *			ascending order
+ *
+ * @perform O(N) time, where N = @p mask.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the lists.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void maskedIndices(const BoolVec &mask, IndexVec &valid, IndexVec &masked) {
+	// copy-and-swap
+	IndexVec tempValid, tempMasked;
+	size_t nValid = static_cast<size_t>(std::count(mask.begin(), mask.end(), true));
+	tempValid .reserve(nValid);
+	tempMasked.reserve(mask.size() - nValid);
+	for (size_t i = 0; i < mask.size(); i++) {
+		if (mask[i]) {
+			tempValid .push_back(i);
+		} else {
+			tempMasked.push_back(i);
+		}
+	}
+
+	using std::swap;
+	swap(valid , tempValid );
+	swap(masked, tempMasked);
+}
+
 }
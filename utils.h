@@ -2,7 +2,7 @@
  * @file timescales/utils.h
  * @author Krzysztof Findeisen
  * @date Created April 13, 2011
- * @date Last modified November 19, 2013
+ * @date Last modified October 18, 2026
  */
  
 /* Copyright 2014, California Institute of Technology.
@@ -27,12 +27,22 @@
  * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef UTILSH
+#define UTILSH
+
 #include <stdexcept>
+#include <string>
 #include <vector>
  
 /** A convenient shorthand for vectors of doubles.
  */
 typedef std::vector<double> DoubleVec;
+/** A convenient shorthand for per-epoch validity flags.
+ */
+typedef std::vector<bool> BoolVec;
+/** A convenient shorthand for lists of epochs.
+ */
+typedef std::vector<size_t> IndexVec;
 
 namespace kpftimes {
 
@@ -57,6 +67,9 @@ public:
 	/** Access function to allow reads and writes of a table element.
 	 */
 	double& at(size_t x, size_t y);
+	/** Access function to allow reads of a table element.
+	 */
+	const double& at(size_t x, size_t y) const;
 	
 	/** Returns the X (outer) dimension of the FastTable
 	 */
@@ -70,7 +83,20 @@ private:
 	const size_t dimX, dimY;
 };
 
+/** Verifies that a validity mask has one flag per epoch.
+ */
+void checkMaskSize(size_t nTimes, const BoolVec &mask, const std::string &caller);
+
+/** Lists the unmasked epochs of a light curve.
+ */
+void unmaskedIndices(const BoolVec &mask, IndexVec &valid);
+
+/** Lists the masked and unmasked epochs of a light curve.
+ */
+void maskedIndices(const BoolVec &mask, IndexVec &valid, IndexVec &masked);
 
 /** @} */
 
 }
+
+#endif		// end ifndef UTILSH
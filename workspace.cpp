@@ -0,0 +1,525 @@
+/** Reusable scratch memory for library calls
+ * @file timescales/workspace.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <pthread.h>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_fft_complex.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+#include <gsl/gsl_fft_real.h>
+#include "timescales.h"
+#include "workspace.h"
+#include "../common/alloc.tmp.h"
+
+namespace kpftimes {
+
+using boost::shared_ptr;
+using kpfutils::checkAlloc;
+
+/** Creates an empty set of pools.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Workspace::Pools::Pools() : doubles(), complexes(), indices(), bools(), 
+		nDoubles(0), nComplexes(0), nIndices(0), nBools(0), 
+		tableSize(0), halfcomplexTable(), spaceSize(0), realSpace(), 
+		complexTableSize(0), oldComplexTableSize(0), complexTable(), oldComplexTable(), 
+		complexSpaceSize(0), oldComplexSpaceSize(0), complexSpace(), oldComplexSpace() {
+}
+
+/** Creates a workspace that holds no memory.
+ *
+ * Memory is allocated the first time the workspace is used.
+ *
+ * @post getBytes() = 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Workspace::Workspace() : pools(NULL) {
+}
+
+/** Creates a workspace that holds no memory.
+ *
+ * Workspaces never share buffers, so a copy of a workspace starts empty.
+ *
+ * @param[in] other	The workspace to copy. Ignored.
+ *
+ * @post getBytes() = 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Workspace::Workspace(const Workspace &) : pools(NULL) {
+}
+
+/** Does nothing.
+ *
+ * Workspaces never share buffers, so assignment keeps this workspace's 
+ * own memory.
+ *
+ * @param[in] other	The workspace to copy. Ignored.
+ *
+ * @return A reference to this object
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Workspace& Workspace::operator=(const Workspace &) {
+	return *this;
+}
+
+/** Frees all memory held by the workspace.
+ *
+ * @pre No function is using the workspace
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Workspace::~Workspace() {
+	delete pools;
+}
+
+/** Frees all memory held by the workspace.
+ *
+ * @pre No function is using the workspace
+ *
+ * @post getBytes() = 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void Workspace::release() {
+	delete pools;
+	pools = NULL;
+}
+
+/** Returns the amount of memory held for reuse.
+ *
+ * @return The total capacity, in bytes, of the buffers held by the 
+ *	workspace. Does not include FFT tables or bookkeeping.
+ *
+ * @perform O(B) time, where B is the number of buffers held
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t Workspace::getBytes() const {
+	if (pools == NULL) {
+		return 0;
+	}
+	
+	size_t bytes = 0;
+	for (size_t i = 0; i < pools->doubles.size(); i++) {
+		bytes += pools->doubles[i].capacity() * sizeof(double);
+	}
+	for (size_t i = 0; i < pools->complexes.size(); i++) {
+		bytes += pools->complexes[i].capacity() * sizeof(std::complex<double>);
+	}
+	for (size_t i = 0; i < pools->indices.size(); i++) {
+		bytes += pools->indices[i].capacity() * sizeof(size_t);
+	}
+	for (size_t i = 0; i < pools->bools.size(); i++) {
+		bytes += pools->bools[i].capacity() / 8;
+	}
+	return bytes;
+}
+
+/** Gets the pools of a workspace, creating them if needed.
+ *
+ * @param[in,out] workspace The workspace to use
+ *
+ * @return The workspace's pools.
+ *
+ * @exception std::bad_alloc Thrown if the pools could not be created.
+ *
+ * @exceptsafe The workspace is unchanged in the event of an exception.
+ */
+Workspace::Pools& Workspace::getPools() {
+	if (pools == NULL) {
+		pools = new Pools();
+	}
+	return *pools;
+}
+
+/** Starts borrowing buffers from a workspace.
+ *
+ * @param[in,out] workspace The workspace to borrow from
+ *
+ * @exception std::bad_alloc Thrown if the workspace could not be 
+ *	initialized.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+ScratchFrame::ScratchFrame(Workspace &workspace) : pools(workspace.getPools()), 
+		markDoubles(pools.nDoubles), markComplexes(pools.nComplexes), 
+		markIndices(pools.nIndices), markBools(pools.nBools) {
+}
+
+/** Returns all buffers borrowed by this frame.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+ScratchFrame::~ScratchFrame() {
+	pools.nDoubles   = markDoubles;
+	pools.nComplexes = markComplexes;
+	pools.nIndices   = markIndices;
+	pools.nBools     = markBools;
+}
+
+/** Takes the next free buffer from a pool.
+ *
+ * @param[in,out] pool	The buffers to choose from
+ * @param[in,out] used	The number of buffers in @p pool already in use
+ * @param[in] n		The number of elements needed
+ *
+ * @return A buffer with @p n elements, whose values are unspecified.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the buffer.
+ *
+ * @exceptsafe The pool is unchanged in the event of an exception, 
+ *	except possibly for the capacity of its buffers.
+ */
+template <typename Vec>
+Vec& takeBuffer(std::deque<Vec> &pool, size_t &used, size_t n) {
+	if (used == pool.size()) {
+		pool.push_back(Vec());
+	}
+	Vec& buffer = pool[used];
+	buffer.resize(n);
+	used++;
+	return buffer;
+}
+
+/** Borrows a vector of doubles.
+ *
+ * @param[in] n	The number of elements needed
+ *
+ * @return A vector of @p n elements, with unspecified values, that 
+ *	remains valid until this frame is destroyed. It may be resized 
+ *	or swapped with another vector freely.
+ *
+ * @perform Amortized constant time if the workspace has already served 
+ *	a request at least as large; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the vector.
+ *
+ * @exceptsafe No buffer is lent in the event of an exception.
+ */
+DoubleVec& ScratchFrame::doubles(size_t n) {
+	return takeBuffer(pools.doubles, pools.nDoubles, n);
+}
+
+/** Borrows a vector of complex numbers.
+ *
+ * @param[in] n	The number of elements needed
+ *
+ * @return A vector of @p n elements, with unspecified values, that 
+ *	remains valid until this frame is destroyed.
+ *
+ * @perform Amortized constant time if the workspace has already served 
+ *	a request at least as large; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the vector.
+ *
+ * @exceptsafe No buffer is lent in the event of an exception.
+ */
+ComplexVec& ScratchFrame::complexes(size_t n) {
+	return takeBuffer(pools.complexes, pools.nComplexes, n);
+}
+
+/** Borrows a vector of indices.
+ *
+ * @param[in] n	The number of elements needed
+ *
+ * @return A vector of @p n elements, with unspecified values, that 
+ *	remains valid until this frame is destroyed.
+ *
+ * @perform Amortized constant time if the workspace has already served 
+ *	a request at least as large; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the vector.
+ *
+ * @exceptsafe No buffer is lent in the event of an exception.
+ */
+IndexVec& ScratchFrame::indices(size_t n) {
+	return takeBuffer(pools.indices, pools.nIndices, n);
+}
+
+/** Borrows a vector of flags.
+ *
+ * @param[in] n	The number of elements needed
+ *
+ * @return A vector of @p n elements, with unspecified values, that 
+ *	remains valid until this frame is destroyed.
+ *
+ * @perform Amortized constant time if the workspace has already served 
+ *	a request at least as large; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the vector.
+ *
+ * @exceptsafe No buffer is lent in the event of an exception.
+ */
+BoolVec& ScratchFrame::bools(size_t n) {
+	return takeBuffer(pools.bools, pools.nBools, n);
+}
+
+/** Returns a cached GSL wavetable for a halfcomplex FFT.
+ *
+ * Only the most recently requested length is cached, so that a long 
+ * series of transforms of different lengths does not accumulate tables.
+ *
+ * @param[in] n	The length of the transform
+ *
+ * @return A wavetable for transforms of length @p n, owned by the 
+ *	workspace.
+ *
+ * @perform Constant time if the last table requested from the workspace 
+ *	had the same length; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the table.
+ *
+ * @exceptsafe The workspace is unchanged in the event of an exception.
+ */
+gsl_fft_halfcomplex_wavetable* ScratchFrame::halfcomplexTable(size_t n) {
+	if (pools.halfcomplexTable.get() == NULL || pools.tableSize != n) {
+		shared_ptr<gsl_fft_halfcomplex_wavetable> table(checkAlloc(
+			gsl_fft_halfcomplex_wavetable_alloc(n)), 
+			&gsl_fft_halfcomplex_wavetable_free);
+		
+		// IMPORTANT: no exceptions beyond this point
+		
+		pools.halfcomplexTable.swap(table);
+		pools.tableSize = n;
+	}
+	return pools.halfcomplexTable.get();
+}
+
+/** Returns a cached GSL workspace for a real or halfcomplex FFT.
+ *
+ * Only the most recently requested length is cached, so that a long 
+ * series of transforms of different lengths does not accumulate 
+ * workspaces.
+ *
+ * @param[in] n	The length of the transform
+ *
+ * @return A GSL workspace for transforms of length @p n, owned by the 
+ *	workspace.
+ *
+ * @perform Constant time if the last GSL workspace requested had the 
+ *	same length; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the GSL workspace.
+ *
+ * @exceptsafe The workspace is unchanged in the event of an exception.
+ */
+gsl_fft_real_workspace* ScratchFrame::realSpace(size_t n) {
+	if (pools.realSpace.get() == NULL || pools.spaceSize != n) {
+		shared_ptr<gsl_fft_real_workspace> space(checkAlloc(
+			gsl_fft_real_workspace_alloc(n)), 
+			&gsl_fft_real_workspace_free);
+		
+		// IMPORTANT: no exceptions beyond this point
+		
+		pools.realSpace.swap(space);
+		pools.spaceSize = n;
+	}
+	return pools.realSpace.get();
+}
+
+/** Returns a GSL object from a cache of the two most recently used 
+ *	transform lengths, creating it if needed.
+ *
+ * @param[in] n	The length of the transform
+ * @param[in,out] size, object	The most recently used length and its object
+ * @param[in,out] oldSize, oldObject The length and object used before that
+ * @param[in] create, destroy	The GSL functions that allocate and free 
+ *			an object of type @p T
+ *
+ * @return An object for transforms of length @p n, owned by the cache.
+ *
+ * @post @p object is the returned object, and @p oldObject is whichever 
+ *	of the previous two objects was used most recently, if it was not 
+ *	the one returned.
+ *
+ * @perform Constant time if one of the last two objects requested had 
+ *	the same length; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the object.
+ *
+ * @exceptsafe The cache is unchanged in the event of an exception.
+ */
+template <typename T>
+T* cachedFftObject(size_t n, size_t &size, shared_ptr<T> &object, 
+		size_t &oldSize, shared_ptr<T> &oldObject, 
+		T* (*create)(size_t), void (*destroy)(T*)) {
+	if (object.get() != NULL && size == n) {
+		return object.get();
+	}
+	if (oldObject.get() != NULL && oldSize == n) {
+		object.swap(oldObject);
+		std::swap(size, oldSize);
+		return object.get();
+	}
+	
+	shared_ptr<T> newObject(checkAlloc(create(n)), destroy);
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	oldObject.swap(object);
+	oldSize = size;
+	object.swap(newObject);
+	size = n;
+	return object.get();
+}
+
+/** Returns a cached GSL wavetable for a complex FFT.
+ *
+ * The two most recently requested lengths are cached, so that 
+ * alternating between two transforms does not rebuild the tables, 
+ * while a long series of transforms of different lengths does not 
+ * accumulate them.
+ *
+ * @param[in] n	The length of the transform
+ *
+ * @return A wavetable for transforms of length @p n, owned by the 
+ *	workspace.
+ *
+ * @perform Constant time if one of the last two tables requested from 
+ *	the workspace had the same length; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the table.
+ *
+ * @exceptsafe The workspace is unchanged in the event of an exception.
+ */
+gsl_fft_complex_wavetable* ScratchFrame::complexTable(size_t n) {
+	return cachedFftObject(n, pools.complexTableSize, pools.complexTable, 
+		pools.oldComplexTableSize, pools.oldComplexTable, 
+		&gsl_fft_complex_wavetable_alloc, &gsl_fft_complex_wavetable_free);
+}
+
+/** Returns a cached GSL workspace for a complex FFT.
+ *
+ * The two most recently requested lengths are cached.
+ *
+ * @param[in] n	The length of the transform
+ *
+ * @return A GSL workspace for transforms of length @p n, owned by the 
+ *	workspace.
+ *
+ * @perform Constant time if one of the last two GSL workspaces requested 
+ *	had the same length; otherwise O(@p n).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	create the GSL workspace.
+ *
+ * @exceptsafe The workspace is unchanged in the event of an exception.
+ */
+gsl_fft_complex_workspace* ScratchFrame::complexSpace(size_t n) {
+	return cachedFftObject(n, pools.complexSpaceSize, pools.complexSpace, 
+		pools.oldComplexSpaceSize, pools.oldComplexSpace, 
+		&gsl_fft_complex_workspace_alloc, &gsl_fft_complex_workspace_free);
+}
+
+/** The calling thread's default workspace, if it has one
+ */
+__thread Workspace *threadDefault = NULL;
+/** Key whose destructor frees each thread's default workspace when the 
+ *	thread exits
+ */
+pthread_key_t threadDefaultKey;
+/** Whether threadDefaultKey could be created
+ */
+bool threadDefaultKeyValid = false;
+/** Makes sure threadDefaultKey is created exactly once
+ */
+pthread_once_t threadDefaultOnce = PTHREAD_ONCE_INIT;
+
+/** Frees a thread's default workspace.
+ *
+ * @param[in] workspace	The workspace to free
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void deleteThreadDefault(void *workspace) {
+	delete static_cast<Workspace*>(workspace);
+}
+
+/** Creates threadDefaultKey.
+ *
+ * @post If the key could be created, threadDefaultKeyValid is true.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void makeThreadDefaultKey() {
+	threadDefaultKeyValid = (pthread_key_create(&threadDefaultKey, 
+			&deleteThreadDefault) == 0);
+}
+
+/** Returns the calling thread's default workspace.
+ *
+ * Each thread has its own default workspace, created the first time the 
+ * thread calls this function. Functions that have a Workspace overload 
+ * use it when called without one, so a thread that calls them 
+ * repeatedly reuses the same memory.
+ *
+ * @return A workspace that only the calling thread uses.
+ *
+ * @post The workspace's memory is freed when the thread exits. The 
+ *	caller may free it earlier with Workspace::release(), provided 
+ *	no function is using it.
+ *
+ * @perform Constant time
+ *
+ * @exception std::bad_alloc Thrown if the workspace could not be 
+ *	created.
+ *
+ * @exceptsafe The program state is unchanged in the event of an 
+ *	exception.
+ */
+Workspace& threadWorkspace() {
+	if (threadDefault == NULL) {
+		pthread_once(&threadDefaultOnce, &makeThreadDefaultKey);
+		Workspace *workspace = new Workspace();
+		
+		// IMPORTANT: no exceptions beyond this point
+		
+		if (threadDefaultKeyValid) {
+			pthread_setspecific(threadDefaultKey, workspace);
+		}
+		threadDefault = workspace;
+	}
+	return *threadDefault;
+}
+
+}		// end kpftimes
@@ -0,0 +1,170 @@
+/** Reusable scratch memory for library calls. None of these routines are 
+ *	intended as part of the public API.
+ * @file timescales/workspace.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the Timescales library.
+ * 
+ * The Timescales library is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following 
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors 
+ *	  may be used to endorse or promote products derived from this software 
+ *	  without specific prior written permission.
+ * 
+ * The Timescales library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with the Timescales library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKSPACEH
+#define WORKSPACEH
+
+#include <complex>
+#include <deque>
+#include <vector>
+#include <boost/smart_ptr.hpp>
+#include <gsl/gsl_fft_complex.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+#include <gsl/gsl_fft_real.h>
+#include "dft.h"
+#include "timescales.h"
+#include "utils.h"
+
+namespace kpftimes {
+
+/** The buffers owned by a Workspace.
+ *
+ * Each pool holds buffers in the order they were first requested. The 
+ * first @p nX buffers of pool X are in use by a ScratchFrame. Pools are 
+ * deques so that adding a buffer never moves the existing ones.
+ *
+ * @ingroup util
+ */
+struct Workspace::Pools {
+	Pools();
+
+	std::deque<DoubleVec > doubles;
+	std::deque<ComplexVec> complexes;
+	std::deque<IndexVec  > indices;
+	std::deque<BoolVec   > bools;
+	size_t nDoubles, nComplexes, nIndices, nBools;
+
+	// FFT tables for the most recent transform length
+	size_t tableSize;
+	boost::shared_ptr<gsl_fft_halfcomplex_wavetable> halfcomplexTable;
+	size_t spaceSize;
+	boost::shared_ptr<gsl_fft_real_workspace> realSpace;
+	// Complex FFT tables for the two most recent transform lengths, 
+	//	since nufftType3() is often called in pairs with different grids
+	size_t complexTableSize, oldComplexTableSize;
+	boost::shared_ptr<gsl_fft_complex_wavetable> complexTable, oldComplexTable;
+	size_t complexSpaceSize, oldComplexSpaceSize;
+	boost::shared_ptr<gsl_fft_complex_workspace> complexSpace, oldComplexSpace;
+};
+
+/** Lends buffers from a Workspace for the duration of one function call.
+ *
+ * Buffers handed out by a ScratchFrame stay valid until the frame is 
+ * destroyed, and are then returned to the Workspace for the next call. 
+ * Frames must be destroyed in the reverse order of their creation, 
+ * which is automatic if each frame is a local variable.
+ *
+ * Once a Workspace has served a call, further calls with the same or 
+ * smaller inputs allocate no memory.
+ *
+ * @ingroup util
+ */
+class ScratchFrame {
+public:
+	/** Starts borrowing buffers from a workspace.
+	 */
+	explicit ScratchFrame(Workspace &workspace);
+	/** Returns all buffers borrowed by this frame.
+	 */
+	~ScratchFrame();
+
+	/** Borrows a vector of doubles.
+	 */
+	DoubleVec & doubles  (size_t n);
+	/** Borrows a vector of complex numbers.
+	 */
+	ComplexVec& complexes(size_t n);
+	/** Borrows a vector of indices.
+	 */
+	IndexVec  & indices  (size_t n);
+	/** Borrows a vector of flags.
+	 */
+	BoolVec   & bools    (size_t n);
+
+	/** Returns a cached GSL wavetable for a halfcomplex FFT.
+	 *
+	 * The table is only valid until the next call to halfcomplexTable().
+	 */
+	gsl_fft_halfcomplex_wavetable* halfcomplexTable(size_t n);
+	/** Returns a cached GSL workspace for a real or halfcomplex FFT.
+	 *
+	 * The workspace is only valid until the next call to realSpace().
+	 */
+	gsl_fft_real_workspace* realSpace(size_t n);
+	/** Returns a cached GSL wavetable for a complex FFT.
+	 *
+	 * The table is only valid until the second-next call to 
+	 * complexTable().
+	 */
+	gsl_fft_complex_wavetable* complexTable(size_t n);
+	/** Returns a cached GSL workspace for a complex FFT.
+	 *
+	 * The workspace is only valid until the second-next call to 
+	 * complexSpace().
+	 */
+	gsl_fft_complex_workspace* complexSpace(size_t n);
+
+private:
+	// Not copyable
+	ScratchFrame(const ScratchFrame &other);
+	ScratchFrame& operator=(const ScratchFrame &other);
+
+	Workspace::Pools& pools;
+	const size_t markDoubles, markComplexes, markIndices, markBools;
+};
+
+/** Stores a result that was calculated in a borrowed buffer.
+ *
+ * If @p result already has room for the answer it is overwritten in 
+ * place, so that neither @p result nor the workspace lose their memory. 
+ * Otherwise the two vectors are swapped.
+ *
+ * @param[in,out] temp	The finished result, in a buffer borrowed from a 
+ *			ScratchFrame
+ * @param[out] result	The vector to receive the result
+ *
+ * @post @p result contains the old value of @p temp
+ *
+ * @exceptsafe Does not throw exceptions, provided that copying an 
+ *	element of @p Vec does not throw.
+ */
+template <typename Vec>
+void storeResult(Vec &temp, Vec &result) {
+	if (result.capacity() >= temp.size()) {
+		result.assign(temp.begin(), temp.end());
+	} else {
+		using std::swap;
+		swap(result, temp);
+	}
+}
+
+}		// end kpftimes
+
+#endif		// end ifndef WORKSPACEH